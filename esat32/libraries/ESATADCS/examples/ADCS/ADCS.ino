@@ -21,6 +21,7 @@
 
 #include <ESAT_ADCS.h>
 #include <ESAT_ADCS-actuators/ESAT_ADCSLED.h>
+#include <ESAT_ADCS-measurements/ESAT_Gyroscope.h>
 #ifdef ARDUINO_ESAT_OBC
 #include <ESAT_I2CMaster.h>
 #endif /* ARDUINO_ESAT_OBC */
@@ -39,7 +40,21 @@
 
 // Target period (in milliseconds) for main loop activities with the
 // exception of the response to I2C requests.
-constexpr word TARGET_PERIOD = 1000;
+// With pipelined sensor acquisition, the sensors are ready some
+// 30 milliseconds after the start of the period, so the loop runs
+// four times as fast as with blocking acquisition while the
+// magnetorquers still stay on for close to 90 % of the period.
+constexpr word TARGET_PERIOD = 250;
+
+// Time (in microseconds) the magnetorquer field needs to settle
+// before measuring the magnetic field.
+const unsigned long MAGNETORQUER_SETTLE_TIME = 20000;
+
+// The gyroscope gathers its samples in its FIFO at
+// 1 kHz / (1 + GYROSCOPE_SAMPLE_RATE_DIVIDER): 200 samples per second
+// fit in the FIFO for periods up to a bit more than 1 second, so a
+// reading averages some 50 samples per TARGET_PERIOD.
+const byte GYROSCOPE_SAMPLE_RATE_DIVIDER = 4;
 
 // Maximum packet data length we will handle.
 const word PACKET_DATA_BUFFER_LENGTH = 1024;
@@ -77,12 +92,17 @@ void setup()
   ESAT_ADCS.enableUSBTelecommands(telecommandPacketData,
                                   sizeof(telecommandPacketData));
   ESAT_ADCS.begin();
+  ESAT_ADCS.enablePipelinedSensorAcquisition(MAGNETORQUER_SETTLE_TIME);
+  ESAT_Gyroscope.enableFIFO(GYROSCOPE_SAMPLE_RATE_DIVIDER);
   ESAT_ADCSLED.begin();
   ESAT_Timer.begin(TARGET_PERIOD);
 }
 
 // Body of the main loop of the program:
 // - Update the heartbeat LED to prove that the ADCS board is working.
+// - Start reading the sensors once per period and advance the
+//   sensor acquisition without waiting.
+// When the sensor readings are ready:
 // - Retrieve the incomming telecommands (from the I2C interface
 //   and from the USB interface).
 // - Handle the incoming telecommands.
@@ -97,6 +117,11 @@ void loop()
 {
   LEDHeartbeat();
   if (ESAT_Timer.elapsedMilliseconds() >= TARGET_PERIOD)
+  {
+    ESAT_ADCS.startSensorAcquisition();
+    ESAT_Timer.begin(TARGET_PERIOD);
+  }
+  if (ESAT_ADCS.acquireSensors())
   {
     byte buffer[PACKET_DATA_BUFFER_LENGTH];
     ESAT_CCSDSPacket packet(buffer, sizeof(buffer));
@@ -109,7 +134,6 @@ void loop()
     {
       ESAT_ADCS.writeTelemetry(packet);
     }
-    ESAT_Timer.begin(TARGET_PERIOD);
   }
   ESAT_ADCS.respondToI2CRequests();
 }
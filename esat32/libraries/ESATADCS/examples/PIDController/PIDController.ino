@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <ESAT_ADCS-controllers/ESAT_PIDController.h>
+#include <ESAT_ADCS-controllers/ESAT_Q31PIDController.h>
+
+// On-board benchmark of the PID control engines on a simulated
+// wheel: the target speed steps up to 10000 rpm, beyond the maximum
+// wheel speed, and then down to 2000 rpm.  For the former wheel PID
+// controller and for each engine with and without derivative term,
+// the program writes the settling time (to 2 % of the target) of the
+// last step and the processing time per update (in processor cycles
+// on STM32 boards, in microseconds elsewhere) through the USB
+// interface.  On STM32 boards, the engines run on the CMSIS-DSP PID
+// functions, and the program also writes the processing time of bare
+// calls to arm_pid_f32() and arm_pid_q31().
+// The host build in extras/host runs the same simulation and
+// compares the results of the engines in detail.
+
+// Simulation period (in seconds).
+const float PERIOD = 0.1;
+
+// Length of the steps of the target speed (in iterations).
+const unsigned long FIRST_STEP_ITERATIONS = 400;
+const unsigned long SECOND_STEP_ITERATIONS = 1200;
+const unsigned long ITERATIONS =
+  FIRST_STEP_ITERATIONS + SECOND_STEP_ITERATIONS;
+
+// Time constant (in seconds) of the wheel speed response.
+const float WHEEL_TIME_CONSTANT = 0.5;
+
+// Maximum wheel speed (in revolutions per minute).
+const float MAXIMUM_SPEED = 8000;
+
+// Full scale (in revolutions per minute) of the errors and commands
+// of the fixed-point engine.  It must cover the largest error
+// (10000 rpm at the start), or the fixed-point engine would see
+// saturated errors that the floating-point engine doesn't see.
+const float FULL_SCALE = 16000;
+
+// Default wheel PID controller gains.
+const float PROPORTIONAL_GAIN = 1.5;
+const float INTEGRAL_GAIN = 0.3;
+
+// Derivative gain (in seconds), derivative filter time constant (in
+// seconds) and slew rate limit (in revolutions per minute per second)
+// of the runs with derivative term.
+const float DERIVATIVE_GAIN = 0.05;
+const float DERIVATIVE_FILTER_TIME_CONSTANT = 0.3;
+const float SLEW_RATE_LIMIT = 20000;
+
+// Controllers under test.
+enum Controller
+{
+  FORMER_CONTROLLER,
+  FLOATING_POINT_ENGINE,
+  FIXED_POINT_ENGINE,
+};
+
+// Engines under test.
+ESAT_PIDController floatingPointEngine;
+ESAT_Q31PIDController fixedPointEngine;
+
+// State of the former wheel PID controller.
+float formerErrorIntegral;
+int formerPreviousError;
+
+// Return the current processor time in cycles on STM32 boards or
+// in microseconds elsewhere.
+unsigned long processorTime()
+{
+#ifdef ARDUINO_ARCH_STM32
+  return dwt_getCycles();
+#else
+  return micros();
+#endif /* ARDUINO_ARCH_STM32 */
+}
+
+// Return the speed command of the former wheel PID controller.
+float formerControllerUpdate(const int error, const float derivativeGain)
+{
+  formerErrorIntegral = formerErrorIntegral + error * PERIOD;
+  const float errorDerivative =
+    (float(error) - float(formerPreviousError)) / PERIOD;
+  formerPreviousError = error;
+  const float control =
+    PROPORTIONAL_GAIN * error
+    + INTEGRAL_GAIN * formerErrorIntegral
+    + derivativeGain * errorDerivative;
+  return constrain(control, 0, MAXIMUM_SPEED);
+}
+
+// Return the target speed (in revolutions per minute) at the given
+// iteration.
+float targetSpeed(const unsigned long iteration)
+{
+  if (iteration < FIRST_STEP_ITERATIONS)
+  {
+    return 10000;
+  }
+  return 2000;
+}
+
+// Write the name and the processing time per update.
+void writeProcessingTime(const char* const name,
+                         const unsigned long processingTime)
+{
+  Serial.print(name);
+  Serial.print(": processing time per update ");
+  Serial.println(float(processingTime) / ITERATIONS);
+}
+
+#ifdef ARDUINO_ARCH_STM32
+// Measure and write the processing time of bare calls to the
+// CMSIS-DSP PID functions with the errors of a simulated wheel
+// speed ramp.  The gains are scaled down by 4 for arm_pid_q31(),
+// as ESAT_Q31PIDController does.
+void measureCMSISDSPFunctions()
+{
+  arm_pid_instance_f32 floatingPointInstance;
+  floatingPointInstance.Kp = PROPORTIONAL_GAIN;
+  floatingPointInstance.Ki = INTEGRAL_GAIN * PERIOD;
+  floatingPointInstance.Kd = DERIVATIVE_GAIN / PERIOD;
+  arm_pid_init_f32(&floatingPointInstance, 1);
+  const float coefficientScale = ESAT_Q31PIDController::MAXIMUM / 4.0;
+  arm_pid_instance_q31 fixedPointInstance;
+  fixedPointInstance.Kp = long(PROPORTIONAL_GAIN * coefficientScale);
+  fixedPointInstance.Ki = long(INTEGRAL_GAIN * PERIOD * coefficientScale);
+  fixedPointInstance.Kd = long(DERIVATIVE_GAIN / PERIOD * coefficientScale);
+  arm_pid_init_q31(&fixedPointInstance, 1);
+  unsigned long floatingPointProcessingTime = 0;
+  unsigned long fixedPointProcessingTime = 0;
+  volatile float floatingPointOutput;
+  volatile long fixedPointOutput;
+  for (unsigned long iteration = 0; iteration < ITERATIONS; iteration++)
+  {
+    const float error =
+      targetSpeed(iteration) - MAXIMUM_SPEED * iteration / ITERATIONS;
+    const unsigned long floatingPointStartTime = processorTime();
+    floatingPointOutput = arm_pid_f32(&floatingPointInstance, error);
+    floatingPointProcessingTime = floatingPointProcessingTime
+      + (processorTime() - floatingPointStartTime);
+    const long scaledError =
+      long(error / FULL_SCALE * ESAT_Q31PIDController::MAXIMUM);
+    const unsigned long fixedPointStartTime = processorTime();
+    fixedPointOutput = arm_pid_q31(&fixedPointInstance, scaledError);
+    fixedPointProcessingTime = fixedPointProcessingTime
+      + (processorTime() - fixedPointStartTime);
+  }
+  (void) floatingPointOutput;
+  (void) fixedPointOutput;
+  writeProcessingTime("arm_pid_f32() alone", floatingPointProcessingTime);
+  writeProcessingTime("arm_pid_q31() alone", fixedPointProcessingTime);
+}
+#endif /* ARDUINO_ARCH_STM32 */
+
+// Run the simulation with the given controller, with or without
+// derivative term, and write the results.
+void simulate(const Controller controller,
+              const boolean derivative,
+              const char* const name)
+{
+  const float derivativeGain = derivative ? DERIVATIVE_GAIN : 0;
+  formerErrorIntegral = 0;
+  formerPreviousError = 0;
+  floatingPointEngine.begin();
+  floatingPointEngine.setOutputLimits(0, MAXIMUM_SPEED);
+  fixedPointEngine.begin();
+  fixedPointEngine.setOutputLimits(0,
+                                   long(MAXIMUM_SPEED / FULL_SCALE
+                                        * fixedPointEngine.MAXIMUM));
+  if (derivative)
+  {
+    floatingPointEngine.setDerivativeFilter(DERIVATIVE_FILTER_TIME_CONSTANT);
+    floatingPointEngine.setSlewRateLimit(SLEW_RATE_LIMIT);
+    fixedPointEngine.setDerivativeFilter(DERIVATIVE_FILTER_TIME_CONSTANT);
+    fixedPointEngine.setSlewRateLimit(SLEW_RATE_LIMIT / FULL_SCALE);
+  }
+  float speed = 0;
+  unsigned long settlingIteration = FIRST_STEP_ITERATIONS;
+  unsigned long processingTime = 0;
+  for (unsigned long iteration = 0; iteration < ITERATIONS; iteration++)
+  {
+    const float target = targetSpeed(iteration);
+    const int error = int(target) - int(speed);
+    float command = 0;
+    const unsigned long startTime = processorTime();
+    switch (controller)
+    {
+      case FORMER_CONTROLLER:
+        command = formerControllerUpdate(error, derivativeGain);
+        break;
+      case FLOATING_POINT_ENGINE:
+        floatingPointEngine.configure(PROPORTIONAL_GAIN,
+                                      INTEGRAL_GAIN,
+                                      derivativeGain,
+                                      PERIOD);
+        command = floatingPointEngine.update(error);
+        break;
+      case FIXED_POINT_ENGINE:
+        fixedPointEngine.configure(PROPORTIONAL_GAIN,
+                                   INTEGRAL_GAIN,
+                                   derivativeGain,
+                                   PERIOD);
+        command = fixedPointEngine.update(long(error / FULL_SCALE
+                                               * fixedPointEngine.MAXIMUM))
+          * (FULL_SCALE / fixedPointEngine.MAXIMUM);
+        break;
+      default:
+        break;
+    }
+    processingTime = processingTime + (processorTime() - startTime);
+    speed = speed + (command - speed) * PERIOD / WHEEL_TIME_CONSTANT;
+    if (iteration >= FIRST_STEP_ITERATIONS)
+    {
+      if (abs(speed - target) > 0.02 * target)
+      {
+        settlingIteration = iteration + 1;
+      }
+    }
+  }
+  Serial.print(name);
+  Serial.print(": settling time (s) ");
+  Serial.println((settlingIteration - FIRST_STEP_ITERATIONS) * PERIOD);
+  writeProcessingTime(name, processingTime);
+}
+
+// Run the simulations.
+void setup()
+{
+  Serial.begin(9600);
+  simulate(FORMER_CONTROLLER, false, "Former wheel PID controller, PI");
+  simulate(FLOATING_POINT_ENGINE, false, "Floating-point PID engine, PI");
+  simulate(FIXED_POINT_ENGINE, false, "Fixed-point PID engine, PI");
+  simulate(FORMER_CONTROLLER, true, "Former wheel PID controller, PID");
+  simulate(FLOATING_POINT_ENGINE, true,
+           "Floating-point PID engine, PID, filter, slew limit");
+  simulate(FIXED_POINT_ENGINE, true,
+           "Fixed-point PID engine, PID, filter, slew limit");
+#ifdef ARDUINO_ARCH_STM32
+  measureCMSISDSPFunctions();
+#endif /* ARDUINO_ARCH_STM32 */
+}
+
+// Nothing left to do.
+void loop()
+{
+}
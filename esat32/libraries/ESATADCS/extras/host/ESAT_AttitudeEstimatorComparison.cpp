@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Comparison of the arithmetics of the attitude estimator on a
+// simulated rotation profile: the satellite stays still, spins up to
+// 10 degrees per second, spins back the other way and stops again
+// while the simulated magnetometer and gyroscope give noisy readings
+// rounded to whole units like the real ones.  Every arithmetic gets
+// the same readings.  The program writes the root mean square errors
+// of the readings and of the estimates of each arithmetic, the
+// largest difference between the estimates of each matrix arithmetic
+// and those of the scalar arithmetic, and the processing time per
+// iteration.
+
+#include <ESAT_ADCS-measurements/ESAT_AttitudeEstimator.h>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+
+// Simulation period (in seconds).
+static const float PERIOD = 0.05;
+
+// Simulation length (in iterations).
+static const int ITERATIONS = 1200;
+
+// Repetitions of the simulation for the processing time.
+static const int TIMING_REPETITIONS = 200;
+
+// Standard deviations of the simulated readings.
+static const float MAGNETIC_ANGLE_NOISE = 2;
+static const float ROTATIONAL_SPEED_NOISE = 1;
+
+// Standard deviation of the random angular acceleration of the
+// estimator model.
+static const float ANGULAR_ACCELERATION_NOISE = 2;
+
+// Simulated attitude and readings.
+static float angles[ITERATIONS];
+static float speeds[ITERATIONS];
+static int measuredAngles[ITERATIONS];
+static int measuredSpeeds[ITERATIONS];
+
+// Estimates of one simulation.
+static float estimatedAngles[ITERATIONS];
+static float estimatedSpeeds[ITERATIONS];
+
+// Return the difference between two angles, normalised between
+// -180 degrees and 180 degrees.
+static float angleDifference(const float minuend, const float subtrahend)
+{
+  float difference = minuend - subtrahend;
+  while (difference > 180)
+  {
+    difference = difference - 360;
+  }
+  while (difference < -180)
+  {
+    difference = difference + 360;
+  }
+  return difference;
+}
+
+// Return the simulated rotational speed (in degrees per second) at
+// the given time (in seconds).
+static float rotationalSpeed(const float time)
+{
+  if (time < 10)
+  {
+    return 0;
+  }
+  if (time < 20)
+  {
+    return time - 10;
+  }
+  if (time < 30)
+  {
+    return 10;
+  }
+  if (time < 40)
+  {
+    return 10 - 2 * (time - 30);
+  }
+  if (time < 50)
+  {
+    return -10 + (time - 40);
+  }
+  return 0;
+}
+
+// Fill the simulated attitude and readings.
+static void simulate()
+{
+  std::mt19937 generator(1);
+  std::normal_distribution<float> angleNoise(0, MAGNETIC_ANGLE_NOISE);
+  std::normal_distribution<float> speedNoise(0, ROTATIONAL_SPEED_NOISE);
+  float angle = 90;
+  for (int iteration = 0; iteration < ITERATIONS; iteration++)
+  {
+    const float speed = rotationalSpeed(iteration * PERIOD);
+    angle = angle - speed * PERIOD;
+    if (angle < 0)
+    {
+      angle = angle + 360;
+    }
+    if (angle >= 360)
+    {
+      angle = angle - 360;
+    }
+    angles[iteration] = angle;
+    speeds[iteration] = speed;
+    const int measuredAngle = lroundf(angle + angleNoise(generator));
+    measuredAngles[iteration] = (measuredAngle + 360) % 360;
+    measuredSpeeds[iteration] = lroundf(speed + speedNoise(generator));
+  }
+}
+
+// Run the estimator with the given arithmetic over the simulated
+// readings and fill the estimates.
+static void estimate(const ESAT_AttitudeEstimator::Arithmetic arithmetic)
+{
+  ESAT_AttitudeEstimator estimator;
+  estimator.setArithmetic(arithmetic);
+  estimator.begin(MAGNETIC_ANGLE_NOISE,
+                  ROTATIONAL_SPEED_NOISE,
+                  ANGULAR_ACCELERATION_NOISE);
+  for (int iteration = 0; iteration < ITERATIONS; iteration++)
+  {
+    estimator.predict(PERIOD);
+    estimator.updateRotationalSpeed(measuredSpeeds[iteration]);
+    estimator.updateAngle(measuredAngles[iteration]);
+    estimatedAngles[iteration] = estimator.angle();
+    estimatedSpeeds[iteration] = estimator.rotationalSpeed();
+  }
+}
+
+// Return the root mean square of the given errors.
+static float rootMeanSquare(const double sumOfSquares)
+{
+  return sqrt(sumOfSquares / ITERATIONS);
+}
+
+int main()
+{
+  simulate();
+  double readingAngleErrors = 0;
+  double readingSpeedErrors = 0;
+  for (int iteration = 0; iteration < ITERATIONS; iteration++)
+  {
+    const float angleError =
+      angleDifference(measuredAngles[iteration], angles[iteration]);
+    const float speedError = measuredSpeeds[iteration] - speeds[iteration];
+    readingAngleErrors = readingAngleErrors + angleError * angleError;
+    readingSpeedErrors = readingSpeedErrors + speedError * speedError;
+  }
+  printf("Readings: angle RMS error %.3f degrees, "
+         "rotational speed RMS error %.3f degrees per second\n",
+         rootMeanSquare(readingAngleErrors),
+         rootMeanSquare(readingSpeedErrors));
+  const struct
+  {
+    ESAT_AttitudeEstimator::Arithmetic arithmetic;
+    const char* name;
+  } arithmetics[] = {
+    {ESAT_AttitudeEstimator::SCALAR_ARITHMETIC, "scalar"},
+    {ESAT_AttitudeEstimator::F32_MATRIX_ARITHMETIC, "arm_mat_mult_f32"},
+    {ESAT_AttitudeEstimator::Q31_MATRIX_ARITHMETIC, "arm_mat_mult_q31"},
+    {ESAT_AttitudeEstimator::Q15_MATRIX_ARITHMETIC, "arm_mat_mult_q15"},
+  };
+  static float scalarAngles[ITERATIONS];
+  static float scalarSpeeds[ITERATIONS];
+  for (const auto& variant : arithmetics)
+  {
+    estimate(variant.arithmetic);
+    if (variant.arithmetic == ESAT_AttitudeEstimator::SCALAR_ARITHMETIC)
+    {
+      memcpy(scalarAngles, estimatedAngles, sizeof(scalarAngles));
+      memcpy(scalarSpeeds, estimatedSpeeds, sizeof(scalarSpeeds));
+    }
+    double angleErrors = 0;
+    double speedErrors = 0;
+    float angleDeviation = 0;
+    float speedDeviation = 0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+      const float angleError =
+        angleDifference(estimatedAngles[iteration], angles[iteration]);
+      const float speedError = estimatedSpeeds[iteration] - speeds[iteration];
+      angleErrors = angleErrors + angleError * angleError;
+      speedErrors = speedErrors + speedError * speedError;
+      angleDeviation =
+        fmaxf(angleDeviation,
+              fabsf(angleDifference(estimatedAngles[iteration],
+                                    scalarAngles[iteration])));
+      speedDeviation =
+        fmaxf(speedDeviation,
+              fabsf(estimatedSpeeds[iteration] - scalarSpeeds[iteration]));
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < TIMING_REPETITIONS; repetition++)
+    {
+      estimate(variant.arithmetic);
+    }
+    const auto endTime = std::chrono::steady_clock::now();
+    const double nanoseconds =
+      std::chrono::duration<double, std::nano>(endTime - startTime).count()
+      / (double(TIMING_REPETITIONS) * ITERATIONS);
+    printf("%s:\n", variant.name);
+    printf("  angle RMS error %.3f degrees, "
+           "rotational speed RMS error %.3f degrees per second\n",
+           rootMeanSquare(angleErrors),
+           rootMeanSquare(speedErrors));
+    printf("  largest difference from scalar: %.2e degrees, "
+           "%.2e degrees per second\n",
+           angleDeviation,
+           speedDeviation);
+    printf("  processing time per iteration: %.1f ns\n", nanoseconds);
+  }
+  return 0;
+}
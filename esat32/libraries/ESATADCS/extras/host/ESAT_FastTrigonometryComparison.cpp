@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Accuracy and speed check of the fast arctangent against the atan2()
+// function of the C library.  The program sweeps the whole circle
+// with vectors of several lengths, from much smaller to much larger
+// than the readings of the magnetometer and the coarse sun sensor,
+// and writes the maximum error of the fast arctangent for each
+// length and the processing time per call of both.
+
+#include <ESAT_ADCS-measurements/ESAT_FastTrigonometry.h>
+#include <chrono>
+#include <stdio.h>
+
+// Number of angles of the sweep.
+static const int ANGLES = 36000;
+
+// Lengths of the vectors of the sweep.
+static const float LENGTHS[] = {1e-30, 1e-3, 1, 300, 32767, 1e30};
+
+// Repetitions of the sweep for the processing time.
+static const int TIMING_REPETITIONS = 100;
+
+// Accumulated result of the calls, so that the compiler doesn't
+// optimise them away.
+static volatile float sink;
+
+// Return the difference between two angles, normalised between
+// -180 degrees and 180 degrees.
+static double angleDifference(const double minuend, const double subtrahend)
+{
+  const double difference = minuend - subtrahend;
+  if (difference > 180)
+  {
+    return difference - 360;
+  }
+  if (difference < -180)
+  {
+    return difference + 360;
+  }
+  return difference;
+}
+
+// Components of the vectors of the sweep with a length of 300.
+static float xComponents[ANGLES];
+static float yComponents[ANGLES];
+
+int main()
+{
+  for (const float length : LENGTHS)
+  {
+    double maximumError = 0;
+    for (int index = 0; index < ANGLES; index++)
+    {
+      const float x = length * cos(index * (2 * M_PI / ANGLES));
+      const float y = length * sin(index * (2 * M_PI / ANGLES));
+      const double exactAngle = atan2(double(y), double(x)) * RAD_TO_DEG;
+      const float fastAngle = ESAT_FastTrigonometry.atan2Degrees(y, x);
+      const double error = fabs(angleDifference(fastAngle, exactAngle));
+      maximumError = fmax(maximumError, error);
+      if (length == 300)
+      {
+        xComponents[index] = x;
+        yComponents[index] = y;
+      }
+    }
+    printf("Length %g: maximum error %.6f degrees\n", length, maximumError);
+  }
+  auto startTime = std::chrono::steady_clock::now();
+  for (int repetition = 0; repetition < TIMING_REPETITIONS; repetition++)
+  {
+    for (int index = 0; index < ANGLES; index++)
+    {
+      sink = sink + atan2f(yComponents[index], xComponents[index]) * RAD_TO_DEG;
+    }
+  }
+  auto endTime = std::chrono::steady_clock::now();
+  printf("atan2f(): processing time per call %.1f ns\n",
+         std::chrono::duration<double, std::nano>(endTime - startTime).count()
+         / (double(TIMING_REPETITIONS) * ANGLES));
+  startTime = std::chrono::steady_clock::now();
+  for (int repetition = 0; repetition < TIMING_REPETITIONS; repetition++)
+  {
+    for (int index = 0; index < ANGLES; index++)
+    {
+      sink = sink
+        + ESAT_FastTrigonometry.atan2Degrees(yComponents[index],
+                                             xComponents[index]);
+    }
+  }
+  endTime = std::chrono::steady_clock::now();
+  printf("Fast arctangent: processing time per call %.1f ns\n",
+         std::chrono::duration<double, std::nano>(endTime - startTime).count()
+         / (double(TIMING_REPETITIONS) * ANGLES));
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Comparison of the PID control engines on a simulated wheel: the
+// target speed steps up to 10000 rpm, beyond the maximum wheel speed
+// (so the wheel speed command saturates and a controller without
+// anti-windup winds up its error integral), and then down to
+// 2000 rpm.  The engines run on the CMSIS-DSP PID functions
+// (arm_pid_f32() and arm_pid_q31()).  For the former wheel PID
+// controller and for each engine with and without derivative term,
+// the program writes the undershoot and the settling time (to 2 % of
+// the target) of the last step, the largest difference between the
+// commands of the fixed-point engine and those of the floating-point
+// engine and the processing time per update.  The speed goes to the
+// controllers in whole revolutions per minute, so when the simulated
+// speeds of the engines round to different whole numbers, their
+// commands differ by about the proportional gain (1.5 rpm); this is
+// the largest difference left between them.
+
+#include <ESAT_ADCS-controllers/ESAT_PIDController.h>
+#include <ESAT_ADCS-controllers/ESAT_Q31PIDController.h>
+#include <chrono>
+#include <stdio.h>
+
+// Simulation period (in seconds).
+static const float PERIOD = 0.1;
+
+// Length of the steps of the target speed (in iterations).
+static const int FIRST_STEP_ITERATIONS = 400;
+static const int SECOND_STEP_ITERATIONS = 1200;
+static const int ITERATIONS = FIRST_STEP_ITERATIONS + SECOND_STEP_ITERATIONS;
+
+// Repetitions of the simulation for the processing time.
+static const int TIMING_REPETITIONS = 2000;
+
+// Time constant (in seconds) of the wheel speed response.
+static const float WHEEL_TIME_CONSTANT = 0.5;
+
+// Maximum wheel speed (in revolutions per minute).
+static const float MAXIMUM_SPEED = 8000;
+
+// Full scale (in revolutions per minute) of the errors and commands
+// of the fixed-point engine.  It must cover the largest error
+// (10000 rpm at the start), or the fixed-point engine would see
+// saturated errors, and so different error derivatives, that the
+// floating-point engine doesn't see.
+static const float FULL_SCALE = 16000;
+
+// Default wheel PID controller gains.
+static const float PROPORTIONAL_GAIN = 1.5;
+static const float INTEGRAL_GAIN = 0.3;
+
+// Derivative gain (in seconds), derivative filter time constant (in
+// seconds) and slew rate limit (in revolutions per minute per second)
+// of the runs with derivative term.
+static const float DERIVATIVE_GAIN = 0.05;
+static const float DERIVATIVE_FILTER_TIME_CONSTANT = 0.3;
+static const float SLEW_RATE_LIMIT = 20000;
+
+// Controllers under test.
+enum Controller
+{
+  FORMER_CONTROLLER,
+  FLOATING_POINT_ENGINE,
+  FIXED_POINT_ENGINE,
+};
+
+// Wheel speed commands of one simulation.
+static float commands[ITERATIONS];
+
+// Return the target speed (in revolutions per minute) at the given
+// iteration.
+static float targetSpeed(const int iteration)
+{
+  if (iteration < FIRST_STEP_ITERATIONS)
+  {
+    return 10000;
+  }
+  return 2000;
+}
+
+// Run the simulation with the given controller, with or without
+// derivative term, and fill the commands.
+static void simulate(const Controller controller, const bool derivative)
+{
+  const float derivativeGain = derivative ? DERIVATIVE_GAIN : 0;
+  ESAT_PIDController floatingPointEngine;
+  floatingPointEngine.begin();
+  floatingPointEngine.setOutputLimits(0, MAXIMUM_SPEED);
+  ESAT_Q31PIDController fixedPointEngine;
+  fixedPointEngine.begin();
+  fixedPointEngine.setOutputLimits(0,
+                                   long(MAXIMUM_SPEED / FULL_SCALE
+                                        * fixedPointEngine.MAXIMUM));
+  if (derivative)
+  {
+    floatingPointEngine.setDerivativeFilter(DERIVATIVE_FILTER_TIME_CONSTANT);
+    floatingPointEngine.setSlewRateLimit(SLEW_RATE_LIMIT);
+    fixedPointEngine.setDerivativeFilter(DERIVATIVE_FILTER_TIME_CONSTANT);
+    fixedPointEngine.setSlewRateLimit(SLEW_RATE_LIMIT / FULL_SCALE);
+  }
+  float formerErrorIntegral = 0;
+  int formerPreviousError = 0;
+  float speed = 0;
+  for (int iteration = 0; iteration < ITERATIONS; iteration++)
+  {
+    const int error = int(targetSpeed(iteration)) - int(speed);
+    float command = 0;
+    switch (controller)
+    {
+      case FORMER_CONTROLLER:
+        {
+          formerErrorIntegral = formerErrorIntegral + error * PERIOD;
+          const float errorDerivative =
+            (float(error) - float(formerPreviousError)) / PERIOD;
+          formerPreviousError = error;
+          command = constrain(PROPORTIONAL_GAIN * error
+                              + INTEGRAL_GAIN * formerErrorIntegral
+                              + derivativeGain * errorDerivative,
+                              0,
+                              MAXIMUM_SPEED);
+        }
+        break;
+      case FLOATING_POINT_ENGINE:
+        floatingPointEngine.configure(PROPORTIONAL_GAIN,
+                                      INTEGRAL_GAIN,
+                                      derivativeGain,
+                                      PERIOD);
+        command = floatingPointEngine.update(error);
+        break;
+      case FIXED_POINT_ENGINE:
+        fixedPointEngine.configure(PROPORTIONAL_GAIN,
+                                   INTEGRAL_GAIN,
+                                   derivativeGain,
+                                   PERIOD);
+        command = fixedPointEngine.update(long(error / FULL_SCALE
+                                               * fixedPointEngine.MAXIMUM))
+          * (FULL_SCALE / fixedPointEngine.MAXIMUM);
+        break;
+      default:
+        break;
+    }
+    commands[iteration] = command;
+    speed = speed + (command - speed) * PERIOD / WHEEL_TIME_CONSTANT;
+  }
+}
+
+int main()
+{
+  const struct
+  {
+    Controller controller;
+    bool derivative;
+    const char* name;
+  } variants[] = {
+    {FORMER_CONTROLLER, false, "former wheel PID controller"},
+    {FLOATING_POINT_ENGINE, false, "arm_pid_f32, PI"},
+    {FIXED_POINT_ENGINE, false, "arm_pid_q31, PI"},
+    {FORMER_CONTROLLER, true, "former wheel PID controller, PID"},
+    {FLOATING_POINT_ENGINE, true, "arm_pid_f32, PID, filter, slew limit"},
+    {FIXED_POINT_ENGINE, true, "arm_pid_q31, PID, filter, slew limit"},
+  };
+  static float floatingPointCommands[ITERATIONS];
+  for (const auto& variant : variants)
+  {
+    simulate(variant.controller, variant.derivative);
+    if (variant.controller == FLOATING_POINT_ENGINE)
+    {
+      memcpy(floatingPointCommands, commands, sizeof(commands));
+    }
+    float speed = 0;
+    float minimumSpeed = MAXIMUM_SPEED;
+    int settlingIteration = FIRST_STEP_ITERATIONS;
+    float commandDeviation = 0;
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+      speed = speed
+        + (commands[iteration] - speed) * PERIOD / WHEEL_TIME_CONSTANT;
+      const float target = targetSpeed(iteration);
+      if (iteration >= FIRST_STEP_ITERATIONS)
+      {
+        minimumSpeed = fminf(minimumSpeed, speed);
+        if (fabsf(speed - target) > 0.02 * target)
+        {
+          settlingIteration = iteration + 1;
+        }
+      }
+      commandDeviation =
+        fmaxf(commandDeviation,
+              fabsf(commands[iteration] - floatingPointCommands[iteration]));
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < TIMING_REPETITIONS; repetition++)
+    {
+      simulate(variant.controller, variant.derivative);
+    }
+    const auto endTime = std::chrono::steady_clock::now();
+    const double nanoseconds =
+      std::chrono::duration<double, std::nano>(endTime - startTime).count()
+      / (double(TIMING_REPETITIONS) * ITERATIONS);
+    printf("%s:\n", variant.name);
+    printf("  undershoot %.1f %%, settling time %.1f s\n",
+           100 * (2000 - minimumSpeed) / 2000,
+           (settlingIteration - FIRST_STEP_ITERATIONS) * PERIOD);
+    if (variant.controller == FIXED_POINT_ENGINE)
+    {
+      printf("  largest difference from arm_pid_f32: %.2e rpm\n",
+             commandDeviation);
+    }
+    printf("  processing time per update: %.1f ns\n", nanoseconds);
+  }
+  return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+// Host stand-in for the Arduino core for host builds of the
+// numerical modules of the ADCS library (estimators, controllers and
+// trigonometry).  It takes the types and constants from the core in
+// esat32/cores/arduino and says that the program runs on an STM32
+// board, so the modules take their CMSIS-DSP paths, which run on the
+// CMSIS-DSP stand-in of arm_math.h.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "wiring_constants.h"
+
+#ifndef ARDUINO_ARCH_STM32
+#define ARDUINO_ARCH_STM32
+#endif
+
+#endif /* Arduino_h */
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+// Host stand-in for the parts of CMSIS-DSP used by the ADCS library.
+// The functions follow the generic C code of CMSIS-DSP (the code
+// that runs on cores without the DSP extension), including its
+// rounding, saturation and overflow behaviour, so the host builds
+// compute the same values as the ADCS board up to the rounding of
+// floating-point operations.
+
+#include <stdint.h>
+#include <string.h>
+
+typedef float float32_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum
+{
+  ARM_MATH_SUCCESS = 0,
+  ARM_MATH_ARGUMENT_ERROR = -1,
+  ARM_MATH_LENGTH_ERROR = -2,
+  ARM_MATH_SIZE_MISMATCH = -3,
+  ARM_MATH_NANINF = -4,
+  ARM_MATH_SINGULAR = -5,
+  ARM_MATH_TEST_FAILURE = -6,
+} arm_status;
+
+typedef struct
+{
+  uint16_t numRows;
+  uint16_t numCols;
+  float32_t* pData;
+} arm_matrix_instance_f32;
+
+typedef struct
+{
+  uint16_t numRows;
+  uint16_t numCols;
+  q15_t* pData;
+} arm_matrix_instance_q15;
+
+typedef struct
+{
+  uint16_t numRows;
+  uint16_t numCols;
+  q31_t* pData;
+} arm_matrix_instance_q31;
+
+typedef struct
+{
+  float32_t A0;
+  float32_t A1;
+  float32_t A2;
+  float32_t state[3];
+  float32_t Kp;
+  float32_t Ki;
+  float32_t Kd;
+} arm_pid_instance_f32;
+
+typedef struct
+{
+  q31_t A0;
+  q31_t A1;
+  q31_t A2;
+  q31_t state[3];
+  q31_t Kp;
+  q31_t Ki;
+  q31_t Kd;
+} arm_pid_instance_q31;
+
+static inline q31_t __QADD(const q31_t x, const q31_t y)
+{
+  const q63_t sum = (q63_t) x + y;
+  if (sum > 0x7FFFFFFF)
+  {
+    return 0x7FFFFFFF;
+  }
+  if (sum < -0x7FFFFFFF - 1)
+  {
+    return -0x7FFFFFFF - 1;
+  }
+  return (q31_t) sum;
+}
+
+static inline q31_t __SSAT(const q31_t value, const uint32_t bits)
+{
+  const q31_t maximum = (q31_t) ((1U << (bits - 1)) - 1);
+  const q31_t minimum = -maximum - 1;
+  if (value > maximum)
+  {
+    return maximum;
+  }
+  if (value < minimum)
+  {
+    return minimum;
+  }
+  return value;
+}
+
+static inline q31_t clip_q63_to_q31(const q63_t value)
+{
+  if ((value >> 32) != (value >> 63))
+  {
+    return (q31_t) (0x7FFFFFFF ^ ((q31_t) (value >> 63)));
+  }
+  return (q31_t) value;
+}
+
+static inline void arm_mat_init_f32(arm_matrix_instance_f32* const S,
+                                    const uint16_t nRows,
+                                    const uint16_t nColumns,
+                                    float32_t* const pData)
+{
+  S->numRows = nRows;
+  S->numCols = nColumns;
+  S->pData = pData;
+}
+
+static inline void arm_mat_init_q15(arm_matrix_instance_q15* const S,
+                                    const uint16_t nRows,
+                                    const uint16_t nColumns,
+                                    q15_t* const pData)
+{
+  S->numRows = nRows;
+  S->numCols = nColumns;
+  S->pData = pData;
+}
+
+static inline void arm_mat_init_q31(arm_matrix_instance_q31* const S,
+                                    const uint16_t nRows,
+                                    const uint16_t nColumns,
+                                    q31_t* const pData)
+{
+  S->numRows = nRows;
+  S->numCols = nColumns;
+  S->pData = pData;
+}
+
+static inline arm_status arm_mat_mult_f32(const arm_matrix_instance_f32* const pSrcA,
+                                          const arm_matrix_instance_f32* const pSrcB,
+                                          arm_matrix_instance_f32* const pDst)
+{
+  if ((pSrcA->numCols != pSrcB->numRows)
+      || (pSrcA->numRows != pDst->numRows)
+      || (pSrcB->numCols != pDst->numCols))
+  {
+    return ARM_MATH_SIZE_MISMATCH;
+  }
+  for (uint16_t row = 0; row < pSrcA->numRows; row++)
+  {
+    for (uint16_t column = 0; column < pSrcB->numCols; column++)
+    {
+      float32_t sum = 0.0f;
+      for (uint16_t k = 0; k < pSrcA->numCols; k++)
+      {
+        sum += pSrcA->pData[row * pSrcA->numCols + k]
+          * pSrcB->pData[k * pSrcB->numCols + column];
+      }
+      pDst->pData[row * pDst->numCols + column] = sum;
+    }
+  }
+  return ARM_MATH_SUCCESS;
+}
+
+// Like CMSIS-DSP, the 1.31 result of each element is the 2.62 sum of
+// products shifted right without saturation: inputs must leave
+// enough headroom for the sums.
+static inline arm_status arm_mat_mult_q31(const arm_matrix_instance_q31* const pSrcA,
+                                          const arm_matrix_instance_q31* const pSrcB,
+                                          arm_matrix_instance_q31* const pDst)
+{
+  if ((pSrcA->numCols != pSrcB->numRows)
+      || (pSrcA->numRows != pDst->numRows)
+      || (pSrcB->numCols != pDst->numCols))
+  {
+    return ARM_MATH_SIZE_MISMATCH;
+  }
+  for (uint16_t row = 0; row < pSrcA->numRows; row++)
+  {
+    for (uint16_t column = 0; column < pSrcB->numCols; column++)
+    {
+      q63_t sum = 0;
+      for (uint16_t k = 0; k < pSrcA->numCols; k++)
+      {
+        sum += (q63_t) pSrcA->pData[row * pSrcA->numCols + k]
+          * pSrcB->pData[k * pSrcB->numCols + column];
+      }
+      pDst->pData[row * pDst->numCols + column] = (q31_t) (sum >> 31);
+    }
+  }
+  return ARM_MATH_SUCCESS;
+}
+
+// Like CMSIS-DSP, the 1.15 result of each element is the 34.30 sum
+// of products shifted right and saturated.  pState is scratch space
+// for the transpose of pSrcB on the board; it is not used here.
+static inline arm_status arm_mat_mult_q15(const arm_matrix_instance_q15* const pSrcA,
+                                          const arm_matrix_instance_q15* const pSrcB,
+                                          arm_matrix_instance_q15* const pDst,
+                                          q15_t* const pState)
+{
+  (void) pState;
+  if ((pSrcA->numCols != pSrcB->numRows)
+      || (pSrcA->numRows != pDst->numRows)
+      || (pSrcB->numCols != pDst->numCols))
+  {
+    return ARM_MATH_SIZE_MISMATCH;
+  }
+  for (uint16_t row = 0; row < pSrcA->numRows; row++)
+  {
+    for (uint16_t column = 0; column < pSrcB->numCols; column++)
+    {
+      q63_t sum = 0;
+      for (uint16_t k = 0; k < pSrcA->numCols; k++)
+      {
+        sum += (q31_t) pSrcA->pData[row * pSrcA->numCols + k]
+          * pSrcB->pData[k * pSrcB->numCols + column];
+      }
+      pDst->pData[row * pDst->numCols + column] =
+        (q15_t) __SSAT((q31_t) (sum >> 15), 16);
+    }
+  }
+  return ARM_MATH_SUCCESS;
+}
+
+static inline void arm_float_to_q15(const float32_t* const pSrc,
+                                    q15_t* const pDst,
+                                    const uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = (q15_t) __SSAT((q31_t) (pSrc[i] * 32768.0f), 16);
+  }
+}
+
+static inline void arm_float_to_q31(const float32_t* const pSrc,
+                                    q31_t* const pDst,
+                                    const uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = clip_q63_to_q31((q63_t) (pSrc[i] * 2147483648.0f));
+  }
+}
+
+static inline void arm_q15_to_float(const q15_t* const pSrc,
+                                    float32_t* const pDst,
+                                    const uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = ((float32_t) pSrc[i] / 32768.0f);
+  }
+}
+
+static inline void arm_q31_to_float(const q31_t* const pSrc,
+                                    float32_t* const pDst,
+                                    const uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = ((float32_t) pSrc[i] / 2147483648.0f);
+  }
+}
+
+static inline void arm_pid_init_f32(arm_pid_instance_f32* const S,
+                                    const int32_t resetStateFlag)
+{
+  S->A0 = S->Kp + S->Ki + S->Kd;
+  S->A1 = (-S->Kp) - ((float32_t) 2.0f * S->Kd);
+  S->A2 = S->Kd;
+  if (resetStateFlag)
+  {
+    memset(S->state, 0, 3U * sizeof(float32_t));
+  }
+}
+
+static inline void arm_pid_reset_f32(arm_pid_instance_f32* const S)
+{
+  memset(S->state, 0, 3U * sizeof(float32_t));
+}
+
+static inline float32_t arm_pid_f32(arm_pid_instance_f32* const S,
+                                    const float32_t in)
+{
+  const float32_t out = (S->A0 * in)
+    + (S->A1 * S->state[0])
+    + (S->A2 * S->state[1])
+    + (S->state[2]);
+  S->state[1] = S->state[0];
+  S->state[0] = in;
+  S->state[2] = out;
+  return out;
+}
+
+static inline void arm_pid_init_q31(arm_pid_instance_q31* const S,
+                                    const int32_t resetStateFlag)
+{
+  S->A0 = __QADD(__QADD(S->Kp, S->Ki), S->Kd);
+  S->A1 = -__QADD(__QADD(S->Kd, S->Kd), S->Kp);
+  S->A2 = S->Kd;
+  if (resetStateFlag)
+  {
+    memset(S->state, 0, 3U * sizeof(q31_t));
+  }
+}
+
+static inline void arm_pid_reset_q31(arm_pid_instance_q31* const S)
+{
+  memset(S->state, 0, 3U * sizeof(q31_t));
+}
+
+// Like CMSIS-DSP, the 2.62 sum of products is shifted right without
+// saturation and the previous output is added without saturation:
+// coefficients and states must leave enough headroom.
+static inline q31_t arm_pid_q31(arm_pid_instance_q31* const S,
+                                const q31_t in)
+{
+  q63_t acc = (q63_t) S->A0 * in;
+  acc += (q63_t) S->A1 * S->state[0];
+  acc += (q63_t) S->A2 * S->state[1];
+  q31_t out = (q31_t) (acc >> 31U);
+  out = (q31_t) ((uint32_t) out + (uint32_t) S->state[2]);
+  S->state[1] = S->state[0];
+  S->state[0] = in;
+  S->state[2] = out;
+  return out;
+}
+
+#endif /* _ARM_MATH_H */
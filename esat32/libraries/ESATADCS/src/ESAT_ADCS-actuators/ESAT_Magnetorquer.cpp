@@ -23,6 +23,7 @@
 void ESAT_MagnetorquerClass::begin()
 {
   configurePins();
+  blankOutputs = false;
   writeEnable(false);
   writeX(POSITIVE);
   writeY(POSITIVE);
@@ -31,13 +32,33 @@ void ESAT_MagnetorquerClass::begin()
   swapAxes(false);
 }
 
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_MagnetorquerClass::beginTimer(HardwareTimer& timer,
+                                        const int pinPlus,
+                                        const int pinMinus)
+{
+  // Both pins of each magnetorquer are channels of the same timer.
+  if (timer.getHandle()->Instance == nullptr)
+  {
+    TIM_TypeDef* const instance =
+      (TIM_TypeDef*) pinmap_peripheral(digitalPinToPinName(pinPlus),
+                                       PinMap_TIM);
+    timer.setup(instance);
+  }
+  timer.setMode(timerChannel(pinPlus), TIMER_OUTPUT_COMPARE_PWM1, pinPlus);
+  timer.setMode(timerChannel(pinMinus), TIMER_OUTPUT_COMPARE_PWM1, pinMinus);
+  timer.setOverflow(PWM_FREQUENCY, HERTZ_FORMAT);
+  timer.setCaptureCompare(timerChannel(pinPlus), 0);
+  timer.setCaptureCompare(timerChannel(pinMinus), 0);
+  timer.resume();
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
 void ESAT_MagnetorquerClass::configurePins()
 {
 #ifdef ARDUINO_ESAT_ADCS
-  pinMode(MTQXPLUS, OUTPUT);
-  pinMode(MTQYPLUS, OUTPUT);
-  pinMode(MTQXMINUS, OUTPUT);
-  pinMode(MTQYMINUS, OUTPUT);
+  beginTimer(xTimer, MTQXPLUS, MTQXMINUS);
+  beginTimer(yTimer, MTQYPLUS, MTQYMINUS);
 #endif /* ARDUINO_ESAT_ADCS */
 #ifdef ARDUINO_ESAT_OBC
   pinMode(ENMTQX, OUTPUT);
@@ -191,6 +212,11 @@ int ESAT_MagnetorquerClass::polarityYLevel() const
   }
 }
 
+boolean ESAT_MagnetorquerClass::readBlanking() const
+{
+  return blankOutputs;
+}
+
 boolean ESAT_MagnetorquerClass::readEnable() const
 {
   return enable;
@@ -201,86 +227,155 @@ ESAT_MagnetorquerClass::Polarity ESAT_MagnetorquerClass::readX() const
   return xPolarity;
 }
 
+float ESAT_MagnetorquerClass::readXDutyCycle() const
+{
+  return xDutyCycle;
+}
+
 ESAT_MagnetorquerClass::Polarity ESAT_MagnetorquerClass::readY() const
 {
   return yPolarity;
 }
 
+float ESAT_MagnetorquerClass::readYDutyCycle() const
+{
+  return yDutyCycle;
+}
+
 void ESAT_MagnetorquerClass::swapAxes(const boolean swap)
 {
   swapPolarityPins = swap;
 }
 
+#ifdef ARDUINO_ESAT_ADCS
+uint32_t ESAT_MagnetorquerClass::timerChannel(const int pin) const
+{
+  const uint32_t function =
+    pinmap_function(digitalPinToPinName(pin), PinMap_TIM);
+  return STM_PIN_CHANNEL(function);
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+void ESAT_MagnetorquerClass::writeBlanking(const boolean blanking)
+{
+  blankOutputs = blanking;
+  writeXPins();
+  writeYPins();
+}
+
 void ESAT_MagnetorquerClass::writeEnable(const boolean enableDriver)
 {
   enable = enableDriver;
+  writeXPins();
+  writeYPins();
+}
+
 #ifdef ARDUINO_ESAT_ADCS
-  if (enable)
+void ESAT_MagnetorquerClass::writePin(const int pin,
+                                      const int level,
+                                      const float dutyCycle)
+{
+  // The pin is high while the timer counter is below the compare
+  // value, so a compare value past the overflow value keeps it high
+  // all the time.
+  HardwareTimer* timer;
+  if ((pin == MTQXPLUS) || (pin == MTQXMINUS))
   {
-    writeX(readX());
-    writeY(readY());
+    timer = &xTimer;
   }
   else
   {
-    digitalWrite(MTQXPLUS, LOW);
-    digitalWrite(MTQYPLUS, LOW);
-    digitalWrite(MTQXMINUS, LOW);
-    digitalWrite(MTQYMINUS, LOW);
-  }
-#endif /* ARDUINO_ESAT_ADCS */
-#ifdef ARDUINO_ESAT_OBC
-  if (enable)
-  {
-    digitalWrite(ENMTQX, HIGH);
-    digitalWrite(ENMTQY, HIGH);
+    timer = &yTimer;
   }
-  else
+  uint32_t compare = 0;
+  if (level == HIGH)
   {
-    digitalWrite(ENMTQX, LOW);
-    digitalWrite(ENMTQY, LOW);
+    const uint32_t period = timer->getOverflow() + 1;
+    compare = uint32_t(constrain(dutyCycle, 0, 1) * period + 0.5);
   }
-#endif /* ARDUINO_ESAT_OBC */
+  timer->setCaptureCompare(timerChannel(pin), compare);
 }
+#endif /* ARDUINO_ESAT_ADCS */
 
-void ESAT_MagnetorquerClass::writeX(const ESAT_MagnetorquerClass::Polarity polarity)
+void ESAT_MagnetorquerClass::writeX(const ESAT_MagnetorquerClass::Polarity polarity,
+                                    const float dutyCycle)
 {
   xPolarity = polarity;
+  xDutyCycle = dutyCycle;
+  writeXPins();
+}
+
+void ESAT_MagnetorquerClass::writeXPins()
+{
 #ifdef ARDUINO_ESAT_ADCS
-  if (enable)
+  const int pinPlus = pinXPolarityPlus();
+  const int pinMinus = pinXPolarityMinus();
+  if (enable && !blankOutputs)
   {
-    const int pinPlus = pinXPolarityPlus();
-    const int pinMinus = pinXPolarityMinus();
     const int levelPlus = polarityXLevel();
     const int levelMinus = invertLevel(levelPlus);
-    digitalWrite(pinPlus, levelPlus);
-    digitalWrite(pinMinus, levelMinus);
+    writePin(pinPlus, levelPlus, xDutyCycle);
+    writePin(pinMinus, levelMinus, xDutyCycle);
+  }
+  else
+  {
+    writePin(pinPlus, LOW, 0);
+    writePin(pinMinus, LOW, 0);
   }
 #endif /* ARDUINO_ESAT_ADCS */
 #ifdef ARDUINO_ESAT_OBC
   const int pin = pinXPolarity();
   const int level = polarityXLevel();
   digitalWrite(pin, level);
+  if (enable && !blankOutputs)
+  {
+    digitalWrite(ENMTQX, HIGH);
+  }
+  else
+  {
+    digitalWrite(ENMTQX, LOW);
+  }
 #endif /* ARDUINO_ESAT_OBC */
 }
 
-void ESAT_MagnetorquerClass::writeY(const ESAT_MagnetorquerClass::Polarity polarity)
+void ESAT_MagnetorquerClass::writeY(const ESAT_MagnetorquerClass::Polarity polarity,
+                                    const float dutyCycle)
 {
   yPolarity = polarity;
+  yDutyCycle = dutyCycle;
+  writeYPins();
+}
+
+void ESAT_MagnetorquerClass::writeYPins()
+{
 #ifdef ARDUINO_ESAT_ADCS
-  if (enable)
+  const int pinPlus = pinYPolarityPlus();
+  const int pinMinus = pinYPolarityMinus();
+  if (enable && !blankOutputs)
   {
-    const int pinPlus = pinYPolarityPlus();
-    const int pinMinus = pinYPolarityMinus();
     const int levelPlus = polarityYLevel();
     const int levelMinus = invertLevel(levelPlus);
-    digitalWrite(pinPlus, levelPlus);
-    digitalWrite(pinMinus, levelMinus);
+    writePin(pinPlus, levelPlus, yDutyCycle);
+    writePin(pinMinus, levelMinus, yDutyCycle);
+  }
+  else
+  {
+    writePin(pinPlus, LOW, 0);
+    writePin(pinMinus, LOW, 0);
   }
 #endif /* ARDUINO_ESAT_ADCS */
 #ifdef ARDUINO_ESAT_OBC
   const int pin = pinYPolarity();
   const int level = polarityYLevel();
   digitalWrite(pin, level);
+  if (enable && !blankOutputs)
+  {
+    digitalWrite(ENMTQY, HIGH);
+  }
+  else
+  {
+    digitalWrite(ENMTQY, LOW);
+  }
 #endif /* ARDUINO_ESAT_OBC */
 }
 
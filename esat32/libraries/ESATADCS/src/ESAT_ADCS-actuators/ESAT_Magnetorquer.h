@@ -37,6 +37,13 @@
 // satellite (one corner of the satellite that depends on the X-axis
 // and Y-axis 1D magnetorquer polarities) when the 2D magnetorquer is
 // switched on.
+//
+// On the ADCS board, the H-bridge inputs are driven by timer
+// channels, so each magnetorquer can also be powered for just a
+// fraction of the time (duty cycle) of a fast pulse-width modulation
+// cycle, which scales down its magnetic dipole and its power
+// consumption.  On the OBC board, the magnetorquers are always at full
+// power.
 class ESAT_MagnetorquerClass
 {
   public:
@@ -62,6 +69,10 @@ class ESAT_MagnetorquerClass
     // troubleshooting.
     void invertYPolarity(boolean invert);
 
+    // Return true if the magnetorquer outputs are blanked; otherwise
+    // return false.
+    boolean readBlanking() const;
+
     // Return true if the magnetorquer driver is powered up; otherwise
     // return false.
     boolean readEnable() const;
@@ -69,24 +80,50 @@ class ESAT_MagnetorquerClass
     // Return the polarity of the X-axis magnetorquer.
     Polarity readX() const;
 
+    // Return the duty cycle of the X-axis magnetorquer, from 0 to 1.
+    float readXDutyCycle() const;
+
     // Return the polarity of the Y-axis magnetorquer.
     Polarity readY() const;
 
+    // Return the duty cycle of the Y-axis magnetorquer, from 0 to 1.
+    float readYDutyCycle() const;
+
     // Swap (if the argument is true) or don't swap (if the argument
     // is false; default value) the axes of the magnetorquer.  This is
     // useful for diagnostics and troubleshooting.
     void swapAxes(boolean swap);
 
+    // Blank (if the argument is true) or stop blanking (if the
+    // argument is false) the magnetorquer outputs.  While blanked, the
+    // magnetorquers stay off whatever the enable, polarity and duty
+    // cycle settings, which take effect when blanking stops.  This is
+    // useful for measuring the magnetic field without the
+    // magnetorquers interfering.
+    void writeBlanking(boolean blanking);
+
     // Power up or down the magnetorquer driver.
     void writeEnable(boolean enable);
 
-    // Set the polarity of the X-axis magnetorquer.
-    void writeX(Polarity polarity);
+    // Set the polarity and duty cycle (from 0 to 1; full power by
+    // default) of the X-axis magnetorquer.
+    void writeX(Polarity polarity, float dutyCycle = 1);
 
-    // Set the polarity of the Y-axis magnetorquer.
-    void writeY(Polarity polarity);
+    // Set the polarity and duty cycle (from 0 to 1; full power by
+    // default) of the Y-axis magnetorquer.
+    void writeY(Polarity polarity, float dutyCycle = 1);
 
   private:
+#ifdef ARDUINO_ESAT_ADCS
+    // Frequency (in hertz) of the pulse-width modulation of the
+    // magnetorquers, well above the cutoff frequency of the coils so
+    // their current is steady.
+    static const word PWM_FREQUENCY = 20000;
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // True if the magnetorquer outputs are blanked; false otherwise.
+    boolean blankOutputs;
+
     // True if the magnetorquer driver is powered up; false otherwise.
     boolean enable;
 
@@ -102,12 +139,34 @@ class ESAT_MagnetorquerClass
     // otherwise.  This is useful for diagnostics and troubleshooting.
     boolean swapPolarityPins;
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Timer driving the X-axis magnetorquer pins.
+    HardwareTimer xTimer;
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // Duty cycle of the X-axis magnetorquer, from 0 to 1.
+    float xDutyCycle;
+
     // Polarity of the X-axis magnetorquer.
     Polarity xPolarity;
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Timer driving the Y-axis magnetorquer pins.
+    HardwareTimer yTimer;
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // Duty cycle of the Y-axis magnetorquer, from 0 to 1.
+    float yDutyCycle;
+
     // Polarity of the Y-axis magnetorquer.
     Polarity yPolarity;
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Set up the timer of a magnetorquer for pulse-width modulation of
+    // its two pins.
+    void beginTimer(HardwareTimer& timer, int pinPlus, int pinMinus);
+#endif /* ARDUINO_ESAT_ADCS */
+
     // Configure the control pins.
     void configurePins();
 
@@ -173,6 +232,24 @@ class ESAT_MagnetorquerClass
     // polarity.  It can be the wrong one if the Y polarity is
     // swapped; this is useful for diagnostics and troubleshooting.
     int polarityYLevel() const;
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Return the timer channel of a magnetorquer pin.
+    uint32_t timerChannel(int pin) const;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Drive a magnetorquer pin: low all the time for a LOW level, or
+    // high for the given fraction of the time (duty cycle, from 0 to
+    // 1) for a HIGH level.
+    void writePin(int pin, int level, float dutyCycle);
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // Update the X-axis magnetorquer pins to the current settings.
+    void writeXPins();
+
+    // Update the Y-axis magnetorquer pins to the current settings.
+    void writeYPins();
 };
 
 // Global instance of the magnetorquer library.
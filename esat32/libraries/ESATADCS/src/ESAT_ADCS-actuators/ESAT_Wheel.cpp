@@ -19,37 +19,48 @@
  */
 
 #include "ESAT_ADCS-actuators/ESAT_Wheel.h"
-#ifdef ARDUINO_ESAT_OBC
-#include <ESAT_CCSDSPacket.h>
-#include <ESAT_I2CMaster.h>
-#include <Wire.h>
-#endif /* ARDUINO_ESAT_OBC */
 
 void ESAT_WheelClass::begin()
 {
+  calibrationPhase = CALIBRATION_IDLE;
+  dutyCycle = 0;
 #ifdef ARDUINO_ESAT_ADCS
   pinMode(EN5V, OUTPUT);
   electronicSpeedController.attach(PWM_A);
-  calibrateElectronicSpeedController();
 #endif /* ARDUINO_ESAT_ADCS */
 #ifdef ARDUINO_ESAT_OBC
+  // The state of the power line is unknown at this point, so the
+  // first power line command must go out whatever it is.
+  powerLineOn = true;
+  powerLineCommandPending = false;
+  powerLineCommandQueued = false;
+  powerLineCommandFailures = 0;
+  powerLineCommandPacket =
+    ESAT_CCSDSPacket(powerLineCommandPacketData,
+                     sizeof(powerLineCommandPacketData));
   electronicSpeedController.attach(PWM);
-  calibrateElectronicSpeedController();
 #endif /* ARDUINO_ESAT_OBC */
+  calibrateElectronicSpeedController();
+}
+
+void ESAT_WheelClass::beginCalibrationPhase(const CalibrationPhase phase)
+{
+  calibrationPhase = phase;
+  calibrationPhaseStartTime = millis();
 }
 
 void ESAT_WheelClass::calibrateElectronicSpeedController()
 {
-  // Perform the ESC calibration sequence (high, low and medium again).
+  // The ESC calibration sequence (high, low and medium again) starts
+  // with the electronic speed controller switched off.  update()
+  // carries on with the rest of the sequence.
   switchOffElectronicSpeedController();
-  delay(1000);
-  writeDutyCycle(100);
-  switchOnElectronicSpeedController();
-  delay(2000);
-  writeDutyCycle(-100);
-  delay(1000);
-  writeDutyCycle(0);
-  delay(4000);
+  beginCalibrationPhase(CALIBRATION_POWER_OFF);
+}
+
+boolean ESAT_WheelClass::calibrating()
+{
+  return calibrationPhase != CALIBRATION_IDLE;
 }
 
 float ESAT_WheelClass::constrainDutyCycle(const float dutyCycle)
@@ -70,6 +81,16 @@ word ESAT_WheelClass::constrainSpeed(const int wheelSpeed)
   return constrain(wheelSpeed, -MAXIMUM_WHEEL_SPEED, MAXIMUM_WHEEL_SPEED);
 }
 
+boolean ESAT_WheelClass::powerLineCommandFailed()
+{
+#ifdef ARDUINO_ESAT_OBC
+  return powerLineCommandPending
+    && (powerLineCommandFailures >= POWER_LINE_COMMAND_ATTEMPTS);
+#else
+  return false;
+#endif /* ARDUINO_ESAT_OBC */
+}
+
 float ESAT_WheelClass::readDutyCycle()
 {
   return dutyCycle;
@@ -80,58 +101,143 @@ void ESAT_WheelClass::resetElectronicSpeedController()
   calibrateElectronicSpeedController();
 }
 
-void ESAT_WheelClass::switchOffElectronicSpeedController()
+void ESAT_WheelClass::switchElectronicSpeedController(const boolean on)
 {
 #ifdef ARDUINO_ESAT_ADCS
-  digitalWrite(EN5V, LOW);
+  if (on)
+  {
+    digitalWrite(EN5V, HIGH);
+  }
+  else
+  {
+    digitalWrite(EN5V, LOW);
+  }
 #endif /* ARDUINO_ESAT_ADCS */
 #ifdef ARDUINO_ESAT_OBC
-  const byte packetDataBufferLength = ESAT_CCSDSSecondaryHeader::LENGTH + 1;
-  byte buffer[packetDataBufferLength];
-  ESAT_CCSDSPacket packet(buffer, packetDataBufferLength);
-  packet.writeTelecommandHeaders(POWER_LINE_IDENTIFIER,
-                                 0,
-                                 ESAT_Timestamp(),
-                                 POWER_LINE_MAJOR_VERSION_NUMBER,
-                                 POWER_LINE_MINOR_VERSION_NUMBER,
-                                 POWER_LINE_PATCH_VERSION_NUMBER,
-                                 POWER_LINE_COMMAND_CODE);
-  packet.writeByte(POWER_LINE_SWITCH_OFF);
-  ESAT_I2CMaster.writePacket(packet,
-                             POWER_LINE_ADDRESS,
-                             MICROSECONDS_BETWEEN_CHUNKS);
+  // The power line command goes to the EPS board from update(),
+  // so the caller doesn't have to wait for the I2C bus.
+  // Repeated commands go out just once, unless the previous one is
+  // still pending: then it gets a new series of attempts.
+  if ((on != powerLineOn) || powerLineCommandPending)
+  {
+    powerLineOn = on;
+    powerLineCommandPending = true;
+    powerLineCommandQueued = false;
+    powerLineCommandFailures = 0;
+  }
 #endif /* ARDUINO_ESAT_OBC */
 }
 
+void ESAT_WheelClass::switchOffElectronicSpeedController()
+{
+  switchElectronicSpeedController(false);
+}
+
 void ESAT_WheelClass::switchOnElectronicSpeedController()
 {
-#ifdef ARDUINO_ESAT_ADCS
-  digitalWrite(EN5V, HIGH);
-#endif /* ARDUINO_ESAT_ADCS */
+  switchElectronicSpeedController(true);
+}
+
+void ESAT_WheelClass::update()
+{
 #ifdef ARDUINO_ESAT_OBC
-  const byte packetDataBufferLength = ESAT_CCSDSSecondaryHeader::LENGTH + 1;
-  byte buffer[packetDataBufferLength];
-  ESAT_CCSDSPacket packet(buffer, packetDataBufferLength);
-  packet.writeTelecommandHeaders(POWER_LINE_IDENTIFIER,
-                                 0,
-                                 ESAT_Timestamp(),
-                                 POWER_LINE_MAJOR_VERSION_NUMBER,
-                                 POWER_LINE_MINOR_VERSION_NUMBER,
-                                 POWER_LINE_PATCH_VERSION_NUMBER,
-                                 POWER_LINE_COMMAND_CODE);
-  packet.writeByte(POWER_LINE_SWITCH_ON);
-  ESAT_I2CMaster.writePacket(packet,
-                             POWER_LINE_ADDRESS,
-                             MICROSECONDS_BETWEEN_CHUNKS);
+  // The calibration sequence waits for the power line command to go
+  // out, as the timing of each phase counts from the power change.
+  // If the command cannot go out, the sequence stays in its current
+  // phase and the failure shows in the housekeeping telemetry.
+  if (powerLineCommandPending)
+  {
+    const boolean powerLineCommandWritten = updatePowerLineCommand();
+    if (!powerLineCommandWritten)
+    {
+      return;
+    }
+    calibrationPhaseStartTime = millis();
+  }
 #endif /* ARDUINO_ESAT_OBC */
+  const unsigned long phaseTime = millis() - calibrationPhaseStartTime;
+  switch (calibrationPhase)
+  {
+    case CALIBRATION_POWER_OFF:
+      if (phaseTime >= CALIBRATION_POWER_OFF_TIME)
+      {
+        writeElectronicSpeedController(100);
+        switchOnElectronicSpeedController();
+        beginCalibrationPhase(CALIBRATION_HIGH);
+      }
+      break;
+    case CALIBRATION_HIGH:
+      if (phaseTime >= CALIBRATION_HIGH_TIME)
+      {
+        writeElectronicSpeedController(-100);
+        beginCalibrationPhase(CALIBRATION_LOW);
+      }
+      break;
+    case CALIBRATION_LOW:
+      if (phaseTime >= CALIBRATION_LOW_TIME)
+      {
+        writeElectronicSpeedController(0);
+        beginCalibrationPhase(CALIBRATION_NEUTRAL);
+      }
+      break;
+    case CALIBRATION_NEUTRAL:
+      if (phaseTime >= CALIBRATION_NEUTRAL_TIME)
+      {
+        beginCalibrationPhase(CALIBRATION_IDLE);
+      }
+      break;
+    default:
+      break;
+  }
 }
 
-void ESAT_WheelClass::writeSpeed(const int rpm)
+#ifdef ARDUINO_ESAT_OBC
+boolean ESAT_WheelClass::updatePowerLineCommand()
 {
-  writeDutyCycle(DUTY_CYCLE_PER_RPM * constrainSpeed(rpm));
+  // The power line command goes to the EPS board as a queued I2C
+  // transaction, one chunk each time ESAT_I2CBusScheduler runs it,
+  // so neither the ADCS cycle nor the rest of the I2C bus users wait
+  // for the EPS board between chunks.  A new command waits for the
+  // transaction to finish writing the previous one.
+  const ESAT_I2CPacketWriteTransaction::State state =
+    powerLineCommandTransaction.state();
+  if (state == ESAT_I2CPacketWriteTransaction::WRITE_IN_PROGRESS)
+  {
+    return false;
+  }
+  if (powerLineCommandQueued)
+  {
+    powerLineCommandQueued = false;
+    if (state == ESAT_I2CPacketWriteTransaction::WRITE_SUCCEEDED)
+    {
+      powerLineCommandPending = false;
+      return true;
+    }
+    powerLineCommandFailures = powerLineCommandFailures + 1;
+  }
+  if (powerLineCommandFailures >= POWER_LINE_COMMAND_ATTEMPTS)
+  {
+    return false;
+  }
+  powerLineCommandQueued = writePowerLineCommand();
+  if (!powerLineCommandQueued)
+  {
+    powerLineCommandFailures = powerLineCommandFailures + 1;
+  }
+  return false;
 }
+#endif /* ARDUINO_ESAT_OBC */
 
 void ESAT_WheelClass::writeDutyCycle(const float newDutyCycle)
+{
+  if (calibrating())
+  {
+    return;
+  }
+  writeElectronicSpeedController(newDutyCycle);
+}
+
+void ESAT_WheelClass::writeElectronicSpeedController(const float newDutyCycle)
 {
   dutyCycle = constrainDutyCycle(newDutyCycle);
   const word microseconds =
@@ -141,4 +247,36 @@ void ESAT_WheelClass::writeDutyCycle(const float newDutyCycle)
   electronicSpeedController.writeMicroseconds(microseconds);
 }
 
+#ifdef ARDUINO_ESAT_OBC
+boolean ESAT_WheelClass::writePowerLineCommand()
+{
+  ESAT_CCSDSPacket& packet = powerLineCommandPacket;
+  packet.flush();
+  packet.writeTelecommandHeaders(POWER_LINE_IDENTIFIER,
+                                 0,
+                                 ESAT_Timestamp(),
+                                 POWER_LINE_MAJOR_VERSION_NUMBER,
+                                 POWER_LINE_MINOR_VERSION_NUMBER,
+                                 POWER_LINE_PATCH_VERSION_NUMBER,
+                                 POWER_LINE_COMMAND_CODE);
+  if (powerLineOn)
+  {
+    packet.writeByte(POWER_LINE_SWITCH_ON);
+  }
+  else
+  {
+    packet.writeByte(POWER_LINE_SWITCH_OFF);
+  }
+  return powerLineCommandTransaction.write(packet,
+                                          POWER_LINE_ADDRESS,
+                                          POWER_LINE_COMMAND_DEADLINE,
+                                          MICROSECONDS_BETWEEN_CHUNKS);
+}
+#endif /* ARDUINO_ESAT_OBC */
+
+void ESAT_WheelClass::writeSpeed(const int rpm)
+{
+  writeDutyCycle(DUTY_CYCLE_PER_RPM * constrainSpeed(rpm));
+}
+
 ESAT_WheelClass ESAT_Wheel;
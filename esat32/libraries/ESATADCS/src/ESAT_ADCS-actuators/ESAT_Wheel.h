@@ -23,6 +23,11 @@
 
 #include <Arduino.h>
 #include <Servo.h>
+#ifdef ARDUINO_ESAT_OBC
+#include <ESAT_CCSDSPacket.h>
+#include <ESAT_CCSDSSecondaryHeader.h>
+#include <ESAT_I2CPacketWriteTransaction.h>
+#endif /* ARDUINO_ESAT_OBC */
 
 // Reaction wheel.
 // Use the global instance ESAT_Wheel.
@@ -30,12 +35,30 @@
 // The ESAT has a heavy flywheel attached to a motor.  Changing the
 // rotational speed of the wheel changes the rotational speed of the
 // satellite in the opposite direction.
+//
+// The electronic speed controller needs a calibration sequence of
+// several seconds after every power up.  The calibration sequence
+// runs in the background: begin() and resetElectronicSpeedController()
+// start it and update() carries it on.  Wheel commands have no effect
+// until it finishes.
 class ESAT_WheelClass
 {
   public:
-    // Set up the wheel controller.
+    // Set up the wheel controller and start the calibration sequence
+    // of the electronic speed controller.
     void begin();
 
+    // Return true while the calibration sequence of the electronic
+    // speed controller is under way; otherwise return false.
+    boolean calibrating();
+
+    // Return true if the latest power line command of the electronic
+    // speed controller could not reach the EPS board; otherwise
+    // return false.  The calibration sequence stays in its current
+    // phase until the command goes out.  Only the OBC board sends
+    // power line commands, so this is always false on the ADCS board.
+    boolean powerLineCommandFailed();
+
     // Return the duty cycle of the electronic speed controller.  The
     // duty cycle is a signed percentage: it should go from -100 % to
     // 0 % for negative (clockwise) speed and from 0 % to 100 % for
@@ -43,24 +66,54 @@ class ESAT_WheelClass
     float readDutyCycle();
 
     // Reset the wheel electronic speed controller to initial state
-    // performing the calibration sequence.
+    // performing the calibration sequence.  This just starts the
+    // calibration sequence; update() carries it on.
     void resetElectronicSpeedController();
 
     // Switch off the electronic speed controller.
     void switchOffElectronicSpeedController();
 
+    // Carry on the calibration sequence of the electronic speed
+    // controller.  On the OBC board, queue the pending power line
+    // command for the EPS board in ESAT_I2CBusScheduler and check
+    // how it went.  Call this on every ADCS cycle.
+    void update();
+
     // Set the speed of the wheel in revolutions per minute: negative
     // for clockwise rotation and positive for counterclockwise
-    // rotation.
+    // rotation.  This has no effect during the calibration sequence.
     void writeSpeed(int rpm);
 
     // Set the duty cycle of the electronic speed controller.  The
     // duty cycle is a signed percentage: it should go from -100 % to
     // 0 % for negative (clockwise) speed and from 0 % to 100 % for
-    // positive (counterclockwise) speed.
+    // positive (counterclockwise) speed.  This has no effect during
+    // the calibration sequence.
     void writeDutyCycle(float dutyCycle);
 
   private:
+    // Phases of the calibration sequence of the electronic speed
+    // controller.
+    enum CalibrationPhase
+    {
+      // No calibration sequence under way.
+      CALIBRATION_IDLE,
+      // Electronic speed controller switched off.
+      CALIBRATION_POWER_OFF,
+      // Maximum duty cycle after switching on.
+      CALIBRATION_HIGH,
+      // Minimum duty cycle.
+      CALIBRATION_LOW,
+      // Zero duty cycle.
+      CALIBRATION_NEUTRAL,
+    };
+
+    // Duration (in milliseconds) of each calibration phase.
+    static const word CALIBRATION_POWER_OFF_TIME = 1000;
+    static const word CALIBRATION_HIGH_TIME = 2000;
+    static const word CALIBRATION_LOW_TIME = 1000;
+    static const word CALIBRATION_NEUTRAL_TIME = 4000;
+
     // Maximum and minimum pulse widths
     // for the electronic speed controller.
     static const word MAXIMUM_PULSE_WIDTH = 1860;
@@ -80,6 +133,14 @@ class ESAT_WheelClass
     // Wait this number of microseconds between successive chunks when
     // writing packets to the EPS board.
     static const word MICROSECONDS_BETWEEN_CHUNKS = 1000;
+
+    // The first chunk of a power line command should go out within
+    // this number of microseconds.
+    static const unsigned long POWER_LINE_COMMAND_DEADLINE = 100000;
+
+    // Stop sending a power line command after this number of failed
+    // attempts.
+    static const byte POWER_LINE_COMMAND_ATTEMPTS = 3;
 #endif /* ARDUINO_ESAT_OBC */
 
     // Duty cycle percentage point per wheel speed RPM.
@@ -88,6 +149,13 @@ class ESAT_WheelClass
     // Maximum allowed wheel speed in rpm.
     static const int MAXIMUM_WHEEL_SPEED = 8000;
 
+    // Current phase of the calibration sequence.
+    CalibrationPhase calibrationPhase;
+
+    // Processor uptime in milliseconds at the start of the current
+    // calibration phase.
+    unsigned long calibrationPhaseStartTime;
+
     // Duty cycle of the electronic speed controller.
     // The duty cycle is a signed percentage: it should go from -100 %
     // to 0 % for negative speed and from 0 % to 100 % for positive
@@ -97,7 +165,53 @@ class ESAT_WheelClass
     // Servo object for commanding the electronic speed controller.
     Servo electronicSpeedController;
 
-    // Run the calibration sequence of the electronic speed controller.
+#ifdef ARDUINO_ESAT_OBC
+    // Number of failed attempts to send the pending power line
+    // command.
+    byte powerLineCommandFailures;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
+    // Packet of the latest power line command, backed by
+    // powerLineCommandPacketData.
+    ESAT_CCSDSPacket powerLineCommandPacket;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
+    // Packet data of the latest power line command.
+    byte powerLineCommandPacketData[ESAT_CCSDSSecondaryHeader::LENGTH + 1];
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
+    // True if there is a power line command waiting to be sent to the
+    // EPS board; false otherwise.
+    boolean powerLineCommandPending;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
+    // True while powerLineCommandTransaction writes the pending power
+    // line command; false otherwise (for example, while it is still
+    // writing a previous command).
+    boolean powerLineCommandQueued;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
+    // Queued I2C transaction that writes the power line commands to
+    // the EPS board.
+    ESAT_I2CPacketWriteTransaction powerLineCommandTransaction;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
+    // Latest commanded state of the power line of the electronic
+    // speed controller: true for on; false for off.
+    boolean powerLineOn;
+#endif /* ARDUINO_ESAT_OBC */
+
+    // Start the given calibration phase now.
+    void beginCalibrationPhase(CalibrationPhase phase);
+
+    // Start the calibration sequence of the electronic speed
+    // controller.
     void calibrateElectronicSpeedController();
 
     // Constrain the duty cycle constrained to lie
@@ -113,6 +227,22 @@ class ESAT_WheelClass
 
     // Switch on the electronic speed controller.
     void switchOnElectronicSpeedController();
+
+#ifdef ARDUINO_ESAT_OBC
+    // Follow the pending power line command on its way to the EPS
+    // board.  Return true once it went out; otherwise return false.
+    boolean updatePowerLineCommand();
+#endif /* ARDUINO_ESAT_OBC */
+
+    // Command the given duty cycle to the electronic speed controller,
+    // even during the calibration sequence.
+    void writeElectronicSpeedController(float dutyCycle);
+
+#ifdef ARDUINO_ESAT_OBC
+    // Queue the pending power line command for the EPS board.
+    // Return true on success; otherwise return false.
+    boolean writePowerLineCommand();
+#endif /* ARDUINO_ESAT_OBC */
 };
 
 extern ESAT_WheelClass ESAT_Wheel;
@@ -67,18 +67,25 @@ void ESAT_AttitudePIDControllerClass::applyActuation()
 
 void ESAT_AttitudePIDControllerClass::applyMagnetorquerActuation()
 {
-  if (actuation > 0)
-  {
-    ESAT_MagnetorquerController.rotateClockwise();
-  }
-  if (actuation < 0)
-  {
-    ESAT_MagnetorquerController.rotateCounterclockwise();
-  }
   if (actuation == 0)
   {
     ESAT_MagnetorquerController.stop();
+    return;
   }
+  if (magnetorquerFullScaleActuation <= 0)
+  {
+    if (actuation > 0)
+    {
+      ESAT_MagnetorquerController.rotateClockwise();
+    }
+    else
+    {
+      ESAT_MagnetorquerController.rotateCounterclockwise();
+    }
+    return;
+  }
+  ESAT_MagnetorquerController.applyTorque(actuation
+                                          / magnetorquerFullScaleActuation);
 }
 
 void ESAT_AttitudePIDControllerClass::applyWheelActuation()
@@ -95,10 +102,14 @@ void ESAT_AttitudePIDControllerClass::begin()
   errorDeadband = DEFAULT_ERROR_DEADBAND;
   errorDerivativeDeadband = DEFAULT_ERROR_DERIVATIVE_DEADBAND;
   integralGain = DEFAULT_INTEGRAL_GAIN;
+  magnetorquerFullScaleActuation = DEFAULT_MAGNETORQUER_FULL_SCALE_ACTUATION;
   proportionalGain = DEFAULT_PROPORTIONAL_GAIN;
   gyroscopeUsage = DEFAULT_GYROSCOPE_USAGE_VALUE;
-  errorIntegral = 0;
+  inversePeriod = 0;
+  period = 0;
   previousError = 0;
+  pidController.begin();
+  pidController.setOutputLimits(-MAXIMUM_ACTUATION, MAXIMUM_ACTUATION);
 }
 
 boolean ESAT_AttitudePIDControllerClass::belowDeadbandThreshold()
@@ -116,37 +127,42 @@ boolean ESAT_AttitudePIDControllerClass::belowDeadbandThreshold()
 
 float ESAT_AttitudePIDControllerClass::computeActuation()
 {
+  // The PID control engine integrates the error on every iteration,
+  // like before, but stops at the actuation limits.
+  pidController.configure(proportionalGain,
+                          integralGain,
+                          derivativeGain,
+                          period);
+  const float pidActuation = pidController.update(error, errorDerivative);
   if (belowDeadbandThreshold())
   {
     return 0;
   }
   if (aboveDetumblingThreshold())
   {
-    return derivativeGain * errorDerivative;
+    return pidController.derivativeTerm();
   }
-  return proportionalGain * error
-    + integralGain * errorIntegral
-    + derivativeGain * errorDerivative;
+  return pidActuation;
 }
 
 float ESAT_AttitudePIDControllerClass::computeErrorDerivative()
 {
   const int errorDifference = angleDifference(error, previousError);
-  return errorDifference / ESAT_ADCS.period();
+  return errorDifference * inversePeriod;
 }
 
 void ESAT_AttitudePIDControllerClass::loop(const word currentAngle)
 {
+  updatePeriod();
   updateError(currentAngle);
   updateErrorDerivative();
-  updateErrorIntegral();
   updateActuation();
   applyActuation();
 }
 
 void ESAT_AttitudePIDControllerClass::resetErrorIntegral()
 {
-  errorIntegral = 0;
+  pidController.reset();
 }
 
 void ESAT_AttitudePIDControllerClass::updateActuation()
@@ -174,9 +190,22 @@ void ESAT_AttitudePIDControllerClass::updateErrorDerivative()
   previousError = error;
 }
 
-void ESAT_AttitudePIDControllerClass::updateErrorIntegral()
+void ESAT_AttitudePIDControllerClass::updatePeriod()
 {
-  errorIntegral = errorIntegral + error * ESAT_ADCS.period();
+  const float currentPeriod = ESAT_ADCS.period();
+  if (currentPeriod == period)
+  {
+    return;
+  }
+  period = currentPeriod;
+  if (period > 0)
+  {
+    inversePeriod = 1 / period;
+  }
+  else
+  {
+    inversePeriod = 0;
+  }
 }
 
 ESAT_AttitudePIDControllerClass ESAT_AttitudePIDController;
@@ -22,6 +22,7 @@
 #define ESAT_AttitudePIDController_h
 
 #include <Arduino.h>
+#include "ESAT_ADCS-controllers/ESAT_PIDController.h"
 
 // Wheel control loop, PID variant.
 // Use the public instance ESAT_WheelPIDController.
@@ -68,6 +69,12 @@ class ESAT_AttitudePIDControllerClass
     // Expressed in 1 / second.
     float integralGain;
 
+    // Magnetorquer full-scale actuation: apply the maximum torque
+    // with the magnetorquers for actuations this large or larger,
+    // and proportionally smaller torques for smaller actuations.
+    // When 0, always apply the maximum torque.
+    float magnetorquerFullScaleActuation;
+
     // Proportional gain of the PID control algorithm.
     // Dimensionless.
     float proportionalGain;
@@ -123,10 +130,18 @@ class ESAT_AttitudePIDControllerClass
     // algorithm.  Expressed in 1 / second.
     static constexpr float DEFAULT_INTEGRAL_GAIN = 0;
 
+    // Default value of the magnetorquer full-scale actuation.
+    static constexpr float DEFAULT_MAGNETORQUER_FULL_SCALE_ACTUATION = 50;
+
     // Default value of the proportional gain of the PID control
     // algorithm.  Dimensionless.
     static constexpr float DEFAULT_PROPORTIONAL_GAIN = 5.5;
 
+    // Keep the actuation between -MAXIMUM_ACTUATION and
+    // MAXIMUM_ACTUATION, which is the maximum wheel speed (in
+    // revolutions per minute), so the error integral doesn't wind up.
+    static constexpr float MAXIMUM_ACTUATION = 8000;
+
     // Current actuation signal for compensating for the error signal.
     float actuation;
 
@@ -136,13 +151,20 @@ class ESAT_AttitudePIDControllerClass
     // Time derivative of the error signal.
     float errorDerivative;
 
-    // Time integral of the error signal.
-    float errorIntegral;
+    // Inverse of the period (in 1 / second), worked out only when
+    // the period changes, so the error derivative takes no division.
+    float inversePeriod;
+
+    // Period (in seconds) of the control loop.
+    float period;
 
     // Angle error (in degrees) at the previous iteration of the
     // control loop.
     int previousError;
 
+    // PID control engine.
+    ESAT_PIDController pidController;
+
     // Return true if the error derivative is above the detumbling
     // threshold.  Otherwise return false.
     boolean aboveDetumblingThreshold();
@@ -183,8 +205,8 @@ class ESAT_AttitudePIDControllerClass
     // Update the value of the error derivative.
     void updateErrorDerivative();
 
-    // Update the value of the error integral.
-    void updateErrorIntegral();
+    // Update the period and its inverse.
+    void updatePeriod();
 };
 
 // Global instance of the attitude PID controller library.
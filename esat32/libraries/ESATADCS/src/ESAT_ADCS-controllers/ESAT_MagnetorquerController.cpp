@@ -21,6 +21,47 @@
 #include "ESAT_ADCS-controllers/ESAT_MagnetorquerController.h"
 #include "ESAT_ADCS.h"
 
+void ESAT_MagnetorquerControllerClass::applyTorque(const float torque)
+{
+  // The torque is proportional to the dipole component perpendicular
+  // to the magnetic field, whose direction comes from the magnetic
+  // angle.  With both magnetorquers at full power, this component
+  // goes up to abs(sine) + abs(cosine), so the requested perpendicular
+  // component is a fraction of that.  The dipole with the least
+  // power is the one fully perpendicular to the magnetic field, but
+  // when that takes more than full power on one magnetorquer, the
+  // other magnetorquer must make up the difference (clamped because
+  // of rounding errors next to the axes).
+  const ESAT_AttitudeStateVector attitudeStateVector =
+    ESAT_ADCS.attitudeStateVector();
+  const float magneticAngle =
+    (attitudeStateVector.magneticAngle % 360) * DEG_TO_RAD;
+  const float sine = sin(magneticAngle);
+  const float cosine = cos(magneticAngle);
+  const float perpendicularDipole =
+    constrain(torque, -1, 1) * (fabs(sine) + fabs(cosine));
+  float xDipole = -perpendicularDipole * sine;
+  float yDipole = perpendicularDipole * cosine;
+  if (fabs(xDipole) > 1)
+  {
+    xDipole = constrain(xDipole, -1, 1);
+    yDipole = constrain((perpendicularDipole + xDipole * sine) / cosine,
+                        -1,
+                        1);
+  }
+  if (fabs(yDipole) > 1)
+  {
+    yDipole = constrain(yDipole, -1, 1);
+    xDipole = constrain((yDipole * cosine - perpendicularDipole) / sine,
+                        -1,
+                        1);
+  }
+  ESAT_Magnetorquer.writeEnable(false);
+  ESAT_Magnetorquer.writeX(polarity(xDipole), fabs(xDipole));
+  ESAT_Magnetorquer.writeY(polarity(yDipole), fabs(yDipole));
+  ESAT_Magnetorquer.writeEnable(true);
+}
+
 ESAT_MagnetorquerClass::Polarity ESAT_MagnetorquerControllerClass::clockwiseXPolarity()
 {
   const ESAT_AttitudeStateVector attitudeStateVector =
@@ -101,6 +142,18 @@ ESAT_MagnetorquerClass::Polarity ESAT_MagnetorquerControllerClass::counterclockw
   return ESAT_Magnetorquer.NEGATIVE;
 }
 
+ESAT_MagnetorquerClass::Polarity ESAT_MagnetorquerControllerClass::polarity(const float dipole)
+{
+  if (dipole < 0)
+  {
+    return ESAT_Magnetorquer.NEGATIVE;
+  }
+  else
+  {
+    return ESAT_Magnetorquer.POSITIVE;
+  }
+}
+
 void ESAT_MagnetorquerControllerClass::rotateClockwise()
 {
   ESAT_Magnetorquer.writeEnable(false);
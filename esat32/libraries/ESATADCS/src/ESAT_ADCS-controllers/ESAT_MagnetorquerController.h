@@ -29,6 +29,15 @@
 class ESAT_MagnetorquerControllerClass
 {
   public:
+    // Apply a torque with a magnitude and direction given as a
+    // fraction of the maximum torque: from -1 (maximum torque in the
+    // counterclockwise direction) to 1 (maximum torque in the
+    // clockwise direction).  The magnetic dipole is perpendicular to
+    // the magnetic field, so no power goes into useless dipole
+    // components, up to the largest torques, which also need a dipole
+    // component along the magnetic field.
+    void applyTorque(float torque);
+
     // Apply a torque to rotate in the clockwise direction.
     void rotateClockwise();
 
@@ -54,6 +63,10 @@ class ESAT_MagnetorquerControllerClass
     // Return the Y-axis magnetorquer polarity needed for
     // counterclockwise rotation.
     ESAT_MagnetorquerClass::Polarity counterclockwiseYPolarity();
+
+    // Return the magnetorquer polarity for a magnetic dipole
+    // component.
+    ESAT_MagnetorquerClass::Polarity polarity(float dipole);
 };
 
 // Global instance of the magnetorquer controller library.
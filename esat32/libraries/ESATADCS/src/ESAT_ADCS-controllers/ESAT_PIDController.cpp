@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ESAT_ADCS-controllers/ESAT_PIDController.h"
+
+void ESAT_PIDController::begin()
+{
+  configuredDerivativeGain = 0;
+  configuredIntegralGain = 0;
+  configuredPeriod = 0;
+  configuredProportionalGain = 0;
+  derivativeCoefficient = 0;
+  derivativeGain = 0;
+  integralCoefficient = 0;
+  proportionalCoefficient = 0;
+  derivativeFilterCoefficient = 1;
+  derivativeFilterTimeConstant = 0;
+  maximumOutputStep = 0;
+  maximumOutput = INFINITY;
+  minimumOutput = -INFINITY;
+  slewRateLimit = 0;
+  reset();
+  computeCoefficients();
+}
+
+void ESAT_PIDController::computeCoefficients()
+{
+  // These are the only divisions of the engine.
+  proportionalCoefficient = configuredProportionalGain;
+  integralCoefficient = configuredIntegralGain * configuredPeriod;
+  derivativeGain = configuredDerivativeGain;
+  if (configuredPeriod > 0)
+  {
+    derivativeCoefficient = configuredDerivativeGain / configuredPeriod;
+  }
+  else
+  {
+    derivativeCoefficient = 0;
+  }
+  if (derivativeFilterTimeConstant > 0)
+  {
+    derivativeFilterCoefficient =
+      configuredPeriod / (derivativeFilterTimeConstant + configuredPeriod);
+  }
+  else
+  {
+    derivativeFilterCoefficient = 1;
+  }
+  maximumOutputStep = slewRateLimit * configuredPeriod;
+#ifdef ARDUINO_ARCH_STM32
+  // Go on from the same error integral with the new coefficients.
+  proportionalIntegralInstance.Kp = proportionalCoefficient;
+  proportionalIntegralInstance.Ki = integralCoefficient;
+  proportionalIntegralInstance.Kd = 0;
+  arm_pid_init_f32(&proportionalIntegralInstance, 0);
+  proportionalIntegralInstance.state[2] =
+    proportionalCoefficient * previousError + integral;
+#endif /* ARDUINO_ARCH_STM32 */
+}
+
+float ESAT_PIDController::computeOutput(const float error,
+                                        const float rawDerivativeTerm)
+{
+  filteredDerivativeTerm = filteredDerivativeTerm
+    + derivativeFilterCoefficient * (rawDerivativeTerm - filteredDerivativeTerm);
+  previousError = error;
+  const float proportionalTerm = proportionalCoefficient * error;
+#ifdef ARDUINO_ARCH_STM32
+  const float unlimitedIntegral =
+    arm_pid_f32(&proportionalIntegralInstance, error) - proportionalTerm;
+#else
+  const float unlimitedIntegral = integral + integralCoefficient * error;
+#endif /* ARDUINO_ARCH_STM32 */
+  const float unlimitedOutput =
+    proportionalTerm + unlimitedIntegral + filteredDerivativeTerm;
+  // Conditional integration: don't integrate further into saturation.
+  const boolean windingUp =
+    ((unlimitedOutput > maximumOutput) && (unlimitedIntegral > integral))
+    || ((unlimitedOutput < minimumOutput) && (unlimitedIntegral < integral));
+  if (!windingUp)
+  {
+    integral = constrain(unlimitedIntegral, minimumOutput, maximumOutput);
+  }
+#ifdef ARDUINO_ARCH_STM32
+  // Anti-windup: go on from the clamped error integral.
+  proportionalIntegralInstance.state[2] = proportionalTerm + integral;
+#endif /* ARDUINO_ARCH_STM32 */
+  float output = constrain(proportionalTerm + integral + filteredDerivativeTerm,
+                           minimumOutput,
+                           maximumOutput);
+  if (maximumOutputStep > 0)
+  {
+    output = constrain(output,
+                       previousOutput - maximumOutputStep,
+                       previousOutput + maximumOutputStep);
+  }
+  previousOutput = output;
+  return output;
+}
+
+void ESAT_PIDController::configure(const float proportionalGain,
+                                   const float integralGain,
+                                   const float derivativeGain,
+                                   const float period)
+{
+  const boolean sameGains =
+    (proportionalGain == configuredProportionalGain)
+    && (integralGain == configuredIntegralGain)
+    && (derivativeGain == configuredDerivativeGain);
+  const boolean samePeriod =
+    fabs(period - configuredPeriod) <= PERIOD_TOLERANCE * configuredPeriod;
+  if (sameGains && samePeriod)
+  {
+    return;
+  }
+  configuredProportionalGain = proportionalGain;
+  configuredIntegralGain = integralGain;
+  configuredDerivativeGain = derivativeGain;
+  configuredPeriod = period;
+  computeCoefficients();
+}
+
+float ESAT_PIDController::derivativeTerm() const
+{
+  return filteredDerivativeTerm;
+}
+
+float ESAT_PIDController::integralTerm() const
+{
+  return integral;
+}
+
+void ESAT_PIDController::reset()
+{
+  filteredDerivativeTerm = 0;
+  integral = 0;
+  previousError = 0;
+  previousOutput = 0;
+#ifdef ARDUINO_ARCH_STM32
+  arm_pid_reset_f32(&proportionalIntegralInstance);
+#endif /* ARDUINO_ARCH_STM32 */
+}
+
+void ESAT_PIDController::setDerivativeFilter(const float timeConstant)
+{
+  derivativeFilterTimeConstant = timeConstant;
+  computeCoefficients();
+}
+
+void ESAT_PIDController::setOutputLimits(const float minimum,
+                                         const float maximum)
+{
+  minimumOutput = minimum;
+  maximumOutput = maximum;
+}
+
+void ESAT_PIDController::setSlewRateLimit(const float rate)
+{
+  slewRateLimit = rate;
+  computeCoefficients();
+}
+
+float ESAT_PIDController::update(const float error)
+{
+  return computeOutput(error, derivativeCoefficient * (error - previousError));
+}
+
+float ESAT_PIDController::update(const float error,
+                                 const float errorDerivative)
+{
+  return computeOutput(error, derivativeGain * errorDerivative);
+}
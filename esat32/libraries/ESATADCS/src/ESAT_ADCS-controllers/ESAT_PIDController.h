@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ESAT_PIDController_h
+#define ESAT_PIDController_h
+
+#include <Arduino.h>
+#ifdef ARDUINO_ARCH_STM32
+#include <CMSIS_DSP.h>
+#endif /* ARDUINO_ARCH_STM32 */
+
+// PID control engine shared by the ADCS controllers, floating-point
+// variant (see ESAT_Q31PIDController for the fixed-point variant).
+//
+// The output is the sum of:
+// - the proportional term: proportional gain * error;
+// - the integral term: integral gain * time integral of the error;
+// - the derivative term: derivative gain * time derivative of the
+//   error, low-pass filtered with the derivative filter time
+//   constant.
+// The output stays between the output limits and changes at most by
+// the slew rate limit per second.  The error integral stops growing
+// while the output is saturated in the direction of the error
+// (conditional integration), so it doesn't wind up.
+//
+// On STM32 boards, the CMSIS-DSP PID function (arm_pid_f32()) works
+// out the sum of the proportional and integral terms in incremental
+// form, without derivative gain; the error integral it keeps is
+// clamped like above after each update.  The derivative term goes
+// apart, so it can be filtered and taken from measured error
+// derivatives.
+//
+// configure() works out the coefficients of each term for the given
+// gains and period and keeps them until they change, so update()
+// takes just a few multiplications and additions, without divisions.
+// Call configure() before each call to update().
+class ESAT_PIDController
+{
+  public:
+    // Start the engine: no output limits, no slew rate limit and no
+    // derivative filter; zero error integral.
+    void begin();
+
+    // Set the gains and the period (in seconds) between calls to
+    // update().  Work out the coefficients again only if the gains
+    // changed or the period changed by more than PERIOD_TOLERANCE.
+    void configure(float proportionalGain,
+                   float integralGain,
+                   float derivativeGain,
+                   float period);
+
+    // Return the derivative term of the latest output.
+    float derivativeTerm() const;
+
+    // Return the integral term of the latest output.
+    float integralTerm() const;
+
+    // Reset the error integral, the derivative filter and the output
+    // slew.
+    void reset();
+
+    // Low-pass filter the derivative term with the given time
+    // constant (in seconds).  Zero disables the filter.
+    void setDerivativeFilter(float timeConstant);
+
+    // Keep the output between the given limits.
+    void setOutputLimits(float minimum, float maximum);
+
+    // Limit the change of the output to the given rate (in output
+    // units per second).  Zero disables the limit.
+    void setSlewRateLimit(float rate);
+
+    // Perform one iteration with the given error, taking the error
+    // derivative from the difference with the previous error.
+    // Return the output.
+    float update(float error);
+
+    // Perform one iteration with the given error and error
+    // derivative (in error units per second), for example, a
+    // rotational speed measured by the gyroscope.
+    // Return the output.
+    float update(float error, float errorDerivative);
+
+  private:
+    // Relative change of the period that makes configure() work out
+    // the coefficients again.
+    static constexpr float PERIOD_TOLERANCE = 0.01;
+
+    // Gains and period of the current coefficients.
+    float configuredDerivativeGain;
+    float configuredIntegralGain;
+    float configuredPeriod;
+    float configuredProportionalGain;
+
+    // Coefficients of the terms: derivativeCoefficient multiplies
+    // error differences; derivativeGain multiplies error
+    // derivatives.
+    float derivativeCoefficient;
+    float derivativeGain;
+    float integralCoefficient;
+    float proportionalCoefficient;
+
+    // Weight of the new derivative term in the derivative filter.
+    float derivativeFilterCoefficient;
+
+    // Time constant (in seconds) of the derivative filter.
+    float derivativeFilterTimeConstant;
+
+    // Filtered derivative term.
+    float filteredDerivativeTerm;
+
+    // Integral term: integral gain * time integral of the error.
+    float integral;
+
+    // Maximum change of the output per iteration.
+    float maximumOutputStep;
+
+    // Output limits.
+    float maximumOutput;
+    float minimumOutput;
+
+    // Error at the previous iteration.
+    float previousError;
+
+    // Output at the previous iteration.
+    float previousOutput;
+
+#ifdef ARDUINO_ARCH_STM32
+    // CMSIS-DSP PID instance that works out the sum of the
+    // proportional and integral terms.
+    arm_pid_instance_f32 proportionalIntegralInstance;
+#endif /* ARDUINO_ARCH_STM32 */
+
+    // Slew rate limit (in output units per second).
+    float slewRateLimit;
+
+    // Work out the coefficients for the configured gains and period.
+    void computeCoefficients();
+
+    // Filter the derivative term, update the integral term without
+    // winding up and return the limited output.
+    float computeOutput(float error, float rawDerivativeTerm);
+};
+
+#endif /* ESAT_PIDController_h */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ESAT_ADCS-controllers/ESAT_Q31PIDController.h"
+
+void ESAT_Q31PIDController::begin()
+{
+  configuredDerivativeGain = 0;
+  configuredIntegralGain = 0;
+  configuredPeriod = 0;
+  configuredProportionalGain = 0;
+  derivativeCoefficient = 0;
+  derivativeGain = 0;
+  integralCoefficient = 0;
+  proportionalCoefficient = 0;
+  coefficientShift = 0;
+  proportionalIntegralShift = 0;
+  derivativeFilterCoefficient = MAXIMUM;
+  derivativeFilterTimeConstant = 0;
+  maximumOutputStep = 0;
+  maximumOutput = MAXIMUM;
+  minimumOutput = MINIMUM;
+  slewRateLimit = 0;
+  reset();
+  computeCoefficients();
+}
+
+void ESAT_Q31PIDController::computeCoefficients()
+{
+  // These are the only floating-point operations and divisions of
+  // the engine.
+  float derivativeCoefficientValue = 0;
+  if (configuredPeriod > 0)
+  {
+    derivativeCoefficientValue = configuredDerivativeGain / configuredPeriod;
+  }
+  const float integralCoefficientValue =
+    configuredIntegralGain * configuredPeriod;
+  // The coefficients of the derivative term share the smallest scale
+  // that makes them fit as Q31 numbers.
+  coefficientShift = scaleShift(max(fabs(derivativeCoefficientValue),
+                                    fabs(configuredDerivativeGain)));
+  derivativeCoefficient =
+    toQ31(derivativeCoefficientValue, 31 - coefficientShift);
+  derivativeGain = toQ31(configuredDerivativeGain, 31 - coefficientShift);
+  // The coefficients of the proportional and integral terms share
+  // the smallest scale that keeps the sums of arm_pid_q31() below
+  // the full scale: the previous sum of the proportional term and the
+  // error integral (at most 1) plus the increment.
+  proportionalIntegralShift =
+    scaleShift(3 * fabs(configuredProportionalGain)
+               + fabs(integralCoefficientValue)
+               + 1);
+  proportionalCoefficient =
+    toQ31(configuredProportionalGain, 31 - proportionalIntegralShift);
+  integralCoefficient =
+    toQ31(integralCoefficientValue, 31 - proportionalIntegralShift);
+  if (derivativeFilterTimeConstant > 0)
+  {
+    derivativeFilterCoefficient =
+      toQ31(configuredPeriod / (derivativeFilterTimeConstant + configuredPeriod),
+            31);
+  }
+  else
+  {
+    derivativeFilterCoefficient = MAXIMUM;
+  }
+  maximumOutputStep = toQ31(slewRateLimit * configuredPeriod, 31);
+#ifdef ARDUINO_ARCH_STM32
+  // Go on from the same error integral with the new coefficients.
+  proportionalIntegralInstance.Kp = proportionalCoefficient;
+  proportionalIntegralInstance.Ki = integralCoefficient;
+  proportionalIntegralInstance.Kd = 0;
+  arm_pid_init_q31(&proportionalIntegralInstance, 0);
+  const long long previousProportionalTerm =
+    multiply(proportionalCoefficient, previousError, proportionalIntegralShift);
+  proportionalIntegralInstance.state[2] =
+    (previousProportionalTerm + integral) >> proportionalIntegralShift;
+#endif /* ARDUINO_ARCH_STM32 */
+}
+
+long ESAT_Q31PIDController::computeOutput(const long error,
+                                          const long long rawDerivativeTerm)
+{
+  const long derivativeTermInput =
+    saturate(rawDerivativeTerm, MINIMUM, MAXIMUM);
+  filteredDerivativeTerm = saturate(
+    filteredDerivativeTerm
+    + ((derivativeFilterCoefficient
+        * ((long long) derivativeTermInput - filteredDerivativeTerm)) >> 31),
+    MINIMUM,
+    MAXIMUM);
+  previousError = error;
+  const long long proportionalTerm =
+    multiply(proportionalCoefficient, error, proportionalIntegralShift);
+#ifdef ARDUINO_ARCH_STM32
+  const long long unlimitedIntegral =
+    ((long long) arm_pid_q31(&proportionalIntegralInstance, error)
+     << proportionalIntegralShift)
+    - proportionalTerm;
+#else
+  const long long unlimitedIntegral = integral
+    + multiply(integralCoefficient, error, proportionalIntegralShift);
+#endif /* ARDUINO_ARCH_STM32 */
+  const long long unlimitedOutput =
+    proportionalTerm + unlimitedIntegral + filteredDerivativeTerm;
+  // Conditional integration: don't integrate further into saturation.
+  const boolean windingUp =
+    ((unlimitedOutput > maximumOutput) && (unlimitedIntegral > integral))
+    || ((unlimitedOutput < minimumOutput) && (unlimitedIntegral < integral));
+  if (!windingUp)
+  {
+    integral = saturate(unlimitedIntegral, minimumOutput, maximumOutput);
+  }
+#ifdef ARDUINO_ARCH_STM32
+  // Anti-windup: go on from the clamped error integral.
+  proportionalIntegralInstance.state[2] =
+    (proportionalTerm + integral) >> proportionalIntegralShift;
+#endif /* ARDUINO_ARCH_STM32 */
+  long output = saturate(proportionalTerm + integral + filteredDerivativeTerm,
+                         minimumOutput,
+                         maximumOutput);
+  if (maximumOutputStep > 0)
+  {
+    output = saturate(output,
+                      saturate((long long) previousOutput - maximumOutputStep,
+                               MINIMUM,
+                               MAXIMUM),
+                      saturate((long long) previousOutput + maximumOutputStep,
+                               MINIMUM,
+                               MAXIMUM));
+  }
+  previousOutput = output;
+  return output;
+}
+
+void ESAT_Q31PIDController::configure(const float proportionalGain,
+                                      const float integralGain,
+                                      const float derivativeGain,
+                                      const float period)
+{
+  const boolean sameGains =
+    (proportionalGain == configuredProportionalGain)
+    && (integralGain == configuredIntegralGain)
+    && (derivativeGain == configuredDerivativeGain);
+  const boolean samePeriod =
+    fabs(period - configuredPeriod) <= PERIOD_TOLERANCE * configuredPeriod;
+  if (sameGains && samePeriod)
+  {
+    return;
+  }
+  configuredProportionalGain = proportionalGain;
+  configuredIntegralGain = integralGain;
+  configuredDerivativeGain = derivativeGain;
+  configuredPeriod = period;
+  computeCoefficients();
+}
+
+long ESAT_Q31PIDController::derivativeTerm() const
+{
+  return filteredDerivativeTerm;
+}
+
+long ESAT_Q31PIDController::integralTerm() const
+{
+  return integral;
+}
+
+long long ESAT_Q31PIDController::multiply(const long coefficient,
+                                          const long long value,
+                                          const byte shift) const
+{
+  return (coefficient * value) >> (31 - shift);
+}
+
+void ESAT_Q31PIDController::reset()
+{
+  filteredDerivativeTerm = 0;
+  integral = 0;
+  previousError = 0;
+  previousOutput = 0;
+#ifdef ARDUINO_ARCH_STM32
+  arm_pid_reset_q31(&proportionalIntegralInstance);
+#endif /* ARDUINO_ARCH_STM32 */
+}
+
+long ESAT_Q31PIDController::saturate(const long long value,
+                                     const long minimum,
+                                     const long maximum) const
+{
+  if (value > maximum)
+  {
+    return maximum;
+  }
+  if (value < minimum)
+  {
+    return minimum;
+  }
+  return long(value);
+}
+
+byte ESAT_Q31PIDController::scaleShift(const float value) const
+{
+  byte shift = 0;
+  float scale = 1;
+  while ((value >= scale) && (shift < 31))
+  {
+    scale = 2 * scale;
+    shift = shift + 1;
+  }
+  return shift;
+}
+
+void ESAT_Q31PIDController::setDerivativeFilter(const float timeConstant)
+{
+  derivativeFilterTimeConstant = timeConstant;
+  computeCoefficients();
+}
+
+void ESAT_Q31PIDController::setOutputLimits(const long minimum,
+                                            const long maximum)
+{
+  minimumOutput = minimum;
+  maximumOutput = maximum;
+}
+
+void ESAT_Q31PIDController::setSlewRateLimit(const float rate)
+{
+  slewRateLimit = rate;
+  computeCoefficients();
+}
+
+long ESAT_Q31PIDController::toQ31(const float value, const int exponent) const
+{
+  const double scaledValue = round(ldexp(double(value), exponent));
+  if (scaledValue >= double(MAXIMUM))
+  {
+    return MAXIMUM;
+  }
+  if (scaledValue <= double(MINIMUM))
+  {
+    return MINIMUM;
+  }
+  return long(scaledValue);
+}
+
+long ESAT_Q31PIDController::update(const long error)
+{
+  return computeOutput(error,
+                       multiply(derivativeCoefficient,
+                                (long long) error - previousError,
+                                coefficientShift));
+}
+
+long ESAT_Q31PIDController::update(const long error,
+                                   const long errorDerivative)
+{
+  return computeOutput(error,
+                       multiply(derivativeGain,
+                                errorDerivative,
+                                coefficientShift));
+}
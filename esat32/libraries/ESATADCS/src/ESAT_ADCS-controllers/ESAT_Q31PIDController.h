@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ESAT_Q31PIDController_h
+#define ESAT_Q31PIDController_h
+
+#include <Arduino.h>
+#ifdef ARDUINO_ARCH_STM32
+#include <CMSIS_DSP.h>
+#endif /* ARDUINO_ARCH_STM32 */
+
+// PID control engine shared by the ADCS controllers, fixed-point
+// variant for processors without floating-point unit.  It works like
+// ESAT_PIDController, but the errors, the error derivatives and the
+// outputs are Q31 numbers: fractions of a full scale chosen by the
+// user, from -1 (-2^31) to almost 1 (2^31 - 1).
+//
+// configure() works out the coefficients of each term as Q31 numbers
+// with a power-of-two scale, so the gains may be larger than 1.
+// update() takes a few 32x32-bit multiplications with 64-bit results
+// and shifts, without divisions nor floating-point operations, and
+// saturates instead of overflowing.  On STM32 boards, the CMSIS-DSP
+// PID function (arm_pid_q31()) works out the sum of the proportional
+// and integral terms; the scale of their coefficients leaves enough
+// headroom for its unsaturated sums.
+// Call configure() before each call to update().
+class ESAT_Q31PIDController
+{
+  public:
+    // Largest and smallest Q31 numbers.
+    static const long MAXIMUM = 0x7FFFFFFFL;
+    static const long MINIMUM = -MAXIMUM - 1;
+
+    // Start the engine: no output limits, no slew rate limit and no
+    // derivative filter; zero error integral.
+    void begin();
+
+    // Set the gains and the period (in seconds) between calls to
+    // update().  Work out the coefficients again only if the gains
+    // changed or the period changed by more than PERIOD_TOLERANCE.
+    void configure(float proportionalGain,
+                   float integralGain,
+                   float derivativeGain,
+                   float period);
+
+    // Return the derivative term of the latest output.
+    long derivativeTerm() const;
+
+    // Return the integral term of the latest output.
+    long integralTerm() const;
+
+    // Reset the error integral, the derivative filter and the output
+    // slew.
+    void reset();
+
+    // Low-pass filter the derivative term with the given time
+    // constant (in seconds).  Zero disables the filter.
+    void setDerivativeFilter(float timeConstant);
+
+    // Keep the output between the given limits.
+    void setOutputLimits(long minimum, long maximum);
+
+    // Limit the change of the output to the given rate (in full
+    // scales per second).  Zero disables the limit.
+    void setSlewRateLimit(float rate);
+
+    // Perform one iteration with the given error, taking the error
+    // derivative from the difference with the previous error.
+    // Return the output.
+    long update(long error);
+
+    // Perform one iteration with the given error and error
+    // derivative (in full scales per second).
+    // Return the output.
+    long update(long error, long errorDerivative);
+
+  private:
+    // Relative change of the period that makes configure() work out
+    // the coefficients again.
+    static constexpr float PERIOD_TOLERANCE = 0.01;
+
+    // Gains and period of the current coefficients.
+    float configuredDerivativeGain;
+    float configuredIntegralGain;
+    float configuredPeriod;
+    float configuredProportionalGain;
+
+    // Coefficients of the derivative term, scaled down by
+    // 2^coefficientShift: derivativeCoefficient multiplies error
+    // differences; derivativeGain multiplies error derivatives.
+    long derivativeCoefficient;
+    long derivativeGain;
+
+    // Coefficients of the integral and proportional terms, scaled
+    // down by 2^proportionalIntegralShift.
+    long integralCoefficient;
+    long proportionalCoefficient;
+
+    // Scale of the coefficients of the derivative term (as a power
+    // of two).
+    byte coefficientShift;
+
+    // Scale of the coefficients of the proportional and integral
+    // terms (as a power of two).
+    byte proportionalIntegralShift;
+
+    // Weight of the new derivative term in the derivative filter.
+    long derivativeFilterCoefficient;
+
+    // Time constant (in seconds) of the derivative filter.
+    float derivativeFilterTimeConstant;
+
+    // Filtered derivative term.
+    long filteredDerivativeTerm;
+
+    // Integral term: integral gain * time integral of the error.
+    long integral;
+
+    // Maximum change of the output per iteration.
+    long maximumOutputStep;
+
+    // Output limits.
+    long maximumOutput;
+    long minimumOutput;
+
+    // Error at the previous iteration.
+    long previousError;
+
+    // Output at the previous iteration.
+    long previousOutput;
+
+#ifdef ARDUINO_ARCH_STM32
+    // CMSIS-DSP PID instance that works out the sum of the
+    // proportional and integral terms, scaled down by
+    // 2^proportionalIntegralShift.
+    arm_pid_instance_q31 proportionalIntegralInstance;
+#endif /* ARDUINO_ARCH_STM32 */
+
+    // Slew rate limit (in full scales per second).
+    float slewRateLimit;
+
+    // Work out the coefficients for the configured gains and period.
+    void computeCoefficients();
+
+    // Filter the derivative term, update the integral term without
+    // winding up and return the limited output.
+    long computeOutput(long error, long long rawDerivativeTerm);
+
+    // Return the product of a coefficient scaled down by 2^shift
+    // and a Q31 number as a Q31 number, not saturated yet.
+    long long multiply(long coefficient, long long value, byte shift) const;
+
+    // Return the value saturated between the given limits.
+    long saturate(long long value, long minimum, long maximum) const;
+
+    // Return the smallest power of two (as an exponent, at most 31)
+    // larger than the value.
+    byte scaleShift(float value) const;
+
+    // Return the value multiplied by 2^exponent as a saturated Q31
+    // number.
+    long toQ31(float value, int exponent) const;
+};
+
+#endif /* ESAT_Q31PIDController_h */
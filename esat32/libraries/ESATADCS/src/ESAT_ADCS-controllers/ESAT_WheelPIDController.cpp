@@ -27,33 +27,23 @@ void ESAT_WheelPIDControllerClass::begin()
   derivativeGain = DEFAULT_DERIVATIVE_GAIN;
   integralGain = DEFAULT_INTEGRAL_GAIN;
   proportionalGain = DEFAULT_PROPORTIONAL_GAIN;
-  errorIntegral = 0;
-  previousError = 0;
+  pidController.begin();
+  pidController.setOutputLimits(0, MAXIMUM_SPEED);
   targetSpeed = 0;
 }
 
 void ESAT_WheelPIDControllerClass::loop(const word newTargetSpeed)
 {
-  const float period = ESAT_ADCS.period();
   targetSpeed = newTargetSpeed;
   const ESAT_AttitudeStateVector attitudeStateVector =
     ESAT_ADCS.attitudeStateVector();
   const int error = int(targetSpeed) - int(attitudeStateVector.wheelSpeed);
-  errorIntegral = errorIntegral + error * period;
-  const float errorDerivative = (float(error) - float(previousError)) / period;
-  previousError = error;
-  const float control =
-    proportionalGain * error
-    + integralGain * errorIntegral
-    + derivativeGain * errorDerivative;
-  if (control > 0)
-  {
-    ESAT_Wheel.writeSpeed(control);
-  }
-  else
-  {
-    ESAT_Wheel.writeSpeed(0);
-  }
+  pidController.configure(proportionalGain,
+                          integralGain,
+                          derivativeGain,
+                          ESAT_ADCS.period());
+  const float control = pidController.update(error);
+  ESAT_Wheel.writeSpeed(control);
 }
 
 word ESAT_WheelPIDControllerClass::readTargetSpeed()
@@ -63,7 +53,7 @@ word ESAT_WheelPIDControllerClass::readTargetSpeed()
 
 void ESAT_WheelPIDControllerClass::resetErrorIntegral()
 {
-  errorIntegral = 0;
+  pidController.reset();
 }
 
 ESAT_WheelPIDControllerClass ESAT_WheelPIDController;
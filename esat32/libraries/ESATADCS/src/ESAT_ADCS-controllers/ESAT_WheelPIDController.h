@@ -22,6 +22,7 @@
 #define ESAT_WheelPIDController_h
 
 #include <Arduino.h>
+#include "ESAT_ADCS-controllers/ESAT_PIDController.h"
 
 // Wheel control loop, PID variant.
 // Use the public instance ESAT_WheelPIDController.
@@ -69,12 +70,13 @@ class ESAT_WheelPIDControllerClass
     // algorithm.  Dimensionless.
     static constexpr float DEFAULT_PROPORTIONAL_GAIN = 1.5;
 
-    // Integral of the error term.
-    float errorIntegral;
+    // Maximum wheel speed (in revolutions per minute).
+    static constexpr float MAXIMUM_SPEED = 8000;
 
-    // Wheel speed (in revolutions per minute) at the previous
-    // iteration of the control loop.
-    int previousError;
+    // PID control engine.  Its output is the wheel speed command,
+    // from 0 to MAXIMUM_SPEED, so the error integral doesn't wind up
+    // while the wheel can't follow.
+    ESAT_PIDController pidController;
 
     // Target rotational speed of the wheel in revolutions per minute.
     word targetSpeed;
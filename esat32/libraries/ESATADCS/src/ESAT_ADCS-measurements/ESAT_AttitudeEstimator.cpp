@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_ADCS-measurements/ESAT_AttitudeEstimator.h"
+#ifdef ARDUINO_ARCH_STM32
+#include <CMSIS_DSP.h>
+#endif /* ARDUINO_ARCH_STM32 */
+
+float ESAT_AttitudeEstimator::angle() const
+{
+  return estimatedAngle;
+}
+
+float ESAT_AttitudeEstimator::angleDifference(const float minuend,
+                                              const float subtrahend) const
+{
+  const float difference = minuend - subtrahend;
+  if (difference > 180)
+  {
+    return difference - 360;
+  }
+  if (difference < -180)
+  {
+    return difference + 360;
+  }
+  return difference;
+}
+
+float ESAT_AttitudeEstimator::angleVariance() const
+{
+  return estimatedAngleVariance;
+}
+
+void ESAT_AttitudeEstimator::begin(const float angleNoise,
+                                   const float rotationalSpeedNoise,
+                                   const float angularAccelerationNoise)
+{
+  angleReadingVariance = angleNoise * angleNoise;
+  rotationalSpeedReadingVariance =
+    rotationalSpeedNoise * rotationalSpeedNoise;
+  angularAccelerationVariance =
+    angularAccelerationNoise * angularAccelerationNoise;
+  estimatedAngle = 0;
+  estimatedRotationalSpeed = 0;
+  estimatedAngleVariance = INITIAL_ANGLE_VARIANCE;
+  estimatedCovariance = 0;
+  estimatedRotationalSpeedVariance = INITIAL_ROTATIONAL_SPEED_VARIANCE;
+}
+
+void ESAT_AttitudeEstimator::correctCovariance(const float correction[])
+{
+  const float covariance[4] = {
+    estimatedAngleVariance, estimatedCovariance,
+    estimatedCovariance, estimatedRotationalSpeedVariance,
+  };
+  float correctedCovariance[4];
+  multiply(correction, covariance, correctedCovariance);
+  estimatedAngleVariance = correctedCovariance[0];
+  estimatedCovariance = correctedCovariance[1];
+  estimatedRotationalSpeedVariance = correctedCovariance[3];
+}
+
+int ESAT_AttitudeEstimator::matrixExponent(const float matrix[]) const
+{
+  // frexpf() gives the largest element as m 2^exponent with m from
+  // 0.5 to less than 1, so one more halving brings it under 0.5 and
+  // a sum of two products stays under 0.5 too.
+  float largestElement = 0;
+  for (int index = 0; index < 4; index++)
+  {
+    const float element = fabsf(matrix[index]);
+    if (element > largestElement)
+    {
+      largestElement = element;
+    }
+  }
+  if (largestElement == 0)
+  {
+    return 0;
+  }
+  int exponent;
+  (void) frexpf(largestElement, &exponent);
+  return exponent + 1;
+}
+
+void ESAT_AttitudeEstimator::multiply(const float left[],
+                                      const float right[],
+                                      float product[]) const
+{
+  // The fixed-point products take each matrix scaled by its power of
+  // two and give back the product scaled by the sum of both powers.
+#ifdef ARDUINO_ARCH_STM32
+  switch (arithmetic)
+  {
+    case F32_MATRIX_ARITHMETIC:
+    {
+      arm_matrix_instance_f32 leftMatrix;
+      arm_matrix_instance_f32 rightMatrix;
+      arm_matrix_instance_f32 productMatrix;
+      arm_mat_init_f32(&leftMatrix, 2, 2, (float32_t*) left);
+      arm_mat_init_f32(&rightMatrix, 2, 2, (float32_t*) right);
+      arm_mat_init_f32(&productMatrix, 2, 2, product);
+      (void) arm_mat_mult_f32(&leftMatrix, &rightMatrix, &productMatrix);
+      return;
+    }
+    case Q31_MATRIX_ARITHMETIC:
+    case Q15_MATRIX_ARITHMETIC:
+    {
+      const int leftExponent = matrixExponent(left);
+      const int rightExponent = matrixExponent(right);
+      float scaledLeft[4];
+      float scaledRight[4];
+      for (int index = 0; index < 4; index++)
+      {
+        scaledLeft[index] = ldexpf(left[index], -leftExponent);
+        scaledRight[index] = ldexpf(right[index], -rightExponent);
+      }
+      if (arithmetic == Q31_MATRIX_ARITHMETIC)
+      {
+        q31_t leftData[4];
+        q31_t rightData[4];
+        q31_t productData[4];
+        arm_float_to_q31(scaledLeft, leftData, 4);
+        arm_float_to_q31(scaledRight, rightData, 4);
+        arm_matrix_instance_q31 leftMatrix;
+        arm_matrix_instance_q31 rightMatrix;
+        arm_matrix_instance_q31 productMatrix;
+        arm_mat_init_q31(&leftMatrix, 2, 2, leftData);
+        arm_mat_init_q31(&rightMatrix, 2, 2, rightData);
+        arm_mat_init_q31(&productMatrix, 2, 2, productData);
+        (void) arm_mat_mult_q31(&leftMatrix, &rightMatrix, &productMatrix);
+        arm_q31_to_float(productData, product, 4);
+      }
+      else
+      {
+        q15_t leftData[4];
+        q15_t rightData[4];
+        q15_t productData[4];
+        q15_t scratch[4];
+        arm_float_to_q15(scaledLeft, leftData, 4);
+        arm_float_to_q15(scaledRight, rightData, 4);
+        arm_matrix_instance_q15 leftMatrix;
+        arm_matrix_instance_q15 rightMatrix;
+        arm_matrix_instance_q15 productMatrix;
+        arm_mat_init_q15(&leftMatrix, 2, 2, leftData);
+        arm_mat_init_q15(&rightMatrix, 2, 2, rightData);
+        arm_mat_init_q15(&productMatrix, 2, 2, productData);
+        (void) arm_mat_mult_q15(&leftMatrix,
+                                &rightMatrix,
+                                &productMatrix,
+                                scratch);
+        arm_q15_to_float(productData, product, 4);
+      }
+      for (int index = 0; index < 4; index++)
+      {
+        product[index] =
+          ldexpf(product[index], leftExponent + rightExponent);
+      }
+      return;
+    }
+    default:
+      break;
+  }
+#endif /* ARDUINO_ARCH_STM32 */
+  product[0] = left[0] * right[0] + left[1] * right[2];
+  product[1] = left[0] * right[1] + left[1] * right[3];
+  product[2] = left[2] * right[0] + left[3] * right[2];
+  product[3] = left[2] * right[1] + left[3] * right[3];
+}
+
+float ESAT_AttitudeEstimator::normaliseAngle(const float angle) const
+{
+  // The remainder keeps the sign of the angle, so negative angles
+  // need one extra turn.  Adding 360 degrees to a tiny negative
+  // remainder rounds to exactly 360 degrees, which is 0 degrees.
+  float normalisedAngle = fmodf(angle, 360);
+  if (normalisedAngle < 0)
+  {
+    normalisedAngle = normalisedAngle + 360;
+  }
+  if (normalisedAngle >= 360)
+  {
+    normalisedAngle = 0;
+  }
+  return normalisedAngle;
+}
+
+void ESAT_AttitudeEstimator::predict(const float period)
+{
+  // State transition: the angle decreases with the rotational speed.
+  //   F = [ 1  -period ]
+  //       [ 0     1    ]
+  // Process noise from a random angular acceleration a:
+  //   Q = G G' var(a) with G = [ -period^2/2  period ]'.
+  estimatedAngle =
+    normaliseAngle(estimatedAngle - estimatedRotationalSpeed * period);
+  const float period2 = period * period;
+  const float period3 = period2 * period;
+  const float period4 = period2 * period2;
+  // P = F P F' + Q.
+  if (arithmetic == SCALAR_ARITHMETIC)
+  {
+    estimatedAngleVariance =
+      estimatedAngleVariance
+      - 2 * period * estimatedCovariance
+      + period2 * estimatedRotationalSpeedVariance
+      + 0.25 * period4 * angularAccelerationVariance;
+    estimatedCovariance =
+      estimatedCovariance
+      - period * estimatedRotationalSpeedVariance
+      - 0.5 * period3 * angularAccelerationVariance;
+    estimatedRotationalSpeedVariance =
+      estimatedRotationalSpeedVariance
+      + period2 * angularAccelerationVariance;
+    return;
+  }
+  const float transition[4] = {1, -period, 0, 1};
+  const float transposedTransition[4] = {1, 0, -period, 1};
+  const float covariance[4] = {
+    estimatedAngleVariance, estimatedCovariance,
+    estimatedCovariance, estimatedRotationalSpeedVariance,
+  };
+  float transitionCovariance[4];
+  float propagatedCovariance[4];
+  multiply(transition, covariance, transitionCovariance);
+  multiply(transitionCovariance, transposedTransition, propagatedCovariance);
+  estimatedAngleVariance =
+    propagatedCovariance[0]
+    + 0.25 * period4 * angularAccelerationVariance;
+  estimatedCovariance =
+    propagatedCovariance[1]
+    - 0.5 * period3 * angularAccelerationVariance;
+  estimatedRotationalSpeedVariance =
+    propagatedCovariance[3]
+    + period2 * angularAccelerationVariance;
+}
+
+float ESAT_AttitudeEstimator::rotationalSpeed() const
+{
+  return estimatedRotationalSpeed;
+}
+
+float ESAT_AttitudeEstimator::rotationalSpeedVariance() const
+{
+  return estimatedRotationalSpeedVariance;
+}
+
+void ESAT_AttitudeEstimator::setArithmetic(const Arithmetic newArithmetic)
+{
+  if (MATRIX_ARITHMETIC_AVAILABLE)
+  {
+    arithmetic = newArithmetic;
+  }
+  else
+  {
+    arithmetic = SCALAR_ARITHMETIC;
+  }
+}
+
+void ESAT_AttitudeEstimator::updateAngle(const float measuredAngle)
+{
+  // Scalar update with H = [ 1 0 ]; the innovation wraps around
+  // so that readings near 0 degrees and 359 degrees agree.
+  const float innovation = angleDifference(measuredAngle, estimatedAngle);
+  const float innovationVariance =
+    estimatedAngleVariance + angleReadingVariance;
+  const float angleGain = estimatedAngleVariance / innovationVariance;
+  const float rotationalSpeedGain = estimatedCovariance / innovationVariance;
+  estimatedAngle = normaliseAngle(estimatedAngle + angleGain * innovation);
+  estimatedRotationalSpeed =
+    estimatedRotationalSpeed + rotationalSpeedGain * innovation;
+  // P = (I - K H) P.
+  if (arithmetic == SCALAR_ARITHMETIC)
+  {
+    estimatedRotationalSpeedVariance =
+      estimatedRotationalSpeedVariance
+      - rotationalSpeedGain * estimatedCovariance;
+    estimatedCovariance = (1 - angleGain) * estimatedCovariance;
+    estimatedAngleVariance = (1 - angleGain) * estimatedAngleVariance;
+    return;
+  }
+  const float correction[4] = {
+    1 - angleGain, 0,
+    -rotationalSpeedGain, 1,
+  };
+  correctCovariance(correction);
+}
+
+void ESAT_AttitudeEstimator::updateRotationalSpeed(const float measuredRotationalSpeed)
+{
+  // Scalar update with H = [ 0 1 ].
+  const float innovation = measuredRotationalSpeed - estimatedRotationalSpeed;
+  const float innovationVariance =
+    estimatedRotationalSpeedVariance + rotationalSpeedReadingVariance;
+  const float angleGain = estimatedCovariance / innovationVariance;
+  const float rotationalSpeedGain =
+    estimatedRotationalSpeedVariance / innovationVariance;
+  estimatedAngle = normaliseAngle(estimatedAngle + angleGain * innovation);
+  estimatedRotationalSpeed =
+    estimatedRotationalSpeed + rotationalSpeedGain * innovation;
+  // P = (I - K H) P.
+  if (arithmetic == SCALAR_ARITHMETIC)
+  {
+    estimatedAngleVariance =
+      estimatedAngleVariance - angleGain * estimatedCovariance;
+    estimatedCovariance = (1 - rotationalSpeedGain) * estimatedCovariance;
+    estimatedRotationalSpeedVariance =
+      (1 - rotationalSpeedGain) * estimatedRotationalSpeedVariance;
+    return;
+  }
+  const float correction[4] = {
+    1, -angleGain,
+    0, 1 - rotationalSpeedGain,
+  };
+  correctCovariance(correction);
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_AttitudeEstimator_h
+#define ESAT_AttitudeEstimator_h
+
+#include <Arduino.h>
+
+// Attitude estimator: two-state Kalman filter that fuses the
+// rotational speed measured by the gyroscope with the angle of a
+// reference direction measured by an attitude sensor (the
+// magnetometer or the coarse sun sensor) into a filtered angle and
+// rotational speed with their variances.
+//
+// The angle follows the same convention as the angles of
+// ESAT_AttitudeStateVector: it is the angle of the reference
+// direction relative to the +X axis, so it decreases when the
+// satellite turns counterclockwise (positive rotational speed).
+// The model keeps the rotational speed constant between iterations
+// except for a random angular acceleration.
+//
+// On each iteration, call predict() once, then updateRate() with the
+// gyroscope reading and updateAngle() with the attitude sensor
+// reading (skip the readings with errors).
+//
+// All the matrices are 2x2, so by default the filter works with their
+// elements directly.  On STM32 boards, setArithmetic() can switch the
+// covariance propagation and correction to CMSIS-DSP matrix products
+// in floating point or in Q31 or Q15 fixed point; the fixed-point
+// products scale each matrix by a power of two that fits it in the
+// fixed-point range.  The host build in extras/host compares their
+// accuracy and speed against the default.
+class ESAT_AttitudeEstimator
+{
+  public:
+    // Arithmetic of the covariance propagation and correction.
+    enum Arithmetic
+    {
+      // Floating-point arithmetic on the matrix elements written out.
+      SCALAR_ARITHMETIC = 0,
+      // Floating-point CMSIS-DSP matrix products (arm_mat_mult_f32()).
+      F32_MATRIX_ARITHMETIC = 1,
+      // Q31 fixed-point CMSIS-DSP matrix products (arm_mat_mult_q31()).
+      Q31_MATRIX_ARITHMETIC = 2,
+      // Q15 fixed-point CMSIS-DSP matrix products (arm_mat_mult_q15()).
+      Q15_MATRIX_ARITHMETIC = 3,
+    };
+
+#ifdef ARDUINO_ARCH_STM32
+    // True when the CMSIS-DSP matrix arithmetics are available (on
+    // STM32 boards); false otherwise.
+    static const boolean MATRIX_ARITHMETIC_AVAILABLE = true;
+#else
+    // True when the CMSIS-DSP matrix arithmetics are available (on
+    // STM32 boards); false otherwise.
+    static const boolean MATRIX_ARITHMETIC_AVAILABLE = false;
+#endif
+
+    // Return the estimated angle (in degrees, from 0 degrees to
+    // less than 360 degrees).
+    float angle() const;
+
+    // Return the variance (in square degrees) of the estimated angle.
+    float angleVariance() const;
+
+    // Start the estimator with the standard deviations of:
+    // - the angle readings (in degrees);
+    // - the rotational speed readings (in degrees per second);
+    // - the random angular acceleration of the model (in degrees per
+    //   second squared).
+    // The first angle reading sets the estimated angle.
+    void begin(float angleNoise,
+               float rotationalSpeedNoise,
+               float angularAccelerationNoise);
+
+    // Propagate the estimate the given period (in seconds) forward.
+    void predict(float period);
+
+    // Return the estimated rotational speed (in degrees per second,
+    // positive counterclockwise).
+    float rotationalSpeed() const;
+
+    // Set the arithmetic of the covariance propagation and
+    // correction (one of the Arithmetic values).
+    // The matrix arithmetics fall back to SCALAR_ARITHMETIC when
+    // MATRIX_ARITHMETIC_AVAILABLE is false.
+    void setArithmetic(Arithmetic newArithmetic);
+
+    // Return the variance (in square degrees per square second) of
+    // the estimated rotational speed.
+    float rotationalSpeedVariance() const;
+
+    // Correct the estimate with an angle reading (in degrees).
+    void updateAngle(float measuredAngle);
+
+    // Correct the estimate with a rotational speed reading (in
+    // degrees per second, positive counterclockwise).
+    void updateRotationalSpeed(float measuredRotationalSpeed);
+
+  private:
+    // Initial variance of the estimated angle (in square degrees):
+    // large enough for the first reading to set the angle.
+    static constexpr float INITIAL_ANGLE_VARIANCE = 32400;
+
+    // Initial variance of the estimated rotational speed (in square
+    // degrees per square second).
+    static constexpr float INITIAL_ROTATIONAL_SPEED_VARIANCE = 10000;
+
+    // Variance (in square degrees per second to the fourth) of the
+    // random angular acceleration.
+    float angularAccelerationVariance;
+
+    // Arithmetic of the covariance propagation and correction.
+    Arithmetic arithmetic = SCALAR_ARITHMETIC;
+
+    // Variance (in square degrees) of the angle readings.
+    float angleReadingVariance;
+
+    // Estimated angle (in degrees).
+    float estimatedAngle;
+
+    // Estimated rotational speed (in degrees per second).
+    float estimatedRotationalSpeed;
+
+    // Covariance matrix of the estimate:
+    // [ angleVariance        covariance ]
+    // [ covariance    rotationalSpeedVariance ].
+    float estimatedAngleVariance;
+    float estimatedCovariance;
+    float estimatedRotationalSpeedVariance;
+
+    // Variance (in square degrees per square second) of the
+    // rotational speed readings.
+    float rotationalSpeedReadingVariance;
+
+    // Return the difference between two angles, normalised between
+    // -180 degrees and 180 degrees.
+    float angleDifference(float minuend, float subtrahend) const;
+
+    // Replace the covariance matrix of the estimate with its product
+    // by the given 2x2 matrix (P = M P), in the current arithmetic.
+    void correctCovariance(const float correction[]);
+
+    // Return the power of two that scales the largest element of the
+    // given 2x2 matrix down to 0.5 at most, so that the fixed-point
+    // matrix products don't overflow.
+    int matrixExponent(const float matrix[]) const;
+
+    // Multiply two 2x2 matrices stored by rows, in the current
+    // arithmetic.
+    void multiply(const float left[],
+                  const float right[],
+                  float product[]) const;
+
+    // Return the angle normalised from 0 degrees to less than 360
+    // degrees.
+    float normaliseAngle(float angle) const;
+};
+
+#endif /* ESAT_AttitudeEstimator_h */
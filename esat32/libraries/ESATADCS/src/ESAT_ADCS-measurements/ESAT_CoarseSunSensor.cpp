@@ -19,6 +19,7 @@
  */
 
 #include "ESAT_ADCS-measurements/ESAT_CoarseSunSensor.h"
+#include "ESAT_ADCS-measurements/ESAT_FastTrigonometry.h"
 
 void ESAT_CoarseSunSensorClass::begin()
 {
@@ -60,10 +61,18 @@ word ESAT_CoarseSunSensorClass::readSunAngle()
   const float readingYMinus = readYMinus();
   const float nx = readingXPlus - readingXMinus;
   const float ny = readingYPlus - readingYMinus;
-  const int reading = round(atan2(ny, nx) * RAD_TO_DEG);
-  if (reading < 0)
+  // The angle goes from 0 degrees to less than 360 degrees before
+  // rounding to the nearest degree, so rounding is just adding 0.5
+  // and truncating, wrapping 360 degrees back to 0 degrees.
+  float angle = ESAT_FastTrigonometry.atan2Degrees(ny, nx);
+  if (angle < 0)
   {
-    return reading + 360;
+    angle = angle + 360;
+  }
+  const word reading = word(angle + 0.5f);
+  if (reading >= 360)
+  {
+    return reading - 360;
   }
   else
   {
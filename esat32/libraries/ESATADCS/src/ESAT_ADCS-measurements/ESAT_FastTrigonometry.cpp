@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ESAT_ADCS-measurements/ESAT_FastTrigonometry.h"
+
+float ESAT_FastTrigonometryClass::atan2Degrees(const float y,
+                                               const float x) const
+{
+  // The arctangent of the smaller component over the larger one is
+  // in the first octant (from 0 to 45 degrees); the other octants
+  // follow by symmetry.
+  const float absoluteX = fabs(x);
+  const float absoluteY = fabs(y);
+  const boolean firstOctant = (absoluteY <= absoluteX);
+  float smaller = firstOctant ? absoluteY : absoluteX;
+  float larger = firstOctant ? absoluteX : absoluteY;
+  if (larger == 0)
+  {
+    return 0;
+  }
+  // Keep the reciprocal a normal number (1 / RECIPROCAL_RANGE is
+  // worked out at compile time).
+  if (larger > RECIPROCAL_RANGE)
+  {
+    smaller = smaller * (1 / RECIPROCAL_RANGE);
+    larger = larger * (1 / RECIPROCAL_RANGE);
+  }
+  if (larger < 1 / RECIPROCAL_RANGE)
+  {
+    smaller = smaller * RECIPROCAL_RANGE;
+    larger = larger * RECIPROCAL_RANGE;
+  }
+  const float octantAngle =
+    octantArctangentDegrees(smaller * reciprocal(larger));
+  float angle = firstOctant ? octantAngle : 90 - octantAngle;
+  if (x < 0)
+  {
+    angle = 180 - angle;
+  }
+  if (y < 0)
+  {
+    angle = -angle;
+  }
+  return angle;
+}
+
+float ESAT_FastTrigonometryClass::octantArctangentDegrees(const float tangent) const
+{
+  const float square = tangent * tangent;
+  const float arctangent =
+    tangent
+    * (ARCTANGENT_COEFFICIENT_1
+       + square
+       * (ARCTANGENT_COEFFICIENT_3
+          + square
+          * (ARCTANGENT_COEFFICIENT_5
+             + square
+             * (ARCTANGENT_COEFFICIENT_7
+                + square * ARCTANGENT_COEFFICIENT_9))));
+  return arctangent * float(RAD_TO_DEG);
+}
+
+float ESAT_FastTrigonometryClass::reciprocal(const float value) const
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bits = RECIPROCAL_MAGIC_NUMBER - bits;
+  float estimate;
+  memcpy(&estimate, &bits, sizeof(estimate));
+  for (byte iteration = 0; iteration < RECIPROCAL_ITERATIONS; iteration++)
+  {
+    estimate = estimate * (2 - value * estimate);
+  }
+  return estimate;
+}
+
+ESAT_FastTrigonometryClass ESAT_FastTrigonometry;
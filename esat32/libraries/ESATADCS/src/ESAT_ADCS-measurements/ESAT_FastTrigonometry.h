@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ESAT_FastTrigonometry_h
+#define ESAT_FastTrigonometry_h
+
+#include <Arduino.h>
+
+// Fast trigonometry for turning sensor readings into angles.
+// Use the global instance ESAT_FastTrigonometry.
+//
+// The arctangent comes from a polynomial approximation in single
+// precision (Abramowitz and Stegun, 4.4.49) on the first octant,
+// extended to the whole circle by symmetry, instead of the
+// double-precision atan2() of the C library.  The tangent of the
+// first octant takes no division: it is the smaller component times
+// the reciprocal of the larger one, which comes from a first guess
+// worked out on the bits of the floating-point number and refined by
+// Newton-Raphson iterations.
+class ESAT_FastTrigonometryClass
+{
+  public:
+    // Return the angle (in degrees, from -180 degrees to 180 degrees)
+    // of the vector (x, y), like atan2(y, x) * RAD_TO_DEG, but faster.
+    // The error is less than 0.001 degrees.  Return 0 for the null
+    // vector.
+    float atan2Degrees(float y, float x) const;
+
+  private:
+    // Coefficients of the polynomial approximation of the arctangent
+    // (in radians) from 0 to 1, in powers of the argument squared.
+    static constexpr float ARCTANGENT_COEFFICIENT_1 = 0.9998660;
+    static constexpr float ARCTANGENT_COEFFICIENT_3 = -0.3302995;
+    static constexpr float ARCTANGENT_COEFFICIENT_5 = 0.1801410;
+    static constexpr float ARCTANGENT_COEFFICIENT_7 = -0.0851330;
+    static constexpr float ARCTANGENT_COEFFICIENT_9 = 0.0208351;
+
+    // Subtracting the bits of a positive floating-point number from
+    // this magic number gives its reciprocal within 5.1 %.
+    static const uint32_t RECIPROCAL_MAGIC_NUMBER = 0x7EF311C3;
+
+    // Number of Newton-Raphson iterations of the reciprocal.  Each
+    // iteration squares the relative error, down to 6.7e-6 after 2
+    // iterations, which adds less than 0.0002 degrees to the error of
+    // the arctangent.
+    static const byte RECIPROCAL_ITERATIONS = 2;
+
+    // Components larger than RECIPROCAL_RANGE or smaller than
+    // 1 / RECIPROCAL_RANGE are scaled by RECIPROCAL_RANGE first, so
+    // their reciprocal is a normal floating-point number.  It is
+    // 2^40, so the scaling is exact.
+    static constexpr float RECIPROCAL_RANGE = 1099511627776.0;
+
+    // Return the arctangent (in degrees) of a number from 0 to 1.
+    float octantArctangentDegrees(float tangent) const;
+
+    // Return the reciprocal of a positive number between
+    // 1 / RECIPROCAL_RANGE and RECIPROCAL_RANGE.
+    float reciprocal(float value) const;
+};
+
+// Global instance of the fast trigonometry library.
+extern ESAT_FastTrigonometryClass ESAT_FastTrigonometry;
+
+#endif /* ESAT_FastTrigonometry_h */
@@ -22,6 +22,7 @@
 #ifdef ARDUINO_ESAT_ADCS
 #include <EEPROM.h>
 #endif /* ARDUINO_ESAT_ADCS */
+#include <ESAT_I2CBusScheduler.h>
 #include <ESAT_Util.h>
 #ifdef ARDUINO_ESAT_OBC
 #include <SD.h>
@@ -34,16 +35,32 @@ const char ESAT_GyroscopeClass::BIAS_FILENAME[] = "gyrobias";
 void ESAT_GyroscopeClass::begin(const byte fullScaleConfiguration)
 {
   error = false;
+  (void) ESAT_I2CBusScheduler.configure(ADDRESS,
+                                        ESAT_I2CBusScheduler.ATTITUDE_PRIORITY);
   configureLowPassFilter();
   configureRange(fullScaleConfiguration);
   setGain(fullScaleConfiguration);
   readBiasCorrection();
   enableBiasCorrection();
+  pendingBiasCorrection = false;
+  if (fifoEnabled)
+  {
+    configureFIFO();
+  }
 }
 
 void ESAT_GyroscopeClass::configureBiasCorrection()
 {
-  const word samples = 1024;
+  // In FIFO mode, read() gathers the samples for the bias
+  // estimation, so there is no need to wait for them here.
+  if (fifoEnabled)
+  {
+    biasCorrectionSampleCount = 0;
+    biasCorrectionSampleSum = 0;
+    pendingBiasCorrection = true;
+    return;
+  }
+  const word samples = BIAS_CORRECTION_SAMPLES;
   long average = 0;
   for (unsigned long sample = 0; sample < samples; sample = sample + 1)
   {
@@ -53,6 +70,25 @@ void ESAT_GyroscopeClass::configureBiasCorrection()
   writeBiasCorrection();
 }
 
+void ESAT_GyroscopeClass::configureFIFO()
+{
+  // The FIFO is reset on every configuration change so that it
+  // never holds samples taken with the previous configuration.
+  if (fifoEnabled)
+  {
+    writeRegister(SAMPLE_RATE_DIVIDER_REGISTER, fifoSampleRateDivider);
+    writeRegister(FIFO_ENABLE_REGISTER, FIFO_GYROSCOPE_Z);
+    writeRegister(USER_CONTROL_REGISTER, FIFO_RESET);
+    writeRegister(USER_CONTROL_REGISTER, FIFO_ENABLE);
+  }
+  else
+  {
+    writeRegister(FIFO_ENABLE_REGISTER, 0);
+    writeRegister(USER_CONTROL_REGISTER, FIFO_RESET);
+    writeRegister(SAMPLE_RATE_DIVIDER_REGISTER, 0);
+  }
+}
+
 void ESAT_GyroscopeClass::configureLowPassFilter()
 {
   bus.beginTransmission(ADDRESS);
@@ -80,24 +116,72 @@ void ESAT_GyroscopeClass::configureRange(const byte fullScaleConfiguration)
   }
 }
 
+boolean ESAT_GyroscopeClass::configuringBiasCorrection() const
+{
+  return pendingBiasCorrection;
+}
+
 void ESAT_GyroscopeClass::disableBiasCorrection()
 {
   correctBias = false;
 }
 
+void ESAT_GyroscopeClass::disableFIFO()
+{
+  fifoEnabled = false;
+  pendingBiasCorrection = false;
+  configureFIFO();
+}
+
 void ESAT_GyroscopeClass::enableBiasCorrection()
 {
   correctBias = true;
 }
 
+void ESAT_GyroscopeClass::enableFIFO(const byte sampleRateDivider)
+{
+  fifoSampleRateDivider = sampleRateDivider;
+  fifoEnabled = true;
+  configureFIFO();
+}
+
+int ESAT_GyroscopeClass::rawSample(const byte highByte,
+                                   const byte lowByte) const
+{
+  const word bits = word(highByte, lowByte);
+  const int reading = ESAT_Util.wordToInt(bits);
+#ifdef ARDUINO_ESAT_OBC
+  return reading;
+#endif /* ARDUINO_ESAT_OBC */
+#ifdef ARDUINO_ESAT_ADCS
+  return -reading;
+#endif /* ARDUINO_ESAT_ADCS */
+}
+
 int ESAT_GyroscopeClass::read(unsigned int samples)
 {
+  const boolean busGranted = ESAT_I2CBusScheduler.beginTransaction(ADDRESS);
+  if (!busGranted)
+  {
+    error = true;
+    return 0;
+  }
   long cumulativeRawReading = 0;
-  for (unsigned int i = 0; i < samples; i++)
+  unsigned int samplesRead = 0;
+  if (fifoEnabled)
+  {
+    samplesRead = readFIFOSamples(cumulativeRawReading);
+  }
+  if (samplesRead == 0)
   {
-    cumulativeRawReading = cumulativeRawReading + readRawSample();
+    for (unsigned int i = 0; i < samples; i++)
+    {
+      cumulativeRawReading = cumulativeRawReading + readRawSample();
+    }
+    samplesRead = samples;
   }
-  const long averageRawReading = cumulativeRawReading / long(samples);
+  ESAT_I2CBusScheduler.endTransaction();
+  const long averageRawReading = cumulativeRawReading / long(samplesRead);
   if (correctBias)
   {
     return (averageRawReading - bias) / gain;
@@ -108,6 +192,78 @@ int ESAT_GyroscopeClass::read(unsigned int samples)
   }
 }
 
+unsigned int ESAT_GyroscopeClass::readFIFOSamples(long& cumulativeRawReading)
+{
+  bus.beginTransmission(ADDRESS);
+  bus.write(FIFO_COUNT_REGISTER);
+  const byte writeStatus = bus.endTransmission();
+  if (writeStatus != 0)
+  {
+    error = true;
+    return 0;
+  }
+  const byte bytesRead = bus.requestFrom(int(ADDRESS), 2);
+  if (bytesRead != 2)
+  {
+    error = true;
+    return 0;
+  }
+  const byte countHighByte = bus.read();
+  const byte countLowByte = bus.read();
+  word count = word(countHighByte, countLowByte) & 0x1FFF;
+  if (count > FIFO_SIZE)
+  {
+    count = FIFO_SIZE;
+  }
+  // Only whole samples are read; a sample half written by the
+  // gyroscope stays in the FIFO for the next call.
+  const unsigned int samples = count / 2;
+  long fifoRawReading = 0;
+  unsigned int remainingBytes = 2 * samples;
+  while (remainingBytes > 0)
+  {
+    byte burstLength = FIFO_BURST_LENGTH;
+    if (remainingBytes < FIFO_BURST_LENGTH)
+    {
+      burstLength = remainingBytes;
+    }
+    bus.beginTransmission(ADDRESS);
+    bus.write(FIFO_READ_WRITE_REGISTER);
+    const byte burstWriteStatus = bus.endTransmission();
+    if (burstWriteStatus != 0)
+    {
+      error = true;
+      return 0;
+    }
+    const byte burstBytesRead = bus.requestFrom(int(ADDRESS), int(burstLength));
+    if (burstBytesRead != burstLength)
+    {
+      error = true;
+      return 0;
+    }
+    for (byte i = 0; i < burstLength; i = i + 2)
+    {
+      const byte highByte = bus.read();
+      const byte lowByte = bus.read();
+      fifoRawReading = fifoRawReading + rawSample(highByte, lowByte);
+    }
+    remainingBytes = remainingBytes - burstLength;
+  }
+  if (pendingBiasCorrection && (samples > 0))
+  {
+    biasCorrectionSampleSum = biasCorrectionSampleSum + fifoRawReading;
+    biasCorrectionSampleCount = biasCorrectionSampleCount + samples;
+    if (biasCorrectionSampleCount >= BIAS_CORRECTION_SAMPLES)
+    {
+      bias = biasCorrectionSampleSum / long(biasCorrectionSampleCount);
+      writeBiasCorrection();
+      pendingBiasCorrection = false;
+    }
+  }
+  cumulativeRawReading = cumulativeRawReading + fifoRawReading;
+  return samples;
+}
+
 int ESAT_GyroscopeClass::readRawSample()
 {
   bus.beginTransmission(ADDRESS);
@@ -126,14 +282,7 @@ int ESAT_GyroscopeClass::readRawSample()
   }
   const byte highByte = bus.read();
   const byte lowByte = bus.read();
-  const word bits = word(highByte, lowByte);
-  const int reading = ESAT_Util.wordToInt(bits);
-#ifdef ARDUINO_ESAT_OBC
-  return reading;
-#endif /* ARDUINO_ESAT_OBC */
-#ifdef ARDUINO_ESAT_ADCS
-  return -reading;
-#endif /* ARDUINO_ESAT_ADCS */
+  return rawSample(highByte, lowByte);
 }
 
 void ESAT_GyroscopeClass::setGain(const byte fullScaleConfiguration)
@@ -181,4 +330,17 @@ void ESAT_GyroscopeClass::writeBiasCorrection()
 #endif /* ARDUINO_ESAT_OBC */
 }
 
+void ESAT_GyroscopeClass::writeRegister(const byte registerNumber,
+                                        const byte value)
+{
+  bus.beginTransmission(ADDRESS);
+  bus.write(registerNumber);
+  bus.write(value);
+  const byte writeStatus = bus.endTransmission();
+  if (writeStatus != 0)
+  {
+    error = true;
+  }
+}
+
 ESAT_GyroscopeClass ESAT_Gyroscope;
@@ -49,10 +49,19 @@ class ESAT_GyroscopeClass
     // Set the error flag on error.
     void begin(byte fullScaleConfiguration = FULL_SCALE_2000_DEGREES_PER_SECOND);
 
+    // Return true while a bias correction configuration started with
+    // configureBiasCorrection() in FIFO mode is gathering samples;
+    // otherwise return false.
+    boolean configuringBiasCorrection() const;
+
     // Configure the sensor bias correction.
     // The gyroscope may have a small bias.
     // Call this function with the satellite perfectly still
     // to estimate the bias for bias correction.
+    // In FIFO mode, return right away and estimate the bias from the
+    // samples gathered by the next calls to read() instead of taking
+    // the samples one by one; the satellite must stay still until
+    // configuringBiasCorrection() returns false.
     void configureBiasCorrection();
 
     // Disable the bias correction.
@@ -60,11 +69,28 @@ class ESAT_GyroscopeClass
     // enableBiasCorrection() will work.
     void disableBiasCorrection();
 
+    // Go back to reading the samples one by one.
+    // Set the error flag on error.
+    void disableFIFO();
+
     // Enable the bias correction.
     void enableBiasCorrection();
 
-    // Read the gyroscope.  Return the average of a number of samples.
+    // Let the gyroscope gather its samples in its internal FIFO at
+    // 1 kHz / (1 + sampleRateDivider), so that read() takes all the
+    // samples gathered since the previous call in a few burst reads.
+    // The FIFO holds 256 samples: choose a sample rate that doesn't
+    // fill it up between two calls to read().
     // Set the error flag on error.
+    void enableFIFO(byte sampleRateDivider = 4);
+
+    // Read the gyroscope.  Return the average of a number of samples.
+    // Take the samples in one go after asking ESAT_I2CBusScheduler
+    // for the bus.
+    // In FIFO mode, return the average of all the samples gathered in
+    // the FIFO since the previous call instead; take the given number
+    // of samples one by one only if the FIFO is empty.
+    // Set the error flag on error or if the bus is not available.
     int read(unsigned int samples);
 
   private:
@@ -80,6 +106,38 @@ class ESAT_GyroscopeClass
     // Register number of the reading of the gyroscope.
     static const byte GYROSCOPE_READING_REGISTER = 71;
 
+    // Register number of the sample rate divider.
+    static const byte SAMPLE_RATE_DIVIDER_REGISTER = 25;
+
+    // Register number of the selection of FIFO contents.
+    static const byte FIFO_ENABLE_REGISTER = 35;
+
+    // Register number of the user control (FIFO enable and reset).
+    static const byte USER_CONTROL_REGISTER = 106;
+
+    // Register number of the FIFO count (high byte first).
+    static const byte FIFO_COUNT_REGISTER = 114;
+
+    // Register number of the FIFO data.
+    static const byte FIFO_READ_WRITE_REGISTER = 116;
+
+    // FIFO contents: only the gyroscope Z axis, 2 bytes per sample.
+    static const byte FIFO_GYROSCOPE_Z = B00010000;
+
+    // User control flags.
+    static const byte FIFO_ENABLE = B01000000;
+    static const byte FIFO_RESET = B00000100;
+
+    // Size of the FIFO in bytes.
+    static const word FIFO_SIZE = 512;
+
+    // Maximum number of bytes read from the FIFO in one go
+    // (the length of the buffer of the I2C bus driver).
+    static const byte FIFO_BURST_LENGTH = 32;
+
+    // Number of samples used for estimating the bias.
+    static const word BIAS_CORRECTION_SAMPLES = 1024;
+
     // Low pass filter configuration.
     static const byte LOW_PASS_FILTER_CONFIGURATION = B00000110;
 
@@ -105,21 +163,52 @@ class ESAT_GyroscopeClass
     // Used for bias correction.
     int bias;
 
+    // Number of samples gathered so far for the bias correction
+    // configuration in FIFO mode.
+    word biasCorrectionSampleCount;
+
+    // Sum of the raw samples gathered so far for the bias correction
+    // configuration in FIFO mode.
+    long biasCorrectionSampleSum;
+
     // Whether to correct the bias.
     // Set by enableBiasCorrection() and disableBiasCorrect().
     boolean correctBias;
 
+    // Whether the FIFO is in use.
+    // Set by enableFIFO() and disableFIFO().
+    boolean fifoEnabled;
+
+    // Sample rate divider of FIFO mode.
+    byte fifoSampleRateDivider;
+
+    // True while configuring the bias correction in FIFO mode.
+    boolean pendingBiasCorrection;
+
     // Gain for internal conversions.  Set by setFullScale().
     double gain;
 
     // Configure the low pass filter of the gyroscope.
     void configureLowPassFilter();
 
+    // Configure the sample rate divider, the FIFO contents and the
+    // user control register for FIFO mode (or back to normal mode).
+    // Set the error flag on error.
+    void configureFIFO();
+
     // Configure the range of measurement of the gyroscope according
     // to the full scale configuration.
     // Set the error flag on error.
     void configureRange(byte fullScaleConfiguration);
 
+    // Return the raw sample value of a reading.
+    int rawSample(byte highByte, byte lowByte) const;
+
+    // Read all the raw samples gathered in the FIFO and add them to
+    // the cumulative raw reading.  Return the number of samples read.
+    // Set the error flag on error.
+    unsigned int readFIFOSamples(long& cumulativeRawReading);
+
     // Read a raw sample.
     // Set the error flag on error.
     int readRawSample();
@@ -133,6 +222,10 @@ class ESAT_GyroscopeClass
 
     // Write the bias correction to non-volatile memory.
     void writeBiasCorrection();
+
+    // Write a register.
+    // Set the error flag on error.
+    void writeRegister(byte registerNumber, byte value);
 };
 
 // Global instance of the gyroscope library.
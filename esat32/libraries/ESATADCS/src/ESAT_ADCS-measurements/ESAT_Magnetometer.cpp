@@ -19,9 +19,11 @@
  */
 
 #include "ESAT_ADCS-measurements/ESAT_Magnetometer.h"
+#include "ESAT_ADCS-measurements/ESAT_FastTrigonometry.h"
 #ifdef ARDUINO_ESAT_ADCS
 #include <EEPROM.h>
 #endif /* ARDUINO_ESAT_ADCS */
+#include <ESAT_I2CBusScheduler.h>
 #include <ESAT_Util.h>
 #ifdef ARDUINO_ESAT_OBC
 #include <SD.h>
@@ -49,9 +51,36 @@ float ESAT_MagnetometerClass::angleDifference(const float minuend,
 void ESAT_MagnetometerClass::begin()
 {
   error = false;
+  (void) ESAT_I2CBusScheduler.configure(MAGNETOMETER_ADDRESS,
+                                        ESAT_I2CBusScheduler.ATTITUDE_PRIORITY);
   readGeometryCorrection();
   enableGeometryCorrection();
   setBypassMode();
+  if (continuousMeasurement)
+  {
+    setMeasurementMode(continuousMeasurementMode);
+  }
+}
+
+void ESAT_MagnetometerClass::beginReading()
+{
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(MAGNETOMETER_ADDRESS);
+  if (!busGranted)
+  {
+    error = true;
+    return;
+  }
+  if (continuousMeasurement)
+  {
+    getSample();
+  }
+  else
+  {
+    setBypassMode();
+    startReading();
+  }
+  ESAT_I2CBusScheduler.endTransaction();
 }
 
 word ESAT_MagnetometerClass::computeAttitude(const float xField,
@@ -62,37 +91,16 @@ word ESAT_MagnetometerClass::computeAttitude(const float xField,
   // components of the magnetic field and a little knowledge of the
   // orientation of the magnetometer.
 #ifdef ARDUINO_ESAT_OBC
-  const float fieldAngle =
-    normaliseAttitude(atan2(xField, yField) * RAD_TO_DEG);
+  const word fieldAngle =
+    normaliseAttitude(ESAT_FastTrigonometry.atan2Degrees(xField, yField));
 #endif /* ARDUINO_ESAT_OBC */
 #ifdef ARDUINO_ESAT_ADCS
-  const float fieldAngle =
-    normaliseAttitude(-atan2(xField, yField) * RAD_TO_DEG);
+  const word fieldAngle =
+    normaliseAttitude(-ESAT_FastTrigonometry.atan2Degrees(xField, yField));
 #endif /* ARDUINO_ESAT_ADCS */
   if (correctGeometry)
   {
-    // The attitude is obtained from a piecewise linear interpolation of the
-    // measured angles.
-    const int actualAngles[] = {315, 0, 45, 90, 135, 180, 225, 270, 315, 0};
-    for (int position = 0;
-         position < (GEOMETRY_CORRECTION_POSITIONS + 1);
-         position = position + 1)
-    {
-      if ((angleDifference(fieldAngle, fieldAngles[position]) >= 0)
-          && (angleDifference(fieldAngle, fieldAngles[position + 1]) <= 0))
-      {
-        const float attitude =
-          fieldAngle
-          + angleDifference(actualAngles[position], fieldAngles[position])
-          * angleDifference(fieldAngle, fieldAngles[position + 1])
-          / angleDifference(fieldAngles[position], fieldAngles[position + 1])
-          + angleDifference(actualAngles[position + 1], fieldAngles[position + 1])
-          * angleDifference(fieldAngle, fieldAngles[position])
-          / angleDifference(fieldAngles[position + 1], fieldAngles[position]);
-        return normaliseAttitude(attitude);
-      }
-    }
-    return fieldAngle;
+    return geometryCorrectionTable[fieldAngle];
   }
   else
   {
@@ -100,6 +108,32 @@ word ESAT_MagnetometerClass::computeAttitude(const float xField,
   }
 }
 
+word ESAT_MagnetometerClass::computeGeometryCorrection(const word fieldAngle) const
+{
+  // The attitude is obtained from a piecewise linear interpolation of the
+  // measured angles.
+  const int actualAngles[] = {315, 0, 45, 90, 135, 180, 225, 270, 315, 0};
+  for (int position = 0;
+       position < (GEOMETRY_CORRECTION_POSITIONS + 1);
+       position = position + 1)
+  {
+    if ((angleDifference(fieldAngle, fieldAngles[position]) >= 0)
+        && (angleDifference(fieldAngle, fieldAngles[position + 1]) <= 0))
+    {
+      const float attitude =
+        fieldAngle
+        + angleDifference(actualAngles[position], fieldAngles[position])
+        * angleDifference(fieldAngle, fieldAngles[position + 1])
+        / angleDifference(fieldAngles[position], fieldAngles[position + 1])
+        + angleDifference(actualAngles[position + 1], fieldAngles[position + 1])
+        * angleDifference(fieldAngle, fieldAngles[position])
+        / angleDifference(fieldAngles[position + 1], fieldAngles[position]);
+      return normaliseAttitude(attitude);
+    }
+  }
+  return fieldAngle;
+}
+
 void ESAT_MagnetometerClass::configureGeometryCorrection(const word measurement0,
                                                          const word measurement45,
                                                          const word measurement90,
@@ -122,19 +156,57 @@ void ESAT_MagnetometerClass::configureGeometryCorrection(const word measurement0
   fieldAngles[7] = measurement270;
   fieldAngles[8] = measurement315;
   fieldAngles[9] = measurement0;
+  updateGeometryCorrectionTable();
   writeGeometryCorrection();
 }
 
+void ESAT_MagnetometerClass::disableContinuousMeasurement()
+{
+  continuousMeasurement = false;
+  setMeasurementMode(POWER_DOWN_MODE);
+}
+
 void ESAT_MagnetometerClass::disableGeometryCorrection()
 {
   correctGeometry = false;
 }
 
+void ESAT_MagnetometerClass::enableContinuousMeasurement(const byte mode)
+{
+  continuousMeasurementMode = mode;
+  continuousMeasurement = true;
+  latestSample.attitude = 0;
+  latestSample.fresh = false;
+  latestSample.timestamp = micros();
+  setBypassMode();
+  setMeasurementMode(continuousMeasurementMode);
+}
+
 void ESAT_MagnetometerClass::enableGeometryCorrection()
 {
   correctGeometry = true;
 }
 
+word ESAT_MagnetometerClass::endReading()
+{
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(MAGNETOMETER_ADDRESS);
+  if (!busGranted)
+  {
+    error = true;
+    return 0;
+  }
+  if (continuousMeasurement)
+  {
+    getSample();
+    ESAT_I2CBusScheduler.endTransaction();
+    return latestSample.attitude;
+  }
+  const word reading = getReading();
+  ESAT_I2CBusScheduler.endTransaction();
+  return reading;
+}
+
 word ESAT_MagnetometerClass::getReading()
 {
   bus.beginTransmission(MAGNETOMETER_ADDRESS);
@@ -162,6 +234,53 @@ word ESAT_MagnetometerClass::getReading()
   return computeAttitude(xField, yField);
 }
 
+void ESAT_MagnetometerClass::getSample()
+{
+  // The magnetometer keeps the data registers of a sample until the
+  // end-of-reading status register is read, so the data status, the
+  // magnetic field and the end-of-reading status go in one burst.
+  latestSample.fresh = false;
+  bus.beginTransmission(MAGNETOMETER_ADDRESS);
+  bus.write(DATA_STATUS_REGISTER);
+  const byte writeStatus = bus.endTransmission();
+  if (writeStatus != 0)
+  {
+    error = true;
+    return;
+  }
+  const byte bytesRead =
+    bus.requestFrom(int(MAGNETOMETER_ADDRESS), int(SAMPLE_LENGTH));
+  if (bytesRead != SAMPLE_LENGTH)
+  {
+    error = true;
+    return;
+  }
+  const byte dataStatus = bus.read();
+  const byte xLowByte = bus.read();
+  const byte xHighByte = bus.read();
+  const byte yLowByte = bus.read();
+  const byte yHighByte = bus.read();
+  (void) bus.read();
+  (void) bus.read();
+  const byte endOfReadingStatus = bus.read();
+  if ((endOfReadingStatus & MAGNETIC_SENSOR_OVERFLOW) != 0)
+  {
+    error = true;
+    return;
+  }
+  if ((dataStatus & DATA_READY) == 0)
+  {
+    return;
+  }
+  const word xFieldBits = word(xHighByte, xLowByte);
+  const word yFieldBits = word(yHighByte, yLowByte);
+  const int xField = ESAT_Util.wordToInt(xFieldBits);
+  const int yField = ESAT_Util.wordToInt(yFieldBits);
+  latestSample.attitude = computeAttitude(xField, yField);
+  latestSample.fresh = true;
+  latestSample.timestamp = micros();
+}
+
 word ESAT_MagnetometerClass::normaliseAttitude(const int attitude) const
 {
   if (attitude < 0)
@@ -178,12 +297,54 @@ word ESAT_MagnetometerClass::normaliseAttitude(const int attitude) const
   }
 }
 
+boolean ESAT_MagnetometerClass::pollReading()
+{
+  bus.beginTransmission(MAGNETOMETER_ADDRESS);
+  bus.write(DATA_STATUS_REGISTER);
+  const byte writeStatus = bus.endTransmission();
+  if (writeStatus != 0)
+  {
+    error = true;
+    return false;
+  }
+  const byte bytesRead = bus.requestFrom(int(MAGNETOMETER_ADDRESS), 1);
+  if (bytesRead != 1)
+  {
+    error = true;
+    return false;
+  }
+  const byte readingState = bus.read();
+  if ((readingState & DATA_READY) != 0)
+  {
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
 word ESAT_MagnetometerClass::read()
 {
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(MAGNETOMETER_ADDRESS);
+  if (!busGranted)
+  {
+    error = true;
+    return 0;
+  }
+  if (continuousMeasurement)
+  {
+    getSample();
+    ESAT_I2CBusScheduler.endTransaction();
+    return latestSample.attitude;
+  }
   setBypassMode();
   startReading();
   waitForReading();
-  return getReading();
+  const word reading = getReading();
+  ESAT_I2CBusScheduler.endTransaction();
+  return reading;
 }
 
 void ESAT_MagnetometerClass::readGeometryCorrection()
@@ -232,6 +393,36 @@ void ESAT_MagnetometerClass::readGeometryCorrection()
   }
   file.close();
 #endif /* ARDUINO_ESAT_OBC */
+  updateGeometryCorrectionTable();
+}
+
+boolean ESAT_MagnetometerClass::readingReady()
+{
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(MAGNETOMETER_ADDRESS);
+  if (!busGranted)
+  {
+    error = true;
+    return false;
+  }
+  const boolean ready = pollReading();
+  ESAT_I2CBusScheduler.endTransaction();
+  return ready;
+}
+
+ESAT_MagnetometerClass::Sample ESAT_MagnetometerClass::readSample()
+{
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(MAGNETOMETER_ADDRESS);
+  if (!busGranted)
+  {
+    error = true;
+    latestSample.fresh = false;
+    return latestSample;
+  }
+  getSample();
+  ESAT_I2CBusScheduler.endTransaction();
+  return latestSample;
 }
 
 void ESAT_MagnetometerClass::setBypassMode()
@@ -246,6 +437,34 @@ void ESAT_MagnetometerClass::setBypassMode()
   }
 }
 
+void ESAT_MagnetometerClass::setMeasurementMode(const byte mode)
+{
+  bus.beginTransmission(MAGNETOMETER_ADDRESS);
+  bus.write(CONTROL_REGISTER);
+  bus.write(POWER_DOWN_MODE);
+  const byte powerDownWriteStatus = bus.endTransmission();
+  if (powerDownWriteStatus != 0)
+  {
+    error = true;
+    return;
+  }
+  // The magnetometer needs 100 microseconds in power-down mode
+  // before going to another mode.
+  delayMicroseconds(100);
+  if (mode == POWER_DOWN_MODE)
+  {
+    return;
+  }
+  bus.beginTransmission(MAGNETOMETER_ADDRESS);
+  bus.write(CONTROL_REGISTER);
+  bus.write(mode);
+  const byte writeStatus = bus.endTransmission();
+  if (writeStatus != 0)
+  {
+    error = true;
+  }
+}
+
 void ESAT_MagnetometerClass::startReading()
 {
   bus.beginTransmission(MAGNETOMETER_ADDRESS);
@@ -258,27 +477,24 @@ void ESAT_MagnetometerClass::startReading()
   }
 }
 
+void ESAT_MagnetometerClass::updateGeometryCorrectionTable()
+{
+  for (word fieldAngle = 0;
+       fieldAngle < GEOMETRY_CORRECTION_TABLE_LENGTH;
+       fieldAngle = fieldAngle + 1)
+  {
+    geometryCorrectionTable[fieldAngle] =
+      computeGeometryCorrection(fieldAngle);
+  }
+}
+
 void ESAT_MagnetometerClass::waitForReading()
 {
   const byte timeout = 255;
   for (int i = 0; i < timeout; i++)
   {
-    bus.beginTransmission(MAGNETOMETER_ADDRESS);
-    bus.write(DATA_STATUS_REGISTER);
-    const byte writeStatus = bus.endTransmission();
-    if (writeStatus != 0)
-    {
-      error = true;
-      return;
-    }
-    const byte bytesRead = bus.requestFrom(int(MAGNETOMETER_ADDRESS), 1);
-    if (bytesRead != 1)
-    {
-      error = true;
-      return;
-    }
-    const byte readingState = bus.read();
-    if ((readingState & DATA_READY) != 0)
+    const boolean ready = pollReading();
+    if (error || ready)
     {
       return;
     }
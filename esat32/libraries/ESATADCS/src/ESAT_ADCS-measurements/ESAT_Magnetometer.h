@@ -33,14 +33,47 @@
 class ESAT_MagnetometerClass
 {
   public:
+    // Continuous measurement modes: the magnetometer measures on its
+    // own 8 times per second or 100 times per second.
+    static const byte CONTINUOUS_MEASUREMENT_8_HZ = B00000010;
+    static const byte CONTINUOUS_MEASUREMENT_100_HZ = B00000110;
+
+    // Magnetic attitude sample taken in continuous measurement mode.
+    struct Sample
+    {
+      // Magnetic attitude in degrees (like the value returned by
+      // read()).
+      word attitude;
+
+      // True if the magnetometer had a new sample since the previous
+      // reading; false if this is the same sample as before.
+      boolean fresh;
+
+      // Processor uptime (in microseconds) when the sample was read
+      // for the first time.
+      unsigned long timestamp;
+    };
+
     // True after a read error.  Must be reset manually.
     boolean error;
 
     // Set up the magnetometer.
     // Enable the geometry correction (use the latest geometry
     // correction set with configureGeometryCorrection()).
+    // Go back to continuous measurement mode if it was enabled.
     void begin();
 
+    // Start a single magnetic field measurement and return without
+    // waiting for it, so that other work can go on during the
+    // conversion.  Poll readingReady() and collect the measurement
+    // with endReading().
+    // In continuous measurement mode, discard the current sample
+    // instead, so that readingReady() waits for the next one.  That
+    // sample may have started up to one measurement period before.
+    // Ask ESAT_I2CBusScheduler for the bus before starting.
+    // Set the error flag on error or if the bus is not available.
+    void beginReading();
+
     // Configure the geometry correction based on measured attitudes
     // at several actual attitudes.
     // The measured angle of the magnetic field can differ from the
@@ -61,21 +94,59 @@ class ESAT_MagnetometerClass
                                      word measurement270,
                                      word measurement315);
 
+    // Go back to single measurements.
+    // Set the error flag on error.
+    void disableContinuousMeasurement();
+
     // Disable the geometry correction.
     // The geometry correction measurements are preserved so that a
     // call to enableGeometryCorrection() will work.
     void disableGeometryCorrection();
 
+    // Let the magnetometer measure on its own in one of the
+    // CONTINUOUS_MEASUREMENT_X_HZ modes, so that readings take the
+    // latest sample with a single burst read instead of starting a
+    // measurement and waiting for it.  The bypass mode of the chip is
+    // set only once, here.
+    // Set the error flag on error.
+    void enableContinuousMeasurement(byte mode = CONTINUOUS_MEASUREMENT_100_HZ);
+
     // Enable the geometry correction.
     void enableGeometryCorrection();
 
+    // Return the magnetic attitude (in degrees, like read()) of the
+    // measurement started with beginReading().
+    // Ask ESAT_I2CBusScheduler for the bus before reading.
+    // Set the error flag on error or if the bus is not available.
+    word endReading();
+
     // Read the magnetic attitude (in degrees) relative to North:
     // the counterclockwise angle from the +X axis of the satellite
     // to the North direction or the clockwise angle from the North
     // direction to the +X axis of the satellite.
     // The attitude goes from 0 degrees to 359 degrees.
+    // In continuous measurement mode, return the attitude of the
+    // latest sample (see readSample()).
+    // Ask ESAT_I2CBusScheduler for the bus before measuring.
+    // Set the error flag on error or if the bus is not available.
     word read();
 
+    // Look once at the data status of the measurement started with
+    // beginReading().  Return true if the measurement is ready;
+    // otherwise return false.
+    // Ask ESAT_I2CBusScheduler for the bus before looking.
+    // Set the error flag on error or if the bus is not available.
+    boolean readingReady();
+
+    // Return the latest sample of continuous measurement mode, with
+    // its timestamp and whether it is fresh, after reading the data
+    // status, the magnetic field and the end-of-reading status in one
+    // burst read.
+    // Ask ESAT_I2CBusScheduler for the bus before reading.
+    // Set the error flag on error, on magnetic sensor overflow or if
+    // the bus is not available.
+    Sample readSample();
+
   private:
     // I2C addresses, registers and flags used when communicating with
     // the magnetometer chip.
@@ -86,12 +157,22 @@ class ESAT_MagnetometerClass
     static const byte DATA_STATUS_REGISTER = 0x02;
     static const byte ENABLE_BYPASS = B00000010;
     static const byte MAGNETOMETER_ADDRESS = 0x0C;
+    static const byte MAGNETIC_SENSOR_OVERFLOW = B00001000;
+    static const byte POWER_DOWN_MODE = B00000000;
     static const byte READING_REGISTER = 0x03;
     static const byte SINGLE_MEASUREMENT_MODE = B00000001;
 
+    // Number of bytes of a sample burst read: data status,
+    // X, Y and Z magnetic field and end-of-reading status.
+    static const byte SAMPLE_LENGTH = 8;
+
     // Number of positions of the geometry correction process.
     static const byte GEOMETRY_CORRECTION_POSITIONS = 8;
 
+    // Number of entries of the geometry correction table: one per
+    // degree of magnetic field angle.
+    static const word GEOMETRY_CORRECTION_TABLE_LENGTH = 360;
+
     // Persistent geometry correction storage.
 #ifdef ARDUINO_ESAT_ADCS
     static const int GEOMETRY_EEPROM_ADDRESS = 2;
@@ -110,13 +191,30 @@ class ESAT_MagnetometerClass
     TwoWire& bus = WireOBC;
 #endif /* ARDUINO_ESAT_OBC */
 
+    // Whether the magnetometer measures on its own.
+    // Set by enableContinuousMeasurement() and
+    // disableContinuousMeasurement().
+    boolean continuousMeasurement;
+
+    // Continuous measurement mode.
+    byte continuousMeasurementMode;
+
     // Whether to correct the geometry.
     // Set by enableGeometryCorrection() and disableGeometryCorrection().
     boolean correctGeometry;
 
+    // Latest sample of continuous measurement mode.
+    Sample latestSample;
+
     // Geometry correction coefficients.
     word fieldAngles[GEOMETRY_CORRECTION_POSITIONS + 2];
 
+    // Geometry correction table: corrected magnetic attitude for each
+    // magnetic field angle, worked out from the geometry correction
+    // coefficients whenever they change, so the correction of each
+    // reading is a table lookup.
+    word geometryCorrectionTable[GEOMETRY_CORRECTION_TABLE_LENGTH];
+
     // Return the difference between two angles, normalised between
     // -180 degrees and 180 degrees.
     float angleDifference(float minuend, float subtrahend) const;
@@ -124,17 +222,34 @@ class ESAT_MagnetometerClass
     // Return the magnetic cattitude angle in degres sas deduced from
     // the magnetic field components.  The attitude angle ranges from
     // 0 degrees to 359 degrees.
+    // This takes constant time: a fast arctangent and a lookup in the
+    // geometry correction table.
     word computeAttitude(float xField,
                          float yField) const;
 
+    // Return the magnetic attitude angle in degrees corrected for the
+    // geometry from the magnetic field angle in degrees.  Both angles
+    // range from 0 degrees to 359 degrees.
+    word computeGeometryCorrection(word fieldAngle) const;
+
     // Get the current reading of the magnetic attitude.
     // Set the error flag on error.
     word getReading();
 
+    // Read the latest sample of continuous measurement mode into
+    // latestSample.
+    // Set the error flag on error or on magnetic sensor overflow.
+    void getSample();
+
     // Return the attitude angle normalised from 0 degrees to 359
     // degrees.
     word normaliseAttitude(int attitude) const;
 
+    // Read the data status once.  Return true if the reading process
+    // finished; otherwise return false.
+    // Set the error flag on error.
+    boolean pollReading();
+
     // Read the geometry correction from persistent storage.
     void readGeometryCorrection();
 
@@ -142,6 +257,10 @@ class ESAT_MagnetometerClass
     // Set the error flag on error.
     void setBypassMode();
 
+    // Change the measurement mode, going through the power-down mode.
+    // Set the error flag on error.
+    void setMeasurementMode(byte mode);
+
     // Start a new reading of the magnetic attitude.
     // Set the error flag on error.
     void startReading();
@@ -150,6 +269,10 @@ class ESAT_MagnetometerClass
     // Set the error flag on error.
     void waitForReading();
 
+    // Fill the geometry correction table with the current geometry
+    // correction coefficients.
+    void updateGeometryCorrectionTable();
+
     // Write the geometry correction to persistent storage.
     void writeGeometryCorrection();
 };
@@ -22,29 +22,230 @@
 
 void ESAT_TachometerClass::begin()
 {
+  speed = 0;
+  stall = true;
+#ifdef ARDUINO_ESAT_ADCS
+  revolutions = 0;
+  previousRevolutions = 0;
+  overflowTicks = 0;
+  outlierFilterPrimed = false;
+  if (captureTimer.getHandle()->Instance == nullptr)
+  {
+    TIM_TypeDef* const instance =
+      (TIM_TypeDef*) pinmap_peripheral(digitalPinToPinName(PIN),
+                                       PinMap_TIM);
+    captureTimer.setup(instance);
+  }
+  const uint32_t function =
+    pinmap_function(digitalPinToPinName(PIN), PinMap_TIM);
+  captureChannel = STM_PIN_CHANNEL(function);
+  // The timer counts microseconds and the input filter rejects
+  // glitches shorter than a few microseconds.
+  captureTimer.setPrescaleFactor(captureTimer.getTimerClkFreq()
+                                 / TICKS_PER_SECOND);
+  captureTimer.setOverflow(0x10000);
+  captureTimer.setMode(captureChannel,
+                       TIMER_INPUT_CAPTURE_FALLING,
+                       PIN,
+                       FILTER_DTS32_N8);
+  // The capture prescaler of the timer channel divides the pulses by
+  // COUNTS_PER_REVOLUTION, so there is one capture per revolution.
+  __HAL_TIM_SET_ICPRESCALER(captureTimer.getHandle(),
+                            captureTimer.getChannel(captureChannel),
+                            TIM_ICPSC_DIV8);
+  captureTimer.attachInterrupt(overflowInterrupt);
+  captureTimer.attachInterrupt(captureChannel, captureInterrupt);
+  captureTimer.resume();
+  latestRevolutionTime = currentTime();
+  previousRevolutionTime = latestRevolutionTime;
+#endif /* ARDUINO_ESAT_ADCS */
+#ifdef ARDUINO_ESAT_OBC
   count = 0;
   previousCount = 0;
-  previousReadingTime = 0;
+  previousReadingTime = millis();
+  previousPulseTime = previousReadingTime;
   pinMode(PIN, INPUT_PULLUP);
   attachInterrupt(PIN, incrementCounter, FALLING);
+#endif /* ARDUINO_ESAT_OBC */
 }
 
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_TachometerClass::captureInterrupt()
+{
+  // The timer overflow and capture interrupts are different, so the
+  // overflow interrupt may run first even if the capture came before
+  // the overflow.  The capture time is safer to reckon backwards from
+  // the current time.
+  const word captureTicks =
+    ESAT_Tachometer.captureTimer.getCaptureCompare(ESAT_Tachometer.captureChannel);
+  const unsigned long time =
+    ESAT_Tachometer.extendTime(ESAT_Tachometer.captureTimer.getCount());
+  const word ticksSinceCapture = word(time) - captureTicks;
+  ESAT_Tachometer.latestRevolutionTime = time - ticksSinceCapture;
+  ESAT_Tachometer.revolutions = ESAT_Tachometer.revolutions + 1;
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+unsigned long ESAT_TachometerClass::currentTime()
+{
+  // Retry if a timer overflow interrupt comes in the middle.
+  unsigned long time;
+  unsigned long overflows;
+  do
+  {
+    overflows = overflowTicks;
+    time = extendTime(captureTimer.getCount());
+  } while (overflows != overflowTicks);
+  return time;
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+unsigned long ESAT_TachometerClass::extendTime(const word ticks)
+{
+  // If the counter overflowed but the overflow interrupt didn't run
+  // yet, the timer ticks belong after the overflow if they are low
+  // and before the overflow if they are high.
+  const boolean pendingOverflow =
+    __HAL_TIM_GET_FLAG(captureTimer.getHandle(), TIM_FLAG_UPDATE);
+  if (pendingOverflow && (ticks < 0x8000))
+  {
+    return overflowTicks + 0x10000 + ticks;
+  }
+  else
+  {
+    return overflowTicks + ticks;
+  }
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+float ESAT_TachometerClass::filterOutliers(const float newSpeed)
+{
+  if (!outlierFilterPrimed)
+  {
+    recentSpeeds[0] = newSpeed;
+    recentSpeeds[1] = newSpeed;
+    outlierFilterPrimed = true;
+  }
+  else
+  {
+    recentSpeeds[0] = recentSpeeds[1];
+    recentSpeeds[1] = recentSpeeds[2];
+  }
+  recentSpeeds[2] = newSpeed;
+  const float a = recentSpeeds[0];
+  const float b = recentSpeeds[1];
+  const float c = recentSpeeds[2];
+  return max(min(a, b), min(max(a, b), c));
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_OBC
 void ESAT_TachometerClass::incrementCounter()
 {
   ESAT_Tachometer.count = ESAT_Tachometer.count + 1;
 }
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_TachometerClass::overflowInterrupt()
+{
+  ESAT_Tachometer.overflowTicks = ESAT_Tachometer.overflowTicks + 0x10000;
+}
+#endif /* ARDUINO_ESAT_ADCS */
 
 unsigned int ESAT_TachometerClass::read()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  readFromRevolutionTimes();
+#endif /* ARDUINO_ESAT_ADCS */
+#ifdef ARDUINO_ESAT_OBC
+  readFromCount();
+#endif /* ARDUINO_ESAT_OBC */
+  return (unsigned int) (speed + 0.5f);
+}
+
+#ifdef ARDUINO_ESAT_OBC
+void ESAT_TachometerClass::readFromCount()
 {
   const unsigned long currentTime = millis();
   const unsigned long ellapsedMilliseconds = currentTime - previousReadingTime;
-  previousReadingTime = currentTime;
+  if (ellapsedMilliseconds == 0)
+  {
+    return;
+  }
+  // Read the pulse count just once, as it may change at any time.
+  const unsigned int currentCount = count;
   const unsigned long millisecondsPerMinute = 60000;
-  const unsigned int reading =
-    (long(millisecondsPerMinute / COUNTS_PER_REVOLUTION)
-     * long(count - previousCount)) / ellapsedMilliseconds;
-  previousCount = count;
-  return reading;
+  speed =
+    (float(millisecondsPerMinute / COUNTS_PER_REVOLUTION)
+     * float(currentCount - previousCount)) / ellapsedMilliseconds;
+  if (currentCount != previousCount)
+  {
+    previousPulseTime = currentTime;
+    stall = false;
+  }
+  else if ((currentTime - previousPulseTime) >= (STALL_TIMEOUT / 1000))
+  {
+    stall = true;
+  }
+  previousCount = currentCount;
+  previousReadingTime = currentTime;
+}
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_TachometerClass::readFromRevolutionTimes()
+{
+  // Retry if a capture interrupt comes in the middle.
+  unsigned long currentRevolutions;
+  unsigned long revolutionTime;
+  do
+  {
+    currentRevolutions = revolutions;
+    revolutionTime = latestRevolutionTime;
+  } while (currentRevolutions != revolutions);
+  const unsigned long newRevolutions = currentRevolutions - previousRevolutions;
+  const unsigned long elapsedTicks = revolutionTime - previousRevolutionTime;
+  previousRevolutions = currentRevolutions;
+  previousRevolutionTime = revolutionTime;
+  if ((newRevolutions > 0) && stall)
+  {
+    // The first revolution after a stall just starts the timing.
+    stall = false;
+    return;
+  }
+  if ((newRevolutions > 0) && (elapsedTicks > 0))
+  {
+    // Reciprocal counting: the time of one revolution at low speeds
+    // and the average time of many revolutions at high speeds.
+    speed = filterOutliers(newRevolutions
+                           * MICROSECONDS_PER_MINUTE
+                           / elapsedTicks);
+    return;
+  }
+  const unsigned long ticksSinceRevolution = currentTime() - revolutionTime;
+  if (stall || (ticksSinceRevolution >= STALL_TIMEOUT))
+  {
+    speed = 0;
+    stall = true;
+    outlierFilterPrimed = false;
+    return;
+  }
+  // Between revolutions, the current revolution takes at least the
+  // time since the latest one.
+  if (ticksSinceRevolution > 0)
+  {
+    speed = min(speed, MICROSECONDS_PER_MINUTE / ticksSinceRevolution);
+  }
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+boolean ESAT_TachometerClass::stalled() const
+{
+  return stall;
 }
 
 ESAT_TachometerClass ESAT_Tachometer;
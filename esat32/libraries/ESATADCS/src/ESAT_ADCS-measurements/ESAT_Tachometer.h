@@ -30,6 +30,19 @@
 // sends a pulse every time a mark passes above it so that
 // the tachometer library can count these pulses to estimate
 // the wheel speed.
+//
+// On the ADCS board, a timer captures the time of every full
+// revolution (every COUNTS_PER_REVOLUTION pulses) in hardware, with a
+// glitch filter on the input, so there is just one interrupt per
+// revolution.  The speed is the number of revolutions since the
+// previous reading over the time they took: the period of a single
+// revolution at low speeds and an average over many revolutions at
+// high speeds.  On the OBC board, the tachometer library counts the
+// pulses in an interrupt and divides the count by the time since
+// the previous reading.
+//
+// The tachometer has a single channel, so it can't tell the
+// direction of rotation, but it tells when the wheel is stalled.
 class ESAT_TachometerClass
 {
   public:
@@ -37,19 +50,37 @@ class ESAT_TachometerClass
     void begin();
 
     // Read the speed of the rotating wheel (in revolutions per minute).
-    // This works by counting the number of tachometer pulses since
-    // the latest call to read(), so calling read() too often will
-    // lower the accuracty of the measurement.
+    // On the ADCS board, this is the median of the three latest
+    // measurements, to filter out outliers, and it can be called as
+    // often as needed: between revolutions, it decays as the time
+    // since the latest revolution grows.  On the OBC board, this
+    // works by counting the number of tachometer pulses since the
+    // latest call to read(), so calling read() too often will lower
+    // the accuracy of the measurement.
     unsigned int read();
 
+    // Return true if the wheel was stalled (no tachometer pulses for
+    // STALL_TIMEOUT microseconds) at the latest call to read();
+    // otherwise return false.
+    boolean stalled() const;
+
   private:
     // The rotating wheel has several marks, so the tachometer gives
     // as many counts per revolution.
     static const unsigned int COUNTS_PER_REVOLUTION = 8;
 
+    // Consider the wheel stalled after this time (in microseconds)
+    // without tachometer pulses: about 7 revolutions per minute.
+    static const unsigned long STALL_TIMEOUT = 1000000;
+
+    // Microseconds per minute, for turning periods into speeds.
+    static constexpr float MICROSECONDS_PER_MINUTE = 60000000;
+
 #ifdef ARDUINO_ESAT_ADCS
     // The output signal of the tachometer goes to this pin.
-    static const unsigned int PIN = TCH_A;
+    // The alternative function of the pin is a channel of a timer
+    // not used by the magnetorquers.
+    static const unsigned int PIN = TCH_A | ALT1;
 #endif /* ARDUINO_ESAT_ADCS */
 
 #ifdef ARDUINO_ESAT_OBC
@@ -57,17 +88,128 @@ class ESAT_TachometerClass
     static const unsigned int PIN = TCH;
 #endif /* ARDUINO_ESAT_OBC */
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Timer ticks per second: one tick per microsecond.
+    static const unsigned long TICKS_PER_SECOND = 1000000;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Timer channel of the tachometer pin.
+    uint32_t captureChannel;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Timer that captures the revolution times.
+    HardwareTimer captureTimer;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_OBC
     // Number of tachometer pulses since the latest measurement.
     volatile unsigned int count;
+#endif /* ARDUINO_ESAT_OBC */
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Time (in timer ticks) of the latest revolution.
+    volatile unsigned long latestRevolutionTime;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // True if the outlier filter has measurements; false otherwise.
+    boolean outlierFilterPrimed;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Timer ticks before the latest timer overflow: the high half of
+    // the revolution times.
+    volatile unsigned long overflowTicks;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_OBC
     // Number of tachometer pulses at the previous measurement.
     unsigned int previousCount;
+#endif /* ARDUINO_ESAT_OBC */
 
+#ifdef ARDUINO_ESAT_OBC
+    // Processor uptime in milliseconds at the latest tachometer pulse
+    // seen by read().
+    unsigned long previousPulseTime;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_OBC
     // Processor uptime in milliseconds at the previous measurement.
     unsigned long previousReadingTime;
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Number of revolutions at the previous measurement.
+    unsigned long previousRevolutions;
+#endif /* ARDUINO_ESAT_ADCS */
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Time (in timer ticks) of the latest revolution at the previous
+    // measurement.
+    unsigned long previousRevolutionTime;
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Latest measurements (in revolutions per minute), for the
+    // outlier filter.
+    float recentSpeeds[3];
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Number of revolutions since begin().
+    volatile unsigned long revolutions;
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // Latest speed reading (in revolutions per minute).
+    float speed;
+
+    // True if the wheel was stalled at the latest measurement; false
+    // otherwise.
+    boolean stall;
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Record the time of a new revolution.
+    static void captureInterrupt();
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Return the current time in timer ticks.
+    unsigned long currentTime();
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Return the time in timer ticks of a 16-bit timer counter value
+    // taken just now, extended with the timer overflows.
+    unsigned long extendTime(word ticks);
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Return the median of the latest three measurements after adding
+    // a new one.
+    float filterOutliers(float newSpeed);
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_OBC
     // Increment the counter of the tachometer.
     static void incrementCounter();
+#endif /* ARDUINO_ESAT_OBC */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Count a timer overflow.
+    static void overflowInterrupt();
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Measure the speed from the revolution times.
+    void readFromRevolutionTimes();
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_OBC
+    // Measure the speed from the pulse count.
+    void readFromCount();
+#endif /* ARDUINO_ESAT_OBC */
 };
 
 // Global instance of the tachometer library.
@@ -36,8 +36,8 @@ void ESAT_WheelResetElectronicSpeedControllerRunModeClass::run()
     // Poll for wheel to be stopped.
     if (ESAT_Tachometer.read() < wheelStoppedSpeedThreshold)
     {
-      // Only resets if the wheel is stopped.
-      delay(100);
+      // Only resets if the wheel is stopped.  The calibration
+      // sequence goes on in the background.
       ESAT_Wheel.resetElectronicSpeedController();
       pendingReset = false;
     }
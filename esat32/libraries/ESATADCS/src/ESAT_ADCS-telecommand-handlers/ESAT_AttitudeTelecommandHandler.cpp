@@ -76,6 +76,10 @@ boolean ESAT_AttitudeTelecommandHandlerClass::handleTelecommand(ESAT_CCSDSPacket
       handleAttitudeControllerSetDetumblingThresholdTelecommand(telecommand);
       return true;
       break;
+    case ATTITUDE_CONTROLLER_SET_MAGNETORQUER_FULL_SCALE_ACTUATION:
+      handleAttitudeControllerSetMagnetorquerFullScaleActuationTelecommand(telecommand);
+      return true;
+      break;
     default:
       return false;
       break;
@@ -154,4 +158,10 @@ void ESAT_AttitudeTelecommandHandlerClass::handleAttitudeControllerSetDetumbling
   ESAT_AttitudePIDController.detumblingThreshold = telecommand.readWord();
 }
 
+void ESAT_AttitudeTelecommandHandlerClass::handleAttitudeControllerSetMagnetorquerFullScaleActuationTelecommand(ESAT_CCSDSPacket telecommand)
+{
+  ESAT_AttitudePIDController.magnetorquerFullScaleActuation =
+    telecommand.readFloat();
+}
+
 ESAT_AttitudeTelecommandHandlerClass ESAT_AttitudeTelecommandHandler;
@@ -48,6 +48,7 @@ class ESAT_AttitudeTelecommandHandlerClass: public ESAT_ADCSTelecommandHandler
       ATTITUDE_CONTROLLER_SET_ACTUATORS = 0x15,
       ATTITUDE_CONTROLLER_SET_DEADBAND = 0x16,
       ATTITUDE_CONTROLLER_SET_DETUMBLING_THRESHOLD = 0x17,
+      ATTITUDE_CONTROLLER_SET_MAGNETORQUER_FULL_SCALE_ACTUATION = 0x18,
     };
 
     // Handle the telecommand for following a target magnetic angle.
@@ -117,6 +118,13 @@ class ESAT_AttitudeTelecommandHandlerClass: public ESAT_ADCSTelecommandHandler
     // The telecommand has one 16-bit unsigned integer parameter:
     // the error derivative detumbling threshold.
     void handleAttitudeControllerSetDetumblingThresholdTelecommand(ESAT_CCSDSPacket telecommand);
+
+    // Handle the telecommand for setting the magnetorquer full-scale
+    // actuation of the attitude controller.
+    // The telecommand has one 32-bit floating-point parameter:
+    // the magnetorquer full-scale actuation, which is 0 for always
+    // applying the maximum torque.
+    void handleAttitudeControllerSetMagnetorquerFullScaleActuationTelecommand(ESAT_CCSDSPacket telecommand);
 };
 
 // Global instance of the attitude control telecommand handler library.
@@ -20,6 +20,7 @@
 
 #include "ESAT_ADCS-telecommand-handlers/ESAT_WheelTelecommandHandler.h"
 #include "ESAT_ADCS.h"
+#include "ESAT_ADCS-actuators/ESAT_Wheel.h"
 #include "ESAT_ADCS-controllers/ESAT_WheelPIDController.h"
 #include "ESAT_ADCS-run-modes/ESAT_WheelResetElectronicSpeedControllerRunMode.h"
 #include "ESAT_ADCS-run-modes/ESAT_WheelSetDutyCycleRunMode.h"
@@ -68,12 +69,24 @@ boolean ESAT_WheelTelecommandHandlerClass::handleTelecommand(ESAT_CCSDSPacket te
 
 void ESAT_WheelTelecommandHandlerClass::handleWheelSetDutyCycleTelecommand(ESAT_CCSDSPacket telecommand)
 {
+  // Wheel commands are forbidden during the calibration sequence of
+  // the electronic speed controller.
+  if (ESAT_Wheel.calibrating())
+  {
+    return;
+  }
   ESAT_ADCS.setRunMode(ESAT_WheelSetDutyCycleRunMode);
   ESAT_WheelSetDutyCycleRunMode.dutyCycle = telecommand.readFloat();
 }
 
 void ESAT_WheelTelecommandHandlerClass::handleWheelSetSpeedTelecommand(ESAT_CCSDSPacket telecommand)
 {
+  // Wheel commands are forbidden during the calibration sequence of
+  // the electronic speed controller.
+  if (ESAT_Wheel.calibrating())
+  {
+    return;
+  }
   ESAT_ADCS.setRunMode(ESAT_WheelSetSpeedRunMode);
   ESAT_WheelSetSpeedRunMode.targetSpeed = telecommand.readWord();
 }
@@ -103,6 +116,12 @@ void ESAT_WheelTelecommandHandlerClass::handleWheelControllerResetErrorIntegralT
 void ESAT_WheelTelecommandHandlerClass::handleWheelResetElectronicSpeedControllerTelecommand(ESAT_CCSDSPacket telecommand)
 {
   (void) telecommand;
+  // Wheel commands are forbidden during the calibration sequence of
+  // the electronic speed controller.
+  if (ESAT_Wheel.calibrating())
+  {
+    return;
+  }
   ESAT_WheelResetElectronicSpeedControllerRunMode.pendingReset = true;
   ESAT_ADCS.setRunMode(ESAT_WheelResetElectronicSpeedControllerRunMode);
 }
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_ADCS-telemetry-packets/ESAT_ADCSControlLoopTelemetryPacket.h"
+#include "ESAT_ADCS.h"
+
+byte ESAT_ADCSControlLoopTelemetryPacketClass::packetIdentifier()
+{
+  return PACKET_IDENTIFIER;
+}
+
+void ESAT_ADCSControlLoopTelemetryPacketClass::readUserData(ESAT_CCSDSPacket& packet)
+{
+  const ESAT_ADCSClass::ControlLoopStatistics statistics =
+    ESAT_ADCS.controlLoopStatistics();
+  packet.writeWord(statistics.frequency);
+  packet.writeWord(statistics.iterations);
+  packet.writeWord(statistics.overruns);
+  packet.writeUnsignedLong(statistics.minimumPeriod);
+  packet.writeUnsignedLong(statistics.meanPeriod);
+  packet.writeUnsignedLong(statistics.maximumPeriod);
+  packet.writeUnsignedLong(statistics.maximumJitter);
+  packet.writeUnsignedLong(statistics.maximumExecutionTime);
+}
+
+ESAT_ADCSControlLoopTelemetryPacketClass ESAT_ADCSControlLoopTelemetryPacket;
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT ADCS library.
+ *
+ * Theia Space's ESAT ADCS library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT ADCS library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT ADCS library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_ADCSControlLoopTelemetryPacket_h
+#define ESAT_ADCSControlLoopTelemetryPacket_h
+
+#include <Arduino.h>
+#include <ESAT_CCSDSPacket.h>
+#include "ESAT_ADCS-telemetry-packets/ESAT_ADCSTelemetryPacket.h"
+
+// ADCS control loop diagnostics telemetry.
+// Use the public instance ESAT_ADCSControlLoopTelemetryPacket.
+//
+// ESAT_ADCS.update() adds this packet while the timer control loop
+// runs (see ESAT_ADCS.enableTimerControlLoop()).
+//
+// This packet has the timing statistics of the timer control loop
+// over the latest ADCS update cycle:
+// * Nominal frequency.
+// * Number of iterations.
+// * Number of overruns.
+// * Minimum, mean and maximum period.
+// * Maximum jitter.
+// * Maximum execution time.
+class ESAT_ADCSControlLoopTelemetryPacketClass: public ESAT_ADCSTelemetryPacket
+{
+  public:
+    // Return the ADCS control loop telemetry packet identifier.
+    byte packetIdentifier();
+
+    // Fill a packet with ADCS control loop telemetry.
+    void readUserData(ESAT_CCSDSPacket& packet);
+
+  private:
+    // Packet identifier of ADCS control loop telemetry.
+    static const byte PACKET_IDENTIFIER = 0x01;
+};
+
+// Public instance of the ADCS control loop telemetry packet library.
+extern ESAT_ADCSControlLoopTelemetryPacketClass ESAT_ADCSControlLoopTelemetryPacket;
+
+#endif /* ESAT_ADCSControlLoopTelemetryPacket_h */
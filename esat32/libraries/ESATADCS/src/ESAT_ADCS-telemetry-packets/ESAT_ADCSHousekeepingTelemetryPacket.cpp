@@ -64,6 +64,8 @@ void ESAT_ADCSHousekeepingTelemetryPacketClass::readUserData(ESAT_CCSDSPacket& p
   packet.writeByte(byte(ESAT_Magnetorquer.readY()));
   packet.writeBoolean(ESAT_Gyroscope.error);
   packet.writeBoolean(ESAT_Magnetometer.error);
+  packet.writeBoolean(ESAT_Wheel.calibrating());
+  packet.writeBoolean(ESAT_Wheel.powerLineCommandFailed());
 }
 
 ESAT_ADCSHousekeepingTelemetryPacketClass ESAT_ADCSHousekeepingTelemetryPacket;
@@ -38,9 +38,21 @@
 #include "ESAT_ADCS-telecommand-handlers/ESAT_MagnetorquerTelecommandHandler.h"
 #include "ESAT_ADCS-telecommand-handlers/ESAT_StopActuatorsTelecommandHandler.h"
 #include "ESAT_ADCS-telecommand-handlers/ESAT_WheelTelecommandHandler.h"
+#include "ESAT_ADCS-telemetry-packets/ESAT_ADCSControlLoopTelemetryPacket.h"
 #include "ESAT_ADCS-telemetry-packets/ESAT_ADCSHousekeepingTelemetryPacket.h"
 
 
+boolean ESAT_ADCSClass::acquireSensors()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  if (timerControlLoop)
+  {
+    return timerControlLoopUpdatePending;
+  }
+#endif /* ARDUINO_ESAT_ADCS */
+  return advanceSensorAcquisition();
+}
+
 void ESAT_ADCSClass::addHousekeepingTelemetryPacket()
 {
   addTelemetryPacket(ESAT_ADCSHousekeepingTelemetryPacket);
@@ -55,9 +67,73 @@ void ESAT_ADCSClass::addTelemetryPacket(ESAT_ADCSTelemetryPacket& newTelemetryPa
 #endif /* ARDUINO_ESAT_ADCS */
 }
 
+boolean ESAT_ADCSClass::advanceSensorAcquisition()
+{
+  // Each call does at most one short step of the sensor acquisition
+  // and never waits, so the main loop keeps answering the I2C bus
+  // while the magnetorquer field settles and the magnetometer
+  // measures.
+  switch (sensorAcquisitionState)
+  {
+    case SENSOR_ACQUISITION_SETTLING:
+      if ((micros() - sensorAcquisitionStageStartTime)
+          >= magnetorquerSettleTime)
+      {
+        ESAT_Magnetometer.beginReading();
+        sensorAcquisitionStageStartTime = micros();
+        sensorAcquisitionState = SENSOR_ACQUISITION_CONVERTING;
+      }
+      return false;
+      break;
+    case SENSOR_ACQUISITION_CONVERTING:
+      finishSensorAcquisition();
+      if (sensorAcquisitionState == SENSOR_ACQUISITION_READY)
+      {
+        return true;
+      }
+      else
+      {
+        return false;
+      }
+      break;
+    case SENSOR_ACQUISITION_READY:
+      return true;
+      break;
+    default:
+      return false;
+      break;
+  }
+  return false;
+}
+
 ESAT_AttitudeStateVector ESAT_ADCSClass::attitudeStateVector()
 {
-  return currentAttitudeStateVector;
+#ifdef ARDUINO_ESAT_ADCS
+  // Outside the control loop, read the latest published attitude
+  // state vector without stopping the control loop: try again if the
+  // control loop published twice in the middle of the copy.
+  if (timerControlLoop && !insideControlLoop)
+  {
+    word sequence;
+    ESAT_AttitudeStateVector snapshot;
+    do
+    {
+      sequence = publishedAttitudeStateVectorSequence;
+      __DMB();
+      snapshot = publishedAttitudeStateVectors[sequence % 2];
+      __DMB();
+    } while (sequence != publishedAttitudeStateVectorSequence);
+    return snapshot;
+  }
+#endif /* ARDUINO_ESAT_ADCS */
+  if (attitudeEstimation)
+  {
+    return estimatedAttitudeStateVector;
+  }
+  else
+  {
+    return currentAttitudeStateVector;
+  }
 }
 
 void ESAT_ADCSClass::begin()
@@ -65,6 +141,18 @@ void ESAT_ADCSClass::begin()
   currentUpdateTime = millis();
   previousUpdateTime = currentUpdateTime;
   telemetryPacketSequenceCount = 0;
+  pipelinedSensorAcquisition = false;
+  magnetorquerSettleTime = MAGNETORQUER_SETTLE_TIME;
+  sensorAcquisitionState = SENSOR_ACQUISITION_IDLE;
+  attitudeEstimation = false;
+  freshMagneticAngle = false;
+#ifdef ARDUINO_ESAT_ADCS
+  timerControlLoop = false;
+  timerControlLoopUpdatePending = false;
+  insideControlLoop = false;
+  controlLoopHoldOffs = 0;
+  publishedAttitudeStateVectorSequence = 0;
+#endif /* ARDUINO_ESAT_ADCS */
   ESAT_AttitudePIDController.begin();
   ESAT_Wheel.begin();
   ESAT_WheelPIDController.begin();
@@ -92,9 +180,44 @@ void ESAT_ADCSClass::begin()
                       MAXIMUM_TELECOMMAND_PACKET_DATA_LENGTH,
                       i2cTelemetryPacketData,
                       MAXIMUM_TELEMETRY_PACKET_DATA_LENGTH);
+  ESAT_I2CSlave.beginTelemetryStaging(STAGED_TELEMETRY_PACKETS,
+                                      MAXIMUM_TELEMETRY_PACKET_DATA_LENGTH);
+  i2cTelemetryQueueResetSequence = ESAT_I2CSlave.telemetryQueueResetSequence();
 #endif /* ARDUINO_ESAT_ADCS */
 }
 
+void ESAT_ADCSClass::beginMagneticFieldAcquisition()
+{
+  // The magnetorquer field settles in the background.  There is
+  // nothing to wait for when the magnetorquers are already off.  The
+  // magnetorquer outputs stay blanked until the end of the
+  // measurement, so the control loop may change the magnetorquer
+  // actuation in the meantime without turning the magnetorquers on.
+  const boolean magnetorquerDriverEnabled = ESAT_Magnetorquer.readEnable();
+  ESAT_Magnetorquer.writeBlanking(true);
+  ESAT_Magnetometer.error = false;
+  if (magnetorquerDriverEnabled)
+  {
+    sensorAcquisitionState = SENSOR_ACQUISITION_SETTLING;
+  }
+  else
+  {
+    ESAT_Magnetometer.beginReading();
+    sensorAcquisitionState = SENSOR_ACQUISITION_CONVERTING;
+  }
+  sensorAcquisitionStageStartTime = micros();
+}
+
+void ESAT_ADCSClass::cancelSensorAcquisition()
+{
+  if ((sensorAcquisitionState == SENSOR_ACQUISITION_SETTLING)
+      || (sensorAcquisitionState == SENSOR_ACQUISITION_CONVERTING))
+  {
+    ESAT_Magnetorquer.writeBlanking(false);
+  }
+  sensorAcquisitionState = SENSOR_ACQUISITION_IDLE;
+}
+
 void ESAT_ADCSClass::clearTelemetryPacketList()
 {
   telemetryPacket = nullptr;
@@ -103,6 +226,58 @@ void ESAT_ADCSClass::clearTelemetryPacketList()
 #endif /* ARDUINO_ESAT_ADCS */
 }
 
+ESAT_ADCSClass::ControlLoopStatistics ESAT_ADCSClass::controlLoopStatistics()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  if (timerControlLoop)
+  {
+    return latestControlLoopStatistics;
+  }
+#endif /* ARDUINO_ESAT_ADCS */
+  const ControlLoopStatistics statistics = {0, 0, 0, 0, 0, 0, 0, 0};
+  return statistics;
+}
+
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_ADCSClass::controlLoopInterrupt()
+{
+  ESAT_ADCS.iterateControlLoop();
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+void ESAT_ADCSClass::disableAttitudeEstimation()
+{
+  holdOffControlLoop();
+  attitudeEstimation = false;
+  letControlLoopRun();
+}
+
+void ESAT_ADCSClass::disablePipelinedSensorAcquisition()
+{
+  holdOffControlLoop();
+  cancelSensorAcquisition();
+  pipelinedSensorAcquisition = false;
+  letControlLoopRun();
+}
+
+void ESAT_ADCSClass::disableTimerControlLoop()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  if (!timerControlLoop)
+  {
+    return;
+  }
+  controlLoopTimer.pause();
+  controlLoopTimer.detachInterrupt();
+  timerControlLoop = false;
+  controlLoopHoldOffs = 0;
+  timerControlLoopUpdatePending = false;
+  cancelSensorAcquisition();
+  currentUpdateTime = millis();
+  previousUpdateTime = currentUpdateTime;
+#endif /* ARDUINO_ESAT_ADCS */
+}
+
 void ESAT_ADCSClass::disableUSBTelecommands()
 {
   usbReader = ESAT_CCSDSPacketFromKISSFrameReader();
@@ -113,6 +288,73 @@ void ESAT_ADCSClass::disableUSBTelemetry()
   usbWriter = ESAT_CCSDSPacketToKISSFrameWriter();
 }
 
+void ESAT_ADCSClass::enableAttitudeEstimation()
+{
+  holdOffControlLoop();
+  magneticAttitudeEstimator.begin(MAGNETIC_ANGLE_NOISE,
+                                  ROTATIONAL_SPEED_NOISE,
+                                  ANGULAR_ACCELERATION_NOISE);
+  solarAttitudeEstimator.begin(SUN_ANGLE_NOISE,
+                               ROTATIONAL_SPEED_NOISE,
+                               ANGULAR_ACCELERATION_NOISE);
+  estimatedAttitudeStateVector = currentAttitudeStateVector;
+  attitudeEstimation = true;
+  letControlLoopRun();
+}
+
+void ESAT_ADCSClass::enablePipelinedSensorAcquisition(const unsigned long settleTime)
+{
+  holdOffControlLoop();
+  magnetorquerSettleTime = settleTime;
+  pipelinedSensorAcquisition = true;
+  letControlLoopRun();
+}
+
+void ESAT_ADCSClass::enableTimerControlLoop(const word frequency,
+                                           const word divider)
+{
+#ifdef ARDUINO_ESAT_ADCS
+  if ((frequency == 0) || (divider == 0))
+  {
+    return;
+  }
+  disableTimerControlLoop();
+  cancelSensorAcquisition();
+  controlLoopNominalPeriod = 1000000UL / frequency;
+  controlLoopPeriod = controlLoopNominalPeriod;
+  magnetometerDivider = divider;
+  controlLoopIterationsToMagnetometer = 0;
+  accumulatedControlLoopPeriod = 0;
+  accumulatedControlLoopStatistics.frequency = frequency;
+  accumulatedControlLoopStatistics.iterations = 0;
+  accumulatedControlLoopStatistics.overruns = 0;
+  accumulatedControlLoopStatistics.minimumPeriod = 0xFFFFFFFF;
+  accumulatedControlLoopStatistics.meanPeriod = 0;
+  accumulatedControlLoopStatistics.maximumPeriod = 0;
+  accumulatedControlLoopStatistics.maximumJitter = 0;
+  accumulatedControlLoopStatistics.maximumExecutionTime = 0;
+  latestControlLoopStatistics = accumulatedControlLoopStatistics;
+  publishAttitudeStateVector();
+  // The timer of the tone() function is free on the ADCS.  The timer
+  // interrupts have the lowest priority of the core, so the I2C bus,
+  // the USB interface and the system tick keep running during the
+  // control loop iterations.
+  if (controlLoopTimer.getHandle()->Instance == nullptr)
+  {
+    controlLoopTimer.setup(TIMER_TONE);
+  }
+  controlLoopTimer.setOverflow(frequency, HERTZ_FORMAT);
+  controlLoopTimer.attachInterrupt(controlLoopInterrupt);
+  controlLoopIterationStartTime = micros();
+  controlLoopHoldOffs = 0;
+  timerControlLoop = true;
+  controlLoopTimer.resume();
+#else
+  (void) frequency;
+  (void) divider;
+#endif /* ARDUINO_ESAT_ADCS */
+}
+
 void ESAT_ADCSClass::enableUSBTelecommands(byte buffer[],
                                            const unsigned long bufferLength)
 {
@@ -126,9 +368,44 @@ void ESAT_ADCSClass::enableUSBTelemetry()
   usbWriter = ESAT_CCSDSPacketToKISSFrameWriter(Serial);
 }
 
+void ESAT_ADCSClass::estimateAttitude()
+{
+  // Each attitude sensor has its own reference direction, so there
+  // is one estimator for the magnetic angle and another one for the
+  // solar angle.  Both use the gyroscope readings; the rotational
+  // speed estimate comes from the magnetic one, as the magnetometer
+  // is more precise than the coarse sun sensor.
+  const float estimationPeriod = period();
+  magneticAttitudeEstimator.predict(estimationPeriod);
+  solarAttitudeEstimator.predict(estimationPeriod);
+  if (!ESAT_Gyroscope.error)
+  {
+    const float rotationalSpeed = currentAttitudeStateVector.rotationalSpeed;
+    magneticAttitudeEstimator.updateRotationalSpeed(rotationalSpeed);
+    solarAttitudeEstimator.updateRotationalSpeed(rotationalSpeed);
+  }
+  if (freshMagneticAngle && !ESAT_Magnetometer.error)
+  {
+    magneticAttitudeEstimator.updateAngle(currentAttitudeStateVector.magneticAngle);
+  }
+  freshMagneticAngle = false;
+  solarAttitudeEstimator.updateAngle(currentAttitudeStateVector.sunAngle);
+  estimatedAttitudeStateVector = currentAttitudeStateVector;
+  estimatedAttitudeStateVector.magneticAngle =
+    word(round(magneticAttitudeEstimator.angle())) % 360;
+  estimatedAttitudeStateVector.rotationalSpeed =
+    round(magneticAttitudeEstimator.rotationalSpeed());
+  estimatedAttitudeStateVector.sunAngle =
+    word(round(solarAttitudeEstimator.angle())) % 360;
+}
+
 boolean ESAT_ADCSClass::fillTelemetryPacket(ESAT_CCSDSPacket& packet,
                                             ESAT_ADCSTelemetryPacket& contents)
 {
+  // Some telemetry packets read the same peripherals as the control
+  // loop (like the analog-to-digital converter of the coarse sun
+  // sensor).
+  holdOffControlLoop();
   packet.writeTelemetryHeaders(getApplicationProcessIdentifier(),
                                telemetryPacketSequenceCount,
                                clock.read(),
@@ -137,6 +414,7 @@ boolean ESAT_ADCSClass::fillTelemetryPacket(ESAT_CCSDSPacket& packet,
                                PATCH_VERSION_NUMBER,
                                contents.packetIdentifier());
   contents.readUserData(packet);
+  letControlLoopRun();
   if (packet.triedToWriteBeyondCapacity())
   {
     return false;
@@ -162,6 +440,26 @@ ESAT_ADCSTelemetryPacket* ESAT_ADCSClass::findTelemetryPacket(const byte identif
   return nullptr;
 }
 
+void ESAT_ADCSClass::finishSensorAcquisition()
+{
+  const boolean ready = ESAT_Magnetometer.readingReady();
+  const boolean timedOut =
+    (micros() - sensorAcquisitionStageStartTime)
+    >= MAGNETOMETER_MEASUREMENT_TIMEOUT;
+  if (!(ready || ESAT_Magnetometer.error || timedOut))
+  {
+    return;
+  }
+  if (!ready)
+  {
+    ESAT_Magnetometer.error = true;
+  }
+  currentAttitudeStateVector.magneticAngle = ESAT_Magnetometer.endReading();
+  freshMagneticAngle = true;
+  ESAT_Magnetorquer.writeBlanking(false);
+  sensorAcquisitionState = SENSOR_ACQUISITION_READY;
+}
+
 word ESAT_ADCSClass::getApplicationProcessIdentifier()
 {
   return APPLICATION_PROCESS_IDENTIFIER;
@@ -184,6 +482,8 @@ void ESAT_ADCSClass::handleTelecommand(ESAT_CCSDSPacket& packet)
   {
     return;
   }
+  // Telecommands change the configuration used by the control loop.
+  holdOffControlLoop();
   for (ESAT_ADCSTelecommandHandler* handler = telecommandHandler;
        handler != nullptr;
        handler = handler->nextTelecommandHandler)
@@ -191,27 +491,166 @@ void ESAT_ADCSClass::handleTelecommand(ESAT_CCSDSPacket& packet)
     const boolean handled = handler->handleTelecommand(packet);
     if (handled)
     {
-      return;
+      break;
     }
   }
+  letControlLoopRun();
+}
+
+void ESAT_ADCSClass::holdOffControlLoop()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  // An update event happening in the meantime leaves its interrupt
+  // pending, so the iteration is delayed, not lost.  Hold-offs nest
+  // (for example, a telecommand handler may enable the attitude
+  // estimation), so only the outermost one touches the interrupt.
+  // The control loop itself needs no hold-off.
+  if (!timerControlLoop || insideControlLoop)
+  {
+    return;
+  }
+  if (controlLoopHoldOffs == 0)
+  {
+    __HAL_TIM_DISABLE_IT(controlLoopTimer.getHandle(), TIM_IT_UPDATE);
+  }
+  controlLoopHoldOffs = controlLoopHoldOffs + 1;
+#endif /* ARDUINO_ESAT_ADCS */
+}
+
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_ADCSClass::iterateControlLoop()
+{
+  const unsigned long startTime = micros();
+  controlLoopPeriod = startTime - controlLoopIterationStartTime;
+  controlLoopIterationStartTime = startTime;
+  insideControlLoop = true;
+  // The magnetometer, which is slow and needs the magnetorquers off,
+  // is read once every magnetometerDivider iterations, carrying the
+  // measurement over several iterations.  The tachometer times the
+  // wheel revolutions in hardware, so it is read on every iteration.
+  if (controlLoopIterationsToMagnetometer > 0)
+  {
+    controlLoopIterationsToMagnetometer =
+      controlLoopIterationsToMagnetometer - 1;
+  }
+  if ((controlLoopIterationsToMagnetometer == 0)
+      && (sensorAcquisitionState == SENSOR_ACQUISITION_IDLE))
+  {
+    beginMagneticFieldAcquisition();
+    controlLoopIterationsToMagnetometer = magnetometerDivider;
+  }
+  if (advanceSensorAcquisition())
+  {
+    sensorAcquisitionState = SENSOR_ACQUISITION_IDLE;
+  }
+  currentAttitudeStateVector.wheelSpeed = ESAT_Tachometer.read();
+  ESAT_Gyroscope.error = false;
+  currentAttitudeStateVector.rotationalSpeed = ESAT_Gyroscope.read(3);
+  currentAttitudeStateVector.sunAngle = ESAT_CoarseSunSensor.readSunAngle();
+  if (attitudeEstimation)
+  {
+    estimateAttitude();
+  }
+  run();
+  publishAttitudeStateVector();
+  insideControlLoop = false;
+  const unsigned long executionTime = micros() - startTime;
+  ControlLoopStatistics& statistics = accumulatedControlLoopStatistics;
+  if (statistics.iterations < 0xFFFF)
+  {
+    statistics.iterations = statistics.iterations + 1;
+    accumulatedControlLoopPeriod =
+      accumulatedControlLoopPeriod + controlLoopPeriod;
+  }
+  if ((executionTime >= controlLoopNominalPeriod)
+      && (statistics.overruns < 0xFFFF))
+  {
+    statistics.overruns = statistics.overruns + 1;
+  }
+  if (controlLoopPeriod < statistics.minimumPeriod)
+  {
+    statistics.minimumPeriod = controlLoopPeriod;
+  }
+  if (controlLoopPeriod > statistics.maximumPeriod)
+  {
+    statistics.maximumPeriod = controlLoopPeriod;
+  }
+  unsigned long jitter;
+  if (controlLoopPeriod > controlLoopNominalPeriod)
+  {
+    jitter = controlLoopPeriod - controlLoopNominalPeriod;
+  }
+  else
+  {
+    jitter = controlLoopNominalPeriod - controlLoopPeriod;
+  }
+  if (jitter > statistics.maximumJitter)
+  {
+    statistics.maximumJitter = jitter;
+  }
+  if (executionTime > statistics.maximumExecutionTime)
+  {
+    statistics.maximumExecutionTime = executionTime;
+  }
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+void ESAT_ADCSClass::letControlLoopRun()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  if (!timerControlLoop || insideControlLoop || (controlLoopHoldOffs == 0))
+  {
+    return;
+  }
+  controlLoopHoldOffs = controlLoopHoldOffs - 1;
+  if (controlLoopHoldOffs == 0)
+  {
+    __HAL_TIM_ENABLE_IT(controlLoopTimer.getHandle(), TIM_IT_UPDATE);
+  }
+#endif /* ARDUINO_ESAT_ADCS */
+}
+
+ESAT_AttitudeStateVector ESAT_ADCSClass::measuredAttitudeStateVector()
+{
+  // The control loop writes the readings field by field.
+  holdOffControlLoop();
+  const ESAT_AttitudeStateVector measurements = currentAttitudeStateVector;
+  letControlLoopRun();
+  return measurements;
 }
 
 float ESAT_ADCSClass::period()
 {
+#ifdef ARDUINO_ESAT_ADCS
+  if (timerControlLoop)
+  {
+    return controlLoopPeriod / 1000000.;
+  }
+#endif /* ARDUINO_ESAT_ADCS */
   return (currentUpdateTime - previousUpdateTime) / 1000.;
 }
 
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_ADCSClass::publishAttitudeStateVector()
+{
+  const word sequence = publishedAttitudeStateVectorSequence + 1;
+  publishedAttitudeStateVectors[sequence % 2] = attitudeStateVector();
+  __DMB();
+  publishedAttitudeStateVectorSequence = sequence;
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
 void ESAT_ADCSClass::readSensors()
 {
   currentAttitudeStateVector.wheelSpeed = ESAT_Tachometer.read();
-  const boolean enableMagnetorquerDriver = ESAT_Magnetorquer.readEnable();
-  ESAT_Magnetorquer.writeEnable(false);
+  ESAT_Magnetorquer.writeBlanking(true);
   delay(20);
   ESAT_Gyroscope.error = false;
   currentAttitudeStateVector.rotationalSpeed = ESAT_Gyroscope.read(3);
   ESAT_Magnetometer.error = false;
   currentAttitudeStateVector.magneticAngle = ESAT_Magnetometer.read();
-  ESAT_Magnetorquer.writeEnable(enableMagnetorquerDriver);
+  freshMagneticAngle = true;
+  ESAT_Magnetorquer.writeBlanking(false);
   currentAttitudeStateVector.sunAngle = ESAT_CoarseSunSensor.readSunAngle();
 }
 
@@ -272,6 +711,7 @@ void ESAT_ADCSClass::registerTelecommandHandler(ESAT_ADCSTelecommandHandler& new
 
 void ESAT_ADCSClass::run()
 {
+  ESAT_Wheel.update();
   runMode->run();
 }
 
@@ -282,7 +722,9 @@ byte ESAT_ADCSClass::runModeIdentifier()
 
 void ESAT_ADCSClass::setRunMode(ESAT_ADCSRunMode& newRunMode)
 {
+  holdOffControlLoop();
   runMode = &newRunMode;
+  letControlLoopRun();
 }
 
 void ESAT_ADCSClass::setTime(const ESAT_Timestamp timestamp)
@@ -290,6 +732,37 @@ void ESAT_ADCSClass::setTime(const ESAT_Timestamp timestamp)
   clock.write(timestamp);
 }
 
+void ESAT_ADCSClass::startSensorAcquisition()
+{
+#ifdef ARDUINO_ESAT_ADCS
+  // With the timer control loop, the control loop reads the sensors.
+  if (timerControlLoop)
+  {
+    timerControlLoopUpdatePending = true;
+    return;
+  }
+#endif /* ARDUINO_ESAT_ADCS */
+  if ((sensorAcquisitionState == SENSOR_ACQUISITION_SETTLING)
+      || (sensorAcquisitionState == SENSOR_ACQUISITION_CONVERTING))
+  {
+    return;
+  }
+  // With blocking sensor acquisition, update() reads the sensors
+  // itself.
+  if (!pipelinedSensorAcquisition)
+  {
+    sensorAcquisitionState = SENSOR_ACQUISITION_READY;
+    return;
+  }
+  // The magnetorquer field settles in the background while the
+  // sensors that don't mind the magnetorquers are read.
+  currentAttitudeStateVector.wheelSpeed = ESAT_Tachometer.read();
+  beginMagneticFieldAcquisition();
+  ESAT_Gyroscope.error = false;
+  currentAttitudeStateVector.rotationalSpeed = ESAT_Gyroscope.read(3);
+  currentAttitudeStateVector.sunAngle = ESAT_CoarseSunSensor.readSunAngle();
+}
+
 boolean ESAT_ADCSClass::telemetryAvailable()
 {
   if (telemetryPacket != nullptr)
@@ -305,8 +778,51 @@ boolean ESAT_ADCSClass::telemetryAvailable()
 void ESAT_ADCSClass::update()
 {
   clearTelemetryPacketList();
+#ifdef ARDUINO_ESAT_ADCS
+  // With the timer control loop, the control loop does the sensing
+  // and the control, so there is only the telemetry left.
+  if (timerControlLoop)
+  {
+    holdOffControlLoop();
+    ControlLoopStatistics& statistics = accumulatedControlLoopStatistics;
+    if (statistics.iterations > 0)
+    {
+      statistics.meanPeriod =
+        accumulatedControlLoopPeriod / statistics.iterations;
+    }
+    else
+    {
+      statistics.minimumPeriod = 0;
+    }
+    latestControlLoopStatistics = statistics;
+    statistics.iterations = 0;
+    statistics.overruns = 0;
+    statistics.minimumPeriod = 0xFFFFFFFF;
+    statistics.meanPeriod = 0;
+    statistics.maximumPeriod = 0;
+    statistics.maximumJitter = 0;
+    statistics.maximumExecutionTime = 0;
+    accumulatedControlLoopPeriod = 0;
+    letControlLoopRun();
+    timerControlLoopUpdatePending = false;
+    addHousekeepingTelemetryPacket();
+    addTelemetryPacket(ESAT_ADCSControlLoopTelemetryPacket);
+    return;
+  }
+#endif /* ARDUINO_ESAT_ADCS */
   updatePeriod();
-  readSensors();
+  if (!pipelinedSensorAcquisition)
+  {
+    readSensors();
+  }
+  if (sensorAcquisitionState == SENSOR_ACQUISITION_READY)
+  {
+    sensorAcquisitionState = SENSOR_ACQUISITION_IDLE;
+  }
+  if (attitudeEstimation)
+  {
+    estimateAttitude();
+  }
   run();
   addHousekeepingTelemetryPacket();
 }
@@ -329,6 +845,7 @@ void ESAT_ADCSClass::respondToI2CRequests()
       respondToNamedPacketTelemetryRequest(byte(requestedPacket));
       break;
   }
+  stageI2CTelemetry();
   #endif /* ARDUINO_ESAT_ADCS */
 }
 
@@ -369,10 +886,7 @@ void ESAT_ADCSClass::respondToNextPacketTelecommandRequest()
 #ifdef ARDUINO_ESAT_ADCS
 void ESAT_ADCSClass::respondToNextPacketTelemetryRequest()
 {
-  if (ESAT_I2CSlave.telemetryQueueResetReceived())
-  {
-    i2cTelemetryPacket = latestTelemetryPacket;
-  }
+  updateI2CTelemetryPacket();
   if (i2cTelemetryPacket != nullptr)
   {
     byte packetData[MAXIMUM_TELEMETRY_PACKET_DATA_LENGTH];
@@ -396,6 +910,52 @@ void ESAT_ADCSClass::respondToNextPacketTelemetryRequest()
 }
 #endif /* ARDUINO_ESAT_ADCS */
 
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_ADCSClass::stageI2CTelemetry()
+{
+  if (ESAT_I2CSlave.stagedTelemetryAvailableForWrite() == 0)
+  {
+    return;
+  }
+  updateI2CTelemetryPacket();
+  while ((ESAT_I2CSlave.stagedTelemetryAvailableForWrite() > 0)
+         && (i2cTelemetryPacket != nullptr))
+  {
+    byte packetData[MAXIMUM_TELEMETRY_PACKET_DATA_LENGTH];
+    ESAT_CCSDSPacket packet(packetData, MAXIMUM_TELEMETRY_PACKET_DATA_LENGTH);
+    const boolean gotPacket = fillTelemetryPacket(packet,
+                                                  *i2cTelemetryPacket);
+    if (gotPacket)
+    {
+      // Staging fails if the master reset the telemetry queue after
+      // updateI2CTelemetryPacket(); the next call starts over.
+      const boolean staged =
+        ESAT_I2CSlave.stageTelemetry(packet, i2cTelemetryQueueResetSequence);
+      if (!staged)
+      {
+        return;
+      }
+    }
+    i2cTelemetryPacket = i2cTelemetryPacket->nextTelemetryPacket;
+  }
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
+#ifdef ARDUINO_ESAT_ADCS
+void ESAT_ADCSClass::updateI2CTelemetryPacket()
+{
+  // The reset sequence number catches every reset, even those that
+  // come while we are staging packets.
+  const unsigned long resetSequence =
+    ESAT_I2CSlave.telemetryQueueResetSequence();
+  if (resetSequence != i2cTelemetryQueueResetSequence)
+  {
+    i2cTelemetryQueueResetSequence = resetSequence;
+    i2cTelemetryPacket = latestTelemetryPacket;
+  }
+}
+#endif /* ARDUINO_ESAT_ADCS */
+
 void ESAT_ADCSClass::updatePeriod()
 {
   previousUpdateTime = currentUpdateTime;
@@ -26,6 +26,7 @@
 #include <ESAT_CCSDSPacketFromKISSFrameReader.h>
 #include <ESAT_CCSDSPacketToKISSFrameWriter.h>
 #include <ESAT_SoftwareClock.h>
+#include "ESAT_ADCS-measurements/ESAT_AttitudeEstimator.h"
 #include "ESAT_ADCS-measurements/ESAT_AttitudeStateVector.h"
 #include "ESAT_ADCS-run-modes/ESAT_ADCSRunMode.h"
 #include "ESAT_ADCS-telecommand-handlers/ESAT_ADCSTelecommandHandler.h"
@@ -43,6 +44,12 @@
 //   ESAT_ADCS.handleTelecommand() to respond to telecommands sent to
 //   the ADCS.
 // * It calls update() to iterate the ADCS loop.
+// * Optionally, it calls startSensorAcquisition() and
+//   acquireSensors() to read the sensors without waiting before
+//   update() (see enablePipelinedSensorAcquisition()).
+// * Optionally, it leaves the sensing and the control to a timer
+//   interrupt and keeps update() for the telemetry (see
+//   enableTimerControlLoop()).
 // * It calls telemetryAvailable() and readTelemetry() to retrieve
 //   ADCS telemetry.
 //
@@ -57,21 +64,106 @@
 class ESAT_ADCSClass
 {
   public:
+    // Timing statistics of the timer control loop.
+    struct ControlLoopStatistics
+    {
+      // Nominal control loop frequency (in hertz).
+      word frequency;
+
+      // Number of control loop iterations.
+      word iterations;
+
+      // Number of control loop iterations that took longer than
+      // the nominal period.
+      word overruns;
+
+      // Shortest, mean and longest period (in microseconds) between
+      // the starts of consecutive control loop iterations.
+      unsigned long minimumPeriod;
+      unsigned long meanPeriod;
+      unsigned long maximumPeriod;
+
+      // Longest deviation (in microseconds) of the period from the
+      // nominal period.
+      unsigned long maximumJitter;
+
+      // Longest execution time (in microseconds) of one control loop
+      // iteration.
+      unsigned long maximumExecutionTime;
+    };
+
+    // Advance the sensor acquisition started with
+    // startSensorAcquisition() by one step without waiting.
+    // Return true when the sensor readings are ready for update();
+    // otherwise return false.
+    boolean acquireSensors();
+
     // Stack a new telemetry packet for emission.
     void addTelemetryPacket(ESAT_ADCSTelemetryPacket& telemetryPacket);
 
     // Return the current attitude state vector.
+    // With attitude estimation, the magnetic angle, the solar angle
+    // and the rotational speed are the estimated ones.
+    // With the timer control loop, this is the snapshot published at
+    // the end of the latest control loop iteration, except for the
+    // controllers running inside the control loop.
     ESAT_AttitudeStateVector attitudeStateVector();
 
     // Get all ADCS subsystems ready.
     void begin();
 
+    // Go back to using the sensor readings directly in the attitude
+    // state vector.  This is the default.
+    void disableAttitudeEstimation();
+
+    // Go back to blocking sensor acquisition: update() reads the
+    // sensors itself, waiting for the magnetorquers to settle and for
+    // the magnetometer to finish its measurement.  This is the
+    // default.
+    void disablePipelinedSensorAcquisition();
+
+    // Stop the timer control loop and go back to sensing and control
+    // in update().  This is the default.
+    void disableTimerControlLoop();
+
     // Disable the reception of telecommands through the USB interface.
     void disableUSBTelecommands();
 
     // Disable the emission of telemetry from the USB interface.
     void disableUSBTelemetry();
 
+    // Estimate the magnetic angle, the solar angle and the
+    // rotational speed on each call to update() by fusing the
+    // gyroscope readings with the magnetometer readings and with the
+    // coarse sun sensor readings (see ESAT_AttitudeEstimator), so
+    // that the controllers work with the estimates.
+    void enableAttitudeEstimation();
+
+    // Enable pipelined sensor acquisition: startSensorAcquisition()
+    // switches off the magnetorquers and reads the tachometer, the
+    // gyroscope and the coarse sun sensor while the magnetorquer
+    // field settles for the given time (in microseconds); then,
+    // acquireSensors() starts the magnetometer measurement and
+    // collects it as soon as it is ready.  update() takes the latest
+    // readings instead of reading the sensors itself.
+    // The magnetometer measurement starts right away when the
+    // magnetorquers are already switched off.
+    void enablePipelinedSensorAcquisition(unsigned long settleTime);
+
+    // Run the sensing and the control from a timer interrupt at the
+    // given frequency (in hertz; 50 to 200 Hz is a sensible range).
+    // The gyroscope and the coarse sun sensor are read on every
+    // iteration; the tachometer and the magnetometer, once every
+    // divider iterations, switching off the magnetorquers while the
+    // magnetometer measures.  update() is then left with the
+    // telemetry and adds the ADCS control loop telemetry packet with
+    // the timing statistics of the loop.
+    // Telecommands, telemetry and every method that changes the state
+    // used by the control loop hold off the control loop interrupt
+    // while they run.
+    // This method does nothing when run on the ESAT OBC board.
+    void enableTimerControlLoop(word frequency, word divider);
+
     // Enable the reception of telecommands from the USB interface.
     // Use the buffer for accumulating the partially-received
     // telecommands from one call to readTelecommand() to the next.
@@ -83,12 +175,22 @@ class ESAT_ADCSClass
     // Handle a telecommand.
     void handleTelecommand(ESAT_CCSDSPacket& packet);
 
+    // Return the timing statistics of the timer control loop over
+    // the latest call to update().
+    ControlLoopStatistics controlLoopStatistics();
+
     // Return the unique identifier of the ADCS.
     word getApplicationProcessIdentifier();
 
+    // Return the attitude state vector as read from the sensors,
+    // without attitude estimation.
+    ESAT_AttitudeStateVector measuredAttitudeStateVector();
+
     // Return the period (in seconds) from the previous call to
-    // update() to the current call to update().  Attitude control
-    // loops may need this.
+    // update() to the current call to update(), or from the start of
+    // the previous control loop iteration to the start of the current
+    // one with the timer control loop.  Attitude control loops may
+    // need this.
     float period();
 
     // Read an incomming telecommand and write it into a packet.
@@ -108,6 +210,7 @@ class ESAT_ADCSClass
     void registerTelecommandHandler(ESAT_ADCSTelecommandHandler& telecommandHandler);
 
     // Respond to telemetry and telecommand requests coming from the I2C bus.
+    // Build the next telemetry packets ahead of their requests.
     // This method does nothing when run on the ESAT OBC board.
     void respondToI2CRequests();
 
@@ -120,6 +223,13 @@ class ESAT_ADCSClass
     // Set the time of the real-time clock.
     void setTime(ESAT_Timestamp timestamp);
 
+    // Start a new sensor acquisition for the next call to update().
+    // Then, call acquireSensors() until it returns true.
+    // Do nothing if a sensor acquisition is already under way.
+    // With the timer control loop, the control loop reads the sensors
+    // and the acquisition is ready right away.
+    void startSensorAcquisition();
+
     // Return true if there is a new telemetry packet available.
     boolean telemetryAvailable();
 
@@ -127,18 +237,50 @@ class ESAT_ADCSClass
     // * Read the sensors.
     // * Perform one iteration.
     // * Make available a new housekeeping telemetry packet.
+    // With the timer control loop, only make available the new
+    // telemetry packets.
     void update();
 
     // Send a telemetry packet through the USB debugging interface.
     void writeTelemetry(ESAT_CCSDSPacket& packet);
 
   private:
+    // Stages of the sensor acquisition.
+    enum SensorAcquisitionState
+    {
+      // No sensor acquisition under way.
+      SENSOR_ACQUISITION_IDLE,
+      // Waiting for the magnetorquer field to settle.
+      SENSOR_ACQUISITION_SETTLING,
+      // Waiting for the magnetometer measurement.
+      SENSOR_ACQUISITION_CONVERTING,
+      // Sensor readings ready for update().
+      SENSOR_ACQUISITION_READY,
+    };
+
     // Unique identifier of the subsystem.
     static const byte APPLICATION_PROCESS_IDENTIFIER = 2;
 
+    // Give up waiting for the magnetometer measurement after this
+    // time (in microseconds).
+    static const unsigned long MAGNETOMETER_MEASUREMENT_TIMEOUT = 50000;
+
+    // Default time (in microseconds) the magnetorquer field takes to
+    // settle.
+    static const unsigned long MAGNETORQUER_SETTLE_TIME = 20000;
+
+    // Standard deviations used by the attitude estimators:
+    // magnetometer and coarse sun sensor angle readings (in degrees),
+    // gyroscope readings (in degrees per second) and random angular
+    // acceleration (in degrees per second squared).
+    static constexpr float MAGNETIC_ANGLE_NOISE = 2;
+    static constexpr float SUN_ANGLE_NOISE = 5;
+    static constexpr float ROTATIONAL_SPEED_NOISE = 1;
+    static constexpr float ANGULAR_ACCELERATION_NOISE = 2;
+
     // Version numbers.
     static const byte MAJOR_VERSION_NUMBER = 3;
-    static const byte MINOR_VERSION_NUMBER = 5;
+    static const byte MINOR_VERSION_NUMBER = 6;
     static const byte PATCH_VERSION_NUMBER = 0;
 
 #ifdef ARDUINO_ESAT_ADCS
@@ -150,6 +292,10 @@ class ESAT_ADCSClass
     // of telemetry packets going out through the I2C bus.
     static const unsigned long MAXIMUM_TELEMETRY_PACKET_DATA_LENGTH = 1024;
 
+    // Number of telemetry packets built ahead of the next-packet
+    // telemetry requests coming from the I2C bus.
+    static const unsigned long STAGED_TELEMETRY_PACKETS = 2;
+
     // Back buffer for the packet data field of telecommand packets
     // coming from the I2C bus.
     byte i2cTelecommandPacketData[MAXIMUM_TELECOMMAND_PACKET_DATA_LENGTH];
@@ -162,10 +308,78 @@ class ESAT_ADCSClass
     // requests.
     ESAT_ADCSTelemetryPacket* i2cTelemetryPacket;
 
+    // Sequence number of the latest telemetry queue reset seen by
+    // updateI2CTelemetryPacket().
+    unsigned long i2cTelemetryQueueResetSequence;
+
     // Latest element added to the stack of telemetry packets.
     ESAT_ADCSTelemetryPacket* latestTelemetryPacket;
 #endif /* ARDUINO_ESAT_ADCS */
 
+    // True when update() estimates the attitude; false otherwise.
+    boolean attitudeEstimation;
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Timing statistics of the control loop accumulated since the
+    // latest call to update().
+    ControlLoopStatistics accumulatedControlLoopStatistics;
+
+    // Sum of the periods (in microseconds) accumulated since the
+    // latest call to update().
+    unsigned long accumulatedControlLoopPeriod;
+
+    // Number of nested holdOffControlLoop() calls not yet matched by
+    // letControlLoopRun().
+    byte controlLoopHoldOffs;
+
+    // Number of control loop iterations left until the next
+    // magnetometer measurement.
+    word controlLoopIterationsToMagnetometer;
+
+    // Processor uptime (in microseconds) at the start of the current
+    // control loop iteration.
+    unsigned long controlLoopIterationStartTime;
+
+    // Nominal period (in microseconds) of the control loop.
+    unsigned long controlLoopNominalPeriod;
+
+    // Period (in microseconds) from the start of the previous control
+    // loop iteration to the start of the current one.
+    unsigned long controlLoopPeriod;
+
+    // Hardware timer of the control loop.
+    HardwareTimer controlLoopTimer;
+
+    // True while a control loop iteration runs.
+    volatile boolean insideControlLoop;
+
+    // Timing statistics of the control loop over the latest call to
+    // update().
+    ControlLoopStatistics latestControlLoopStatistics;
+
+    // Read the magnetometer once every this number of control loop
+    // iterations.
+    word magnetometerDivider;
+
+    // Double buffer of attitude state vectors published by the
+    // control loop: the control loop writes the slot not pointed to
+    // by publishedAttitudeStateVectorSequence and then moves the
+    // sequence forward, so the readers never wait.
+    ESAT_AttitudeStateVector publishedAttitudeStateVectors[2];
+
+    // Number of attitude state vectors published by the control
+    // loop.  The latest one is in slot
+    // publishedAttitudeStateVectorSequence % 2.
+    volatile word publishedAttitudeStateVectorSequence;
+
+    // True when the timer control loop runs; false otherwise.
+    boolean timerControlLoop;
+
+    // True from startSensorAcquisition() to update() with the timer
+    // control loop.
+    boolean timerControlLoopUpdatePending;
+#endif /* ARDUINO_ESAT_ADCS */
+
     // Real-time clock.
     // Useful for generating timestamps for telemetry packets.
     ESAT_SoftwareClock clock;
@@ -176,12 +390,40 @@ class ESAT_ADCSClass
     // Processor uptime (in milliseconds) at the current call to update().
     unsigned long currentUpdateTime;
 
+    // Estimated attitude state vector.
+    ESAT_AttitudeStateVector estimatedAttitudeStateVector;
+
+    // True when the magnetic angle of the current attitude state
+    // vector has not been used by the attitude estimator yet.
+    boolean freshMagneticAngle;
+
+    // Estimator of the magnetic angle.
+    ESAT_AttitudeEstimator magneticAttitudeEstimator;
+
+    // Time (in microseconds) the magnetorquer field takes to settle
+    // in pipelined sensor acquisition and in the timer control loop.
+    unsigned long magnetorquerSettleTime;
+
+    // True when the sensors are read with startSensorAcquisition()
+    // and acquireSensors(); false when update() reads them itself.
+    boolean pipelinedSensorAcquisition;
+
     // Processor uptime (in milliseconds) at the previous call to update().
     unsigned long previousUpdateTime;
 
     // Current run mode.
     ESAT_ADCSRunMode* runMode;
 
+    // Estimator of the solar angle.
+    ESAT_AttitudeEstimator solarAttitudeEstimator;
+
+    // Current stage of the sensor acquisition.
+    SensorAcquisitionState sensorAcquisitionState;
+
+    // Processor uptime (in microseconds) at the start of the current
+    // stage of the sensor acquisition.
+    unsigned long sensorAcquisitionStageStartTime;
+
     // First element of the list of telecommand handlers.
     ESAT_ADCSTelecommandHandler* telecommandHandler = nullptr;
 
@@ -202,9 +444,33 @@ class ESAT_ADCSClass
     // Add the housekeeping telemetry packet to the telemetry packet stack.
     void addHousekeepingTelemetryPacket();
 
+    // Advance the sensor acquisition by one step without waiting.
+    // Return true when the sensor readings are ready; otherwise
+    // return false.
+    boolean advanceSensorAcquisition();
+
+    // Switch off the magnetorquers and start waiting for their
+    // field to settle, or start the magnetometer measurement right
+    // away if they are already off.
+    void beginMagneticFieldAcquisition();
+
+    // Stop the sensor acquisition under way, giving the
+    // magnetorquers back their state.
+    void cancelSensorAcquisition();
+
     // Clear the list of telemetry packets.
     void clearTelemetryPacketList();
 
+#ifdef ARDUINO_ESAT_ADCS
+    // Run one iteration of the control loop from the control loop
+    // timer interrupt.
+    static void controlLoopInterrupt();
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // Update the estimated attitude state vector with the latest
+    // sensor readings.
+    void estimateAttitude();
+
     // Fill a telemetry packet with the contents of the
     // given ESAT_ADCSTelemetryPacket.
     // Return true on success; otherwise return false.
@@ -215,6 +481,31 @@ class ESAT_ADCSClass
     // or nullptr if it couldn't be found.
     ESAT_ADCSTelemetryPacket* findTelemetryPacket(byte identifier);
 
+    // Collect the magnetometer measurement and give the
+    // magnetorquers back their state at the end of pipelined
+    // sensor acquisition.
+    void finishSensorAcquisition();
+
+    // Keep the control loop interrupt from running until the
+    // matching call to letControlLoopRun().  Calls nest.
+    // Does nothing inside the control loop.
+    void holdOffControlLoop();
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Read the sensors, estimate the attitude, actuate and publish
+    // the attitude state vector.  Measure the timing of the loop.
+    void iterateControlLoop();
+#endif /* ARDUINO_ESAT_ADCS */
+
+    // Let the control loop interrupt run again after the matching
+    // call to holdOffControlLoop().
+    void letControlLoopRun();
+
+#ifdef ARDUINO_ESAT_ADCS
+    // Publish the attitude state vector to the double buffer.
+    void publishAttitudeStateVector();
+#endif /* ARDUINO_ESAT_ADCS */
+
     // Read the sensors needed for attitude determination and control.
     void readSensors();
 
@@ -230,6 +521,16 @@ class ESAT_ADCSClass
     // Respond to a next-packet telemetry request coming from the I2C
     // bus.
     void respondToNextPacketTelemetryRequest();
+
+    // Build the next telemetry packets for the I2C bus ahead of
+    // their requests while there is room for them in the
+    // I2C telemetry staging ring.
+    void stageI2CTelemetry();
+
+    // Go back to the latest telemetry packet for I2C telemetry
+    // requests if the I2C master requested a reset of the
+    // telemetry queue.
+    void updateI2CTelemetryPacket();
 #endif /* ARDUINO_ESAT_ADCS */
 
     // Actuate according to the current run mode.
@@ -0,0 +1,105 @@
+/*
+ * ESAT OBC Main Program on FreeRTOS
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <STM32FreeRTOS.h>
+#include <ESAT_ConcurrentOnBoardDataHandling.h>
+
+// Main program of the on-board computer with the concurrent on-board
+// data handling runtime.  It does the same peripheral setup and
+// subsystem registration as the sequential ESAT-OBC program, but
+// instead of running the main on-board data handling loop, it hands
+// the subsystems to ESAT_ConcurrentOnBoardDataHandling and starts the
+// FreeRTOS scheduler: each subsystem runs in its own task, a router
+// task moves the telecommands and telemetry between them and a
+// storage task writes the telemetry to the SD card.
+
+// Cycle period of the subsystem tasks in milliseconds.
+const word PERIOD = 1000;
+
+// Maximum packet data length we will handle.
+const word PACKET_DATA_BUFFER_LENGTH =
+  ESAT_ConcurrentOnBoardDataHandlingClass::PACKET_DATA_BUFFER_LENGTH;
+
+// Maximum whole packet length we will handle.
+const word WHOLE_PACKET_BUFFER_LENGTH =
+  ESAT_CCSDSPrimaryHeader::LENGTH + PACKET_DATA_BUFFER_LENGTH;
+
+// Accumulate incoming USB telecommands in this buffer.
+byte usbTelecommandBuffer[WHOLE_PACKET_BUFFER_LENGTH];
+
+// Accumulate incoming Wifi telecommands in this buffer.
+byte wifiReaderBuffer[WHOLE_PACKET_BUFFER_LENGTH];
+
+// Accumulate the packet data field of a full packet coming
+// from the Wifi board in this buffer.
+byte wifiPacketDataBuffer[PACKET_DATA_BUFFER_LENGTH];
+
+// Start peripherals, register and begin the subsystems, create the
+// tasks and start the FreeRTOS scheduler, which never returns.
+void setup()
+{
+  Serial.begin(9600);
+  SerialWifi.begin(9600);
+  Wire.begin();
+  while (!SD.begin(SD_DETECT_NONE))
+  {
+    Serial.println("initialization failed. Is a card inserted?");
+    delay(10);
+  }
+  ESAT_I2CStatistics.begin(Wire);
+  ESAT_I2CBusScheduler.begin(Wire);
+  ESAT_I2CMaster.begin(Wire);
+  delay(1000);
+  ESAT_OBCSubsystem.begin();
+  ESAT_EPSSubsystem.begin();
+  ESAT_ADCSSubsystem.begin();
+  ESAT_COMSubsystem.begin();
+  ESAT_WifiSubsystem.begin(wifiReaderBuffer,
+                           sizeof(wifiReaderBuffer),
+                           wifiPacketDataBuffer,
+                           sizeof(wifiPacketDataBuffer));
+  ESAT_OnBoardDataHandling.registerSubsystem(ESAT_OBCSubsystem);
+  ESAT_OnBoardDataHandling.registerSubsystem(ESAT_EPSSubsystem);
+  ESAT_OnBoardDataHandling.registerSubsystem(ESAT_ADCSSubsystem);
+  ESAT_OnBoardDataHandling.registerSubsystem(ESAT_COMSubsystem);
+  ESAT_OnBoardDataHandling.registerSubsystem(ESAT_WifiSubsystem);
+  if (ESAT_ThermalPayloadSubsystem.enabled)
+  {
+    ESAT_ThermalPayloadSubsystem.begin();
+    ESAT_OnBoardDataHandling.registerSubsystem(ESAT_ThermalPayloadSubsystem);
+  }
+  ESAT_ConcurrentOnBoardDataHandling.enableUSBTelecommands(usbTelecommandBuffer,
+                                                           sizeof(usbTelecommandBuffer));
+  ESAT_ConcurrentOnBoardDataHandling.enableUSBTelemetry();
+  ESAT_ConcurrentOnBoardDataHandling.setStorageSubsystem(ESAT_OBCSubsystem);
+  const boolean started = ESAT_ConcurrentOnBoardDataHandling.begin(PERIOD);
+  if (!started)
+  {
+    Serial.println("Could not create the on-board data handling tasks.");
+    while (true)
+    {
+    }
+  }
+  vTaskStartScheduler();
+}
+
+// The FreeRTOS scheduler runs the tasks, so the loop is never reached.
+void loop()
+{
+}
@@ -37,6 +37,36 @@
 // Cycle period in milliseconds.
 const word PERIOD = 1000;
 
+// Spend at most this number of microseconds per cycle waiting for
+// the telemetry packets of the I2C boards.
+const unsigned long TELEMETRY_COLLECTION_BUDGET = 200000;
+
+// Queue this number of telemetry packets per sink.
+const byte TELEMETRY_QUEUE_CAPACITY = 8;
+
+// Spend at most this number of microseconds per cycle writing the
+// queued telemetry packets to each sink.
+const unsigned long TELEMETRY_QUEUE_BUDGET = 50000;
+
+// Spend at most these numbers of microseconds per cycle reading
+// telecommands, updating the subsystems, reading telemetry and
+// writing the queued telemetry packets, so that the whole cycle fits
+// in the cycle period.
+const unsigned long TELECOMMAND_BUDGET = 100000;
+const unsigned long UPDATE_BUDGET = 250000;
+const unsigned long TELEMETRY_BUDGET = 300000;
+const unsigned long DRAIN_BUDGET = 150000;
+
+// Let the COM board use the I2C bus for at most this number of
+// microseconds per cycle, so that forwarding telemetry to it never
+// takes the bus time of the attitude sensors and the rest of the
+// boards.
+const unsigned long COM_I2C_TIME_SLOT = 150000;
+
+// Reset the on-board computer if no cycle goes through in this
+// number of microseconds.
+const unsigned long WATCHDOG_TIMEOUT = 4000000;
+
 // Maximum packet data length we will handle.
 const word PACKET_DATA_BUFFER_LENGTH = 256;
 
@@ -54,6 +84,12 @@ byte wifiReaderBuffer[WHOLE_PACKET_BUFFER_LENGTH];
 // from the Wifi board in this buffer.
 byte wifiPacketDataBuffer[PACKET_DATA_BUFFER_LENGTH];
 
+// Output telemetry queues of the USB interface, the Wifi board and
+// the COM board, so that a slow link doesn't stall the main loop.
+ESAT_TelemetrySinkQueue usbTelemetryQueue;
+ESAT_TelemetrySinkQueue wifiTelemetryQueue;
+ESAT_TelemetrySinkQueue comTelemetryQueue;
+
 //SdFatFs fatFs;
 
 // Start peripherals and do the initial bookkeeping here:
@@ -61,8 +97,12 @@ byte wifiPacketDataBuffer[PACKET_DATA_BUFFER_LENGTH];
 // - Activate the emission of telemetry through the USB interface.
 // - Register the available subsystems for use by the on-board data
 //   handling module.
+// - Add the output telemetry queues.
+// - Set the time budgets of the phases of the main loop.
 // - Begin the subsystems.
+// - Set the time slot of the COM board on the I2C bus.
 // - Begin the timer that keeps a precise timing of the main loop.
+// - Enable the watchdog.
 // This is the first function of the program to be run at it runs only
 // once.
 void setup()
@@ -79,12 +119,15 @@ void setup()
 
   Serial.println("A card is present.");
 
+  ESAT_I2CStatistics.begin(Wire);
+  ESAT_I2CBusScheduler.begin(Wire);
   ESAT_I2CMaster.begin(Wire);
   delay(1000);
   ESAT_OBCSubsystem.begin();
   ESAT_EPSSubsystem.begin();
   ESAT_ADCSSubsystem.begin();
   ESAT_COMSubsystem.begin();
+  ESAT_COMSubsystem.setI2CTimeSlot(COM_I2C_TIME_SLOT);
   ESAT_WifiSubsystem.begin(wifiReaderBuffer,
                            sizeof(wifiReaderBuffer),
                            wifiPacketDataBuffer,
@@ -92,6 +135,7 @@ void setup()
   ESAT_OnBoardDataHandling.enableUSBTelecommands(usbTelecommandBuffer,
                                                  sizeof(usbTelecommandBuffer));
   ESAT_OnBoardDataHandling.enableUSBTelemetry();
+  ESAT_OnBoardDataHandling.enablePipelinedTelemetry(TELEMETRY_COLLECTION_BUDGET);
   ESAT_OnBoardDataHandling.registerSubsystem(ESAT_OBCSubsystem);
   ESAT_OnBoardDataHandling.registerSubsystem(ESAT_EPSSubsystem);
   ESAT_OnBoardDataHandling.registerSubsystem(ESAT_ADCSSubsystem);
@@ -102,23 +146,70 @@ void setup()
     ESAT_ThermalPayloadSubsystem.begin();
     ESAT_OnBoardDataHandling.registerSubsystem(ESAT_ThermalPayloadSubsystem);
   }
+  usbTelemetryQueue.begin(ESAT_TelemetryRoutingTable.USB_SINK,
+                          TELEMETRY_QUEUE_CAPACITY,
+                          ESAT_TelemetrySinkQueue::DROP_LOWEST,
+                          TELEMETRY_QUEUE_BUDGET);
+  wifiTelemetryQueue.begin(ESAT_WifiSubsystem.getApplicationProcessIdentifier(),
+                           TELEMETRY_QUEUE_CAPACITY,
+                           ESAT_TelemetrySinkQueue::DROP_LOWEST,
+                           TELEMETRY_QUEUE_BUDGET);
+  comTelemetryQueue.begin(ESAT_COMSubsystem.getApplicationProcessIdentifier(),
+                          TELEMETRY_QUEUE_CAPACITY,
+                          ESAT_TelemetrySinkQueue::DROP_LOWEST,
+                          TELEMETRY_QUEUE_BUDGET);
+  ESAT_OnBoardDataHandling.addTelemetryQueue(usbTelemetryQueue);
+  ESAT_OnBoardDataHandling.addTelemetryQueue(wifiTelemetryQueue);
+  ESAT_OnBoardDataHandling.addTelemetryQueue(comTelemetryQueue);
+  ESAT_OnBoardDataHandling.setPhaseBudget(ESAT_OnBoardDataHandling.TELECOMMAND_BUDGET_PHASE,
+                                          TELECOMMAND_BUDGET);
+  ESAT_OnBoardDataHandling.setPhaseBudget(ESAT_OnBoardDataHandling.UPDATE_BUDGET_PHASE,
+                                          UPDATE_BUDGET);
+  ESAT_OnBoardDataHandling.setPhaseBudget(ESAT_OnBoardDataHandling.TELEMETRY_BUDGET_PHASE,
+                                          TELEMETRY_BUDGET);
+  ESAT_OnBoardDataHandling.setPhaseBudget(ESAT_OnBoardDataHandling.DRAIN_BUDGET_PHASE,
+                                          DRAIN_BUDGET);
   ESAT_Timer.begin(PERIOD);
+  ESAT_OnBoardDataHandling.enableWatchdog(WATCHDOG_TIMEOUT);
 }
 
 // Body of the main loop of the program:
+// - Wait until the next cycle or until there is an incoming
+//   telecommand.  On incoming telecommands, just retrieve and
+//   dispatch them and go back to wait, so that they don't have
+//   to wait for the next cycle.
+// - Start a new cycle of the on-board data handling (for the time
+//   budgets), of the cycle profiler (which does nothing unless it is
+//   compiled in) and of the I2C bus scheduler.
 // - Retrieve the incoming telecommands.
 // - Dispatch the incoming telecommands on their target subsystems.
-// - Update the subsystems.
+// - Update the subsystems and ask the I2C boards for their telemetry.
 // - Retrieve the telemetry packets from the subsystems.
 // - Forward the retrieved telemetry packets to the subsystems so that
 //   they can use them (for example, a subsystem may send telemetry
 //   packets to the ground station or it can store them for later use).
+// - Write the queued telemetry packets to their sinks.
+// - Run the asynchronous I2C transactions still waiting for the bus.
+// - End the cycle of the on-board data handling, which refreshes the
+//   watchdog, and of the cycle profiler.
 // This function is run in an infinite loop that starts after setup().
 void loop()
 {
-  ESAT_Timer.waitUntilNextCycle();
+  const boolean newCycle =
+    ESAT_OnBoardDataHandling.waitUntilNextCycleOrEvent();
   byte buffer[PACKET_DATA_BUFFER_LENGTH];
   ESAT_CCSDSPacket packet(buffer, sizeof(buffer));
+  if (!newCycle)
+  {
+    while (ESAT_OnBoardDataHandling.readTelecommand(packet))
+    {
+      ESAT_OnBoardDataHandling.dispatchTelecommand(packet);
+    }
+    return;
+  }
+  ESAT_OnBoardDataHandling.beginCycle();
+  ESAT_CycleProfiler.beginCycle();
+  ESAT_I2CBusScheduler.beginCycle();
   while (ESAT_OnBoardDataHandling.readTelecommand(packet))
   {
     ESAT_OnBoardDataHandling.dispatchTelecommand(packet);
@@ -128,4 +219,8 @@ void loop()
   {
     ESAT_OnBoardDataHandling.writeTelemetry(packet);
   }
+  ESAT_OnBoardDataHandling.drainTelemetryQueues();
+  ESAT_I2CBusScheduler.run();
+  ESAT_OnBoardDataHandling.endCycle();
+  ESAT_CycleProfiler.endCycle();
 }
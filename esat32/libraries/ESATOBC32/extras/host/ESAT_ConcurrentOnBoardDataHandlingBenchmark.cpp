@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+// Host benchmark of ESAT_ConcurrentOnBoardDataHandling.
+// It runs the runtime on the thread-based FreeRTOS stand-in with
+// three synthetic subsystems:
+// - a fast subsystem, which sends a burst of telemetry packets and
+//   one telecommand for the slow subsystem every cycle;
+// - a slow subsystem, whose update takes as long as a few I2C
+//   retries;
+// - a storage subsystem, whose telemetry writes take as long as an
+//   SD card write.
+// Every packet carries the time it was made, so the subsystems
+// that get it can measure its latency.  With no routes, telemetry
+// goes to all the subsystems and to the USB interface.  After the
+// run, the benchmark prints the throughput and latency of the
+// packets together with the runtime statistics.
+// See README.txt for building and running it.
+
+#include <STM32FreeRTOS.h>
+#include <ESAT_ConcurrentOnBoardDataHandling.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Cycle period of the subsystem tasks in milliseconds.
+const word PERIOD = 100;
+
+// Length of the run in milliseconds.
+const unsigned long RUN_TIME = 10000;
+
+// Latency statistics of a kind of packets.
+struct LatencyStatistics
+{
+  // Number of packets received.
+  unsigned long packets;
+
+  // Sum of the latencies in microseconds.
+  unsigned long long totalLatency;
+
+  // Longest latency in microseconds.
+  unsigned long maximumLatency;
+};
+
+// Synthetic subsystem for the benchmark.
+class BenchmarkSubsystem: public ESAT_Subsystem
+{
+  public:
+    // Name of the subsystem in the report.
+    const char* const name;
+
+    // Number of telemetry packets made.
+    unsigned long telemetryPacketsSent = 0;
+
+    // Number of telecommands made.
+    unsigned long telecommandsSent = 0;
+
+    // Latency of the telemetry packets received.
+    LatencyStatistics telemetry = {0, 0, 0};
+
+    // Latency of the telecommands received.
+    LatencyStatistics telecommands = {0, 0, 0};
+
+    // Make a subsystem with the given name and application process
+    // identifier that sends the given number of telemetry packets per
+    // cycle and the given number of telecommands per cycle to the
+    // given target, takes the given number of milliseconds to update
+    // and the given number of milliseconds to write each telemetry
+    // packet.
+    BenchmarkSubsystem(const char* const subsystemName,
+                       const word subsystemApplicationProcessIdentifier,
+                       const byte telemetryPacketsPerCycle,
+                       const byte telecommandsPerCycle,
+                       const word telecommandTarget,
+                       const word updateTime,
+                       const word writeTime):
+      name(subsystemName),
+      applicationProcessIdentifier(subsystemApplicationProcessIdentifier),
+      telemetryPerCycle(telemetryPacketsPerCycle),
+      telecommandsPerCycle(telecommandsPerCycle),
+      target(telecommandTarget),
+      updateMilliseconds(updateTime),
+      writeMilliseconds(writeTime)
+    {
+    }
+
+    word getApplicationProcessIdentifier()
+    {
+      return applicationProcessIdentifier;
+    }
+
+    void handleTelecommand(ESAT_CCSDSPacket& telecommand)
+    {
+      measureLatency(telecommand, telecommands);
+    }
+
+    boolean readTelecommand(ESAT_CCSDSPacket& packet)
+    {
+      if (pendingTelecommands == 0)
+      {
+        return false;
+      }
+      pendingTelecommands = pendingTelecommands - 1;
+      packet.writeTelecommandHeaders(target,
+                                     word(telecommandsSent),
+                                     ESAT_Timestamp(),
+                                     1, 0, 0,
+                                     0);
+      packet.writeUnsignedLong(micros());
+      telecommandsSent = telecommandsSent + 1;
+      return true;
+    }
+
+    boolean readTelemetry(ESAT_CCSDSPacket& packet)
+    {
+      if (pendingTelemetry == 0)
+      {
+        return false;
+      }
+      pendingTelemetry = pendingTelemetry - 1;
+      packet.writeTelemetryHeaders(applicationProcessIdentifier,
+                                   word(telemetryPacketsSent),
+                                   ESAT_Timestamp(),
+                                   1, 0, 0,
+                                   0);
+      packet.writeUnsignedLong(micros());
+      telemetryPacketsSent = telemetryPacketsSent + 1;
+      return true;
+    }
+
+    void update()
+    {
+      delay(updateMilliseconds);
+      pendingTelecommands = telecommandsPerCycle;
+      pendingTelemetry = telemetryPerCycle;
+    }
+
+    void writeTelemetry(ESAT_CCSDSPacket& packet)
+    {
+      delay(writeMilliseconds);
+      measureLatency(packet, telemetry);
+    }
+
+  private:
+    const word applicationProcessIdentifier;
+    const byte telemetryPerCycle;
+    const byte telecommandsPerCycle;
+    const word target;
+    const word updateMilliseconds;
+    const word writeMilliseconds;
+
+    // Packets left to send in the current cycle.
+    byte pendingTelecommands = 0;
+    byte pendingTelemetry = 0;
+
+    // Add the latency of the packet to the given statistics.
+    void measureLatency(ESAT_CCSDSPacket& packet,
+                        LatencyStatistics& statistics)
+    {
+      packet.rewind();
+      (void) packet.readSecondaryHeader();
+      const unsigned long latency = micros() - packet.readUnsignedLong();
+      taskENTER_CRITICAL();
+      statistics.packets = statistics.packets + 1;
+      statistics.totalLatency = statistics.totalLatency + latency;
+      if (latency > statistics.maximumLatency)
+      {
+        statistics.maximumLatency = latency;
+      }
+      taskEXIT_CRITICAL();
+    }
+};
+
+BenchmarkSubsystem fastSubsystem("fast", 1, 4, 1, 2, 0, 0);
+BenchmarkSubsystem slowSubsystem("slow", 2, 1, 0, 0, 30, 0);
+BenchmarkSubsystem storageSubsystem("storage", 3, 0, 0, 0, 0, 2);
+
+BenchmarkSubsystem* const subsystems[] =
+{
+  &fastSubsystem,
+  &slowSubsystem,
+  &storageSubsystem,
+};
+
+// Print the latency statistics of a kind of packets.
+static void printLatency(const char* const kind,
+                         const LatencyStatistics& statistics)
+{
+  if (statistics.packets == 0)
+  {
+    printf("  %s: none received\n", kind);
+    return;
+  }
+  printf("  %s: %lu received, %.1f/s, latency mean %llu us, maximum %lu us\n",
+         kind,
+         statistics.packets,
+         statistics.packets * 1000.0 / RUN_TIME,
+         statistics.totalLatency / statistics.packets,
+         statistics.maximumLatency);
+}
+
+// Wait for the end of the run, print the report and end the program.
+static void reportTask(void* const parameters)
+{
+  (void) parameters;
+  vTaskDelay(pdMS_TO_TICKS(RUN_TIME));
+  taskENTER_CRITICAL();
+  printf("Run time: %lu ms, period: %u ms\n", RUN_TIME, PERIOD);
+  for (BenchmarkSubsystem* const subsystem : subsystems)
+  {
+    printf("Subsystem %s: sent %lu telemetry packets, %lu telecommands\n",
+           subsystem->name,
+           subsystem->telemetryPacketsSent,
+           subsystem->telecommandsSent);
+    printLatency("telemetry", subsystem->telemetry);
+    printLatency("telecommands", subsystem->telecommands);
+  }
+  printf("USB interface: %lu bytes\n", Serial.bytesWritten);
+  const ESAT_ConcurrentOnBoardDataHandlingClass::Statistics statistics =
+    ESAT_ConcurrentOnBoardDataHandling.readStatistics();
+  printf("Runtime: %lu telecommands routed, %lu telemetry packets routed, "
+         "%lu stored, %lu dropped, %lu cycle overruns, "
+         "longest cycle %lu us\n",
+         statistics.routedTelecommands,
+         statistics.routedTelemetryPackets,
+         statistics.storedTelemetryPackets,
+         statistics.droppedPackets,
+         statistics.cycleOverruns,
+         statistics.maximumCycleTime);
+  fflush(stdout);
+  _Exit(0);
+}
+
+int main()
+{
+  for (BenchmarkSubsystem* const subsystem : subsystems)
+  {
+    ESAT_OnBoardDataHandling.registerSubsystem(*subsystem);
+  }
+  ESAT_ConcurrentOnBoardDataHandling.enableUSBTelemetry();
+  ESAT_ConcurrentOnBoardDataHandling.setStorageSubsystem(storageSubsystem);
+  const boolean started = ESAT_ConcurrentOnBoardDataHandling.begin(PERIOD);
+  if (!started)
+  {
+    fprintf(stderr, "Could not create the on-board data handling tasks.\n");
+    return 1;
+  }
+  (void) xTaskCreate(reportTask, "Report", 512, nullptr, tskIDLE_PRIORITY, nullptr);
+  vTaskStartScheduler();
+  return 0;
+}
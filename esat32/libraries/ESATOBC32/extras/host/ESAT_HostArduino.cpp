@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+// Host stand-ins for the Arduino core, the Wire library, the STM32SD
+// library and the independent watchdog.
+// See include/Arduino.h, include/Wire.h, include/STM32SD.h and
+// include/IWatchdog.h.
+
+#include <Arduino.h>
+#include <IWatchdog.h>
+#include <STM32SD.h>
+#include <Wire.h>
+#include <chrono>
+#include <thread>
+
+// Time starts from here.
+static const std::chrono::steady_clock::time_point startTime =
+  std::chrono::steady_clock::now();
+
+// The host counts nanoseconds as core clock cycles.
+uint32_t SystemCoreClock = 1000000000;
+
+HardwareSerial Serial;
+HardwareSerial SerialWifi;
+IWatchdogClass IWatchdog;
+SDClass SD;
+TwoWire Wire;
+
+// Return the time elapsed since start-up in the given unit.
+template <typename Unit>
+static unsigned long elapsedTime()
+{
+  const std::chrono::steady_clock::duration elapsedTime =
+    std::chrono::steady_clock::now() - startTime;
+  return std::chrono::duration_cast<Unit>(elapsedTime).count();
+}
+
+uint32_t analogRead(const uint32_t pin)
+{
+  (void) pin;
+  return 0;
+}
+
+void delay(const unsigned long milliseconds)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+void delayMicroseconds(const unsigned int microseconds)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
+}
+
+int digitalRead(const uint32_t pin)
+{
+  (void) pin;
+  return 0;
+}
+
+void digitalWrite(const uint32_t pin, const uint32_t value)
+{
+  (void) pin;
+  (void) value;
+}
+
+uint32_t dwt_getCycles()
+{
+  return elapsedTime<std::chrono::nanoseconds>();
+}
+
+unsigned long micros()
+{
+  return elapsedTime<std::chrono::microseconds>();
+}
+
+unsigned long millis()
+{
+  return elapsedTime<std::chrono::milliseconds>();
+}
+
+void pinMode(const uint32_t pin, const uint32_t mode)
+{
+  (void) pin;
+  (void) mode;
+}
+
+void HardwareSerial::begin(const unsigned long baudRate)
+{
+  (void) baudRate;
+}
+
+int HardwareSerial::available()
+{
+  return 0;
+}
+
+int HardwareSerial::peek()
+{
+  return -1;
+}
+
+int HardwareSerial::read()
+{
+  return -1;
+}
+
+size_t HardwareSerial::write(const uint8_t datum)
+{
+  (void) datum;
+  bytesWritten = bytesWritten + 1;
+  return 1;
+}
+
+HardwareSerial::operator bool()
+{
+  return true;
+}
+
+void IWatchdogClass::begin(const uint32_t timeout, const uint32_t window)
+{
+  (void) timeout;
+  (void) window;
+}
+
+bool IWatchdogClass::isEnabled()
+{
+  return false;
+}
+
+bool IWatchdogClass::isReset(const bool clear)
+{
+  (void) clear;
+  return false;
+}
+
+void IWatchdogClass::reload()
+{
+}
+
+int File::available()
+{
+  return 0;
+}
+
+void File::close()
+{
+}
+
+void File::flush()
+{
+}
+
+int File::peek()
+{
+  return -1;
+}
+
+int File::read()
+{
+  return -1;
+}
+
+int File::read(void* const buffer, const size_t length)
+{
+  (void) buffer;
+  (void) length;
+  return -1;
+}
+
+bool File::seek(const uint32_t position)
+{
+  (void) position;
+  return false;
+}
+
+uint32_t File::size()
+{
+  return 0;
+}
+
+size_t File::write(const uint8_t datum)
+{
+  (void) datum;
+  return 0;
+}
+
+size_t File::write(const uint8_t* const buffer, const size_t length)
+{
+  (void) buffer;
+  (void) length;
+  return 0;
+}
+
+File::operator bool()
+{
+  return false;
+}
+
+bool SDClass::begin(const uint32_t detect)
+{
+  (void) detect;
+  return false;
+}
+
+File SDClass::open(const char* const filename, const uint8_t mode)
+{
+  (void) filename;
+  (void) mode;
+  return File();
+}
+
+void TwoWire::begin()
+{
+}
+
+void TwoWire::beginTransmission(const uint8_t address)
+{
+  (void) address;
+}
+
+uint8_t TwoWire::endTransmission(const uint8_t sendStop)
+{
+  (void) sendStop;
+  return I2C_NACK_ADDR;
+}
+
+bool TwoWire::isDeviceReady(const uint8_t address, const uint32_t trials)
+{
+  (void) address;
+  (void) trials;
+  return false;
+}
+
+void TwoWire::onReceive(void (* const callback)(int))
+{
+  (void) callback;
+}
+
+void TwoWire::onRequest(void (* const callback)(void))
+{
+  (void) callback;
+}
+
+void TwoWire::onTransfer(const cb_function_transfer_t callback)
+{
+  (void) callback;
+}
+
+uint8_t TwoWire::requestFrom(const uint8_t address,
+                             const uint8_t quantity,
+                             const uint8_t sendStop)
+{
+  (void) address;
+  (void) quantity;
+  (void) sendStop;
+  return 0;
+}
+
+void TwoWire::setClock(const uint32_t frequency)
+{
+  (void) frequency;
+}
+
+int TwoWire::available()
+{
+  return 0;
+}
+
+int TwoWire::peek()
+{
+  return -1;
+}
+
+int TwoWire::read()
+{
+  return -1;
+}
+
+size_t TwoWire::write(const uint8_t datum)
+{
+  (void) datum;
+  return 0;
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+// Thread-based FreeRTOS stand-in for host builds.
+// See include/STM32FreeRTOS.h.
+
+#include <STM32FreeRTOS.h>
+#include <semphr.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A queue or a mutex.  Mutexes keep no items: they track their owner
+// thread and how many times it took them.
+struct QueueDefinition
+{
+  enum Kind
+  {
+    QUEUE,
+    MUTEX,
+    RECURSIVE_MUTEX,
+  };
+
+  Kind kind;
+
+  // Maximum number of items and size of each item (queues only).
+  UBaseType_t length;
+  UBaseType_t itemSize;
+
+  // Items waiting in the queue, oldest first.
+  std::deque<std::vector<unsigned char>> items;
+
+  // Thread holding the mutex (none if nobody holds it) and number of
+  // times it took it.
+  std::thread::id owner;
+  UBaseType_t takes;
+
+  // Guards the fields above.
+  std::mutex lock;
+
+  // Signalled whenever an item comes in or goes out and whenever the
+  // mutex is given back.
+  std::condition_variable changed;
+};
+
+// A task waiting for the scheduler to start.
+struct TaskControlBlock
+{
+  TaskFunction_t code;
+  void* parameters;
+};
+
+// Lock of the critical sections.
+static std::recursive_mutex criticalSection;
+
+// Tasks created so far.
+static std::vector<TaskControlBlock*> tasks;
+
+// One of taskSCHEDULER_NOT_STARTED and taskSCHEDULER_RUNNING.
+static std::atomic<BaseType_t> schedulerState(taskSCHEDULER_NOT_STARTED);
+
+// The tick count starts from here.
+static const std::chrono::steady_clock::time_point startTime =
+  std::chrono::steady_clock::now();
+
+// Wait on the queue until the condition holds or the given number of
+// ticks passes.  Return true if the condition holds.
+template <typename Condition>
+static bool waitUntil(QueueDefinition& queue,
+                      std::unique_lock<std::mutex>& lock,
+                      const TickType_t ticksToWait,
+                      const Condition condition)
+{
+  if (ticksToWait == portMAX_DELAY)
+  {
+    queue.changed.wait(lock, condition);
+    return true;
+  }
+  const std::chrono::milliseconds timeout(ticksToWait * 1000 / configTICK_RATE_HZ);
+  return queue.changed.wait_for(lock, timeout, condition);
+}
+
+static QueueHandle_t createQueue(const QueueDefinition::Kind kind,
+                                 const UBaseType_t length,
+                                 const UBaseType_t itemSize)
+{
+  QueueDefinition* const queue = new QueueDefinition();
+  queue->kind = kind;
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->takes = 0;
+  return queue;
+}
+
+static BaseType_t giveMutex(const SemaphoreHandle_t semaphore)
+{
+  std::unique_lock<std::mutex> lock(semaphore->lock);
+  if (semaphore->owner != std::this_thread::get_id())
+  {
+    return pdFALSE;
+  }
+  semaphore->takes = semaphore->takes - 1;
+  if (semaphore->takes == 0)
+  {
+    semaphore->owner = std::thread::id();
+    semaphore->changed.notify_all();
+  }
+  return pdTRUE;
+}
+
+static BaseType_t takeMutex(const SemaphoreHandle_t semaphore,
+                            const TickType_t ticksToWait)
+{
+  const std::thread::id self = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lock(semaphore->lock);
+  const bool recursive =
+    (semaphore->kind == QueueDefinition::RECURSIVE_MUTEX);
+  const bool taken =
+    waitUntil(*semaphore, lock, ticksToWait, [&]
+              {
+                return (semaphore->owner == std::thread::id())
+                  || (recursive && (semaphore->owner == self));
+              });
+  if (!taken)
+  {
+    return pdFALSE;
+  }
+  semaphore->owner = self;
+  semaphore->takes = semaphore->takes + 1;
+  return pdTRUE;
+}
+
+void vPortEnterCritical()
+{
+  criticalSection.lock();
+}
+
+void vPortExitCritical()
+{
+  criticalSection.unlock();
+}
+
+QueueHandle_t xQueueCreate(const UBaseType_t queueLength,
+                           const UBaseType_t itemSize)
+{
+  return createQueue(QueueDefinition::QUEUE, queueLength, itemSize);
+}
+
+void vQueueDelete(const QueueHandle_t queue)
+{
+  delete queue;
+}
+
+BaseType_t xQueueReceive(const QueueHandle_t queue,
+                         void* const buffer,
+                         const TickType_t ticksToWait)
+{
+  std::unique_lock<std::mutex> lock(queue->lock);
+  const bool received =
+    waitUntil(*queue, lock, ticksToWait, [&]
+              {
+                return !queue->items.empty();
+              });
+  if (!received)
+  {
+    return pdFALSE;
+  }
+  (void) memcpy(buffer, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueSend(const QueueHandle_t queue,
+                      const void* const item,
+                      const TickType_t ticksToWait)
+{
+  std::unique_lock<std::mutex> lock(queue->lock);
+  const bool roomLeft =
+    waitUntil(*queue, lock, ticksToWait, [&]
+              {
+                return queue->items.size() < queue->length;
+              });
+  if (!roomLeft)
+  {
+    return pdFALSE;
+  }
+  const unsigned char* const bytes = (const unsigned char*) item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  return createQueue(QueueDefinition::MUTEX, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+  return createQueue(QueueDefinition::RECURSIVE_MUTEX, 1, 0);
+}
+
+BaseType_t xSemaphoreGive(const SemaphoreHandle_t semaphore)
+{
+  return giveMutex(semaphore);
+}
+
+BaseType_t xSemaphoreGiveRecursive(const SemaphoreHandle_t semaphore)
+{
+  return giveMutex(semaphore);
+}
+
+BaseType_t xSemaphoreTake(const SemaphoreHandle_t semaphore,
+                          const TickType_t ticksToWait)
+{
+  return takeMutex(semaphore, ticksToWait);
+}
+
+BaseType_t xSemaphoreTakeRecursive(const SemaphoreHandle_t semaphore,
+                                   const TickType_t ticksToWait)
+{
+  return takeMutex(semaphore, ticksToWait);
+}
+
+void vSemaphoreDelete(const SemaphoreHandle_t semaphore)
+{
+  delete semaphore;
+}
+
+BaseType_t xTaskCreate(const TaskFunction_t code,
+                       const char* const name,
+                       const uint16_t stackDepth,
+                       void* const parameters,
+                       const UBaseType_t priority,
+                       TaskHandle_t* const createdTask)
+{
+  (void) name;
+  (void) stackDepth;
+  (void) priority;
+  TaskControlBlock* const task = new TaskControlBlock();
+  task->code = code;
+  task->parameters = parameters;
+  if (schedulerState == taskSCHEDULER_RUNNING)
+  {
+    std::thread(code, parameters).detach();
+  }
+  else
+  {
+    tasks.push_back(task);
+  }
+  if (createdTask)
+  {
+    *createdTask = task;
+  }
+  return pdPASS;
+}
+
+void vTaskDelay(const TickType_t ticksToDelay)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticksToDelay * 1000 / configTICK_RATE_HZ));
+}
+
+void vTaskDelete(const TaskHandle_t task)
+{
+  // Threads can't be stopped from outside, so only tasks that haven't
+  // started yet can go.
+  if (schedulerState == taskSCHEDULER_RUNNING)
+  {
+    fprintf(stderr, "vTaskDelete(): the host stand-in can't delete running tasks.\n");
+    abort();
+  }
+  for (std::vector<TaskControlBlock*>::iterator iterator = tasks.begin();
+       iterator != tasks.end();
+       ++iterator)
+  {
+    if (*iterator == task)
+    {
+      (void) tasks.erase(iterator);
+      break;
+    }
+  }
+  delete task;
+}
+
+BaseType_t xTaskGetSchedulerState()
+{
+  return schedulerState;
+}
+
+TickType_t xTaskGetTickCount()
+{
+  const std::chrono::steady_clock::duration elapsedTime =
+    std::chrono::steady_clock::now() - startTime;
+  const long long milliseconds =
+    std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count();
+  return TickType_t(milliseconds * configTICK_RATE_HZ / 1000);
+}
+
+void vTaskStartScheduler()
+{
+  // As on the target, this never returns: the program ends when a
+  // task calls exit().
+  schedulerState = taskSCHEDULER_RUNNING;
+  std::vector<std::thread> threads;
+  for (TaskControlBlock* const task : tasks)
+  {
+    threads.emplace_back(task->code, task->parameters);
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  while (true)
+  {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+}
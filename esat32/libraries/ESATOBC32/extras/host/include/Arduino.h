@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef Arduino_h
+#define Arduino_h
+
+// Host stand-in for the Arduino core for host builds of the OBC
+// library.  It takes the portable parts (strings, streams, math) from
+// the core in esat32/cores/arduino and defines the include guard of
+// the core's Arduino.h, so the core sources compiled for the host pick
+// this header instead.  Time comes from the monotonic clock, the
+// serial ports discard what they get and never receive anything, and
+// the pins read as 0 (see ../ESAT_HostArduino.cpp).
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "binary.h"
+#include "wiring_constants.h"
+#include "WString.h"
+#include "Stream.h"
+#include "WMath.h"
+#include "WInterrupts.h"
+
+// Pins used by the OBC library.
+enum
+{
+  LED_O = 1,
+  ESP0 = 2,
+  ESP_SLEEP = 3,
+  ESP_RST = 4,
+  PWR_ON = 6,
+  ADC12 = 12,
+  ADC13 = 13,
+  ADC14 = 14,
+  GPIO2 = 22,
+};
+
+// Core clock frequency in hertz.
+extern uint32_t SystemCoreClock;
+
+// Core clock cycles since start-up.
+uint32_t dwt_getCycles();
+
+// Interrupts don't exist on the host.
+inline void __disable_irq()
+{
+}
+
+inline void __enable_irq()
+{
+}
+
+void delay(unsigned long milliseconds);
+void delayMicroseconds(unsigned int microseconds);
+unsigned long micros();
+unsigned long millis();
+
+uint32_t analogRead(uint32_t pin);
+int digitalRead(uint32_t pin);
+void digitalWrite(uint32_t pin, uint32_t value);
+void pinMode(uint32_t pin, uint32_t mode);
+
+// Serial port.  Counts the bytes written to it.
+class HardwareSerial: public Stream
+{
+  public:
+    // Number of bytes written so far.
+    unsigned long bytesWritten = 0;
+
+    void begin(unsigned long baudRate);
+    int available();
+    int peek();
+    int read();
+    size_t write(uint8_t datum);
+    using Print::write;
+    operator bool();
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial SerialWifi;
+
+#endif /* Arduino_h */
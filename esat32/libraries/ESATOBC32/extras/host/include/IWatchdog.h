@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef IWatchdog_h
+#define IWatchdog_h
+
+// Host stand-in for the independent watchdog: it never bites.
+
+#include <stdint.h>
+
+class IWatchdogClass
+{
+  public:
+    void begin(uint32_t timeout, uint32_t window = 0);
+    bool isEnabled();
+    bool isReset(bool clear = false);
+    void reload();
+};
+
+extern IWatchdogClass IWatchdog;
+
+#endif /* IWatchdog_h */
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STM32FreeRTOS_h
+#define STM32FreeRTOS_h
+
+// Thread-based stand-in for the STM32duino FreeRTOS library for host
+// builds of ESAT_ConcurrentOnBoardDataHandling.  It provides the part
+// of the FreeRTOS API used by the runtime on top of the C++ standard
+// threads (see ../ESAT_HostFreeRTOS.cpp):
+// - each task is a thread started by vTaskStartScheduler();
+// - queues and mutexes are blocking queues and mutexes with
+//   timeouts;
+// - the tick count runs at 1 kHz off the monotonic clock;
+// - critical sections take one process-wide recursive lock.
+// Task priorities are ignored: the host scheduler decides which thread
+// runs.  Tasks can only be deleted before the scheduler starts.
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef struct QueueDefinition* QueueHandle_t;
+typedef struct TaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE ((BaseType_t) 1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY ((BaseType_t) -1)
+
+#define configTICK_RATE_HZ ((TickType_t) 1000)
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFF)
+#define pdMS_TO_TICKS(milliseconds) \
+  ((TickType_t) (((TickType_t) (milliseconds) * configTICK_RATE_HZ) / 1000))
+
+#define tskIDLE_PRIORITY ((UBaseType_t) 0)
+
+#define taskSCHEDULER_SUSPENDED ((BaseType_t) 0)
+#define taskSCHEDULER_NOT_STARTED ((BaseType_t) 1)
+#define taskSCHEDULER_RUNNING ((BaseType_t) 2)
+
+#define taskENTER_CRITICAL() vPortEnterCritical()
+#define taskEXIT_CRITICAL() vPortExitCritical()
+
+void vPortEnterCritical();
+void vPortExitCritical();
+
+QueueHandle_t xQueueCreate(UBaseType_t queueLength, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueReceive(QueueHandle_t queue,
+                         void* buffer,
+                         TickType_t ticksToWait);
+BaseType_t xQueueSend(QueueHandle_t queue,
+                      const void* item,
+                      TickType_t ticksToWait);
+
+BaseType_t xTaskCreate(TaskFunction_t code,
+                       const char* name,
+                       uint16_t stackDepth,
+                       void* parameters,
+                       UBaseType_t priority,
+                       TaskHandle_t* createdTask);
+void vTaskDelay(TickType_t ticksToDelay);
+void vTaskDelete(TaskHandle_t task);
+BaseType_t xTaskGetSchedulerState();
+TickType_t xTaskGetTickCount();
+void vTaskStartScheduler();
+
+#endif /* STM32FreeRTOS_h */
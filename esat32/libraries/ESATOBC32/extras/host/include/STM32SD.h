@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STM32SD_h
+#define STM32SD_h
+
+// Host stand-in for the STM32SD library: an SD card that is never
+// there.  Opening files fails, so the tables kept in the SD card stay
+// empty.
+
+#include <Arduino.h>
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x02
+#define SD_DETECT_NONE 0
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_ALWAYS 0x10
+
+class File: public Stream
+{
+  public:
+    int available();
+    void close();
+    void flush();
+    int peek();
+    int read();
+    int read(void* buffer, size_t length);
+    bool seek(uint32_t position);
+    uint32_t size();
+    size_t write(uint8_t datum);
+    size_t write(const uint8_t* buffer, size_t length);
+    using Print::write;
+    operator bool();
+};
+
+class SDClass
+{
+  public:
+    bool begin(uint32_t detect = SD_DETECT_NONE);
+    File open(const char* filename, uint8_t mode = FILE_READ);
+};
+
+extern SDClass SD;
+
+#endif /* STM32SD_h */
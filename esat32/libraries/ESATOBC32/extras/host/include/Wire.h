@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TwoWire_h
+#define TwoWire_h
+
+// Host stand-in for the Wire library: an I2C bus with nothing on it.
+// Every transfer fails as if no slave acknowledged its address.
+
+#include <Arduino.h>
+#include <functional>
+
+typedef enum
+{
+  I2C_OK = 0,
+  I2C_DATA_TOO_LONG = 1,
+  I2C_NACK_ADDR = 2,
+  I2C_NACK_DATA = 3,
+  I2C_ERROR = 4,
+  I2C_TIMEOUT = 5,
+  I2C_BUSY = 6
+} i2c_status_e;
+
+class TwoWire: public Stream
+{
+  public:
+    typedef std::function<void(uint8_t, uint8_t, uint16_t, uint32_t)> cb_function_transfer_t;
+
+    void begin();
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(uint8_t sendStop = true);
+    bool isDeviceReady(uint8_t address, uint32_t trials = 1);
+    void onReceive(void (*callback)(int));
+    void onRequest(void (*callback)(void));
+    void onTransfer(cb_function_transfer_t callback);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true);
+    void setClock(uint32_t frequency);
+    int available();
+    int peek();
+    int read();
+    size_t write(uint8_t datum);
+    using Print::write;
+};
+
+extern TwoWire Wire;
+
+#endif /* TwoWire_h */
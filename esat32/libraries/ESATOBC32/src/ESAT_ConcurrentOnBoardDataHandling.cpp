@@ -0,0 +1,620 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_ConcurrentOnBoardDataHandling.h"
+
+#ifdef ESAT_CONCURRENT_ON_BOARD_DATA_HANDLING
+
+byte ESAT_ConcurrentOnBoardDataHandlingClass::allocatePacketBuffer(ESAT_CCSDSPacket& packet)
+{
+  byte index;
+  const BaseType_t gotBuffer =
+    xQueueReceive(freePacketBuffers, &index, pdMS_TO_TICKS(QUEUE_TIMEOUT));
+  if (gotBuffer != pdTRUE)
+  {
+    return NO_PACKET_BUFFER;
+  }
+  PacketBuffer& packetBuffer = packetBuffers[index];
+  packetBuffer.packet.flush();
+  (void) packet.copyTo(packetBuffer.packet);
+  packetBuffer.references = 1;
+  packetBuffer.stored = false;
+  return index;
+}
+
+boolean ESAT_ConcurrentOnBoardDataHandlingClass::begin(const word periodInMilliseconds)
+{
+  // Everything is created up front: the packet buffer pool, the
+  // queues and the tasks.  The subsystem list comes from
+  // ESAT_OnBoardDataHandling, so the main program registers the
+  // subsystems in the same way for both runtimes.  Nothing runs
+  // before the scheduler starts, so on failure everything created
+  // so far can simply be deleted.
+  (void) memset(&statistics, 0, sizeof(statistics));
+  period = pdMS_TO_TICKS(periodInMilliseconds);
+  busMutex = xSemaphoreCreateRecursiveMutex();
+  freePacketBuffers = xQueueCreate(PACKET_POOL_SIZE, sizeof(byte));
+  routerQueue = xQueueCreate(QUEUE_LENGTH, sizeof(byte));
+  storageQueue = xQueueCreate(QUEUE_LENGTH, sizeof(byte));
+  if (!busMutex || !freePacketBuffers || !routerQueue || !storageQueue)
+  {
+    deleteTasksAndQueues();
+    return false;
+  }
+  for (byte index = 0; index < PACKET_POOL_SIZE; index++)
+  {
+    PacketBuffer& packetBuffer = packetBuffers[index];
+    packetBuffer.packet = ESAT_CCSDSPacket(packetBuffer.packetData,
+                                           sizeof(packetBuffer.packetData));
+    packetBuffer.references = 0;
+    (void) xQueueSend(freePacketBuffers, &index, 0);
+  }
+  numberOfSubsystemTasks = 0;
+  storageSubsystemTask = nullptr;
+  for (ESAT_Subsystem* subsystem =
+         ESAT_OnBoardDataHandling.registeredSubsystems();
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    if (numberOfSubsystemTasks >= MAXIMUM_NUMBER_OF_SUBSYSTEMS)
+    {
+      deleteTasksAndQueues();
+      return false;
+    }
+    SubsystemTask& subsystemTask = subsystemTasks[numberOfSubsystemTasks];
+    subsystemTask.subsystem = subsystem;
+    subsystemTask.inbox = xQueueCreate(QUEUE_LENGTH, sizeof(byte));
+    subsystemTask.mutex = xSemaphoreCreateMutex();
+    numberOfSubsystemTasks = numberOfSubsystemTasks + 1;
+    if (!subsystemTask.inbox || !subsystemTask.mutex)
+    {
+      deleteTasksAndQueues();
+      return false;
+    }
+    if (subsystem == storageSubsystem)
+    {
+      storageSubsystemTask = &subsystemTask;
+    }
+  }
+  for (byte index = 0; index < numberOfSubsystemTasks; index++)
+  {
+    SubsystemTask& task = subsystemTasks[index];
+    const BaseType_t created = xTaskCreate(subsystemTask,
+                                           "Subsystem",
+                                           TASK_STACK_SIZE,
+                                           &task,
+                                           SUBSYSTEM_TASK_PRIORITY,
+                                           &task.task);
+    if (created != pdPASS)
+    {
+      deleteTasksAndQueues();
+      return false;
+    }
+  }
+  const BaseType_t routerCreated = xTaskCreate(routerTask,
+                                               "Router",
+                                               TASK_STACK_SIZE,
+                                               nullptr,
+                                               ROUTER_TASK_PRIORITY,
+                                               &routerTaskHandle);
+  if (routerCreated != pdPASS)
+  {
+    deleteTasksAndQueues();
+    return false;
+  }
+  const BaseType_t storageCreated = xTaskCreate(storageTask,
+                                                "Storage",
+                                                TASK_STACK_SIZE,
+                                                nullptr,
+                                                STORAGE_TASK_PRIORITY,
+                                                &storageTaskHandle);
+  if (storageCreated != pdPASS)
+  {
+    deleteTasksAndQueues();
+    return false;
+  }
+  ESAT_I2CBusScheduler.setLock(lockBus, unlockBus, sleepBus);
+  return true;
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::count(unsigned long& counter)
+{
+  taskENTER_CRITICAL();
+  if (counter < 0xFFFFFFFF)
+  {
+    counter = counter + 1;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::deleteTasksAndQueues()
+{
+  // A failed xTaskCreate() leaves its handle untouched, so every
+  // handle that isn't nullptr belongs to something begin() created.
+  if (storageTaskHandle)
+  {
+    vTaskDelete(storageTaskHandle);
+    storageTaskHandle = nullptr;
+  }
+  if (routerTaskHandle)
+  {
+    vTaskDelete(routerTaskHandle);
+    routerTaskHandle = nullptr;
+  }
+  for (byte index = 0; index < numberOfSubsystemTasks; index++)
+  {
+    SubsystemTask& subsystemTask = subsystemTasks[index];
+    if (subsystemTask.task)
+    {
+      vTaskDelete(subsystemTask.task);
+      subsystemTask.task = nullptr;
+    }
+    if (subsystemTask.mutex)
+    {
+      vSemaphoreDelete(subsystemTask.mutex);
+      subsystemTask.mutex = nullptr;
+    }
+    if (subsystemTask.inbox)
+    {
+      vQueueDelete(subsystemTask.inbox);
+      subsystemTask.inbox = nullptr;
+    }
+  }
+  numberOfSubsystemTasks = 0;
+  storageSubsystemTask = nullptr;
+  if (storageQueue)
+  {
+    vQueueDelete(storageQueue);
+    storageQueue = nullptr;
+  }
+  if (routerQueue)
+  {
+    vQueueDelete(routerQueue);
+    routerQueue = nullptr;
+  }
+  if (freePacketBuffers)
+  {
+    vQueueDelete(freePacketBuffers);
+    freePacketBuffers = nullptr;
+  }
+  if (busMutex)
+  {
+    vSemaphoreDelete(busMutex);
+    busMutex = nullptr;
+  }
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::disableUSBTelecommands()
+{
+  usbReader = ESAT_CCSDSPacketFromKISSFrameReader();
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::disableUSBTelemetry()
+{
+  usbWriter = ESAT_CCSDSPacketToKISSFrameWriter();
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::enableUSBTelecommands(byte buffer[],
+                                                                    const unsigned long bufferLength)
+{
+  usbReader = ESAT_CCSDSPacketFromKISSFrameReader(Serial,
+                                                  buffer,
+                                                  bufferLength);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::enableUSBTelemetry()
+{
+  usbWriter = ESAT_CCSDSPacketToKISSFrameWriter(Serial);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::lockBus()
+{
+  // Before the scheduler starts there is only one thread of
+  // execution, so there is nothing to lock.
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+  {
+    return;
+  }
+  (void) xSemaphoreTakeRecursive(ESAT_ConcurrentOnBoardDataHandling.busMutex,
+                                 portMAX_DELAY);
+}
+
+ESAT_ConcurrentOnBoardDataHandlingClass::Statistics ESAT_ConcurrentOnBoardDataHandlingClass::readStatistics()
+{
+  taskENTER_CRITICAL();
+  const Statistics currentStatistics = statistics;
+  taskEXIT_CRITICAL();
+  return currentStatistics;
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::readPacketBuffer(const byte index,
+                                                               ESAT_CCSDSPacket& packet)
+{
+  packet.flush();
+  (void) packetBuffers[index].packet.copyTo(packet);
+  packet.rewind();
+  releasePacketBuffer(index);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::releasePacketBuffer(const byte index)
+{
+  taskENTER_CRITICAL();
+  PacketBuffer& packetBuffer = packetBuffers[index];
+  if (packetBuffer.references > 0)
+  {
+    packetBuffer.references = packetBuffer.references - 1;
+  }
+  const boolean bufferFree = (packetBuffer.references == 0);
+  taskEXIT_CRITICAL();
+  if (bufferFree)
+  {
+    (void) xQueueSend(freePacketBuffers, &index, 0);
+  }
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::routeTelecommand(const byte index,
+                                                               ESAT_CCSDSPacket& packet)
+{
+  // The telecommand goes to the first subsystem that matches its
+  // application process identifier, as in
+  // ESAT_OnBoardDataHandling.dispatchTelecommand().  The reference
+  // of the router passes on to the target subsystem task.
+  packet.rewind();
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
+  for (byte taskIndex = 0; taskIndex < numberOfSubsystemTasks; taskIndex++)
+  {
+    SubsystemTask& subsystemTask = subsystemTasks[taskIndex];
+    ESAT_Subsystem& subsystem = *subsystemTask.subsystem;
+    if (subsystem.getApplicationProcessIdentifier()
+        == primaryHeader.applicationProcessIdentifier)
+    {
+      if (!ESAT_OnBoardDataHandling.isHealthy(subsystem))
+      {
+        break;
+      }
+      const BaseType_t sent =
+        xQueueSend(subsystemTask.inbox,
+                   &index,
+                   pdMS_TO_TICKS(QUEUE_TIMEOUT));
+      if (sent != pdTRUE)
+      {
+        count(statistics.droppedPackets);
+        break;
+      }
+      count(statistics.routedTelecommands);
+      return;
+    }
+  }
+  releasePacketBuffer(index);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::routeTelemetry(const byte index,
+                                                             ESAT_CCSDSPacket& packet)
+{
+  // The packet buffer gets one reference for each target task before
+  // the router sends it, so no target can put it back in the pool
+  // while the router is still sending it to the rest of the targets.
+  // The telemetry for the storage subsystem goes to the storage task.
+  // Only the sinks given by ESAT_TelemetryRoutingTable get the packet.
+  // The router is the only task that sees all the telemetry, so it
+  // keeps the snapshot fields and applies the telemetry policies to
+  // the fresh packets like the sequential runtime does: the snapshot
+  // keeps the fields even of the packets held back by the policies;
+  // stored telemetry goes out as it was stored.
+  if (!packetBuffers[index].stored)
+  {
+    ESAT_TelemetrySnapshot.cache(packet);
+    if (!ESAT_TelemetryPolicyTable.accept(packet))
+    {
+      releasePacketBuffer(index);
+      return;
+    }
+  }
+  const word sinks = ESAT_TelemetryRoutingTable.sinks(packet);
+  QueueHandle_t targets[MAXIMUM_NUMBER_OF_SUBSYSTEMS];
+  byte numberOfTargets = 0;
+  for (byte taskIndex = 0; taskIndex < numberOfSubsystemTasks; taskIndex++)
+  {
+    SubsystemTask& subsystemTask = subsystemTasks[taskIndex];
+    ESAT_Subsystem& subsystem = *subsystemTask.subsystem;
+    const word sink = subsystem.getApplicationProcessIdentifier();
+    if (!ESAT_OnBoardDataHandling.isHealthy(subsystem)
+        || !ESAT_TelemetryRoutingTable.contains(sinks, sink))
+    {
+      continue;
+    }
+    ESAT_TelemetryRoutingTable.count(sink, packet);
+    if (&subsystemTask == storageSubsystemTask)
+    {
+      targets[numberOfTargets] = storageQueue;
+    }
+    else
+    {
+      targets[numberOfTargets] = subsystemTask.inbox;
+    }
+    numberOfTargets = numberOfTargets + 1;
+  }
+  taskENTER_CRITICAL();
+  packetBuffers[index].references =
+    packetBuffers[index].references + numberOfTargets;
+  taskEXIT_CRITICAL();
+  for (byte target = 0; target < numberOfTargets; target++)
+  {
+    const BaseType_t sent =
+      xQueueSend(targets[target], &index, pdMS_TO_TICKS(QUEUE_TIMEOUT));
+    if (sent != pdTRUE)
+    {
+      count(statistics.droppedPackets);
+      releasePacketBuffer(index);
+    }
+  }
+  count(statistics.routedTelemetryPackets);
+  if (ESAT_TelemetryRoutingTable.contains(sinks,
+                                          ESAT_TelemetryRoutingTable.USB_SINK))
+  {
+    packet.rewind();
+    (void) usbWriter.unbufferedWrite(packet);
+    ESAT_TelemetryRoutingTable.count(ESAT_TelemetryRoutingTable.USB_SINK,
+                                     packet);
+  }
+  releasePacketBuffer(index);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::routerTask(void* const parameters)
+{
+  // The router wakes up for each packet coming from the subsystem
+  // tasks and at least once every USB polling period to read the
+  // telecommands from the USB interface.
+  (void) parameters;
+  ESAT_ConcurrentOnBoardDataHandlingClass& runtime =
+    ESAT_ConcurrentOnBoardDataHandling;
+  byte buffer[PACKET_DATA_BUFFER_LENGTH];
+  ESAT_CCSDSPacket packet(buffer, sizeof(buffer));
+  while (true)
+  {
+    byte index;
+    const BaseType_t received =
+      xQueueReceive(runtime.routerQueue,
+                    &index,
+                    pdMS_TO_TICKS(USB_POLLING_PERIOD));
+    if (received == pdTRUE)
+    {
+      packet.flush();
+      (void) runtime.packetBuffers[index].packet.copyTo(packet);
+      if (packet.isTelecommand())
+      {
+        runtime.routeTelecommand(index, packet);
+      }
+      else
+      {
+        runtime.routeTelemetry(index, packet);
+      }
+    }
+    packet.flush();
+    const boolean gotPacket = runtime.usbReader.read(packet);
+    if (gotPacket && packet.isTelecommand())
+    {
+      const byte usbIndex = runtime.allocatePacketBuffer(packet);
+      if (usbIndex == NO_PACKET_BUFFER)
+      {
+        runtime.count(runtime.statistics.droppedPackets);
+      }
+      else
+      {
+        runtime.routeTelecommand(usbIndex, packet);
+      }
+    }
+  }
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::runSubsystemCycle(SubsystemTask& subsystemTask,
+                                                                ESAT_CCSDSPacket& packet)
+{
+  // The subsystem mutex is given back after each step so that the
+  // storage task can write telemetry to the subsystem in between and
+  // the subsystem task never waits for the router while holding it.
+  ESAT_Subsystem& subsystem = *subsystemTask.subsystem;
+  const unsigned long startTime = micros();
+  (void) xSemaphoreTake(subsystemTask.mutex, portMAX_DELAY);
+  ESAT_OnBoardDataHandling.checkHealth(subsystem);
+  const boolean healthy = ESAT_OnBoardDataHandling.isHealthy(subsystem);
+  (void) xSemaphoreGive(subsystemTask.mutex);
+  if (!healthy)
+  {
+    return;
+  }
+  while (true)
+  {
+    packet.flush();
+    (void) xSemaphoreTake(subsystemTask.mutex, portMAX_DELAY);
+    const boolean gotPacket = subsystem.readTelecommand(packet);
+    (void) xSemaphoreGive(subsystemTask.mutex);
+    if (!gotPacket)
+    {
+      break;
+    }
+    if (packet.isTelecommand())
+    {
+      sendToRouter(packet, false);
+    }
+  }
+  (void) xSemaphoreTake(subsystemTask.mutex, portMAX_DELAY);
+  subsystem.update();
+  (void) xSemaphoreGive(subsystemTask.mutex);
+  while (true)
+  {
+    packet.flush();
+    (void) xSemaphoreTake(subsystemTask.mutex, portMAX_DELAY);
+    const boolean gotPacket = subsystem.readTelemetry(packet);
+    const boolean stored = subsystem.latestTelemetryWasStored();
+    (void) xSemaphoreGive(subsystemTask.mutex);
+    if (!gotPacket)
+    {
+      break;
+    }
+    if (packet.isTelemetry())
+    {
+      sendToRouter(packet, stored);
+    }
+  }
+  const unsigned long cycleTime = micros() - startTime;
+  taskENTER_CRITICAL();
+  if (cycleTime > statistics.maximumCycleTime)
+  {
+    statistics.maximumCycleTime = cycleTime;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::sendToRouter(ESAT_CCSDSPacket& packet,
+                                                           const boolean stored)
+{
+  const byte index = allocatePacketBuffer(packet);
+  if (index == NO_PACKET_BUFFER)
+  {
+    count(statistics.droppedPackets);
+    return;
+  }
+  packetBuffers[index].stored = stored;
+  const BaseType_t sent =
+    xQueueSend(routerQueue, &index, pdMS_TO_TICKS(QUEUE_TIMEOUT));
+  if (sent != pdTRUE)
+  {
+    count(statistics.droppedPackets);
+    releasePacketBuffer(index);
+  }
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::serveInbox(SubsystemTask& subsystemTask,
+                                                         const byte index,
+                                                         ESAT_CCSDSPacket& packet)
+{
+  readPacketBuffer(index, packet);
+  ESAT_Subsystem& subsystem = *subsystemTask.subsystem;
+  (void) xSemaphoreTake(subsystemTask.mutex, portMAX_DELAY);
+  if (ESAT_OnBoardDataHandling.isHealthy(subsystem))
+  {
+    if (packet.isTelecommand())
+    {
+      subsystem.handleTelecommand(packet);
+    }
+    else
+    {
+      subsystem.writeTelemetry(packet);
+    }
+  }
+  (void) xSemaphoreGive(subsystemTask.mutex);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::setStorageSubsystem(ESAT_Subsystem& subsystem)
+{
+  storageSubsystem = &subsystem;
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::sleepBus(const unsigned long microseconds)
+{
+  // Tasks waiting for the I2C bus sleep for whole ticks (at least
+  // one) so that the tasks of lower priority, down to the idle task,
+  // get the processor in the meantime.  Before the scheduler starts
+  // there is nobody else to run, so a plain delay will do.
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+  {
+    delay(microseconds / 1000);
+    delayMicroseconds(microseconds % 1000);
+    return;
+  }
+  TickType_t ticks = pdMS_TO_TICKS((microseconds + 999) / 1000);
+  if (ticks == 0)
+  {
+    ticks = 1;
+  }
+  vTaskDelay(ticks);
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::storageTask(void* const parameters)
+{
+  (void) parameters;
+  ESAT_ConcurrentOnBoardDataHandlingClass& runtime =
+    ESAT_ConcurrentOnBoardDataHandling;
+  byte buffer[PACKET_DATA_BUFFER_LENGTH];
+  ESAT_CCSDSPacket packet(buffer, sizeof(buffer));
+  while (true)
+  {
+    byte index;
+    const BaseType_t received =
+      xQueueReceive(runtime.storageQueue, &index, portMAX_DELAY);
+    if (received == pdTRUE)
+    {
+      runtime.serveInbox(*runtime.storageSubsystemTask, index, packet);
+      runtime.count(runtime.statistics.storedTelemetryPackets);
+    }
+  }
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::subsystemTask(void* const parameters)
+{
+  // Between cycles, the task handles the packets arriving at its inbox
+  // as they come.  A cycle that runs past the start of the next one
+  // counts as an overrun, and the next cycle starts right away.
+  SubsystemTask& subsystemTask = *((SubsystemTask*) parameters);
+  ESAT_ConcurrentOnBoardDataHandlingClass& runtime =
+    ESAT_ConcurrentOnBoardDataHandling;
+  byte buffer[PACKET_DATA_BUFFER_LENGTH];
+  ESAT_CCSDSPacket packet(buffer, sizeof(buffer));
+  TickType_t nextCycleTime = xTaskGetTickCount();
+  while (true)
+  {
+    runtime.runSubsystemCycle(subsystemTask, packet);
+    nextCycleTime = nextCycleTime + runtime.period;
+    if (int32_t(xTaskGetTickCount() - nextCycleTime) > 0)
+    {
+      runtime.count(runtime.statistics.cycleOverruns);
+      nextCycleTime = xTaskGetTickCount();
+    }
+    while (true)
+    {
+      const int32_t ticksToNextCycle = int32_t(nextCycleTime - xTaskGetTickCount());
+      if (ticksToNextCycle <= 0)
+      {
+        break;
+      }
+      byte index;
+      const BaseType_t received =
+        xQueueReceive(subsystemTask.inbox, &index, TickType_t(ticksToNextCycle));
+      if (received == pdTRUE)
+      {
+        runtime.serveInbox(subsystemTask, index, packet);
+      }
+    }
+  }
+}
+
+void ESAT_ConcurrentOnBoardDataHandlingClass::unlockBus()
+{
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+  {
+    return;
+  }
+  (void) xSemaphoreGiveRecursive(ESAT_ConcurrentOnBoardDataHandling.busMutex);
+}
+
+ESAT_ConcurrentOnBoardDataHandlingClass ESAT_ConcurrentOnBoardDataHandling;
+
+#endif /* ESAT_CONCURRENT_ON_BOARD_DATA_HANDLING */
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_ConcurrentOnBoardDataHandling_h
+#define ESAT_ConcurrentOnBoardDataHandling_h
+
+// The concurrent runtime is only available when the program uses the
+// STM32duino FreeRTOS library: include <STM32FreeRTOS.h> before this
+// header.  Without it, the rest of the OBC library builds as usual and
+// doesn't pull FreeRTOS into the program.
+#if __has_include(<STM32FreeRTOS.h>)
+#define ESAT_CONCURRENT_ON_BOARD_DATA_HANDLING
+#endif
+
+#ifdef ESAT_CONCURRENT_ON_BOARD_DATA_HANDLING
+
+#include <Arduino.h>
+#include <STM32FreeRTOS.h>
+#include <semphr.h>
+#include <ESAT_CCSDSPacket.h>
+#include <ESAT_CCSDSPacketFromKISSFrameReader.h>
+#include <ESAT_CCSDSPacketToKISSFrameWriter.h>
+#include "ESAT_OnBoardDataHandling.h"
+
+// Concurrent on-board data handling runtime on FreeRTOS.
+// An alternative to the sequential main loop of ESAT_OnBoardDataHandling
+// for the same subsystems (those registered with
+// ESAT_OnBoardDataHandling.registerSubsystem()):
+// - each subsystem gets its own task, which checks the health of the
+//   subsystem (see ESAT_OnBoardDataHandling.checkHealth()), updates it
+//   and reads its telecommands and telemetry once per period, and
+//   handles the packets that arrive for it in between;
+// - a router task takes the telecommands and telemetry from the
+//   subsystem tasks and from the USB interface, sends each telecommand
+//   to the task of its target subsystem and each telemetry packet to
+//   the tasks of all the subsystems and to the USB interface;
+// - a storage task, with the lowest priority, writes the telemetry
+//   packets to the storage subsystem (for example, ESAT_OBCSubsystem,
+//   which keeps them in the SD card), so slow SD card writes run when
+//   nothing else has to.
+// Packets travel between tasks through FreeRTOS queues as indices of
+// a fixed pool of packet buffers, so nothing is allocated after
+// begin().  A slow step (an I2C retry, an SD card write, a Wifi serial
+// write) only delays its own task.  The tasks share the I2C bus through
+// ESAT_I2CBusScheduler, which gets a FreeRTOS mutex as its lock.
+// Use the global instance ESAT_ConcurrentOnBoardDataHandling:
+// register and begin the subsystems, call begin() and then start the
+// FreeRTOS scheduler with vTaskStartScheduler().
+class ESAT_ConcurrentOnBoardDataHandlingClass
+{
+  public:
+    // Handle up to this number of subsystems.
+    static const byte MAXIMUM_NUMBER_OF_SUBSYSTEMS = 8;
+
+    // Maximum packet data length of the packets handled by the runtime.
+    static const word PACKET_DATA_BUFFER_LENGTH = 256;
+
+    // Number of packet buffers shared by all the tasks.
+    static const byte PACKET_POOL_SIZE = 24;
+
+    // Length of the queues between tasks (in packets).
+    static const byte QUEUE_LENGTH = 8;
+
+    // Runtime statistics.  Counters stop at their maximum value
+    // instead of overflowing.
+    struct Statistics
+    {
+      // Number of telecommands sent to their target subsystems.
+      unsigned long routedTelecommands;
+
+      // Number of telemetry packets sent to the subsystems.
+      unsigned long routedTelemetryPackets;
+
+      // Number of telemetry packets written to the storage subsystem.
+      unsigned long storedTelemetryPackets;
+
+      // Number of packets dropped because there was no free packet
+      // buffer or because a queue was full.
+      unsigned long droppedPackets;
+
+      // Number of subsystem cycles that took longer than the period.
+      unsigned long cycleOverruns;
+
+      // Longest subsystem cycle in microseconds.
+      unsigned long maximumCycleTime;
+    };
+
+    // Create the queues and the tasks for the registered subsystems.
+    // Each subsystem task runs once every given number of
+    // milliseconds.
+    // Return true on success; return false if there are too many
+    // subsystems or FreeRTOS ran out of memory.  On failure, the
+    // tasks, queues and mutexes created so far are deleted.
+    boolean begin(word period);
+
+    // Disable reception of telecommands from the USB interface.
+    void disableUSBTelecommands();
+
+    // Disable emission of telemetry through the USB interface.
+    void disableUSBTelemetry();
+
+    // Enable reception of telecommands from the USB interface.  Use
+    // the buffer for accumulating the partially-received telecommands.
+    void enableUSBTelecommands(byte buffer[], unsigned long bufferLength);
+
+    // Enable emission of telemetry through the USB interface.
+    void enableUSBTelemetry();
+
+    // Return the runtime statistics.
+    Statistics readStatistics();
+
+    // Hand the telemetry writes of the given subsystem to the storage
+    // task.  Call this before begin().
+    void setStorageSubsystem(ESAT_Subsystem& subsystem);
+
+  private:
+    // Bookkeeping of a subsystem task.
+    struct SubsystemTask
+    {
+      // The subsystem run by the task.
+      ESAT_Subsystem* subsystem;
+
+      // Packets for the subsystem: telecommands to handle and
+      // telemetry to write.
+      QueueHandle_t inbox = nullptr;
+
+      // Held while a task uses the subsystem.
+      SemaphoreHandle_t mutex = nullptr;
+
+      // Task handle.
+      TaskHandle_t task = nullptr;
+    };
+
+    // A packet buffer of the pool.
+    struct PacketBuffer
+    {
+      // Packet data of the packet.
+      byte packetData[PACKET_DATA_BUFFER_LENGTH];
+
+      // Packet backed by packetData.
+      ESAT_CCSDSPacket packet;
+
+      // Number of tasks yet to read the packet.  The buffer goes back
+      // to the pool when this drops to 0.
+      byte references;
+
+      // True if the packet is telemetry that the storage subsystem
+      // read back from its storage instead of fresh telemetry.
+      boolean stored;
+    };
+
+    // Priority of the router task.
+    static const UBaseType_t ROUTER_TASK_PRIORITY = tskIDLE_PRIORITY + 3;
+
+    // Priority of the subsystem tasks.
+    static const UBaseType_t SUBSYSTEM_TASK_PRIORITY = tskIDLE_PRIORITY + 2;
+
+    // Priority of the storage task.
+    static const UBaseType_t STORAGE_TASK_PRIORITY = tskIDLE_PRIORITY + 1;
+
+    // Stack size of the tasks (in words).
+    static const word TASK_STACK_SIZE = 512;
+
+    // The router task polls the USB interface for telecommands once
+    // every this number of milliseconds.
+    static const word USB_POLLING_PERIOD = 10;
+
+    // Wait up to this number of milliseconds for a free packet
+    // buffer or for room in a full queue before dropping a packet.
+    static const word QUEUE_TIMEOUT = 100;
+
+    // Index returned when there are no free packet buffers.
+    static const byte NO_PACKET_BUFFER = 0xFF;
+
+    // Recursive mutex that ESAT_I2CBusScheduler uses as its lock.
+    SemaphoreHandle_t busMutex = nullptr;
+
+    // Queue of indices of free packet buffers.
+    QueueHandle_t freePacketBuffers = nullptr;
+
+    // Number of subsystem tasks.
+    byte numberOfSubsystemTasks = 0;
+
+    // Packet buffer pool.
+    PacketBuffer packetBuffers[PACKET_POOL_SIZE];
+
+    // Period of the subsystem tasks in ticks.
+    TickType_t period;
+
+    // Telecommands and telemetry packets going to the router.
+    QueueHandle_t routerQueue = nullptr;
+
+    // Handle of the router task.
+    TaskHandle_t routerTaskHandle = nullptr;
+
+    // Runtime statistics.
+    Statistics statistics;
+
+    // Telemetry packets going to the storage subsystem.
+    QueueHandle_t storageQueue = nullptr;
+
+    // Subsystem whose telemetry writes run in the storage task
+    // or nullptr.
+    ESAT_Subsystem* storageSubsystem = nullptr;
+
+    // Task of the storage subsystem or nullptr.
+    SubsystemTask* storageSubsystemTask = nullptr;
+
+    // Handle of the storage task.
+    TaskHandle_t storageTaskHandle = nullptr;
+
+    // Subsystem tasks.
+    SubsystemTask subsystemTasks[MAXIMUM_NUMBER_OF_SUBSYSTEMS];
+
+    // Use this to read packets from the USB interface.
+    ESAT_CCSDSPacketFromKISSFrameReader usbReader;
+
+    // Use this to write packets to the USB interface.
+    ESAT_CCSDSPacketToKISSFrameWriter usbWriter;
+
+    // Take a free packet buffer, copy the packet into it and return
+    // the index of the buffer with one reference.
+    // Return NO_PACKET_BUFFER if there are no free packet buffers.
+    byte allocatePacketBuffer(ESAT_CCSDSPacket& packet);
+
+    // Increment a counter without overflowing it.
+    void count(unsigned long& counter);
+
+    // Delete the tasks, queues and mutexes created by begin().
+    void deleteTasksAndQueues();
+
+    // Take and give back the I2C bus lock (for ESAT_I2CBusScheduler).
+    static void lockBus();
+    static void unlockBus();
+
+    // Copy the packet of the given packet buffer into the given packet
+    // and drop one reference to the buffer.
+    void readPacketBuffer(byte index, ESAT_CCSDSPacket& packet);
+
+    // Drop one reference to the packet buffer with the given index.
+    // Return the buffer to the pool when nobody else references it.
+    void releasePacketBuffer(byte index);
+
+    // Send the telecommand in the given packet buffer to the task of
+    // its target subsystem.
+    void routeTelecommand(byte index, ESAT_CCSDSPacket& packet);
+
+    // Send the telemetry packet in the given packet buffer to the
+    // tasks of all the healthy subsystems and to the USB interface.
+    // Fresh telemetry goes to ESAT_TelemetrySnapshot and goes out
+    // only if ESAT_TelemetryPolicyTable accepts it, as in
+    // ESAT_OnBoardDataHandling.writeTelemetry().
+    void routeTelemetry(byte index, ESAT_CCSDSPacket& packet);
+
+    // Body of the router task.
+    static void routerTask(void* parameters);
+
+    // Do one cycle of a subsystem task: check the health of the
+    // subsystem, update it and send its telecommands and telemetry
+    // to the router.
+    void runSubsystemCycle(SubsystemTask& subsystemTask,
+                           ESAT_CCSDSPacket& packet);
+
+    // Send the packet to the router, marked as stored telemetry if
+    // stored is true.  Count it as dropped on failure.
+    void sendToRouter(ESAT_CCSDSPacket& packet, boolean stored);
+
+    // Handle one packet arriving at a subsystem task.
+    void serveInbox(SubsystemTask& subsystemTask,
+                    byte index,
+                    ESAT_CCSDSPacket& packet);
+
+    // Sleep while waiting for the I2C bus (for ESAT_I2CBusScheduler).
+    static void sleepBus(unsigned long microseconds);
+
+    // Body of the storage task.
+    static void storageTask(void* parameters);
+
+    // Body of the subsystem tasks.
+    static void subsystemTask(void* parameters);
+};
+
+// Global instance of the concurrent on-board data handling library.
+extern ESAT_ConcurrentOnBoardDataHandlingClass ESAT_ConcurrentOnBoardDataHandling;
+
+#endif /* ESAT_CONCURRENT_ON_BOARD_DATA_HANDLING */
+
+#endif /* ESAT_ConcurrentOnBoardDataHandling_h */
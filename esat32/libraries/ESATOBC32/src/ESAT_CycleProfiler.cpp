@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_CycleProfiler.h"
+#include <ESAT_Timer.h>
+
+void ESAT_CycleProfilerClass::beginCycle()
+{
+  if (!ENABLED)
+  {
+    return;
+  }
+  cycleStartTime = start();
+  cycleInProgress = true;
+}
+
+void ESAT_CycleProfilerClass::endCycle()
+{
+  // Phases measured outside a cycle (for example, telecommands
+  // handled between cycles in event-driven mode) count in the next
+  // cycle.
+  if (!ENABLED || !cycleInProgress)
+  {
+    return;
+  }
+  const unsigned long busyTime = microseconds(start() - cycleStartTime);
+  cycleInProgress = false;
+  update(cycleProbe, busyTime);
+  for (byte index = 0; index < numberOfProbes; index++)
+  {
+    Probe& probe = probeTable[index];
+    if (probe.cyclesThisCycle > 0)
+    {
+      update(probe, microseconds(probe.cyclesThisCycle));
+      probe.cyclesThisCycle = 0;
+    }
+  }
+  const unsigned long period = 1000UL * ESAT_Timer.period;
+  byte bin = HISTOGRAM_BINS - 1;
+  if ((period > 0) && (busyTime < period))
+  {
+    bin = byte((HISTOGRAM_BINS * (unsigned long long) busyTime) / period);
+  }
+  histogramBins[histogramPosition] = bin;
+  histogramPosition = (histogramPosition + 1) % HISTOGRAM_WINDOW;
+  if (histogramEntries < HISTOGRAM_WINDOW)
+  {
+    histogramEntries = histogramEntries + 1;
+  }
+}
+
+byte ESAT_CycleProfilerClass::histogram(const byte bin) const
+{
+  byte count = 0;
+  for (byte index = 0; index < histogramEntries; index++)
+  {
+    if (histogramBins[index] == bin)
+    {
+      count = count + 1;
+    }
+  }
+  return count;
+}
+
+unsigned long ESAT_CycleProfilerClass::microseconds(const unsigned long cycles) const
+{
+  const unsigned long cyclesPerMicrosecond = SystemCoreClock / 1000000;
+  if (cyclesPerMicrosecond == 0)
+  {
+    return cycles;
+  }
+  return cycles / cyclesPerMicrosecond;
+}
+
+byte ESAT_CycleProfilerClass::probes() const
+{
+  return numberOfProbes;
+}
+
+ESAT_CycleProfilerClass::Statistics ESAT_CycleProfilerClass::readCycleStatistics() const
+{
+  return statistics(cycleProbe);
+}
+
+ESAT_CycleProfilerClass::Statistics ESAT_CycleProfilerClass::readProbeStatistics(const byte index) const
+{
+  if (index < numberOfProbes)
+  {
+    return statistics(probeTable[index]);
+  }
+  const Probe emptyProbe = {0xFF, 0xFF, 0, 0, 0xFFFFFFFF, 0, 0};
+  return statistics(emptyProbe);
+}
+
+void ESAT_CycleProfilerClass::record(const byte phase,
+                                     const byte instance,
+                                     const unsigned long cycles)
+{
+  for (byte index = 0; index < numberOfProbes; index++)
+  {
+    Probe& probe = probeTable[index];
+    if ((probe.phase == phase) && (probe.instance == instance))
+    {
+      probe.cyclesThisCycle = probe.cyclesThisCycle + cycles;
+      return;
+    }
+  }
+  if (numberOfProbes >= MAXIMUM_NUMBER_OF_PROBES)
+  {
+    return;
+  }
+  const Probe newProbe = {phase, instance, cycles, 0, 0xFFFFFFFF, 0, 0};
+  probeTable[numberOfProbes] = newProbe;
+  numberOfProbes = numberOfProbes + 1;
+}
+
+ESAT_CycleProfilerClass::Statistics ESAT_CycleProfilerClass::statistics(const Probe& probe) const
+{
+  Statistics result;
+  result.phase = probe.phase;
+  result.instance = probe.instance;
+  result.cycles = probe.cycles;
+  if (probe.cycles == 0)
+  {
+    result.minimum = 0;
+    result.mean = 0;
+    result.maximum = 0;
+  }
+  else
+  {
+    result.minimum = probe.minimum;
+    result.mean = probe.total / probe.cycles;
+    result.maximum = probe.maximum;
+  }
+  return result;
+}
+
+void ESAT_CycleProfilerClass::update(Probe& probe, const unsigned long time)
+{
+  if (probe.cycles < 0xFFFFFFFF)
+  {
+    probe.cycles = probe.cycles + 1;
+    probe.total = probe.total + time;
+  }
+  if (time < probe.minimum)
+  {
+    probe.minimum = time;
+  }
+  if (time > probe.maximum)
+  {
+    probe.maximum = time;
+  }
+}
+
+ESAT_CycleProfilerClass ESAT_CycleProfiler;
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_CycleProfiler_h
+#define ESAT_CycleProfiler_h
+
+#include <Arduino.h>
+#include "ESAT_CycleProfilerConfiguration.h"
+
+// Profiler of the on-board data handling cycle.
+// Use the global instance ESAT_CycleProfiler.
+//
+// The profiler measures time with the DWT cycle counter of the
+// processor.  ESAT_OnBoardDataHandling measures each phase of the
+// cycle (telecommand reads, telecommand dispatch, update and telemetry
+// reads of each subsystem and telemetry writes to each sink) with
+// start() and stop(); the main program marks the cycle boundaries
+// with beginCycle() and endCycle().  The profiler adds up the time
+// of each phase during the cycle and keeps the minimum, mean and
+// maximum time per cycle of each phase, the same statistics of the
+// busy time of the whole cycle and a histogram of the busy time of
+// the last HISTOGRAM_WINDOW cycles relative to the ESAT_Timer period.
+//
+// The profiler is disabled by default: then, it measures nothing,
+// its calls compile to nothing and it keeps no tables.  Enable it by
+// defining the ESAT_CYCLE_PROFILER macro in
+// ESAT_CycleProfilerConfiguration.h, which every file that includes
+// this header sees alike.
+class ESAT_CycleProfilerClass
+{
+  public:
+    // Phases of the on-board data handling cycle.
+    enum Phase
+    {
+      // Telecommand reads from a subsystem or from the USB interface.
+      TELECOMMAND_READ_PHASE = 0,
+      // Telecommand dispatch to a subsystem.
+      TELECOMMAND_DISPATCH_PHASE = 1,
+      // Update of a subsystem.
+      UPDATE_PHASE = 2,
+      // Telemetry reads from a subsystem.
+      TELEMETRY_READ_PHASE = 3,
+      // Telemetry writes to a sink.
+      TELEMETRY_WRITE_PHASE = 4,
+    };
+
+    // Statistics of the busy time per cycle.
+    // Times are in microseconds.
+    struct Statistics
+    {
+      // Phase (one of the Phase values) or 0xFF for the whole cycle.
+      byte phase;
+
+      // Application process identifier (subsystems) or sink number
+      // (sinks); 0xFF for the whole cycle.
+      byte instance;
+
+      // Number of cycles with measurements.
+      unsigned long cycles;
+
+      // Shortest time per cycle.
+      unsigned long minimum;
+
+      // Mean time per cycle.
+      unsigned long mean;
+
+      // Longest time per cycle.
+      unsigned long maximum;
+    };
+
+#ifdef ESAT_CYCLE_PROFILER
+    // True when the profiler is compiled in; false otherwise.
+    static const boolean ENABLED = true;
+#else
+    // True when the profiler is compiled in; false otherwise.
+    static const boolean ENABLED = false;
+#endif
+
+    // Number of histogram bins.  Each bin spans an equal fraction of
+    // the ESAT_Timer period; the last bin also takes the overruns.
+    static const byte HISTOGRAM_BINS = 8;
+
+    // Number of cycles of the histogram.
+    // The disabled profiler keeps no history.
+    static const byte HISTOGRAM_WINDOW = ENABLED ? 64 : 1;
+
+    // Maximum number of measured phases (phase and instance pairs).
+    // Measurements of further phases are ignored.
+    // The disabled profiler keeps no measurements.
+    static const byte MAXIMUM_NUMBER_OF_PROBES = ENABLED ? 24 : 1;
+
+    // Mark the start of a cycle.
+    void beginCycle();
+
+    // Mark the end of a cycle and update the statistics.
+    void endCycle();
+
+    // Return the number of cycles of the last HISTOGRAM_WINDOW cycles
+    // that fall in the given histogram bin.
+    byte histogram(byte bin) const;
+
+    // Return the number of measured phases.
+    byte probes() const;
+
+    // Return the busy time statistics of the whole cycle.
+    Statistics readCycleStatistics() const;
+
+    // Return the statistics of the measured phase with the given index
+    // (from 0 to probes() - 1).
+    Statistics readProbeStatistics(byte index) const;
+
+    // Return the start time of a measurement, to be passed to stop().
+    unsigned long start()
+    {
+#ifdef ESAT_CYCLE_PROFILER
+      return dwt_getCycles();
+#else
+      return 0;
+#endif
+    }
+
+    // Add the time since the given start time (as returned by
+    // start()) to the given phase of the given instance.
+    void stop(byte phase, byte instance, unsigned long startTime)
+    {
+#ifdef ESAT_CYCLE_PROFILER
+      record(phase, instance, dwt_getCycles() - startTime);
+#else
+      (void) phase;
+      (void) instance;
+      (void) startTime;
+#endif
+    }
+
+  private:
+    // Measurements of a phase.
+    struct Probe
+    {
+      // One of the Phase values.
+      byte phase;
+
+      // Application process identifier or sink number.
+      byte instance;
+
+      // Processor cycles spent in the phase during the current cycle.
+      unsigned long cyclesThisCycle;
+
+      // Number of cycles with measurements.
+      unsigned long cycles;
+
+      // Shortest time per cycle in microseconds.
+      unsigned long minimum;
+
+      // Longest time per cycle in microseconds.
+      unsigned long maximum;
+
+      // Total time in microseconds.
+      unsigned long long total;
+    };
+
+    // Value of the processor cycle counter at the start of the cycle.
+    unsigned long cycleStartTime = 0;
+
+    // True between beginCycle() and endCycle(); false otherwise.
+    boolean cycleInProgress = false;
+
+    // Busy time statistics of the whole cycle.
+    Probe cycleProbe = {0xFF, 0xFF, 0, 0, 0xFFFFFFFF, 0, 0};
+
+    // Histogram bins of the last HISTOGRAM_WINDOW cycles.
+    byte histogramBins[HISTOGRAM_WINDOW];
+
+    // Next position of histogramBins.
+    byte histogramPosition = 0;
+
+    // Number of valid entries of histogramBins.
+    byte histogramEntries = 0;
+
+    // Number of measured phases.
+    byte numberOfProbes = 0;
+
+    // Measured phases.
+    Probe probeTable[MAXIMUM_NUMBER_OF_PROBES];
+
+    // Return the given number of processor cycles in microseconds.
+    unsigned long microseconds(unsigned long cycles) const;
+
+    // Add the given number of processor cycles to the given phase of
+    // the given instance.
+    void record(byte phase, byte instance, unsigned long cycles);
+
+    // Return the statistics of the given probe.
+    Statistics statistics(const Probe& probe) const;
+
+    // Add the time of the current cycle to the statistics of the given
+    // probe.
+    void update(Probe& probe, unsigned long time);
+};
+
+// Global instance of the cycle profiler.
+extern ESAT_CycleProfilerClass ESAT_CycleProfiler;
+
+#endif /* ESAT_CycleProfiler_h */
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_CycleProfilerConfiguration_h
+#define ESAT_CycleProfilerConfiguration_h
+
+// Build configuration of ESAT_CycleProfiler.
+//
+// The profiler changes the layout of ESAT_CycleProfilerClass and the
+// code of its inline functions, so every file of the program must
+// see the same configuration.  This header is that single place:
+// ESAT_CycleProfiler.h includes it, so change the configuration here
+// instead of defining the macro in a sketch or in a single file.
+
+// Uncomment this line to compile the cycle profiler in.
+// #define ESAT_CYCLE_PROFILER
+
+#endif /* ESAT_CycleProfilerConfiguration_h */
@@ -29,6 +29,7 @@
 // is passed to Arduino ("ADCS code running in: ADCS").
 
 #ifdef ESAT_ADCS_CODE_RUNNING_IN_ADCS
+#include <ESAT_I2CBusScheduler.h>
 #include <ESAT_I2CMaster.h>
 #else
 //#include <ESAT_ADCS.h>
@@ -43,6 +44,8 @@ void ESAT_ADCSSubsystemClass::begin()
   // soon as we know the ADCS board is ready: upon reception of the
   // first telemetry packet.
   timeIsSet = false;
+  (void) ESAT_I2CBusScheduler.configure(ADDRESS,
+                                        ESAT_I2CBusScheduler.HOUSEKEEPING_PRIORITY);
 #else
 //  ESAT_ADCS.begin();
 //  setTime();
@@ -67,6 +70,45 @@ void ESAT_ADCSSubsystemClass::handleTelecommand(ESAT_CCSDSPacket& packet)
 #endif /* ESAT_ADCS_CODE_RUNNING_IN_ADCS */
 }
 
+boolean ESAT_ADCSSubsystemClass::probe()
+{
+#ifdef ESAT_ADCS_CODE_RUNNING_IN_ADCS
+  return ESAT_I2CMaster.probe(ADDRESS);
+#else
+  return true;
+#endif /* ESAT_ADCS_CODE_RUNNING_IN_ADCS */
+}
+
+ESAT_Subsystem::TelemetryPollResult ESAT_ADCSSubsystemClass::pollTelemetry(ESAT_CCSDSPacket& packet)
+{
+#ifdef ESAT_ADCS_CODE_RUNNING_IN_ADCS
+  const ESAT_I2CMasterClass::PollResult result =
+    ESAT_I2CMaster.pollNextTelemetry(packet, ADDRESS);
+  switch (result)
+  {
+    case ESAT_I2CMaster.PACKET_RECEIVED:
+      // The ADCS board is ready, so we can set the time if we
+      // haven't done it yet.
+      if (!timeIsSet)
+      {
+        setTime();
+        timeIsSet = true;
+      }
+      return TELEMETRY_PACKET_READ;
+      break;
+    case ESAT_I2CMaster.PACKET_PENDING:
+      return TELEMETRY_PACKET_PENDING;
+      break;
+    default:
+      return NO_TELEMETRY_PACKET;
+      break;
+  }
+#else
+  (void) packet;
+  return NO_TELEMETRY_PACKET;
+#endif /* ESAT_ADCS_CODE_RUNNING_IN_ADCS */
+}
+
 boolean ESAT_ADCSSubsystemClass::readTelecommand(ESAT_CCSDSPacket& packet)
 {
   (void) packet;
@@ -91,6 +133,15 @@ boolean ESAT_ADCSSubsystemClass::readTelemetry(ESAT_CCSDSPacket& packet)
 #endif /* ESAT_ADCS_CODE_RUNNING_IN_ADCS */
 }
 
+boolean ESAT_ADCSSubsystemClass::requestTelemetry()
+{
+#ifdef ESAT_ADCS_CODE_RUNNING_IN_ADCS
+  return ESAT_I2CMaster.requestNextTelemetry(ADDRESS);
+#else
+  return false;
+#endif /* ESAT_ADCS_CODE_RUNNING_IN_ADCS */
+}
+
 void ESAT_ADCSSubsystemClass::setTime()
 {
   // Build and send a telecommand to set the ADCS time.
@@ -57,6 +57,18 @@ class ESAT_ADCSSubsystemClass: public ESAT_Subsystem
     // otherwise return false.
     boolean readTelemetry(ESAT_CCSDSPacket& packet);
 
+    // Return true if the board acknowledges its I2C address;
+    // otherwise return false.
+    boolean probe();
+
+    // Look once at the telemetry request made with requestTelemetry()
+    // and fill the packet with the telemetry packet if it is ready.
+    TelemetryPollResult pollTelemetry(ESAT_CCSDSPacket& packet);
+
+    // Ask for the next telemetry packet without waiting for it.
+    // Return true if the request went out; otherwise return false.
+    boolean requestTelemetry();
+
     // Deprecated method; don't use it.
     // Return true if there is new telemetry available;
     // Otherwise return false.
@@ -20,11 +20,16 @@
 
 #include "ESAT_OBC-subsystems/ESAT_COMSubsystem.h"
 #include "ESAT_OBC-hardware/ESAT_OBCClock.h"
+#include <ESAT_I2CBusScheduler.h>
 #include <ESAT_I2CMaster.h>
 
 void ESAT_COMSubsystemClass::begin()
 {
-    setTime();
+  // Telemetry forwarded to the COM board is bulk traffic: it must
+  // not delay more urgent users of the I2C bus.
+  (void) ESAT_I2CBusScheduler.configure(ADDRESS,
+                                        ESAT_I2CBusScheduler.BULK_PRIORITY);
+  setTime();
 }
 
 word ESAT_COMSubsystemClass::getApplicationProcessIdentifier()
@@ -41,6 +46,29 @@ void ESAT_COMSubsystemClass::handleTelecommand(ESAT_CCSDSPacket& packet)
                                     MICROSECONDS_BETWEEN_CHUNKS);
 }
 
+boolean ESAT_COMSubsystemClass::probe()
+{
+  return ESAT_I2CMaster.probe(ADDRESS);
+}
+
+ESAT_Subsystem::TelemetryPollResult ESAT_COMSubsystemClass::pollTelemetry(ESAT_CCSDSPacket& packet)
+{
+  const ESAT_I2CMasterClass::PollResult result =
+    ESAT_I2CMaster.pollNextTelemetry(packet, ADDRESS);
+  switch (result)
+  {
+    case ESAT_I2CMaster.PACKET_RECEIVED:
+      return TELEMETRY_PACKET_READ;
+      break;
+    case ESAT_I2CMaster.PACKET_PENDING:
+      return TELEMETRY_PACKET_PENDING;
+      break;
+    default:
+      return NO_TELEMETRY_PACKET;
+      break;
+  }
+}
+
 boolean ESAT_COMSubsystemClass::readTelecommand(ESAT_CCSDSPacket& packet)
 {
   // We read telecommand packets from the COM board with our
@@ -54,6 +82,18 @@ boolean ESAT_COMSubsystemClass::readTelemetry(ESAT_CCSDSPacket& packet)
 	return ESAT_I2CMaster.readNextTelemetry(packet, ADDRESS);
 }
 
+boolean ESAT_COMSubsystemClass::requestTelemetry()
+{
+  return ESAT_I2CMaster.requestNextTelemetry(ADDRESS);
+}
+
+void ESAT_COMSubsystemClass::setI2CTimeSlot(const unsigned long timeSlot)
+{
+  (void) ESAT_I2CBusScheduler.configure(ADDRESS,
+                                        ESAT_I2CBusScheduler.BULK_PRIORITY,
+                                        timeSlot);
+}
+
 void ESAT_COMSubsystemClass::setTime()
 {
   // To set the time of the COM board, we send it the telecommand to
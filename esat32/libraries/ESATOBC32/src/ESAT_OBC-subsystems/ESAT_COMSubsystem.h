@@ -52,6 +52,24 @@ class ESAT_COMSubsystemClass: public ESAT_Subsystem
     // otherwise return false.
     boolean readTelemetry(ESAT_CCSDSPacket& packet);
 
+    // Return true if the board acknowledges its I2C address;
+    // otherwise return false.
+    boolean probe();
+
+    // Look once at the telemetry request made with requestTelemetry()
+    // and fill the packet with the telemetry packet if it is ready.
+    TelemetryPollResult pollTelemetry(ESAT_CCSDSPacket& packet);
+
+    // Ask for the next telemetry packet without waiting for it.
+    // Return true if the request went out; otherwise return false.
+    boolean requestTelemetry();
+
+    // Let the COM board use the I2C bus for at most the given number
+    // of microseconds per ESAT_I2CBusScheduler cycle, so forwarding
+    // telemetry to it leaves bus time for the rest of the boards.
+    // Call this after begin().
+    void setI2CTimeSlot(unsigned long timeSlot);
+
     // Handles the periodic tasks required for a proper operation
     // of the subsystem.
     void update();
@@ -20,6 +20,7 @@
 
 #include "ESAT_OBC-subsystems/ESAT_EPSSubsystem.h"
 #include "ESAT_OBCClock.h"
+#include <ESAT_I2CBusScheduler.h>
 #include <ESAT_I2CMaster.h>
 
 void ESAT_EPSSubsystemClass::begin()
@@ -29,6 +30,11 @@ void ESAT_EPSSubsystemClass::begin()
   // In addition, we want to start with the EPS clock in sync with the
   // OBC clock.
   newTelemetryPacket = false;
+  (void) ESAT_I2CBusScheduler.configure(ADDRESS,
+                                        ESAT_I2CBusScheduler.HOUSEKEEPING_PRIORITY);
+  protocolVersionNumber = ESAT_SemanticVersionNumber(0, 0, 0);
+  protocolVersionNumberKnown = false;
+  (void) probe();
   setTime();
 }
 
@@ -46,6 +52,47 @@ void ESAT_EPSSubsystemClass::handleTelecommand(ESAT_CCSDSPacket& packet)
                                     MICROSECONDS_BETWEEN_CHUNKS);
 }
 
+boolean ESAT_EPSSubsystemClass::preliminaryProtocol()
+{
+  if (!protocolVersionNumberKnown)
+  {
+    (void) probe();
+  }
+  return protocolVersionNumber == ESAT_SemanticVersionNumber(0, 0, 0);
+}
+
+boolean ESAT_EPSSubsystemClass::probe()
+{
+  // The protocol version number doesn't change while the EPS board
+  // is running, so we read it just once, when the board first
+  // answers.
+  const boolean answered = ESAT_I2CMaster.probe(ADDRESS);
+  if (answered && !protocolVersionNumberKnown)
+  {
+    protocolVersionNumber = ESAT_I2CMaster.readProtocolVersionNumber(ADDRESS);
+    protocolVersionNumberKnown = true;
+  }
+  return answered;
+}
+
+ESAT_Subsystem::TelemetryPollResult ESAT_EPSSubsystemClass::pollTelemetry(ESAT_CCSDSPacket& packet)
+{
+  const ESAT_I2CMasterClass::PollResult result =
+    ESAT_I2CMaster.pollNextTelemetry(packet, ADDRESS);
+  switch (result)
+  {
+    case ESAT_I2CMaster.PACKET_RECEIVED:
+      return TELEMETRY_PACKET_READ;
+      break;
+    case ESAT_I2CMaster.PACKET_PENDING:
+      return TELEMETRY_PACKET_PENDING;
+      break;
+    default:
+      return NO_TELEMETRY_PACKET;
+      break;
+  }
+}
+
 boolean ESAT_EPSSubsystemClass::readTelecommand(ESAT_CCSDSPacket& packet)
 {
   // The EPS board doesn't produce telecommands at this moment.
@@ -60,9 +107,7 @@ boolean ESAT_EPSSubsystemClass::readTelemetry(ESAT_CCSDSPacket& packet)
   // If the protocol version number is 0.0.0, we will request just one
   // housekeeping telemetry packet per cycle; for newer protocol
   // versions, we will do a next-packet telemetry request.
-  const ESAT_SemanticVersionNumber protocolVersionNumber =
-    ESAT_I2CMaster.readProtocolVersionNumber(ADDRESS);
-  if (protocolVersionNumber == ESAT_SemanticVersionNumber(0, 0, 0))
+  if (preliminaryProtocol())
   {
     if (newTelemetryPacket)
     {
@@ -82,6 +127,18 @@ boolean ESAT_EPSSubsystemClass::readTelemetry(ESAT_CCSDSPacket& packet)
   }
 }
 
+boolean ESAT_EPSSubsystemClass::requestTelemetry()
+{
+  // The preliminary (0.0.0) version of our I2C protocol didn't
+  // support next-packet telemetry requests, so the EPS boards
+  // with that version go through readTelemetry().
+  if (preliminaryProtocol())
+  {
+    return false;
+  }
+  return ESAT_I2CMaster.requestNextTelemetry(ADDRESS);
+}
+
 void ESAT_EPSSubsystemClass::setTime()
 {
   // To set the time of the EPS board, we send it the telecommand to
@@ -117,9 +174,7 @@ void ESAT_EPSSubsystemClass::update()
   // housekeeping telemetry packet per cycle; for newer protocol
   // versions, we will start a new series of next-packet telemetry
   // requests.
-  const ESAT_SemanticVersionNumber protocolVersionNumber =
-    ESAT_I2CMaster.readProtocolVersionNumber(ADDRESS);
-  if (protocolVersionNumber == ESAT_SemanticVersionNumber(0, 0, 0))
+  if (preliminaryProtocol())
   {
     newTelemetryPacket = true;
   }
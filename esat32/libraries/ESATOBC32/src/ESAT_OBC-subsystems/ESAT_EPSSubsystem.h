@@ -23,6 +23,7 @@
 
 #include <Arduino.h>
 #include "ESAT_OBC-subsystems/ESAT_Subsystem.h"
+#include <ESAT_SemanticVersionNumber.h>
 
 // Interface to the EPS (electrical power subsystem) from the point of
 // view of the on-board data handling subsystem.  There is a global
@@ -54,6 +55,18 @@ class ESAT_EPSSubsystemClass: public ESAT_Subsystem
     // otherwise return false.
     boolean readTelemetry(ESAT_CCSDSPacket& telemetry);
 
+    // Return true if the board acknowledges its I2C address;
+    // otherwise return false.
+    boolean probe();
+
+    // Look once at the telemetry request made with requestTelemetry()
+    // and fill the packet with the telemetry packet if it is ready.
+    TelemetryPollResult pollTelemetry(ESAT_CCSDSPacket& packet);
+
+    // Ask for the next telemetry packet without waiting for it.
+    // Return true if the request went out; otherwise return false.
+    boolean requestTelemetry();
+
     // Deprecated method; don't use it.
     // Return true if a new telemetry packet is available.
     boolean telemetryAvailable() __attribute__((deprecated));
@@ -90,6 +103,18 @@ class ESAT_EPSSubsystemClass: public ESAT_Subsystem
     // (after update()); false otherwise (after readTelemetry()).
     boolean newTelemetryPacket;
 
+    // Protocol version number of the EPS board, read once when the
+    // board first answers a probe.
+    ESAT_SemanticVersionNumber protocolVersionNumber;
+
+    // True once protocolVersionNumber has been read; false otherwise.
+    boolean protocolVersionNumberKnown;
+
+    // Return true if the EPS board uses the preliminary (0.0.0)
+    // version of our I2C protocol or hasn't answered yet; otherwise
+    // return false.
+    boolean preliminaryProtocol();
+
     // Set the time of the EPS board.
     void setTime();
 };
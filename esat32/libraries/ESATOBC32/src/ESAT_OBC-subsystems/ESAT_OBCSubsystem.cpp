@@ -21,15 +21,32 @@
 #include "ESAT_OBC-subsystems/ESAT_OBCSubsystem.h"
 #include "ESAT_OBC-hardware/ESAT_OBCLED.h"
 #include "ESAT_OBC-hardware/ESAT_TelemetryStorage.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCDefineSnapshotTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCDisableTelemetryTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCDownloadStoredTelemetryTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCEnableTelemetryTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCEraseStoredTelemetryTelecommand.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCScheduleTelecommandTelecommand.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCSetTelemetryPolicyTelecommand.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCSetTelemetryRouteTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCSetTimeTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCStoreTelemetryTelecommand.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCCycleBudgetTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCCycleProfileTelemetry.h"
 #include "ESAT_OBC-telemetry/ESAT_OBCHousekeepingTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCI2CBusTelemetry.h"
 #include "ESAT_OBC-telemetry/ESAT_OBCLinesTelemetry.h"
 #include "ESAT_OBC-telemetry/ESAT_OBCProcessorTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCSnapshotTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCSubsystemsHealthTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryPoliciesTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryQueuesTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryRoutingTelemetry.h"
+#include "ESAT_OnBoardDataHandling.h"
+#include "ESAT_TelecommandScheduler.h"
+#include "ESAT_TelemetryPolicyTable.h"
+#include "ESAT_TelemetryRoutingTable.h"
+#include "ESAT_TelemetrySnapshot.h"
 #include <ESAT_Timer.h>
 #include <ESAT_Timestamp.h>
 
@@ -54,6 +71,10 @@ void ESAT_OBCSubsystemClass::beginHardware()
 {
   storeTelemetry = true;//false;
   ESAT_OBCLED.begin();
+  ESAT_TelemetryRoutingTable.begin();
+  ESAT_TelemetryPolicyTable.begin();
+  ESAT_TelemetrySnapshot.begin();
+  ESAT_TelecommandScheduler.begin();
 }
 
 void ESAT_OBCSubsystemClass::beginTelemetry()
@@ -67,6 +88,14 @@ void ESAT_OBCSubsystemClass::beginTelemetry()
   enableTelemetry(ESAT_OBCHousekeepingTelemetry.packetIdentifier());
   addTelemetry(ESAT_OBCLinesTelemetry);
   addTelemetry(ESAT_OBCProcessorTelemetry);
+  addTelemetry(ESAT_OBCI2CBusTelemetry);
+  addTelemetry(ESAT_OBCSubsystemsHealthTelemetry);
+  addTelemetry(ESAT_OBCTelemetryRoutingTelemetry);
+  addTelemetry(ESAT_OBCTelemetryQueuesTelemetry);
+  addTelemetry(ESAT_OBCCycleProfileTelemetry);
+  addTelemetry(ESAT_OBCCycleBudgetTelemetry);
+  addTelemetry(ESAT_OBCTelemetryPoliciesTelemetry);
+  addTelemetry(ESAT_OBCSnapshotTelemetry);
 }
 
 void ESAT_OBCSubsystemClass::beginTelecommands()
@@ -77,6 +106,10 @@ void ESAT_OBCSubsystemClass::beginTelecommands()
   addTelecommand(ESAT_OBCEraseStoredTelemetryTelecommand);
   addTelecommand(ESAT_OBCEnableTelemetryTelecommand);
   addTelecommand(ESAT_OBCDisableTelemetryTelecommand);
+  addTelecommand(ESAT_OBCSetTelemetryRouteTelecommand);
+  addTelecommand(ESAT_OBCScheduleTelecommandTelecommand);
+  addTelecommand(ESAT_OBCSetTelemetryPolicyTelecommand);
+  addTelecommand(ESAT_OBCDefineSnapshotTelecommand);
 }
 
 void ESAT_OBCSubsystemClass::disableTelemetry(const byte identifier)
@@ -113,11 +146,16 @@ void ESAT_OBCSubsystemClass::readEnabledTelemetry()
   file.close();
 }
 
+boolean ESAT_OBCSubsystemClass::latestTelemetryWasStored()
+{
+  return latestTelemetryStored;
+}
+
 boolean ESAT_OBCSubsystemClass::readTelecommand(ESAT_CCSDSPacket& packet)
 {
-  // The OBC subsystem doesn't produce telecommands at this moment.
-  (void) packet;
-  return false;
+  // The OBC subsystem produces the scheduled telecommands as their
+  // execution time comes.
+  return ESAT_TelecommandScheduler.read(packet, ESAT_OBCClock);
 }
 
 boolean ESAT_OBCSubsystemClass::readTelemetry(ESAT_CCSDSPacket& packet)
@@ -129,14 +167,24 @@ boolean ESAT_OBCSubsystemClass::readTelemetry(ESAT_CCSDSPacket& packet)
   {
     const byte identifier = byte(pendingTelemetry.readNext());
     pendingTelemetry.clear(identifier);
+    latestTelemetryStored = false;
     return telemetryPacketBuilder.build(packet, identifier);
   }
+  latestTelemetryStored = true;
   return readStoredTelemetry(packet);
   return false;
 }
 
 boolean ESAT_OBCSubsystemClass::readStoredTelemetry(ESAT_CCSDSPacket& packet)
 {
+  // Stored telemetry is bulk telemetry: while the telemetry queues
+  // are full, the download waits so that it doesn't push the
+  // real-time telemetry out of the queues.
+  if (ESAT_TelemetryStorage.reading()
+      && ESAT_OnBoardDataHandling.telemetryQueuesFull())
+  {
+    return false;
+  }
   const boolean correctRead = ESAT_TelemetryStorage.read(packet);
   // If there aren't more stored telemetry packets to be read,
   // we must ensure that the telemetry storage module is free.
@@ -66,6 +66,11 @@ class ESAT_OBCSubsystemClass: public ESAT_Subsystem
     // Handle a telecommand.
     void handleTelecommand(ESAT_CCSDSPacket& packet);
 
+    // Return true if the latest telemetry packet read with
+    // readTelemetry() was a stored telemetry packet; otherwise return
+    // false.
+    boolean latestTelemetryWasStored();
+
     // Fill a packet with the next telecommand packet available.
     // Return true if the operation was successful;
     // otherwise return false.
@@ -96,7 +101,7 @@ class ESAT_OBCSubsystemClass: public ESAT_Subsystem
 
     // Version numbers.
     static const byte MAJOR_VERSION_NUMBER = 4;
-    static const byte MINOR_VERSION_NUMBER = 8;
+    static const byte MINOR_VERSION_NUMBER = 9;
     static const byte PATCH_VERSION_NUMBER = 0;
 
     const char* ENABLED_TELEMETRY_FILENAME = "ENABLETM";
@@ -104,6 +109,10 @@ class ESAT_OBCSubsystemClass: public ESAT_Subsystem
     // List of enabled telemetry packet identifiers.
     ESAT_FlagContainer enabledTelemetry;
 
+    // True if the latest telemetry packet read with readTelemetry()
+    // was a stored telemetry packet; false otherwise.
+    boolean latestTelemetryStored = false;
+
     // List of pending telemetry packet identifiers.
     ESAT_FlagContainer pendingTelemetry;
 
@@ -134,6 +143,8 @@ class ESAT_OBCSubsystemClass: public ESAT_Subsystem
     // Read the next stored telemetry packet and fill the given packet buffer.
     // Return true on success; otherwise return false.
     // Set downloadTelemetry to false on unsuccessful read.
+    // Hold off the download (without ending it) while the telemetry
+    // queues of ESAT_OnBoardDataHandling are full.
     boolean readStoredTelemetry(ESAT_CCSDSPacket& packet);
 };
 
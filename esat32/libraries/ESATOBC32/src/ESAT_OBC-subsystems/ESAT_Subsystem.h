@@ -37,6 +37,12 @@
 class ESAT_Subsystem
 {
   public:
+    // True while ESAT_OnBoardDataHandling handles an event that this
+    // subsystem signalled (see
+    // ESAT_OnBoardDataHandling.waitUntilNextCycleOrEvent()).
+    // Only ESAT_OnBoardDataHandling should care about this.
+    boolean eventPending = false;
+
     // Next subsystem in the list of registered subsystems.
     // ESAT_OnBoardDataHandling uses this to keep a linked
     // list of registered subsystems: it can traverse
@@ -45,6 +51,87 @@ class ESAT_Subsystem
     // Only ESAT_OnBoardDataHandling should care about this.
     ESAT_Subsystem* nextSubsystem = nullptr;
 
+    // True while ESAT_OnBoardDataHandling waits for the answer to a
+    // telemetry request made with requestTelemetry().
+    // Only ESAT_OnBoardDataHandling should care about this.
+    boolean telemetryRequestPending = false;
+
+    // True if the current series of telemetry packets of this
+    // subsystem goes through requestTelemetry() and pollTelemetry()
+    // instead of readTelemetry().
+    // Only ESAT_OnBoardDataHandling should care about this.
+    boolean telemetryPipelined = false;
+
+    // Set when the wake-up line of the subsystem (see wakeUpLine())
+    // changes; cleared when ESAT_OnBoardDataHandling reads the
+    // telecommands of the subsystem.
+    // Only ESAT_OnBoardDataHandling should care about this.
+    volatile boolean wakeUpLineChanged = false;
+
+    // Health states of a subsystem.
+    enum HealthState
+    {
+      // The subsystem answers: use it normally.
+      HEALTHY = 0,
+      // The latest probes failed: skip the subsystem for a number of
+      // cycles that doubles after each failure.
+      BACKING_OFF = 1,
+      // Too many probes failed in a row: skip the subsystem and probe
+      // it just once in a while.
+      QUARANTINED = 2,
+    };
+
+    // Health of the subsystem as tracked by ESAT_OnBoardDataHandling.
+    // Only ESAT_OnBoardDataHandling should change this.
+    struct Health
+    {
+      // One of the HealthState values.
+      byte state;
+
+      // Number of probes failed in a row.
+      byte consecutiveFailures;
+
+      // Skip the subsystem for this number of cycles before the next
+      // probe.
+      word cyclesToNextProbe;
+
+      // Total number of failed probes.
+      word failures;
+
+      // Number of times the subsystem went back to HEALTHY.
+      word recoveries;
+    };
+
+    // Health of the subsystem.
+    Health health = {HEALTHY, 0, 0, 0, 0};
+
+    // Cycle budget of the subsystem as tracked by
+    // ESAT_OnBoardDataHandling.
+    // Only ESAT_OnBoardDataHandling should change this.
+    struct CycleBudget
+    {
+      // Time (in microseconds) the subsystem may spend per cycle
+      // in calls from ESAT_OnBoardDataHandling.
+      unsigned long microsecondsPerCycle;
+
+      // Time (in microseconds) spent during the current cycle.
+      unsigned long busyTime;
+
+      // Number of cycles in which the subsystem ran out of budget.
+      word overruns;
+    };
+
+    // Cycle budget of the subsystem.  Unlimited by default.
+    CycleBudget cycleBudget = {0xFFFFFFFF, 0, 0};
+
+    // Possible results of pollTelemetry().
+    enum TelemetryPollResult
+    {
+      TELEMETRY_PACKET_READ,
+      TELEMETRY_PACKET_PENDING,
+      NO_TELEMETRY_PACKET,
+    };
+
     virtual ~ESAT_Subsystem() {};
 
     // Return the application process identifier of this subsystem.
@@ -59,22 +146,92 @@ class ESAT_Subsystem
     // value returned by getApplicationProcessIdentifier().
     virtual void handleTelecommand(ESAT_CCSDSPacket& telecommand) = 0;
 
+    // Return true if the latest telemetry packet read with
+    // readTelemetry() came from the telemetry storage instead of being
+    // fresh telemetry; otherwise return false.
+    // ESAT_OnBoardDataHandling.writeTelemetry() queues stored
+    // telemetry as bulk telemetry.
+    // By default, subsystems don't give out stored telemetry.
+    virtual boolean latestTelemetryWasStored()
+    {
+      return false;
+    }
+
+    // Cheap check that the subsystem is there and answers (for
+    // example, that an I2C board acknowledges its address).
+    // Return true if the subsystem answers; otherwise return false.
+    // By default, subsystems always answer.
+    // Called from ESAT_OnBoardDataHandling.updateSubsystems().
+    virtual boolean probe()
+    {
+      return true;
+    }
+
     // Fill a packet with the next telecommand packet available.
     // Return true if the operation was successful;
     // otherwise return false.
     // Called from ESAT_OnBoardDataHandling.readTelecommand().
     virtual boolean readTelecommand(ESAT_CCSDSPacket& packet) = 0;
 
+    // Look once at the telemetry request made with requestTelemetry()
+    // and return:
+    // - TELEMETRY_PACKET_READ if the telemetry packet was ready;
+    //   then, fill the given packet with it.
+    // - TELEMETRY_PACKET_PENDING if the telemetry packet is not
+    //   ready yet.
+    // - NO_TELEMETRY_PACKET if there are no more telemetry packets
+    //   or there was an error.
+    // Called from ESAT_OnBoardDataHandling.readSubsystemsTelemetry()
+    // in pipelined telemetry mode.
+    virtual TelemetryPollResult pollTelemetry(ESAT_CCSDSPacket& packet)
+    {
+      (void) packet;
+      return NO_TELEMETRY_PACKET;
+    }
+
     // Fill a packet with the next telemetry packet available.
     // Return true if the operation was successful;
     // otherwise return false.
     // Called from ESAT_OnBoardDataHandling.readSubsystemsTelemetry().
     virtual boolean readTelemetry(ESAT_CCSDSPacket& packet) = 0;
 
+    // Ask for the next telemetry packet without waiting for it, so
+    // that the subsystem can prepare it in the meantime.  Collect the
+    // packet later with pollTelemetry().
+    // Return true if the request went out; return false if the
+    // subsystem doesn't take split telemetry requests (the default)
+    // or on error.  Then, readTelemetry() provides the telemetry.
+    // Called from ESAT_OnBoardDataHandling in pipelined telemetry mode.
+    virtual boolean requestTelemetry()
+    {
+      return false;
+    }
+
+    // Return true if there may be a telecommand ready for
+    // readTelecommand() right now (for example, received bytes waiting
+    // in a serial port); otherwise return false.
+    // By default, subsystems never say so and their telecommands wait
+    // for the next cycle.
+    // Called from ESAT_OnBoardDataHandling.eventPending().
+    virtual boolean telecommandPending()
+    {
+      return false;
+    }
+
     // Update the subsystem.
     // Called from ESAT_OnBoardDataHandling.updateSubsystems().
     virtual void update() = 0;
 
+    // Return the number of an input line that changes when the
+    // subsystem has news for the on-board computer (for example, a
+    // ready line or a connection line) or -1 if there is no such line.
+    // By default, subsystems have no wake-up line.
+    // Used by ESAT_OnBoardDataHandling.waitUntilNextCycleOrEvent().
+    virtual int wakeUpLine()
+    {
+      return -1;
+    }
+
     // Send a telemetry packet to this subsystem.
     // Called from ESAT_OnBoardDataHandling.writeTelemetry().
     virtual void writeTelemetry(ESAT_CCSDSPacket& packet) = 0;
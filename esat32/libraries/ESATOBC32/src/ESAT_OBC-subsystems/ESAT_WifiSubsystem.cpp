@@ -200,6 +200,30 @@ void ESAT_WifiSubsystemClass::setTime()
   (void) wifiWriter.unbufferedWrite(packet);
 }
 
+boolean ESAT_WifiSubsystemClass::telecommandPending()
+{
+  // Incoming data may be telemetry, which we can only keep in the
+  // buffered packet: while telemetry is flowing or buffered, we leave
+  // the incoming data for the next cycle instead of risking the loss
+  // of a telemetry packet.
+  if (telecommandAlreadyBuffered())
+  {
+    return true;
+  }
+  if (readingTelemetry || telemetryAlreadyBuffered())
+  {
+    return false;
+  }
+  if (SerialWifi.available() > 0)
+  {
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
 boolean ESAT_WifiSubsystemClass::telemetryAvailable()
 {
   return readingTelemetry;
@@ -241,6 +265,11 @@ void ESAT_WifiSubsystemClass::update()
   }
 }
 
+int ESAT_WifiSubsystemClass::wakeUpLine()
+{
+  return NOT_CONNECTED_SIGNAL_PIN;
+}
+
 void ESAT_WifiSubsystemClass::writeTelemetry(ESAT_CCSDSPacket& packet)
 {
   // The Wifi board is generally responsive, but it may block when
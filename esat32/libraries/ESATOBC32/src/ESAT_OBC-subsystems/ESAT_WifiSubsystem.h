@@ -65,6 +65,10 @@ class ESAT_WifiSubsystemClass: public ESAT_Subsystem
     // otherwise return false.
     boolean readTelemetry(ESAT_CCSDSPacket& packet);
 
+    // Return true if there is a buffered telecommand or incoming data
+    // from the ESAT Wifi board; otherwise return false.
+    boolean telecommandPending();
+
     // Deprecated method; don't use it.
     // Return true if there is new telemetry available;
     // Otherwise return false.
@@ -75,6 +79,11 @@ class ESAT_WifiSubsystemClass: public ESAT_Subsystem
     // telemetry packets.
     void update();
 
+    // Return the connection signal line of the ESAT Wifi board, which
+    // changes when the board connects to or disconnects from the
+    // server.
+    int wakeUpLine();
+
    // Send a telemetry packet to this subsystem.
     void writeTelemetry(ESAT_CCSDSPacket& packet);
 
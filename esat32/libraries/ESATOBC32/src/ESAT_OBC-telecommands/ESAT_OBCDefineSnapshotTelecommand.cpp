@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telecommands/ESAT_OBCDefineSnapshotTelecommand.h"
+#include "ESAT_TelemetrySnapshot.h"
+
+boolean ESAT_OBCDefineSnapshotTelecommandClass::handleUserData(ESAT_CCSDSPacket packet)
+{
+  // The telecommand carries the snapshot period followed by the
+  // fields of the snapshot: application process identifier, packet
+  // identifier, offset and length of each field.
+  const word period = packet.readWord();
+  if (packet.triedToReadBeyondLength())
+  {
+    return false;
+  }
+  ESAT_TelemetrySnapshotClass::Field
+    fields[ESAT_TelemetrySnapshotClass::MAXIMUM_NUMBER_OF_FIELDS];
+  byte numberOfFields = 0;
+  while (packet.available() > 0)
+  {
+    if (numberOfFields >= ESAT_TelemetrySnapshotClass::MAXIMUM_NUMBER_OF_FIELDS)
+    {
+      return false;
+    }
+    ESAT_TelemetrySnapshotClass::Field& field = fields[numberOfFields];
+    field.applicationProcessIdentifier = packet.readWord();
+    field.packetIdentifier = packet.readByte();
+    field.offset = packet.readByte();
+    field.length = packet.readByte();
+    if (packet.triedToReadBeyondLength())
+    {
+      return false;
+    }
+    numberOfFields = numberOfFields + 1;
+  }
+  return ESAT_TelemetrySnapshot.setDefinition(period,
+                                              numberOfFields,
+                                              fields);
+}
+
+ESAT_OBCDefineSnapshotTelecommandClass ESAT_OBCDefineSnapshotTelecommand;
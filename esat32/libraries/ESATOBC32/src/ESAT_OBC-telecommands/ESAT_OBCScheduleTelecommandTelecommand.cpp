@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telecommands/ESAT_OBCScheduleTelecommandTelecommand.h"
+#include "ESAT_TelecommandScheduler.h"
+
+boolean ESAT_OBCScheduleTelecommandTelecommandClass::handleUserData(ESAT_CCSDSPacket packet)
+{
+  // The telecommand carries the execution time followed by the
+  // telecommand packet to execute then (primary header and packet
+  // data).
+  const ESAT_Timestamp executionTime = packet.readTimestamp();
+  if (packet.triedToReadBeyondLength())
+  {
+    return false;
+  }
+  byte buffer[ESAT_TelecommandSchedulerClass::MAXIMUM_PACKET_LENGTH
+              - ESAT_CCSDSPrimaryHeader::LENGTH];
+  ESAT_CCSDSPacket telecommand(buffer, sizeof(buffer));
+  if (!telecommand.readFrom(packet) || !telecommand.isTelecommand())
+  {
+    return false;
+  }
+  return ESAT_TelecommandScheduler.schedule(executionTime, telecommand);
+}
+
+ESAT_OBCScheduleTelecommandTelecommandClass ESAT_OBCScheduleTelecommandTelecommand;
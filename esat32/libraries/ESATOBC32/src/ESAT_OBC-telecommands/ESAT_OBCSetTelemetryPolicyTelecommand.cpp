@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telecommands/ESAT_OBCSetTelemetryPolicyTelecommand.h"
+#include "ESAT_TelemetryPolicyTable.h"
+
+boolean ESAT_OBCSetTelemetryPolicyTelecommandClass::handleUserData(ESAT_CCSDSPacket packet)
+{
+  // The telecommand carries the application process identifier and
+  // the packet identifier of the policy, its decimation and its
+  // keep-alive interval, followed by the fields of change-only
+  // policies: offset, type and deadband of each field.
+  const word applicationProcessIdentifier = packet.readWord();
+  const byte packetIdentifier = packet.readByte();
+  const word decimation = packet.readWord();
+  const word keepAliveInterval = packet.readWord();
+  if (packet.triedToReadBeyondLength())
+  {
+    return false;
+  }
+  ESAT_TelemetryPolicyTableClass::Field
+    fields[ESAT_TelemetryPolicyTableClass::MAXIMUM_NUMBER_OF_FIELDS];
+  byte numberOfFields = 0;
+  while (packet.available() > 0)
+  {
+    if (numberOfFields >= ESAT_TelemetryPolicyTable.MAXIMUM_NUMBER_OF_FIELDS)
+    {
+      return false;
+    }
+    fields[numberOfFields].offset = packet.readByte();
+    fields[numberOfFields].type = packet.readByte();
+    fields[numberOfFields].deadband = packet.readFloat();
+    if (packet.triedToReadBeyondLength())
+    {
+      return false;
+    }
+    numberOfFields = numberOfFields + 1;
+  }
+  return ESAT_TelemetryPolicyTable.setPolicy(applicationProcessIdentifier,
+                                             packetIdentifier,
+                                             decimation,
+                                             keepAliveInterval,
+                                             numberOfFields,
+                                             fields);
+}
+
+ESAT_OBCSetTelemetryPolicyTelecommandClass ESAT_OBCSetTelemetryPolicyTelecommand;
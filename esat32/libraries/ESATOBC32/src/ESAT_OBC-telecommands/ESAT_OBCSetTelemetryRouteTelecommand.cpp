@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telecommands/ESAT_OBCSetTelemetryRouteTelecommand.h"
+#include "ESAT_TelemetryRoutingTable.h"
+#include "ESAT_TelemetrySinkQueue.h"
+
+boolean ESAT_OBCSetTelemetryRouteTelecommandClass::handleUserData(ESAT_CCSDSPacket packet)
+{
+  // The telecommand carries the application process identifier and
+  // the packet identifier of the route and its new set of sinks,
+  // optionally followed by its priority class for the sink queues.
+  const word applicationProcessIdentifier = packet.readWord();
+  const byte packetIdentifier = packet.readByte();
+  const word sinks = packet.readWord();
+  if (packet.triedToReadBeyondLength())
+  {
+    return false;
+  }
+  byte priorityClass = 0;
+  if (packet.available() > 0)
+  {
+    priorityClass = packet.readByte();
+  }
+  if (priorityClass >= ESAT_TelemetrySinkQueue::NUMBER_OF_PRIORITY_CLASSES)
+  {
+    return false;
+  }
+  return ESAT_TelemetryRoutingTable.setRoute(applicationProcessIdentifier,
+                                             packetIdentifier,
+                                             sinks,
+                                             priorityClass);
+}
+
+ESAT_OBCSetTelemetryRouteTelecommandClass ESAT_OBCSetTelemetryRouteTelecommand;
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCCycleBudgetTelemetry.h"
+#include "ESAT_OnBoardDataHandling.h"
+
+boolean ESAT_OBCCycleBudgetTelemetryClass::available()
+{
+  // The OBC cycle budget telemetry packet is always available.
+  return true;
+}
+
+boolean ESAT_OBCCycleBudgetTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the watchdog state, the budget and number of
+  // overruns of each phase and, for each registered subsystem in
+  // order of registration, its budget and number of overruns.
+  // Budgets are in microseconds.
+  packet.writeBoolean(ESAT_OnBoardDataHandling.watchdogEnabled());
+  packet.writeBoolean(ESAT_OnBoardDataHandling.resetByWatchdog());
+  for (byte phase = 0;
+       phase < ESAT_OnBoardDataHandling.NUMBER_OF_BUDGET_PHASES;
+       phase++)
+  {
+    packet.writeUnsignedLong(ESAT_OnBoardDataHandling.phaseBudget(phase));
+    packet.writeUnsignedLong(ESAT_OnBoardDataHandling.phaseOverruns(phase));
+  }
+  byte subsystems = 0;
+  for (ESAT_Subsystem* subsystem =
+         ESAT_OnBoardDataHandling.registeredSubsystems();
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    subsystems = subsystems + 1;
+  }
+  packet.writeByte(subsystems);
+  for (ESAT_Subsystem* subsystem =
+         ESAT_OnBoardDataHandling.registeredSubsystems();
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    packet.writeWord(subsystem->getApplicationProcessIdentifier());
+    packet.writeUnsignedLong(subsystem->cycleBudget.microsecondsPerCycle);
+    packet.writeWord(subsystem->cycleBudget.overruns);
+  }
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+ESAT_OBCCycleBudgetTelemetryClass ESAT_OBCCycleBudgetTelemetry;
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCCycleProfileTelemetry.h"
+#include "ESAT_CycleProfiler.h"
+
+boolean ESAT_OBCCycleProfileTelemetryClass::available()
+{
+  // The OBC cycle profile telemetry packet is available only when the
+  // cycle profiler is compiled in.
+  return ESAT_CycleProfiler.ENABLED;
+}
+
+boolean ESAT_OBCCycleProfileTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the number of profiled cycles and the
+  // minimum, mean and maximum busy time per cycle (microseconds),
+  // the busy time histogram, the number of measured phases and, for
+  // each phase, its identification and its minimum, mean and maximum
+  // time per cycle (microseconds, saturated to fit in a word).
+  const ESAT_CycleProfilerClass::Statistics cycleStatistics =
+    ESAT_CycleProfiler.readCycleStatistics();
+  packet.writeUnsignedLong(cycleStatistics.cycles);
+  packet.writeUnsignedLong(cycleStatistics.minimum);
+  packet.writeUnsignedLong(cycleStatistics.mean);
+  packet.writeUnsignedLong(cycleStatistics.maximum);
+  for (byte bin = 0;
+       bin < ESAT_CycleProfiler.HISTOGRAM_BINS;
+       bin++)
+  {
+    packet.writeByte(ESAT_CycleProfiler.histogram(bin));
+  }
+  packet.writeByte(ESAT_CycleProfiler.probes());
+  for (byte index = 0; index < ESAT_CycleProfiler.probes(); index++)
+  {
+    const ESAT_CycleProfilerClass::Statistics statistics =
+      ESAT_CycleProfiler.readProbeStatistics(index);
+    packet.writeByte(statistics.phase);
+    packet.writeByte(statistics.instance);
+    packet.writeWord(saturate(statistics.minimum));
+    packet.writeWord(saturate(statistics.mean));
+    packet.writeWord(saturate(statistics.maximum));
+  }
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+word ESAT_OBCCycleProfileTelemetryClass::saturate(const unsigned long time) const
+{
+  if (time > 0xFFFF)
+  {
+    return 0xFFFF;
+  }
+  return word(time);
+}
+
+ESAT_OBCCycleProfileTelemetryClass ESAT_OBCCycleProfileTelemetry;
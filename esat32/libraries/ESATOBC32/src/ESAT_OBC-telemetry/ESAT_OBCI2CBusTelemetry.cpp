@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCI2CBusTelemetry.h"
+#include <ESAT_I2CStatistics.h>
+
+boolean ESAT_OBCI2CBusTelemetryClass::available()
+{
+  // The OBC I2C bus telemetry packet is always available.
+  return true;
+}
+
+boolean ESAT_OBCI2CBusTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the accumulated statistics of each slave
+  // address seen on the I2C bus, in order of appearance.
+  const byte addresses = ESAT_I2CStatistics.addresses();
+  packet.writeByte(addresses);
+  for (byte index = 0; index < addresses; index++)
+  {
+    const ESAT_I2CStatisticsClass::AddressStatistics statistics =
+      ESAT_I2CStatistics.read(index);
+    packet.writeByte(statistics.address);
+    packet.writeUnsignedLong(statistics.transactions);
+    packet.writeUnsignedLong(statistics.bytes);
+    packet.writeWord(statistics.nacks);
+    packet.writeWord(statistics.timeouts);
+    packet.writeWord(statistics.retries);
+    packet.writeWord(statistics.packetNotReadyPolls);
+    for (byte bucket = 0;
+         bucket < ESAT_I2CStatistics.LATENCY_HISTOGRAM_BUCKETS;
+         bucket++)
+    {
+      packet.writeWord(statistics.latencyHistogram[bucket]);
+    }
+  }
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+ESAT_OBCI2CBusTelemetryClass ESAT_OBCI2CBusTelemetry;
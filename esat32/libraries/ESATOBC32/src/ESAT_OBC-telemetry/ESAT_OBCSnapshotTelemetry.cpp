@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCSnapshotTelemetry.h"
+#include "ESAT_TelemetrySnapshot.h"
+
+boolean ESAT_OBCSnapshotTelemetryClass::available()
+{
+  // The OBC snapshot telemetry packet is available once every
+  // snapshot period.
+  return ESAT_TelemetrySnapshot.due();
+}
+
+boolean ESAT_OBCSnapshotTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the fields of the snapshot definition as
+  // they came in the latest telemetry packets of the subsystems.
+  ESAT_TelemetrySnapshot.writeTo(packet);
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+ESAT_OBCSnapshotTelemetryClass ESAT_OBCSnapshotTelemetry;
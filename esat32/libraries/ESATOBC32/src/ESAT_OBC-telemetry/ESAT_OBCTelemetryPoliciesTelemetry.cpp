@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryPoliciesTelemetry.h"
+#include "ESAT_TelemetryPolicyTable.h"
+
+boolean ESAT_OBCTelemetryPoliciesTelemetryClass::available()
+{
+  // The OBC telemetry policies telemetry packet is always available.
+  return true;
+}
+
+boolean ESAT_OBCTelemetryPoliciesTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the number of policies followed by the
+  // packet and the traffic of each policy.
+  const byte policies = ESAT_TelemetryPolicyTable.policies();
+  packet.writeByte(policies);
+  for (byte index = 0; index < policies; index++)
+  {
+    const ESAT_TelemetryPolicyTableClass::PolicyStatistics statistics =
+      ESAT_TelemetryPolicyTable.readPolicyStatistics(index);
+    packet.writeWord(statistics.applicationProcessIdentifier);
+    packet.writeByte(statistics.packetIdentifier);
+    packet.writeUnsignedLong(statistics.passedPackets);
+    packet.writeUnsignedLong(statistics.suppressedPackets);
+  }
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+ESAT_OBCTelemetryPoliciesTelemetryClass ESAT_OBCTelemetryPoliciesTelemetry;
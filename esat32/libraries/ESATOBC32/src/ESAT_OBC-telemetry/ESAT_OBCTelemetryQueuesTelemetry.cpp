@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryQueuesTelemetry.h"
+#include "ESAT_OnBoardDataHandling.h"
+
+boolean ESAT_OBCTelemetryQueuesTelemetryClass::available()
+{
+  // The OBC telemetry queues telemetry packet is always available.
+  return true;
+}
+
+boolean ESAT_OBCTelemetryQueuesTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the number of telemetry queues followed by
+  // the sink number of each queue and the number of queued packets
+  // and dropped packets of each priority class.
+  byte numberOfQueues = 0;
+  for (ESAT_TelemetrySinkQueue* queue =
+         ESAT_OnBoardDataHandling.telemetryQueues();
+       queue != nullptr;
+       queue = queue->next)
+  {
+    numberOfQueues = numberOfQueues + 1;
+  }
+  packet.writeByte(numberOfQueues);
+  for (ESAT_TelemetrySinkQueue* queue =
+         ESAT_OnBoardDataHandling.telemetryQueues();
+       queue != nullptr;
+       queue = queue->next)
+  {
+    packet.writeByte(queue->sink());
+    for (byte priorityClass = 0;
+         priorityClass < ESAT_TelemetrySinkQueue::NUMBER_OF_PRIORITY_CLASSES;
+         priorityClass++)
+    {
+      packet.writeByte(queue->depth(priorityClass));
+      packet.writeUnsignedLong(queue->drops(priorityClass));
+    }
+  }
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+ESAT_OBCTelemetryQueuesTelemetryClass ESAT_OBCTelemetryQueuesTelemetry;
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryRoutingTelemetry.h"
+#include "ESAT_TelemetryRoutingTable.h"
+
+boolean ESAT_OBCTelemetryRoutingTelemetryClass::available()
+{
+  // The OBC telemetry routing telemetry packet is always available.
+  return true;
+}
+
+boolean ESAT_OBCTelemetryRoutingTelemetryClass::fillUserData(ESAT_CCSDSPacket& packet)
+{
+  // This packet contains the number of routes followed by the
+  // traffic of each sink, in order of sink number.
+  packet.writeByte(ESAT_TelemetryRoutingTable.routes());
+  for (byte sink = 0;
+       sink < ESAT_TelemetryRoutingTable.NUMBER_OF_SINKS;
+       sink++)
+  {
+    const ESAT_TelemetryRoutingTableClass::SinkStatistics statistics =
+      ESAT_TelemetryRoutingTable.readSinkStatistics(sink);
+    packet.writeUnsignedLong(statistics.packets);
+    packet.writeUnsignedLong(statistics.bytes);
+  }
+  // This packet is valid in general, except when it is truncated
+  // because its capacity was too small.
+  if (packet.triedToWriteBeyondCapacity())
+  {
+    return false;
+  }
+  else
+  {
+    return true;
+  }
+}
+
+ESAT_OBCTelemetryRoutingTelemetryClass ESAT_OBCTelemetryRoutingTelemetry;
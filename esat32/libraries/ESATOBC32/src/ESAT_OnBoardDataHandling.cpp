@@ -19,6 +19,76 @@
  */
 
 #include "ESAT_OnBoardDataHandling.h"
+#include <IWatchdog.h>
+
+volatile boolean ESAT_OnBoardDataHandlingClass::wakeUpRequested = false;
+
+void ESAT_OnBoardDataHandlingClass::addTelemetryQueue(ESAT_TelemetrySinkQueue& queue)
+{
+  queue.next = firstTelemetryQueue;
+  firstTelemetryQueue = &queue;
+}
+
+void ESAT_OnBoardDataHandlingClass::addWakeUpLine(const byte line)
+{
+  attachInterrupt(line, requestWakeUp, CHANGE);
+}
+
+void ESAT_OnBoardDataHandlingClass::beginCycle()
+{
+  for (ESAT_Subsystem* subsystem = firstSubsystem;
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    subsystem->cycleBudget.busyTime = 0;
+    subsystem->wakeUpLineChanged = false;
+  }
+  telecommandSubsystem = firstSubsystem;
+  startPhase(TELECOMMAND_BUDGET_PHASE);
+  cycleInProgress = true;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::budgetLeft(const byte phase)
+{
+  if ((micros() - phaseStartTimes[phase]) < phaseBudgets[phase])
+  {
+    return true;
+  }
+  if (!phaseCutShort[phase])
+  {
+    phaseCutShort[phase] = true;
+    if (phaseOverrunCounters[phase] < 0xFFFFFFFF)
+    {
+      phaseOverrunCounters[phase] = phaseOverrunCounters[phase] + 1;
+    }
+  }
+  return false;
+}
+
+void ESAT_OnBoardDataHandlingClass::chargeSubsystem(ESAT_Subsystem& subsystem,
+                                                    const unsigned long startTime)
+{
+  // The overrun counts once per cycle: when the busy time goes
+  // past the budget.
+  ESAT_Subsystem::CycleBudget& budget = subsystem.cycleBudget;
+  const boolean hadBudgetLeft =
+    budget.busyTime < budget.microsecondsPerCycle;
+  const unsigned long elapsedTime = micros() - startTime;
+  if (budget.busyTime > (0xFFFFFFFF - elapsedTime))
+  {
+    budget.busyTime = 0xFFFFFFFF;
+  }
+  else
+  {
+    budget.busyTime = budget.busyTime + elapsedTime;
+  }
+  if (hadBudgetLeft
+      && (budget.busyTime >= budget.microsecondsPerCycle)
+      && (budget.overruns < 0xFFFF))
+  {
+    budget.overruns = budget.overruns + 1;
+  }
+}
 
 void ESAT_OnBoardDataHandlingClass::disableUSBTelecommands()
 {
@@ -26,6 +96,64 @@ void ESAT_OnBoardDataHandlingClass::disableUSBTelecommands()
   // packets, so a way to disable USB telecommands is to make the USB
   // reader an empty CCSDS-packet-from-KISS-frame reader.
   usbReader = ESAT_CCSDSPacketFromKISSFrameReader();
+  usbTelecommandsEnabled = false;
+}
+
+void ESAT_OnBoardDataHandlingClass::checkHealth(ESAT_Subsystem& subsystem)
+{
+  // Healthy subsystems are probed on every cycle.  Unhealthy
+  // subsystems wait for their next probe.  After each failed probe,
+  // the wait doubles (1, 2, 4... cycles) up to the quarantine probe
+  // period.  Counters stop at their maximum value.
+  ESAT_Subsystem::Health& health = subsystem.health;
+  if (health.state != ESAT_Subsystem::HEALTHY)
+  {
+    if (health.cyclesToNextProbe > 0)
+    {
+      health.cyclesToNextProbe = health.cyclesToNextProbe - 1;
+      return;
+    }
+  }
+  const boolean answered = subsystem.probe();
+  if (answered)
+  {
+    if ((health.state != ESAT_Subsystem::HEALTHY)
+        && (health.recoveries < 0xFFFF))
+    {
+      health.recoveries = health.recoveries + 1;
+    }
+    health.state = ESAT_Subsystem::HEALTHY;
+    health.consecutiveFailures = 0;
+    health.cyclesToNextProbe = 0;
+    return;
+  }
+  if (health.failures < 0xFFFF)
+  {
+    health.failures = health.failures + 1;
+  }
+  if (health.consecutiveFailures < 0xFF)
+  {
+    health.consecutiveFailures = health.consecutiveFailures + 1;
+  }
+  if (health.consecutiveFailures >= QUARANTINE_THRESHOLD)
+  {
+    health.state = ESAT_Subsystem::QUARANTINED;
+    health.cyclesToNextProbe = QUARANTINE_PROBE_PERIOD - 1;
+  }
+  else
+  {
+    health.state = ESAT_Subsystem::BACKING_OFF;
+    health.cyclesToNextProbe = word(1) << (health.consecutiveFailures - 1);
+    if (health.cyclesToNextProbe > QUARANTINE_PROBE_PERIOD)
+    {
+      health.cyclesToNextProbe = QUARANTINE_PROBE_PERIOD;
+    }
+  }
+}
+
+void ESAT_OnBoardDataHandlingClass::disablePipelinedTelemetry()
+{
+  pipelinedTelemetry = false;
 }
 
 void ESAT_OnBoardDataHandlingClass::disableUSBTelemetry()
@@ -34,6 +162,8 @@ void ESAT_OnBoardDataHandlingClass::disableUSBTelemetry()
   // packets, so a way to disable USB telemetry is to make the USB
   // writer an empty CCSDS-packet-from-KISS-frame writer.
   usbWriter = ESAT_CCSDSPacketToKISSFrameWriter();
+  usbTransferFrameWriter = ESAT_CCSDSPacketToTransferFrameWriter();
+  usbTransferFramesEnabled = false;
 }
 
 void ESAT_OnBoardDataHandlingClass::dispatchTelecommand(ESAT_CCSDSPacket& packet)
@@ -57,12 +187,99 @@ void ESAT_OnBoardDataHandlingClass::dispatchTelecommand(ESAT_CCSDSPacket& packet
     if (subsystemsApplicationProcessIdentifier
         == primaryHeader.applicationProcessIdentifier)
     {
-      subsystem->handleTelecommand(packet);
+      if (isHealthy(*subsystem))
+      {
+        const unsigned long budgetStartTime = micros();
+        const unsigned long startTime = ESAT_CycleProfiler.start();
+        subsystem->handleTelecommand(packet);
+        ESAT_CycleProfiler.stop(ESAT_CycleProfiler.TELECOMMAND_DISPATCH_PHASE,
+                                subsystemsApplicationProcessIdentifier,
+                                startTime);
+        chargeSubsystem(*subsystem, budgetStartTime);
+      }
+      return;
+    }
+  }
+}
+
+void ESAT_OnBoardDataHandlingClass::drainTelemetryQueues()
+{
+  // Each queue gets its own time budget, so a slow sink eats only
+  // its own share of the cycle.  The budget is checked before each
+  // packet, so a queue writes at least one packet per cycle.
+  // The queues also share the budget of the drain phase.  When it
+  // runs out, the drain stops and the next cycle starts from the
+  // queue that was cut short, so that every queue gets its turn.
+  ESAT_CCSDSPacket packet(drainBuffer, sizeof(drainBuffer));
+  startPhase(DRAIN_BUDGET_PHASE);
+  ESAT_TelemetrySinkQueue* queue = drainQueue;
+  if (queue == nullptr)
+  {
+    queue = firstTelemetryQueue;
+  }
+  drainQueue = nullptr;
+  ESAT_TelemetrySinkQueue* const firstQueue = queue;
+  while (queue != nullptr)
+  {
+    const word sink = queue->sink();
+    if (isSinkHealthy(sink))
+    {
+      const unsigned long startTime = micros();
+      while ((micros() - startTime) < queue->budget())
+      {
+        if (!budgetLeft(DRAIN_BUDGET_PHASE))
+        {
+          drainQueue = queue;
+          return;
+        }
+        const boolean gotPacket = queue->read(packet);
+        if (!gotPacket)
+        {
+          break;
+        }
+        writeTelemetryToSink(sink, packet);
+      }
+    }
+    queue = queue->next;
+    if (queue == nullptr)
+    {
+      queue = firstTelemetryQueue;
+    }
+    if (queue == firstQueue)
+    {
       return;
     }
   }
 }
 
+boolean ESAT_OnBoardDataHandlingClass::eventPending()
+{
+  if (wakeUpRequested)
+  {
+    return true;
+  }
+  if (usbTelecommandsEnabled && (Serial.available() > 0))
+  {
+    return true;
+  }
+  for (ESAT_Subsystem* subsystem = firstSubsystem;
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    if (subsystemEventPending(*subsystem))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ESAT_OnBoardDataHandlingClass::enablePipelinedTelemetry(const unsigned long microsecondsPerCycle)
+{
+  pipelinedTelemetry = true;
+  pipelinedTelemetryBudget = microsecondsPerCycle;
+}
+
 void ESAT_OnBoardDataHandlingClass::enableUSBTelecommands(byte buffer[],
                                                           const unsigned long bufferLength)
 {
@@ -73,6 +290,7 @@ void ESAT_OnBoardDataHandlingClass::enableUSBTelecommands(byte buffer[],
   usbReader = ESAT_CCSDSPacketFromKISSFrameReader(Serial,
                                                   buffer,
                                                   bufferLength);
+  usbTelecommandsEnabled = true;
 }
 
 void ESAT_OnBoardDataHandlingClass::enableUSBTelemetry()
@@ -83,6 +301,193 @@ void ESAT_OnBoardDataHandlingClass::enableUSBTelemetry()
   usbWriter = ESAT_CCSDSPacketToKISSFrameWriter(Serial);
 }
 
+void ESAT_OnBoardDataHandlingClass::enableUSBTransferFrames(byte buffer[],
+                                                            const word frameLength,
+                                                            const word spacecraftIdentifier)
+{
+  usbTransferFrameWriter =
+    ESAT_CCSDSPacketToTransferFrameWriter(Serial,
+                                          buffer,
+                                          frameLength,
+                                          spacecraftIdentifier,
+                                          0);
+  usbTransferFramesEnabled = true;
+}
+
+void ESAT_OnBoardDataHandlingClass::enableWatchdog(const unsigned long timeout)
+{
+  watchdogReset = IWatchdog.isReset(true);
+  IWatchdog.begin(timeout);
+  watchdogActive = IWatchdog.isEnabled();
+}
+
+void ESAT_OnBoardDataHandlingClass::endCycle()
+{
+  // The packets of this cycle shouldn't wait for the next cycle to
+  // fill up their transfer frame.
+  if (usbTransferFramesEnabled)
+  {
+    (void) usbTransferFrameWriter.flush();
+  }
+  // Only whole cycles count as progress: a loop stuck in a phase
+  // never gets here and the watchdog resets the on-board computer.
+  if (!cycleInProgress)
+  {
+    return;
+  }
+  cycleInProgress = false;
+  if (watchdogActive)
+  {
+    IWatchdog.reload();
+  }
+}
+
+ESAT_Subsystem* ESAT_OnBoardDataHandlingClass::findSinkSubsystem(const word sink)
+{
+  for (ESAT_Subsystem* subsystem = firstSubsystem;
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    if (subsystem->getApplicationProcessIdentifier() == sink)
+    {
+      return subsystem;
+    }
+  }
+  return nullptr;
+}
+
+ESAT_TelemetrySinkQueue* ESAT_OnBoardDataHandlingClass::findTelemetryQueue(const word sink)
+{
+  for (ESAT_TelemetrySinkQueue* queue = firstTelemetryQueue;
+       queue != nullptr;
+       queue = queue->next)
+  {
+    if (queue->sink() == sink)
+    {
+      return queue;
+    }
+  }
+  return nullptr;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::isHealthy(ESAT_Subsystem& subsystem)
+{
+  return subsystem.health.state == ESAT_Subsystem::HEALTHY;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::isSinkHealthy(const word sink)
+{
+  if (sink == ESAT_TelemetryRoutingTable.USB_SINK)
+  {
+    return true;
+  }
+  ESAT_Subsystem* const subsystem = findSinkSubsystem(sink);
+  if (subsystem == nullptr)
+  {
+    return false;
+  }
+  return isHealthy(*subsystem);
+}
+
+unsigned long ESAT_OnBoardDataHandlingClass::phaseBudget(const byte phase)
+{
+  if (phase >= NUMBER_OF_BUDGET_PHASES)
+  {
+    return 0;
+  }
+  return phaseBudgets[phase];
+}
+
+unsigned long ESAT_OnBoardDataHandlingClass::phaseOverruns(const byte phase)
+{
+  if (phase >= NUMBER_OF_BUDGET_PHASES)
+  {
+    return 0;
+  }
+  return phaseOverrunCounters[phase];
+}
+
+boolean ESAT_OnBoardDataHandlingClass::pollEvents()
+{
+  return ESAT_OnBoardDataHandling.eventPending();
+}
+
+boolean ESAT_OnBoardDataHandlingClass::pollSubsystemsTelemetry(ESAT_CCSDSPacket& packet)
+{
+  // Each round of polls visits the subsystems with a pending
+  // telemetry request.  A subsystem that delivers a packet gets
+  // a new request at once, so it prepares its next packet while we
+  // handle the current one and poll the other subsystems.
+  // Subsystems with nothing more to send drop out of the rounds.
+  // The rounds go on while there are pending requests and time
+  // budget left; then, the remaining requests are abandoned.
+  while (true)
+  {
+    boolean pendingRequests = false;
+    for (ESAT_Subsystem* subsystem = firstSubsystem;
+         subsystem != nullptr;
+         subsystem = subsystem->nextSubsystem)
+    {
+      if (!subsystem->telemetryRequestPending)
+      {
+        continue;
+      }
+      if (!subsystemBudgetLeft(*subsystem))
+      {
+        subsystem->telemetryRequestPending = false;
+        continue;
+      }
+      packet.flush();
+      const unsigned long budgetStartTime = micros();
+      const unsigned long startTime = ESAT_CycleProfiler.start();
+      const ESAT_Subsystem::TelemetryPollResult result =
+        subsystem->pollTelemetry(packet);
+      ESAT_CycleProfiler.stop(ESAT_CycleProfiler.TELEMETRY_READ_PHASE,
+                              subsystem->getApplicationProcessIdentifier(),
+                              startTime);
+      chargeSubsystem(*subsystem, budgetStartTime);
+      switch (result)
+      {
+        case ESAT_Subsystem::TELEMETRY_PACKET_READ:
+          subsystem->telemetryRequestPending =
+            subsystem->requestTelemetry();
+          if (packet.isTelemetry())
+          {
+            packet.rewind();
+            return true;
+          }
+          packet.flush();
+          pendingRequests = pendingRequests
+                            || subsystem->telemetryRequestPending;
+          break;
+        case ESAT_Subsystem::TELEMETRY_PACKET_PENDING:
+          pendingRequests = true;
+          break;
+        default:
+          subsystem->telemetryRequestPending = false;
+          break;
+      }
+    }
+    if (!pendingRequests)
+    {
+      return false;
+    }
+    const unsigned long elapsedTime = micros() - pipelinedTelemetryStartTime;
+    if ((elapsedTime >= pipelinedTelemetryBudget)
+        || !budgetLeft(TELEMETRY_BUDGET_PHASE))
+    {
+      for (ESAT_Subsystem* subsystem = firstSubsystem;
+           subsystem != nullptr;
+           subsystem = subsystem->nextSubsystem)
+      {
+        subsystem->telemetryRequestPending = false;
+      }
+      return false;
+    }
+    ESAT_I2CBusScheduler.wait(PIPELINED_TELEMETRY_POLLING_PERIOD);
+  }
+}
+
 boolean ESAT_OnBoardDataHandlingClass::readTelecommand(ESAT_CCSDSPacket& packet)
 {
   // Subsystems are visited in a first-in, first-out basis, from the
@@ -98,8 +503,22 @@ boolean ESAT_OnBoardDataHandlingClass::readTelecommand(ESAT_CCSDSPacket& packet)
   // to produce a telecommand if USB telecommands are disabled, so
   // it is correct to always ask it for a telecommand and let it
   // decide what to do.
+  // When the telecommand phase runs out of budget, the remaining
+  // telecommands wait in their subsystems for the next cycle.
+  // While handling an event, only the sources of the event are read.
+  if (!budgetLeft(TELECOMMAND_BUDGET_PHASE))
+  {
+    return false;
+  }
   while (telecommandSubsystem != nullptr)
   {
+    if (!isHealthy(*telecommandSubsystem)
+        || !subsystemBudgetLeft(*telecommandSubsystem)
+        || (handlingEvent && !telecommandSubsystem->eventPending))
+    {
+      telecommandSubsystem = telecommandSubsystem->nextSubsystem;
+      continue;
+    }
     const boolean gotTelecommand =
       readTelecommandFromSubsystem(packet, *telecommandSubsystem);
     if (gotTelecommand)
@@ -111,6 +530,10 @@ boolean ESAT_OnBoardDataHandlingClass::readTelecommand(ESAT_CCSDSPacket& packet)
       telecommandSubsystem = telecommandSubsystem->nextSubsystem;
     }
   }
+  if (handlingEvent && !usbEventPending)
+  {
+    return false;
+  }
   return readTelecommandFromUSB(packet);
 }
 
@@ -118,7 +541,13 @@ boolean ESAT_OnBoardDataHandlingClass::readTelecommandFromSubsystem(ESAT_CCSDSPa
                                                                     ESAT_Subsystem& subsystem)
 {
   packet.flush();
+  const unsigned long budgetStartTime = micros();
+  const unsigned long startTime = ESAT_CycleProfiler.start();
   const boolean gotPacket = subsystem.readTelecommand(packet);
+  ESAT_CycleProfiler.stop(ESAT_CycleProfiler.TELECOMMAND_READ_PHASE,
+                          subsystem.getApplicationProcessIdentifier(),
+                          startTime);
+  chargeSubsystem(subsystem, budgetStartTime);
   if (gotPacket && packet.isTelecommand())
   {
     packet.rewind();
@@ -134,7 +563,11 @@ boolean ESAT_OnBoardDataHandlingClass::readTelecommandFromSubsystem(ESAT_CCSDSPa
 boolean ESAT_OnBoardDataHandlingClass::readTelecommandFromUSB(ESAT_CCSDSPacket& packet)
 {
   packet.flush();
+  const unsigned long startTime = ESAT_CycleProfiler.start();
   const boolean gotPacket = usbReader.read(packet);
+  ESAT_CycleProfiler.stop(ESAT_CycleProfiler.TELECOMMAND_READ_PHASE,
+                          ESAT_TelemetryRoutingTable.USB_SINK,
+                          startTime);
   if (gotPacket && packet.isTelecommand())
   {
     packet.rewind();
@@ -151,9 +584,16 @@ boolean ESAT_OnBoardDataHandlingClass::readTelemetryFromSubsystem(ESAT_CCSDSPack
                                                                   ESAT_Subsystem& subsystem)
 {
   packet.flush();
+  const unsigned long budgetStartTime = micros();
+  const unsigned long startTime = ESAT_CycleProfiler.start();
   const boolean gotPacket = subsystem.readTelemetry(packet);
+  ESAT_CycleProfiler.stop(ESAT_CycleProfiler.TELEMETRY_READ_PHASE,
+                          subsystem.getApplicationProcessIdentifier(),
+                          startTime);
+  chargeSubsystem(subsystem, budgetStartTime);
   if (gotPacket && packet.isTelemetry())
   {
+    latestTelemetryStored = subsystem.latestTelemetryWasStored();
     packet.rewind();
     return true;
   }
@@ -176,8 +616,40 @@ boolean ESAT_OnBoardDataHandlingClass::readSubsystemsTelemetry(ESAT_CCSDSPacket&
   // subsystem.
   // The packet is rewound after the subsystem fills it so that
   // the main program can use it directly.
+  // In pipelined telemetry mode, the packets of the subsystems with
+  // pending telemetry requests come first; these subsystems are
+  // skipped afterwards.
+  // When the telemetry phase runs out of budget, the rest of the
+  // telemetry of this cycle is skipped.
+  latestTelemetryStored = false;
+  if (!budgetLeft(TELEMETRY_BUDGET_PHASE))
+  {
+    for (ESAT_Subsystem* subsystem = firstSubsystem;
+         subsystem != nullptr;
+         subsystem = subsystem->nextSubsystem)
+    {
+      subsystem->telemetryRequestPending = false;
+    }
+    telemetrySubsystem = nullptr;
+    return false;
+  }
+  if (pipelinedTelemetry)
+  {
+    const boolean gotTelemetry = pollSubsystemsTelemetry(packet);
+    if (gotTelemetry)
+    {
+      return true;
+    }
+  }
   while (telemetrySubsystem != nullptr)
   {
+    if (telemetrySubsystem->telemetryPipelined
+        || !isHealthy(*telemetrySubsystem)
+        || !subsystemBudgetLeft(*telemetrySubsystem))
+    {
+      telemetrySubsystem = telemetrySubsystem->nextSubsystem;
+      continue;
+    }
     const boolean gotTelemetry =
       readTelemetryFromSubsystem(packet, *telemetrySubsystem);
     if (gotTelemetry)
@@ -211,6 +683,100 @@ void ESAT_OnBoardDataHandlingClass::registerSubsystem(ESAT_Subsystem& subsystem)
   }
 }
 
+ESAT_Subsystem* ESAT_OnBoardDataHandlingClass::registeredSubsystems()
+{
+  return firstSubsystem;
+}
+
+void ESAT_OnBoardDataHandlingClass::requestSubsystemsTelemetry()
+{
+  // Subsystems that don't take split telemetry requests (or that
+  // fail to take them) go through readTelemetry() as usual.
+  for (ESAT_Subsystem* subsystem = firstSubsystem;
+       subsystem != nullptr;
+       subsystem = subsystem->nextSubsystem)
+  {
+    if (pipelinedTelemetry && isHealthy(*subsystem))
+    {
+      subsystem->telemetryRequestPending = subsystem->requestTelemetry();
+    }
+    else
+    {
+      subsystem->telemetryRequestPending = false;
+    }
+    subsystem->telemetryPipelined = subsystem->telemetryRequestPending;
+  }
+  pipelinedTelemetryStartTime = micros();
+}
+
+boolean ESAT_OnBoardDataHandlingClass::resetByWatchdog()
+{
+  return watchdogReset;
+}
+
+void ESAT_OnBoardDataHandlingClass::setPhaseBudget(const byte phase,
+                                                   const unsigned long microsecondsPerCycle)
+{
+  if (phase >= NUMBER_OF_BUDGET_PHASES)
+  {
+    return;
+  }
+  phaseBudgets[phase] = microsecondsPerCycle;
+}
+
+void ESAT_OnBoardDataHandlingClass::setSubsystemBudget(ESAT_Subsystem& subsystem,
+                                                       const unsigned long microsecondsPerCycle)
+{
+  subsystem.cycleBudget.microsecondsPerCycle = microsecondsPerCycle;
+}
+
+void ESAT_OnBoardDataHandlingClass::startPhase(const byte phase)
+{
+  phaseStartTimes[phase] = micros();
+  phaseCutShort[phase] = false;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::subsystemBudgetLeft(ESAT_Subsystem& subsystem)
+{
+  return subsystem.cycleBudget.busyTime
+    < subsystem.cycleBudget.microsecondsPerCycle;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::subsystemEventPending(ESAT_Subsystem& subsystem)
+{
+  // The cheap tests go first, so telecommandPending() is only asked
+  // when the subsystem would be read.
+  if (!isHealthy(subsystem) || !subsystemBudgetLeft(subsystem))
+  {
+    return false;
+  }
+  return subsystem.wakeUpLineChanged || subsystem.telecommandPending();
+}
+
+ESAT_TelemetrySinkQueue* ESAT_OnBoardDataHandlingClass::telemetryQueues()
+{
+  return firstTelemetryQueue;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::telemetryQueuesFull()
+{
+  for (ESAT_TelemetrySinkQueue* queue = firstTelemetryQueue;
+       queue != nullptr;
+       queue = queue->next)
+  {
+    if (queue->full() && isSinkHealthy(queue->sink()))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ESAT_OnBoardDataHandlingClass::requestWakeUp()
+{
+  wakeUpRequested = true;
+}
+
 void ESAT_OnBoardDataHandlingClass::updateSubsystems()
 {
   // Subsystems are updated in a first-in, first-out basis, from the
@@ -219,14 +785,115 @@ void ESAT_OnBoardDataHandlingClass::updateSubsystems()
   // and readTelemetry() are assigned to the first subsystem so that
   // the next series of calls to those methods can work from the
   // start of the list.
+  // The telemetry requests of the pipelined telemetry mode go out
+  // once all the subsystems have started their new telemetry series.
+  // Only healthy subsystems with budget left are updated.
+  // When the update phase runs out of budget, the rest of the
+  // subsystems wait for the next cycle, which starts from the
+  // first subsystem left out.  The budget is checked before each
+  // subsystem but the first one, so at least one subsystem is
+  // updated per cycle.
+  startPhase(UPDATE_BUDGET_PHASE);
+  ESAT_Subsystem* subsystem = updateSubsystem;
+  if (subsystem == nullptr)
+  {
+    subsystem = firstSubsystem;
+  }
+  updateSubsystem = nullptr;
+  ESAT_Subsystem* const firstUpdatedSubsystem = subsystem;
+  while (subsystem != nullptr)
+  {
+    checkHealth(*subsystem);
+    if (isHealthy(*subsystem) && subsystemBudgetLeft(*subsystem))
+    {
+      const unsigned long budgetStartTime = micros();
+      const unsigned long startTime = ESAT_CycleProfiler.start();
+      subsystem->update();
+      ESAT_CycleProfiler.stop(ESAT_CycleProfiler.UPDATE_PHASE,
+                              subsystem->getApplicationProcessIdentifier(),
+                              startTime);
+      chargeSubsystem(*subsystem, budgetStartTime);
+    }
+    subsystem = subsystem->nextSubsystem;
+    if (subsystem == nullptr)
+    {
+      subsystem = firstSubsystem;
+    }
+    if (subsystem == firstUpdatedSubsystem)
+    {
+      break;
+    }
+    if (!budgetLeft(UPDATE_BUDGET_PHASE))
+    {
+      updateSubsystem = subsystem;
+      break;
+    }
+  }
+  requestSubsystemsTelemetry();
+  startPhase(TELEMETRY_BUDGET_PHASE);
+  telecommandSubsystem = firstSubsystem;
+  telemetrySubsystem = firstSubsystem;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::waitUntilNextCycleOrEvent()
+{
+  // Events only start a new series of telecommand reads; the
+  // periodic cycle goes on unchanged.  Each subsystem wake-up line
+  // flags its own subsystem, so an event reads only the subsystems
+  // that signalled it and the USB interface if it has incoming data.
+  // The lines added with addWakeUpLine() don't say whose they are,
+  // so their events read all the subsystems that could be read.
+  if (!subsystemWakeUpLinesAttached)
+  {
+    for (ESAT_Subsystem* subsystem = firstSubsystem;
+         subsystem != nullptr;
+         subsystem = subsystem->nextSubsystem)
+    {
+      const int line = subsystem->wakeUpLine();
+      if (line >= 0)
+      {
+        attachInterrupt(line,
+                        [subsystem]()
+                        {
+                          subsystem->wakeUpLineChanged = true;
+                        },
+                        CHANGE);
+      }
+    }
+    subsystemWakeUpLinesAttached = true;
+  }
+  const boolean newCycle = ESAT_Timer.waitUntilNextCycleOrEvent(pollEvents);
+  const boolean anonymousWakeUp = wakeUpRequested;
+  wakeUpRequested = false;
+  if (newCycle)
+  {
+    handlingEvent = false;
+    return true;
+  }
   for (ESAT_Subsystem* subsystem = firstSubsystem;
        subsystem != nullptr;
        subsystem = subsystem->nextSubsystem)
   {
-    subsystem->update();
+    subsystem->eventPending =
+      (anonymousWakeUp
+       && isHealthy(*subsystem)
+       && subsystemBudgetLeft(*subsystem))
+      || subsystemEventPending(*subsystem);
+    if (subsystem->eventPending)
+    {
+      subsystem->wakeUpLineChanged = false;
+    }
   }
+  usbEventPending = usbTelecommandsEnabled && (Serial.available() > 0);
+  handlingEvent = true;
   telecommandSubsystem = firstSubsystem;
-  telemetrySubsystem = firstSubsystem;
+  startPhase(TELECOMMAND_BUDGET_PHASE);
+  return false;
+}
+
+boolean ESAT_OnBoardDataHandlingClass::watchdogEnabled()
+{
+  return watchdogActive;
 }
 
 void ESAT_OnBoardDataHandlingClass::writeTelemetry(ESAT_CCSDSPacket& packet)
@@ -239,18 +906,100 @@ void ESAT_OnBoardDataHandlingClass::writeTelemetry(ESAT_CCSDSPacket& packet)
   // The USB writer will just drop the packet if USB telemetry output
   // is disabled, so it is correct to always pass it the packet and
   // let it decide what to do.
+  // The routing table tells which sinks want the packet; the rest
+  // are skipped.  Sinks with a telemetry queue get the packet in
+  // their queue, to be written by drainTelemetryQueues().
+  // The snapshot keeps its fields of the fresh packets, even of those
+  // that the policy table holds back because they don't need to go
+  // out this time; stored telemetry goes out as it was stored.
   if (!packet.isTelemetry())
   {
     return;
   }
+  if (!latestTelemetryStored)
+  {
+    ESAT_TelemetrySnapshot.cache(packet);
+    if (!ESAT_TelemetryPolicyTable.accept(packet))
+    {
+      return;
+    }
+  }
+  const word sinks = ESAT_TelemetryRoutingTable.sinks(packet);
+  byte priorityClass = ESAT_TelemetryRoutingTable.priorityClass(packet);
+  if (latestTelemetryStored)
+  {
+    priorityClass = ESAT_TelemetrySinkQueue::BULK_CLASS;
+  }
   for (ESAT_Subsystem* subsystem = firstSubsystem;
        subsystem != nullptr;
        subsystem = subsystem->nextSubsystem)
   {
+    const word sink = subsystem->getApplicationProcessIdentifier();
+    if (!isHealthy(*subsystem)
+        || !ESAT_TelemetryRoutingTable.contains(sinks, sink))
+    {
+      continue;
+    }
+    ESAT_TelemetrySinkQueue* const queue = findTelemetryQueue(sink);
+    packet.rewind();
+    if (queue == nullptr)
+    {
+      writeTelemetryToSink(sink, packet);
+    }
+    else
+    {
+      (void) queue->write(packet, priorityClass);
+    }
+  }
+  if (ESAT_TelemetryRoutingTable.contains(sinks,
+                                          ESAT_TelemetryRoutingTable.USB_SINK))
+  {
+    ESAT_TelemetrySinkQueue* const queue =
+      findTelemetryQueue(ESAT_TelemetryRoutingTable.USB_SINK);
+    packet.rewind();
+    if (queue == nullptr)
+    {
+      writeTelemetryToSink(ESAT_TelemetryRoutingTable.USB_SINK, packet);
+    }
+    else
+    {
+      (void) queue->write(packet, priorityClass);
+    }
+  }
+}
+
+void ESAT_OnBoardDataHandlingClass::writeTelemetryToSink(const word sink,
+                                                         ESAT_CCSDSPacket& packet)
+{
+  // The USB writer will just drop the packet if USB telemetry output
+  // is disabled.
+  const unsigned long startTime = ESAT_CycleProfiler.start();
+  if (sink == ESAT_TelemetryRoutingTable.USB_SINK)
+  {
+    packet.rewind();
+    if (usbTransferFramesEnabled)
+    {
+      (void) usbTransferFrameWriter.write(packet);
+    }
+    else
+    {
+      (void) usbWriter.unbufferedWrite(packet);
+    }
+  }
+  else
+  {
+    ESAT_Subsystem* const subsystem = findSinkSubsystem(sink);
+    if (subsystem == nullptr)
+    {
+      return;
+    }
     packet.rewind();
     subsystem->writeTelemetry(packet);
   }
-  (void) usbWriter.unbufferedWrite(packet);
+  ESAT_CycleProfiler.stop(ESAT_CycleProfiler.TELEMETRY_WRITE_PHASE,
+                          sink,
+                          startTime);
+  ESAT_TelemetryRoutingTable.count(sink, packet);
 }
 
 ESAT_OnBoardDataHandlingClass ESAT_OnBoardDataHandling;
@@ -24,7 +24,10 @@
 #include <ESAT_CCSDSPacket.h>
 #include <ESAT_CCSDSPacketFromKISSFrameReader.h>
 #include <ESAT_CCSDSPacketToKISSFrameWriter.h>
+#include <ESAT_CCSDSPacketToTransferFrameWriter.h>
+#include <ESAT_I2CBusScheduler.h>
 #include <ESAT_I2CMaster.h>
+#include <ESAT_I2CStatistics.h>
 #include <ESAT_KISSStream.h>
 #include <ESAT_Timer.h>
 #include <Wire.h>
@@ -39,15 +42,33 @@
 #include "ESAT_OBC-subsystems/ESAT_Subsystem.h"
 #include "ESAT_OBC-subsystems/ESAT_ThermalPayloadSubsystem.h"
 #include "ESAT_OBC-subsystems/ESAT_WifiSubsystem.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCDefineSnapshotTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCDisableTelemetryTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCDownloadStoredTelemetryTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCEnableTelemetryTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCEraseStoredTelemetryTelecommand.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCScheduleTelecommandTelecommand.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCSetTelemetryPolicyTelecommand.h"
+#include "ESAT_OBC-telecommands/ESAT_OBCSetTelemetryRouteTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCSetTimeTelecommand.h"
 #include "ESAT_OBC-telecommands/ESAT_OBCStoreTelemetryTelecommand.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCCycleBudgetTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCCycleProfileTelemetry.h"
 #include "ESAT_OBC-telemetry/ESAT_OBCHousekeepingTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCI2CBusTelemetry.h"
 #include "ESAT_OBC-telemetry/ESAT_OBCLinesTelemetry.h"
 #include "ESAT_OBC-telemetry/ESAT_OBCProcessorTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCSnapshotTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCSubsystemsHealthTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryPoliciesTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryQueuesTelemetry.h"
+#include "ESAT_OBC-telemetry/ESAT_OBCTelemetryRoutingTelemetry.h"
+#include "ESAT_CycleProfiler.h"
+#include "ESAT_TelecommandScheduler.h"
+#include "ESAT_TelemetryPolicyTable.h"
+#include "ESAT_TelemetryRoutingTable.h"
+#include "ESAT_TelemetrySinkQueue.h"
+#include "ESAT_TelemetrySnapshot.h"
 
 // On-board data handling library.
 // ESAT_OnBoardDataHandling operates on the subsystems (which
@@ -62,19 +83,139 @@
 //   * then, it calls availableTelemetry() on each subsystem and,
 //     while there is telemetry available, it calls readTelemetry();
 //   * finally, it calls writeTelemetry() on all the subsystems.
+// In pipelined telemetry mode, updateSubsystems() also calls
+// requestTelemetry() on all the subsystems, so the subsystems that
+// take split telemetry requests (like the I2C boards) prepare their
+// packets in parallel; then, readSubsystemsTelemetry() collects their
+// packets with pollTelemetry() as they get ready before visiting the
+// rest of the subsystems with readTelemetry().
+// On each call to updateSubsystems(), the subsystems are probed with
+// probe().  A subsystem that fails its probe is skipped for a number
+// of cycles that doubles with each new failure (backoff); after
+// QUARANTINE_THRESHOLD failures in a row, it is probed only once every
+// QUARANTINE_PROBE_PERIOD cycles (quarantine).  Skipped subsystems
+// don't get calls to readTelecommand(), handleTelecommand(), update(),
+// readTelemetry() or writeTelemetry(), so a dead board doesn't eat
+// the cycle time of the rest of the satellite.  The first probe that
+// succeeds brings the subsystem back.
+// In event-driven mode, the main program waits with
+// waitUntilNextCycleOrEvent() instead of ESAT_Timer.waitUntilNextCycle():
+// it wakes up as soon as there is an incoming telecommand on the USB
+// interface or on a subsystem (see ESAT_Subsystem::telecommandPending())
+// or a change on a wake-up line (see ESAT_Subsystem::wakeUpLine() and
+// addWakeUpLine()), handles the telecommands of the sources of the
+// event right away and goes back to sleep, while the periodic update
+// of the subsystems keeps the cycle period of ESAT_Timer.
+// When the cycle profiler is compiled in (see ESAT_CycleProfiler),
+// the phases of the cycle are measured.
+// Sinks with a telemetry queue (see ESAT_TelemetrySinkQueue and
+// addTelemetryQueue()) don't get their packets right away from
+// writeTelemetry(): the packets wait in the queue until
+// drainTelemetryQueues() writes them within the time budget of the
+// queue.
+// The cycle budget keeps the cycle time deterministic: each phase
+// of the cycle (telecommands, update, telemetry, telemetry queue
+// drain; see setPhaseBudget()) and each subsystem (see
+// setSubsystemBudget()) may spend up to a number of microseconds per
+// cycle.  The budgets are checked between calls to the subsystems,
+// so a phase or subsystem that runs out of budget is cut short and
+// counted as an overrun; the unread telecommands wait for the next
+// cycle and the update and the telemetry queue drain resume next
+// cycle where they left off.  The main program marks the cycle
+// boundaries with beginCycle() and endCycle().  A call that never
+// returns (like a hung I2C slave) can't be cut short: then, the
+// independent watchdog (see enableWatchdog()), which only endCycle()
+// refreshes, resets the on-board computer.
 // Use the global instance ESAT_OnBoardDataHandling.
 class ESAT_OnBoardDataHandlingClass
 {
   public:
+    // Phases of the cycle with a time budget.
+    enum BudgetPhase
+    {
+      // Telecommand reads (readTelecommand()).
+      TELECOMMAND_BUDGET_PHASE = 0,
+      // Subsystem update (updateSubsystems()).
+      UPDATE_BUDGET_PHASE = 1,
+      // Telemetry reads (readSubsystemsTelemetry()).
+      TELEMETRY_BUDGET_PHASE = 2,
+      // Telemetry queue drain (drainTelemetryQueues()).
+      DRAIN_BUDGET_PHASE = 3,
+    };
+
+    // Number of phases with a time budget.
+    static const byte NUMBER_OF_BUDGET_PHASES = 4;
+
+    // Time budget of the phases and subsystems without a limit.
+    static const unsigned long UNLIMITED_BUDGET = 0xFFFFFFFF;
+
+    // Add a telemetry queue for the sink of the queue.  From then on,
+    // writeTelemetry() puts the packets for that sink in the queue.
+    // The queue must be ready (its begin() method called).
+    void addTelemetryQueue(ESAT_TelemetrySinkQueue& queue);
+
+    // Wake up waitUntilNextCycleOrEvent() whenever the given input
+    // line changes (for example, the ready line of an I2C board).
+    // Configure the line as an input before.  These lines don't say
+    // which subsystem they belong to, so their events read the
+    // telecommands of all the subsystems; lines given by
+    // ESAT_Subsystem::wakeUpLine() are attached automatically and
+    // only read their own subsystem.
+    void addWakeUpLine(byte line);
+
+    // Mark the start of a cycle: start the telecommand phase and the
+    // budget of the subsystems.
+    void beginCycle();
+
+    // Probe the subsystem if it is due for a probe and update its
+    // health accordingly.  updateSubsystems() calls this on each
+    // registered subsystem.
+    void checkHealth(ESAT_Subsystem& subsystem);
+
     // Disable reception of telecommands from the USB interface.
     void disableUSBTelecommands();
 
+    // Disable the pipelined telemetry mode: visit the subsystems
+    // strictly one after another.  This is the default mode.
+    void disablePipelinedTelemetry();
+
     // Disable emission of telecommands through the USB interface.
     void disableUSBTelemetry();
 
     // Dispatch a command on the registered subsystems.
     void dispatchTelecommand(ESAT_CCSDSPacket& packet);
 
+    // Write the queued telemetry packets to their sinks, the most
+    // important ones first, until the queues are empty or their time
+    // budgets run out.  Unhealthy sinks keep their packets.
+    void drainTelemetryQueues();
+
+    // Enable the independent watchdog with the given timeout in
+    // microseconds.  From then on, the on-board computer resets
+    // unless endCycle() is called at least once every timeout.
+    // The watchdog can't be disabled once enabled.
+    void enableWatchdog(unsigned long timeout);
+
+    // Mark the end of a cycle: send the pending USB transfer frame (if
+    // USB transfer frames are enabled) and refresh the watchdog if the
+    // cycle went through since the latest call to beginCycle().
+    void endCycle();
+
+    // Return true if there is an event to handle before the next
+    // cycle: a change on a wake-up line, incoming data on the USB
+    // interface (when USB telecommands are enabled) or a telecommand
+    // pending on a healthy subsystem; otherwise return false.
+    // Subsystems out of cycle budget don't count, as readTelecommand()
+    // would skip them anyway.
+    boolean eventPending();
+
+    // Enable the pipelined telemetry mode: ask all the subsystems that
+    // take split telemetry requests for their telemetry up front and
+    // collect the packets as they get ready.  Stop waiting for the
+    // packets that aren't ready the given number of microseconds
+    // after the update of the subsystems.
+    void enablePipelinedTelemetry(unsigned long microsecondsPerCycle);
+
     // Enable reception of telecommands from the USB interface.  Use
     // the buffer for accumulating the partially-received telecommands
     // from one call to readTelecommand() to the next.
@@ -83,6 +224,29 @@ class ESAT_OnBoardDataHandlingClass
     // Enable emission of telemetry through the USB interface.
     void enableUSBTelemetry();
 
+    // Enable emission of telemetry through the USB interface packed
+    // in fixed-length CCSDS TM Transfer Frames (virtual channel 0 of
+    // the given spacecraft) instead of one KISS frame per packet.  Use
+    // the buffer (which must hold frameLength bytes) to build the
+    // frames.  Longer frames cut the framing overhead per packet;
+    // endCycle() sends the last frame of each cycle padded with an
+    // idle packet.
+    void enableUSBTransferFrames(byte buffer[],
+                                 word frameLength,
+                                 word spacecraftIdentifier);
+
+    // Return true if the subsystem is healthy and can be used in the
+    // current cycle; otherwise return false.
+    boolean isHealthy(ESAT_Subsystem& subsystem);
+
+    // Return the time budget per cycle of the given phase in
+    // microseconds.
+    unsigned long phaseBudget(byte phase);
+
+    // Return the number of cycles in which the given phase ran out of
+    // budget.
+    unsigned long phaseOverruns(byte phase);
+
     // Read an incomming telecommand and write it into a packet.
     // Return true if there was a valid telecommand available;
     // otherwise return false.
@@ -91,21 +255,130 @@ class ESAT_OnBoardDataHandlingClass
     // Register a subsystem.
     void registerSubsystem(ESAT_Subsystem& subsystem);
 
+    // Return true if the latest reset came from the watchdog;
+    // otherwise return false.  Known after enableWatchdog().
+    boolean resetByWatchdog();
+
+    // Return the first registered subsystem (follow nextSubsystem for
+    // the rest of them) or nullptr if there are no registered
+    // subsystems.
+    ESAT_Subsystem* registeredSubsystems();
+
     // Read the next available telemetry packet and write it into the
     // provided packet object.
     // Return true if there was a valid telemetry packet available;
     // otherwise return false.
     boolean readSubsystemsTelemetry(ESAT_CCSDSPacket& packet);
 
+    // Set the time budget per cycle (in microseconds) of the given
+    // phase (one of the BudgetPhase values).  The phase goes on at
+    // least until its first call to a subsystem or sink.
+    void setPhaseBudget(byte phase, unsigned long microsecondsPerCycle);
+
+    // Set the time budget per cycle (in microseconds) of the given
+    // subsystem.  After running out of budget, the subsystem is
+    // skipped until the next cycle, except for the dispatch of
+    // telecommands already read.
+    void setSubsystemBudget(ESAT_Subsystem& subsystem,
+                            unsigned long microsecondsPerCycle);
+
+    // Return the first telemetry queue (follow next for the rest of
+    // them) or nullptr if there are no telemetry queues.
+    ESAT_TelemetrySinkQueue* telemetryQueues();
+
+    // Return true if the telemetry queue of any healthy sink is full;
+    // otherwise return false.  Producers of bulk telemetry (like the stored telemetry
+    // download) should hold off their packets while this is true.
+    boolean telemetryQueuesFull();
+
     // Update the registered subsystems.
     void updateSubsystems();
 
+    // Return true if the watchdog is enabled; otherwise return false.
+    boolean watchdogEnabled();
+
+    // Wait until the next cycle of ESAT_Timer is due or there is an
+    // event to handle (see eventPending()), whichever happens first.
+    // The first call attaches the wake-up lines of the registered
+    // subsystems.
+    // Return true at the start of the next cycle: then, go through
+    // the whole cycle (telecommands, update, telemetry).  Return false
+    // on events: then, just handle the telecommands with
+    // readTelecommand() and dispatchTelecommand(), which read only
+    // the sources of the event (the subsystems that signalled it and
+    // the USB interface if it has incoming data).
+    boolean waitUntilNextCycleOrEvent();
+
     // Write a telemetry packet to the subsystems that handle
     // telemetry.  For example, a communications subsystem may
     // transmit the packet to the ground station.
+    // Only the sinks given by ESAT_TelemetryRoutingTable get the packet.
+    // Sinks with a telemetry queue get the packet in their queue with
+    // the priority class given by ESAT_TelemetryRoutingTable, except
+    // stored telemetry packets, which go as bulk telemetry.
     void writeTelemetry(ESAT_CCSDSPacket& packet);
 
   private:
+    // Put a subsystem in quarantine after this number of failed
+    // probes in a row.
+    static const byte QUARANTINE_THRESHOLD = 4;
+
+    // Probe the subsystems in quarantine once every this number
+    // of cycles.  This is also the longest backoff.
+    static const word QUARANTINE_PROBE_PERIOD = 16;
+
+    // In pipelined telemetry mode, wait this number of microseconds
+    // between successive rounds of polls to the subsystems whose
+    // telemetry packets aren't ready yet.
+    static const word PIPELINED_TELEMETRY_POLLING_PERIOD = 250;
+
+    // Read queued telemetry packets into this buffer before writing
+    // them to their sinks.
+    byte drainBuffer[ESAT_TelemetrySinkQueue::PACKET_DATA_CAPACITY];
+
+    // True between beginCycle() and endCycle(); false otherwise.
+    boolean cycleInProgress = false;
+
+    // Next telemetry queue to drain: drainTelemetryQueues() starts
+    // from the queue where it ran out of budget in the previous cycle.
+    ESAT_TelemetrySinkQueue* drainQueue = nullptr;
+
+    // First telemetry queue.
+    ESAT_TelemetrySinkQueue* firstTelemetryQueue = nullptr;
+
+    // True if the latest telemetry packet read from the subsystems
+    // was a stored telemetry packet; false otherwise.
+    boolean latestTelemetryStored = false;
+
+    // Time budget per cycle of each phase in microseconds.
+    unsigned long phaseBudgets[NUMBER_OF_BUDGET_PHASES] =
+      {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+
+    // True if the phase ran out of budget during the current cycle;
+    // false otherwise.
+    boolean phaseCutShort[NUMBER_OF_BUDGET_PHASES] =
+      {false, false, false, false};
+
+    // Number of cycles in which each phase ran out of budget.
+    // Counters stop at their maximum value instead of overflowing.
+    unsigned long phaseOverrunCounters[NUMBER_OF_BUDGET_PHASES] =
+      {0, 0, 0, 0};
+
+    // Start time (in microseconds) of each phase.
+    unsigned long phaseStartTimes[NUMBER_OF_BUDGET_PHASES] =
+      {0, 0, 0, 0};
+
+    // True in pipelined telemetry mode; false otherwise.
+    boolean pipelinedTelemetry = false;
+
+    // In pipelined telemetry mode, stop waiting for telemetry packets
+    // this number of microseconds after the update of the subsystems.
+    unsigned long pipelinedTelemetryBudget = 0;
+
+    // Time (in microseconds) of the latest telemetry requests of
+    // the pipelined telemetry mode.
+    unsigned long pipelinedTelemetryStartTime = 0;
+
     // Head of the list of subsystems visited by readTelecommand().
     ESAT_Subsystem* telecommandSubsystem;
 
@@ -118,12 +391,79 @@ class ESAT_OnBoardDataHandlingClass
     // Last subsystem of the list of registered subsystems.
     ESAT_Subsystem* lastSubsystem;
 
+    // Next subsystem to update: updateSubsystems() starts from the
+    // subsystem where it ran out of budget in the previous cycle.
+    ESAT_Subsystem* updateSubsystem = nullptr;
+
+    // True while handling an event: then, readTelecommand() reads
+    // only the sources of the event.
+    boolean handlingEvent = false;
+
+    // True after attaching the wake-up lines of the registered
+    // subsystems; false otherwise.
+    boolean subsystemWakeUpLinesAttached = false;
+
+    // True while handling an event with incoming data on the USB
+    // interface.
+    boolean usbEventPending = false;
+
+    // True when USB telecommands are enabled; false otherwise.
+    boolean usbTelecommandsEnabled = false;
+
+    // True when USB telemetry goes in transfer frames; false otherwise.
+    boolean usbTransferFramesEnabled = false;
+
+    // True if the watchdog is enabled; false otherwise.
+    boolean watchdogActive = false;
+
+    // True if the latest reset came from the watchdog; false otherwise.
+    boolean watchdogReset = false;
+
+    // Set by the wake-up line interrupts; cleared by
+    // waitUntilNextCycleOrEvent() when it wakes up.
+    static volatile boolean wakeUpRequested;
+
     // Use this to read packets from the USB interface.
     ESAT_CCSDSPacketFromKISSFrameReader usbReader;
 
     // Use this to write packets to the USB interface.
     ESAT_CCSDSPacketToKISSFrameWriter usbWriter;
 
+    // Use this to write packets to the USB interface in transfer
+    // frames.
+    ESAT_CCSDSPacketToTransferFrameWriter usbTransferFrameWriter;
+
+    // Return true if the given phase has budget left in the current
+    // cycle; otherwise count the overrun (once per cycle) and return
+    // false.
+    boolean budgetLeft(byte phase);
+
+    // Add the time since the given start time (as returned by
+    // micros()) to the busy time of the subsystem and count the
+    // overrun if the subsystem runs out of budget.
+    void chargeSubsystem(ESAT_Subsystem& subsystem,
+                         unsigned long startTime);
+
+    // Return the registered subsystem that takes the telemetry of the
+    // given sink or nullptr if there is no such subsystem.
+    ESAT_Subsystem* findSinkSubsystem(word sink);
+
+    // Return the telemetry queue of the given sink or nullptr if the
+    // sink has no telemetry queue.
+    ESAT_TelemetrySinkQueue* findTelemetryQueue(word sink);
+
+    // Return true if the given sink is the USB interface or a
+    // registered healthy subsystem; otherwise return false.
+    boolean isSinkHealthy(word sink);
+
+    // Collect the next telemetry packet that gets ready among the
+    // pending telemetry requests of the pipelined telemetry mode and
+    // write it into the provided packet object.  Ask the subsystem
+    // for its next telemetry packet right away.
+    // Return true if there was a telemetry packet before running out
+    // of pending requests or time budget; otherwise return false.
+    boolean pollSubsystemsTelemetry(ESAT_CCSDSPacket& packet);
+
     // Read a telecommand packet from a subsystem.  Return true on
     // success; otherwise return false.
     boolean readTelecommandFromSubsystem(ESAT_CCSDSPacket& packet,
@@ -137,6 +477,34 @@ class ESAT_OnBoardDataHandlingClass
     // success; otherwise return false.
     boolean readTelemetryFromSubsystem(ESAT_CCSDSPacket& packet,
                                        ESAT_Subsystem& subsystem);
+
+    // Return ESAT_OnBoardDataHandling.eventPending() so that
+    // ESAT_Timer can call it.
+    static boolean pollEvents();
+
+    // Ask all the subsystems for their first telemetry packet in
+    // pipelined telemetry mode.
+    void requestSubsystemsTelemetry();
+
+    // Wake-up line interrupt handler: set wakeUpRequested.
+    static void requestWakeUp();
+
+    // Start the time budget of the given phase.
+    void startPhase(byte phase);
+
+    // Return true if the subsystem has budget left in the current
+    // cycle; otherwise return false.
+    boolean subsystemBudgetLeft(ESAT_Subsystem& subsystem);
+
+    // Return true if the given subsystem has an event to handle: it
+    // is healthy, it has cycle budget left and either its wake-up
+    // line changed or it has a telecommand pending; otherwise return
+    // false.
+    boolean subsystemEventPending(ESAT_Subsystem& subsystem);
+
+    // Write a telemetry packet to the given sink right away and count
+    // it on ESAT_TelemetryRoutingTable.
+    void writeTelemetryToSink(word sink, ESAT_CCSDSPacket& packet);
 };
 
 // Global instance of the on-board data handling library.
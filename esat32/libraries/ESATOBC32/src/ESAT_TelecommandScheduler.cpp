@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_TelecommandScheduler.h"
+#include <ESAT_Buffer.h>
+
+// The filename of the schedule cannot exceed 8 characters
+// due to filesystem limitations.
+const char ESAT_TelecommandSchedulerClass::SCHEDULE_FILENAME[] = "TCSCHED";
+
+void ESAT_TelecommandSchedulerClass::begin()
+{
+  // The file is kept open and flushed after each change.
+  // A header that promises more slots than the file has means a
+  // damaged file.
+  numberOfTelecommands = 0;
+  arrivalNumber = 0;
+  file = SD.open(SCHEDULE_FILENAME, FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
+  if (!file)
+  {
+    return;
+  }
+  byte header[HEADER_LENGTH];
+  file.seek(0);
+  const int bytesRead = file.read(header, sizeof(header));
+  if (bytesRead != int(sizeof(header)))
+  {
+    (void) writeHeader();
+    file.flush();
+    return;
+  }
+  const word storedTelecommands = word(header[0], header[1]);
+  arrivalNumber = (((unsigned long) header[2]) << 24)
+                | (((unsigned long) header[3]) << 16)
+                | (((unsigned long) header[4]) << 8)
+                | ((unsigned long) header[5]);
+  const unsigned long storedLength =
+    HEADER_LENGTH + ((unsigned long) storedTelecommands) * SLOT_LENGTH;
+  if ((storedTelecommands > MAXIMUM_NUMBER_OF_TELECOMMANDS)
+      || (file.size() < storedLength))
+  {
+    (void) writeHeader();
+    file.flush();
+    return;
+  }
+  numberOfTelecommands = storedTelecommands;
+  if ((numberOfTelecommands > 0) && !readKey(0, earliestKey))
+  {
+    numberOfTelecommands = 0;
+  }
+}
+
+void ESAT_TelecommandSchedulerClass::encodeKey(const ESAT_Timestamp executionTime,
+                                               const unsigned long arrival,
+                                               byte key[])
+{
+  key[0] = highByte(executionTime.year);
+  key[1] = lowByte(executionTime.year);
+  key[2] = executionTime.month;
+  key[3] = executionTime.day;
+  key[4] = executionTime.hours;
+  key[5] = executionTime.minutes;
+  key[6] = executionTime.seconds;
+  key[7] = byte(arrival >> 24);
+  key[8] = byte(arrival >> 16);
+  key[9] = byte(arrival >> 8);
+  key[10] = byte(arrival);
+}
+
+boolean ESAT_TelecommandSchedulerClass::read(ESAT_CCSDSPacket& packet,
+                                             ESAT_Clock& clock)
+{
+  // The earliest telecommand leaves the root of the heap and the
+  // last telecommand goes down from the root to its place.
+  if (numberOfTelecommands == 0)
+  {
+    return false;
+  }
+  byte currentKey[KEY_LENGTH];
+  encodeKey(clock.read(), 0, currentKey);
+  if (memcmp(earliestKey, currentKey, TIME_KEY_LENGTH) > 0)
+  {
+    return false;
+  }
+  if (!readSlot(0, otherSlot))
+  {
+    return false;
+  }
+  ESAT_Buffer buffer(otherSlot + KEY_LENGTH,
+                     MAXIMUM_PACKET_LENGTH,
+                     MAXIMUM_PACKET_LENGTH);
+  packet.flush();
+  const boolean gotPacket = packet.readFrom(buffer);
+  numberOfTelecommands = numberOfTelecommands - 1;
+  if ((numberOfTelecommands > 0)
+      && readSlot(numberOfTelecommands, movingSlot))
+  {
+    (void) siftDown();
+  }
+  (void) writeHeader();
+  if (numberOfTelecommands > 0)
+  {
+    (void) readKey(0, earliestKey);
+  }
+  file.flush();
+  if (gotPacket && packet.isTelecommand())
+  {
+    packet.rewind();
+    return true;
+  }
+  else
+  {
+    packet.flush();
+    return false;
+  }
+}
+
+boolean ESAT_TelecommandSchedulerClass::readKey(const word index,
+                                                byte key[])
+{
+  const unsigned long position =
+    HEADER_LENGTH + ((unsigned long) index) * SLOT_LENGTH;
+  if (!file.seek(position))
+  {
+    return false;
+  }
+  const int bytesRead = file.read(key, KEY_LENGTH);
+  return bytesRead == KEY_LENGTH;
+}
+
+boolean ESAT_TelecommandSchedulerClass::readSlot(const word index,
+                                                 byte slot[])
+{
+  const unsigned long position =
+    HEADER_LENGTH + ((unsigned long) index) * SLOT_LENGTH;
+  if (!file.seek(position))
+  {
+    return false;
+  }
+  const int bytesRead = file.read(slot, SLOT_LENGTH);
+  return bytesRead == SLOT_LENGTH;
+}
+
+boolean ESAT_TelecommandSchedulerClass::schedule(const ESAT_Timestamp executionTime,
+                                                 ESAT_CCSDSPacket& packet)
+{
+  // The new telecommand goes to the end of the heap (which grows the
+  // file when needed) and then up to its place.  The slot is written
+  // and read back before the header counts it and takes its arrival
+  // number, so neither a failed write nor a reset leaves an unwritten
+  // slot in the heap or skips an arrival number.  Only then does the
+  // telecommand go up, once it is safely in the heap.
+  if (!file || (numberOfTelecommands >= MAXIMUM_NUMBER_OF_TELECOMMANDS))
+  {
+    return false;
+  }
+  if ((ESAT_CCSDSPrimaryHeader::LENGTH + packet.length())
+      > MAXIMUM_PACKET_LENGTH)
+  {
+    return false;
+  }
+  (void) memset(movingSlot, 0, sizeof(movingSlot));
+  encodeKey(executionTime, arrivalNumber, movingSlot);
+  ESAT_Buffer buffer(movingSlot + KEY_LENGTH, MAXIMUM_PACKET_LENGTH);
+  if (!packet.writeTo(buffer))
+  {
+    return false;
+  }
+  const word index = numberOfTelecommands;
+  if (!writeSlot(index, movingSlot))
+  {
+    return false;
+  }
+  byte writtenKey[KEY_LENGTH];
+  if (!readKey(index, writtenKey)
+      || (memcmp(writtenKey, movingSlot, KEY_LENGTH) != 0))
+  {
+    return false;
+  }
+  numberOfTelecommands = numberOfTelecommands + 1;
+  arrivalNumber = arrivalNumber + 1;
+  if (!writeHeader())
+  {
+    numberOfTelecommands = numberOfTelecommands - 1;
+    arrivalNumber = arrivalNumber - 1;
+    return false;
+  }
+  const boolean placed = siftUp(index);
+  (void) readKey(0, earliestKey);
+  file.flush();
+  return placed;
+}
+
+boolean ESAT_TelecommandSchedulerClass::siftDown()
+{
+  // Each step moves the earliest child up into the hole until
+  // movingSlot is not later than the earliest child.
+  word index = 0;
+  while (true)
+  {
+    word child = 2 * index + 1;
+    if (child >= numberOfTelecommands)
+    {
+      break;
+    }
+    byte childKey[KEY_LENGTH];
+    if (!readKey(child, childKey))
+    {
+      break;
+    }
+    if ((child + 1) < numberOfTelecommands)
+    {
+      byte siblingKey[KEY_LENGTH];
+      if (readKey(child + 1, siblingKey)
+          && (memcmp(siblingKey, childKey, KEY_LENGTH) < 0))
+      {
+        child = child + 1;
+        (void) memcpy(childKey, siblingKey, KEY_LENGTH);
+      }
+    }
+    if (memcmp(childKey, movingSlot, KEY_LENGTH) >= 0)
+    {
+      break;
+    }
+    if (!readSlot(child, otherSlot) || !writeSlot(index, otherSlot))
+    {
+      break;
+    }
+    index = child;
+  }
+  return writeSlot(index, movingSlot);
+}
+
+boolean ESAT_TelecommandSchedulerClass::siftUp(word index)
+{
+  // Each step moves a later parent down into the hole until
+  // movingSlot is not earlier than its parent.
+  while (index > 0)
+  {
+    const word parent = (index - 1) / 2;
+    byte parentKey[KEY_LENGTH];
+    if (!readKey(parent, parentKey))
+    {
+      break;
+    }
+    if (memcmp(parentKey, movingSlot, KEY_LENGTH) <= 0)
+    {
+      break;
+    }
+    if (!readSlot(parent, otherSlot) || !writeSlot(index, otherSlot))
+    {
+      break;
+    }
+    index = parent;
+  }
+  return writeSlot(index, movingSlot);
+}
+
+word ESAT_TelecommandSchedulerClass::telecommands() const
+{
+  return numberOfTelecommands;
+}
+
+boolean ESAT_TelecommandSchedulerClass::writeHeader()
+{
+  if (!file.seek(0))
+  {
+    return false;
+  }
+  const byte header[HEADER_LENGTH] = {
+    highByte(numberOfTelecommands),
+    lowByte(numberOfTelecommands),
+    byte(arrivalNumber >> 24),
+    byte(arrivalNumber >> 16),
+    byte(arrivalNumber >> 8),
+    byte(arrivalNumber),
+  };
+  const size_t bytesWritten = file.write(header, sizeof(header));
+  return bytesWritten == sizeof(header);
+}
+
+boolean ESAT_TelecommandSchedulerClass::writeSlot(const word index,
+                                                  const byte slot[])
+{
+  const unsigned long position =
+    HEADER_LENGTH + ((unsigned long) index) * SLOT_LENGTH;
+  if (!file.seek(position))
+  {
+    return false;
+  }
+  const size_t bytesWritten = file.write(slot, SLOT_LENGTH);
+  return bytesWritten == SLOT_LENGTH;
+}
+
+ESAT_TelecommandSchedulerClass ESAT_TelecommandScheduler;
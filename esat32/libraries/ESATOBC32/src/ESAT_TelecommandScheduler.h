@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_TelecommandScheduler_h
+#define ESAT_TelecommandScheduler_h
+
+#include <Arduino.h>
+#include <STM32SD.h>
+#include <ESAT_CCSDSPacket.h>
+#include <ESAT_Clock.h>
+#include <ESAT_Timestamp.h>
+
+// Time-tagged telecommand scheduler: telecommands that wait until
+// their execution time, even across resets.
+// Use the global instance ESAT_TelecommandScheduler.
+//
+// The scheduled telecommands make a binary min-heap ordered by
+// execution time (and by order of arrival for equal execution times)
+// kept in the SD card as a file of fixed-size slots, so the schedule
+// holds thousands of telecommands without taking RAM.  Scheduling a
+// telecommand and taking a due telecommand read and write O(log n)
+// slots; checking for due telecommands reads no slot, as the earliest
+// execution time stays in RAM.  A reset in the middle of scheduling or
+// taking a telecommand may lose that telecommand or repeat another one.
+// The SPI interface must be configured before using this library:
+// you must have called SD.begin() before begin().
+class ESAT_TelecommandSchedulerClass
+{
+  public:
+    // Maximum number of scheduled telecommands.
+    static const word MAXIMUM_NUMBER_OF_TELECOMMANDS = 4096;
+
+    // Maximum length of a scheduled telecommand (whole packet).
+    static const word MAXIMUM_PACKET_LENGTH = 128;
+
+    // Open the schedule file of the SD card, creating it if needed.
+    // Start with an empty schedule if the file is damaged.
+    void begin();
+
+    // Take the earliest scheduled telecommand if its execution time
+    // has come according to the given clock and copy it into the
+    // given packet.
+    // Return true on success; return false if no telecommand is due
+    // or on error.
+    boolean read(ESAT_CCSDSPacket& packet, ESAT_Clock& clock);
+
+    // Schedule a telecommand packet for the given execution time.
+    // Return true on success; return false if the schedule is full,
+    // the packet is too long or on error.
+    boolean schedule(ESAT_Timestamp executionTime,
+                     ESAT_CCSDSPacket& packet);
+
+    // Return the number of scheduled telecommands.
+    word telecommands() const;
+
+  private:
+    // Length of the file header: number of scheduled telecommands
+    // (2 bytes) and next arrival number (4 bytes), big endian.
+    static const byte HEADER_LENGTH = 6;
+
+    // Length of the keys that order the heap: execution time (year as
+    // 2 bytes, month, day, hours, minutes and seconds) followed by the
+    // arrival number (4 bytes), big endian, so that comparing keys
+    // byte by byte gives their order.
+    static const byte KEY_LENGTH = 11;
+
+    // Length of the execution time part of the keys.
+    static const byte TIME_KEY_LENGTH = 7;
+
+    // Length of each slot of the file: key and telecommand packet,
+    // padded with zeros.
+    static const word SLOT_LENGTH = KEY_LENGTH + MAXIMUM_PACKET_LENGTH;
+
+    // Keep the schedule in this file.
+    static const char SCHEDULE_FILENAME[];
+
+    // Arrival number of the next scheduled telecommand.
+    unsigned long arrivalNumber = 0;
+
+    // Key of the earliest scheduled telecommand.
+    byte earliestKey[KEY_LENGTH];
+
+    // Schedule file.
+    File file;
+
+    // Number of scheduled telecommands.
+    word numberOfTelecommands = 0;
+
+    // Slot being moved through the heap.
+    byte movingSlot[SLOT_LENGTH];
+
+    // Slot being moved to make room for movingSlot.
+    byte otherSlot[SLOT_LENGTH];
+
+    // Write the key of the given execution time and arrival number.
+    void encodeKey(ESAT_Timestamp executionTime,
+                   unsigned long arrival,
+                   byte key[]);
+
+    // Read the key of the slot with the given heap index.
+    // Return true on success; otherwise return false.
+    boolean readKey(word index, byte key[]);
+
+    // Read the slot with the given heap index.
+    // Return true on success; otherwise return false.
+    boolean readSlot(word index, byte slot[]);
+
+    // Move movingSlot down from the root of the heap to its place
+    // among the first numberOfTelecommands slots.
+    // Return true on success; otherwise return false.
+    boolean siftDown();
+
+    // Move movingSlot up from the given heap index to its place.
+    // Return true on success; otherwise return false.
+    boolean siftUp(word index);
+
+    // Write the file header.
+    // Return true on success; otherwise return false.
+    boolean writeHeader();
+
+    // Write the slot with the given heap index.
+    // Return true on success; otherwise return false.
+    boolean writeSlot(word index, const byte slot[]);
+};
+
+// Global instance of the telecommand scheduler library.
+extern ESAT_TelecommandSchedulerClass ESAT_TelecommandScheduler;
+
+#endif /* ESAT_TelecommandScheduler_h */
@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_TelemetryPolicyTable.h"
+#include <ESAT_Util.h>
+
+// The filename of the policy table cannot exceed 8 characters
+// due to filesystem limitations.
+const char ESAT_TelemetryPolicyTableClass::POLICIES_FILENAME[] = "TMPOLICY";
+
+boolean ESAT_TelemetryPolicyTableClass::accept(ESAT_CCSDSPacket& packet)
+{
+  const byte index = findPacketPolicy(packet);
+  if (index == numberOfPolicies)
+  {
+    return true;
+  }
+  const Policy& policy = policyTable[index];
+  PolicyState& state = policyStates[index];
+  const unsigned long now = millis();
+  const unsigned long keepAliveTime =
+    1000UL * policy.keepAliveInterval;
+  const boolean keepAliveDue =
+    (!state.started)
+    || ((policy.keepAliveInterval > 0)
+        && ((now - state.latestPassTime) >= keepAliveTime));
+  if (state.packetsSinceDecimation < 0xFFFF)
+  {
+    state.packetsSinceDecimation = state.packetsSinceDecimation + 1;
+  }
+  const boolean decimationDue =
+    state.packetsSinceDecimation >= policy.decimation;
+  if (decimationDue)
+  {
+    state.packetsSinceDecimation = 0;
+  }
+  // Reading the fields is the expensive part, so do it only when
+  // it matters.
+  boolean pass = keepAliveDue;
+  if (!pass && decimationDue)
+  {
+    pass = fieldsChanged(packet, index);
+  }
+  if (!pass)
+  {
+    if (state.suppressedPackets < 0xFFFFFFFF)
+    {
+      state.suppressedPackets = state.suppressedPackets + 1;
+    }
+    packet.rewind();
+    return false;
+  }
+  // Changes are measured from the latest packet that went out, so
+  // slow drifts also get through sooner or later.
+  for (byte field = 0; field < policy.numberOfFields; field++)
+  {
+    float value;
+    if (readField(packet, policy.fields[field], value))
+    {
+      state.latestValues[field] = value;
+    }
+  }
+  state.started = true;
+  state.latestPassTime = now;
+  if (state.passedPackets < 0xFFFFFFFF)
+  {
+    state.passedPackets = state.passedPackets + 1;
+  }
+  packet.rewind();
+  return true;
+}
+
+void ESAT_TelemetryPolicyTableClass::begin()
+{
+  readPolicies();
+  for (byte index = 0; index < MAXIMUM_NUMBER_OF_POLICIES; index++)
+  {
+    resetState(index);
+  }
+}
+
+boolean ESAT_TelemetryPolicyTableClass::fieldsChanged(ESAT_CCSDSPacket& packet,
+                                                      const byte index)
+{
+  const Policy& policy = policyTable[index];
+  const PolicyState& state = policyStates[index];
+  if (policy.numberOfFields == 0)
+  {
+    return true;
+  }
+  for (byte field = 0; field < policy.numberOfFields; field++)
+  {
+    float value;
+    if (!readField(packet, policy.fields[field], value))
+    {
+      return true;
+    }
+    const float change = value - state.latestValues[field];
+    if ((change > policy.fields[field].deadband)
+        || (-change > policy.fields[field].deadband))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+byte ESAT_TelemetryPolicyTableClass::findPacketPolicy(ESAT_CCSDSPacket& packet) const
+{
+  if (numberOfPolicies == 0)
+  {
+    return numberOfPolicies;
+  }
+  packet.rewind();
+  if (packet.packetDataLength() < ESAT_CCSDSSecondaryHeader::LENGTH)
+  {
+    return numberOfPolicies;
+  }
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
+  const ESAT_CCSDSSecondaryHeader secondaryHeader =
+    packet.readSecondaryHeader();
+  packet.rewind();
+  return findPolicy(primaryHeader.applicationProcessIdentifier,
+                    secondaryHeader.packetIdentifier);
+}
+
+byte ESAT_TelemetryPolicyTableClass::findPolicy(const word applicationProcessIdentifier,
+                                                const byte packetIdentifier) const
+{
+  for (byte index = 0; index < numberOfPolicies; index++)
+  {
+    const Policy& policy = policyTable[index];
+    if ((policy.applicationProcessIdentifier == applicationProcessIdentifier)
+        && (policy.packetIdentifier == packetIdentifier))
+    {
+      return index;
+    }
+  }
+  return numberOfPolicies;
+}
+
+byte ESAT_TelemetryPolicyTableClass::policies() const
+{
+  return numberOfPolicies;
+}
+
+boolean ESAT_TelemetryPolicyTableClass::readField(ESAT_CCSDSPacket& packet,
+                                                  const Field& field,
+                                                  float& value) const
+{
+  packet.rewind();
+  const boolean correctSeek =
+    packet.seek(ESAT_CCSDSSecondaryHeader::LENGTH + field.offset);
+  if (!correctSeek)
+  {
+    return false;
+  }
+  switch (field.type)
+  {
+    case BYTE_FIELD:
+      value = packet.readByte();
+      break;
+    case CHAR_FIELD:
+      value = packet.readChar();
+      break;
+    case WORD_FIELD:
+      value = packet.readWord();
+      break;
+    case INT_FIELD:
+      value = packet.readInt();
+      break;
+    case UNSIGNED_LONG_FIELD:
+      value = packet.readUnsignedLong();
+      break;
+    case LONG_FIELD:
+      value = packet.readLong();
+      break;
+    case FLOAT_FIELD:
+      value = packet.readFloat();
+      break;
+    default:
+      return false;
+  }
+  const boolean correctRead = !packet.triedToReadBeyondLength();
+  packet.rewind();
+  return correctRead;
+}
+
+void ESAT_TelemetryPolicyTableClass::readPolicies()
+{
+  // The file has the number of policies followed by the policies:
+  // application process identifier (2 bytes, big endian), packet
+  // identifier (1 byte), decimation (2 bytes, big endian), keep-alive
+  // interval (2 bytes, big endian), number of fields (1 byte) and
+  // MAXIMUM_NUMBER_OF_FIELDS fields: offset (1 byte), type (1 byte)
+  // and deadband (4 bytes, big endian IEEE 754 number).
+  // A short file means a damaged file.
+  numberOfPolicies = 0;
+  File file = SD.open(POLICIES_FILENAME, FILE_READ);
+  if (!file)
+  {
+    return;
+  }
+  file.seek(0);
+  const int storedPolicies = file.read();
+  if ((storedPolicies < 0) || (storedPolicies > MAXIMUM_NUMBER_OF_POLICIES))
+  {
+    file.close();
+    return;
+  }
+  for (int index = 0; index < storedPolicies; index++)
+  {
+    byte data[POLICY_FILE_LENGTH];
+    const int bytesRead = file.read(data, sizeof(data));
+    if ((bytesRead != int(sizeof(data)))
+        || (data[7] > MAXIMUM_NUMBER_OF_FIELDS))
+    {
+      numberOfPolicies = 0;
+      break;
+    }
+    Policy& policy = policyTable[index];
+    policy.applicationProcessIdentifier = word(data[0], data[1]);
+    policy.packetIdentifier = data[2];
+    policy.decimation = word(data[3], data[4]);
+    policy.keepAliveInterval = word(data[5], data[6]);
+    policy.numberOfFields = data[7];
+    for (byte field = 0; field < MAXIMUM_NUMBER_OF_FIELDS; field++)
+    {
+      const byte* const fieldData = &data[8 + 6 * field];
+      policy.fields[field].offset = fieldData[0];
+      policy.fields[field].type = fieldData[1];
+      const unsigned long deadbandBits =
+        ESAT_Util.unsignedLong(word(fieldData[2], fieldData[3]),
+                               word(fieldData[4], fieldData[5]));
+      policy.fields[field].deadband =
+        ESAT_Util.unsignedLongToFloat(deadbandBits);
+    }
+    numberOfPolicies = numberOfPolicies + 1;
+  }
+  file.close();
+}
+
+ESAT_TelemetryPolicyTableClass::PolicyStatistics ESAT_TelemetryPolicyTableClass::readPolicyStatistics(const byte index) const
+{
+  PolicyStatistics statistics;
+  (void) memset(&statistics, 0, sizeof(statistics));
+  if (index < numberOfPolicies)
+  {
+    statistics.applicationProcessIdentifier =
+      policyTable[index].applicationProcessIdentifier;
+    statistics.packetIdentifier = policyTable[index].packetIdentifier;
+    statistics.passedPackets = policyStates[index].passedPackets;
+    statistics.suppressedPackets = policyStates[index].suppressedPackets;
+  }
+  return statistics;
+}
+
+void ESAT_TelemetryPolicyTableClass::resetState(const byte index)
+{
+  (void) memset(&policyStates[index], 0, sizeof(policyStates[index]));
+}
+
+boolean ESAT_TelemetryPolicyTableClass::setPolicy(const word applicationProcessIdentifier,
+                                                  const byte packetIdentifier,
+                                                  const word decimation,
+                                                  const word keepAliveInterval,
+                                                  const byte numberOfFields,
+                                                  const Field fields[])
+{
+  if (numberOfFields > MAXIMUM_NUMBER_OF_FIELDS)
+  {
+    return false;
+  }
+  for (byte field = 0; field < numberOfFields; field++)
+  {
+    if ((fields[field].type > FLOAT_FIELD)
+        || !(fields[field].deadband >= 0))
+    {
+      return false;
+    }
+  }
+  const byte index = findPolicy(applicationProcessIdentifier,
+                                packetIdentifier);
+  if ((decimation <= 1) && (numberOfFields == 0))
+  {
+    // Such a policy lets every packet through, just like having no
+    // policy.  Fill its place with the last policy.
+    if (index < numberOfPolicies)
+    {
+      numberOfPolicies = numberOfPolicies - 1;
+      policyTable[index] = policyTable[numberOfPolicies];
+      policyStates[index] = policyStates[numberOfPolicies];
+    }
+  }
+  else
+  {
+    if (index == numberOfPolicies)
+    {
+      if (numberOfPolicies >= MAXIMUM_NUMBER_OF_POLICIES)
+      {
+        return false;
+      }
+      numberOfPolicies = numberOfPolicies + 1;
+    }
+    Policy& policy = policyTable[index];
+    (void) memset(&policy, 0, sizeof(policy));
+    policy.applicationProcessIdentifier = applicationProcessIdentifier;
+    policy.packetIdentifier = packetIdentifier;
+    if (decimation > 1)
+    {
+      policy.decimation = decimation;
+    }
+    else
+    {
+      policy.decimation = 1;
+    }
+    policy.keepAliveInterval = keepAliveInterval;
+    policy.numberOfFields = numberOfFields;
+    for (byte field = 0; field < numberOfFields; field++)
+    {
+      policy.fields[field] = fields[field];
+    }
+    resetState(index);
+  }
+  writePolicies();
+  return true;
+}
+
+void ESAT_TelemetryPolicyTableClass::writePolicies()
+{
+  File file = SD.open(POLICIES_FILENAME, FILE_WRITE);
+  if (!file)
+  {
+    return;
+  }
+  file.seek(0);
+  (void) file.write(numberOfPolicies);
+  for (byte index = 0; index < numberOfPolicies; index++)
+  {
+    const Policy& policy = policyTable[index];
+    byte data[POLICY_FILE_LENGTH];
+    data[0] = highByte(policy.applicationProcessIdentifier);
+    data[1] = lowByte(policy.applicationProcessIdentifier);
+    data[2] = policy.packetIdentifier;
+    data[3] = highByte(policy.decimation);
+    data[4] = lowByte(policy.decimation);
+    data[5] = highByte(policy.keepAliveInterval);
+    data[6] = lowByte(policy.keepAliveInterval);
+    data[7] = policy.numberOfFields;
+    for (byte field = 0; field < MAXIMUM_NUMBER_OF_FIELDS; field++)
+    {
+      byte* const fieldData = &data[8 + 6 * field];
+      const unsigned long deadbandBits =
+        ESAT_Util.floatToUnsignedLong(policy.fields[field].deadband);
+      fieldData[0] = policy.fields[field].offset;
+      fieldData[1] = policy.fields[field].type;
+      fieldData[2] = highByte(ESAT_Util.highWord(deadbandBits));
+      fieldData[3] = lowByte(ESAT_Util.highWord(deadbandBits));
+      fieldData[4] = highByte(ESAT_Util.lowWord(deadbandBits));
+      fieldData[5] = lowByte(ESAT_Util.lowWord(deadbandBits));
+    }
+    (void) file.write(data, sizeof(data));
+  }
+  file.close();
+}
+
+ESAT_TelemetryPolicyTableClass ESAT_TelemetryPolicyTable;
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_TelemetryPolicyTable_h
+#define ESAT_TelemetryPolicyTable_h
+
+#include <Arduino.h>
+#include <STM32SD.h>
+#include <ESAT_CCSDSPacket.h>
+
+// Telemetry policy table: when each telemetry packet goes out.
+// Use the global instance ESAT_TelemetryPolicyTable.
+//
+// Each policy applies to a telemetry packet (application process
+// identifier and packet identifier) and combines up to three rules:
+// - Decimation: only one of every N packets may go out.
+// - Change only: the packet goes out only if one of its fields
+//   changed more than its deadband since the latest packet that went
+//   out.  The fields are numbers at given offsets of the user data
+//   field of the packet.  Without fields, this rule lets all the
+//   packets through.
+// - Keep-alive: a packet goes out at least once every given number of
+//   seconds, whatever the other rules say.
+// The first packet after begin() or after setting the policy always
+// goes out.  Packets without policy always go out, so an empty table
+// lets every packet through.  The table is kept in the SD card.  The
+// SPI interface must be configured before using this library: you
+// must have called SD.begin() before begin().
+class ESAT_TelemetryPolicyTableClass
+{
+  public:
+    // Types of the fields of change-only policies, as stored in the
+    // packets by ESAT_CCSDSPacket.
+    enum FieldType
+    {
+      BYTE_FIELD = 0,
+      CHAR_FIELD = 1,
+      WORD_FIELD = 2,
+      INT_FIELD = 3,
+      UNSIGNED_LONG_FIELD = 4,
+      LONG_FIELD = 5,
+      FLOAT_FIELD = 6,
+    };
+
+    // Field of a change-only policy.
+    struct Field
+    {
+      // Position of the field in the user data field of the packet.
+      byte offset;
+
+      // One of the FieldType values.
+      byte type;
+
+      // Changes up to this value don't count.
+      float deadband;
+    };
+
+    // Traffic statistics of a policy.
+    // Counters stop at their maximum value instead of overflowing.
+    struct PolicyStatistics
+    {
+      // Application process identifier of the packets of the policy.
+      word applicationProcessIdentifier;
+
+      // Packet identifier of the packets of the policy.
+      byte packetIdentifier;
+
+      // Number of packets that went out.
+      unsigned long passedPackets;
+
+      // Number of packets held back.
+      unsigned long suppressedPackets;
+    };
+
+    // Maximum number of fields of a change-only policy.
+    static const byte MAXIMUM_NUMBER_OF_FIELDS = 4;
+
+    // Maximum number of policies.
+    static const byte MAXIMUM_NUMBER_OF_POLICIES = 16;
+
+    // Return true if the given telemetry packet may go out under its
+    // policy; otherwise (the packet must be held back) return false.
+    // Update the state of the policy accordingly.
+    // This leaves the read/write pointer at the start of the packet
+    // data.
+    boolean accept(ESAT_CCSDSPacket& packet);
+
+    // Read the policy table from the SD card and reset the state and
+    // statistics of the policies.
+    void begin();
+
+    // Return the number of policies.
+    byte policies() const;
+
+    // Return the statistics of the policy at the given position
+    // (from 0 to policies() - 1).
+    PolicyStatistics readPolicyStatistics(byte index) const;
+
+    // Set the policy of the telemetry packets with the given
+    // application process identifier and packet identifier and write
+    // the policy table to the SD card: let one of every decimation
+    // packets through, only when one of the given fields changed more
+    // than its deadband, but at least once every keepAliveInterval
+    // seconds (0 for no keep-alive).  Setting a decimation of 1 or less
+    // without fields removes the policy.
+    // Return true on success; return false if the fields are wrong or
+    // if there are already MAXIMUM_NUMBER_OF_POLICIES policies.
+    boolean setPolicy(word applicationProcessIdentifier,
+                      byte packetIdentifier,
+                      word decimation,
+                      word keepAliveInterval,
+                      byte numberOfFields,
+                      const Field fields[]);
+
+  private:
+    // Policy of the telemetry packets with an application process
+    // identifier and a packet identifier.
+    struct Policy
+    {
+      word applicationProcessIdentifier;
+      byte packetIdentifier;
+      word decimation;
+      word keepAliveInterval;
+      byte numberOfFields;
+      Field fields[MAXIMUM_NUMBER_OF_FIELDS];
+    };
+
+    // State of a policy.
+    struct PolicyState
+    {
+      // True after the first packet went out.
+      boolean started;
+
+      // Number of packets since the latest decimated packet.
+      word packetsSinceDecimation;
+
+      // Time (as given by millis()) when the latest packet went out.
+      unsigned long latestPassTime;
+
+      // Values of the fields in the latest packet that went out.
+      float latestValues[MAXIMUM_NUMBER_OF_FIELDS];
+
+      // Number of packets that went out.
+      unsigned long passedPackets;
+
+      // Number of packets held back.
+      unsigned long suppressedPackets;
+    };
+
+    // Number of bytes of a policy in the policy table file.
+    static const byte POLICY_FILE_LENGTH =
+      8 + 6 * MAXIMUM_NUMBER_OF_FIELDS;
+
+    // Keep the policy table in this file.
+    static const char POLICIES_FILENAME[];
+
+    // Number of policies.
+    byte numberOfPolicies = 0;
+
+    // Policies.
+    Policy policyTable[MAXIMUM_NUMBER_OF_POLICIES];
+
+    // State of each policy.
+    PolicyState policyStates[MAXIMUM_NUMBER_OF_POLICIES];
+
+    // Return true if one of the fields of the given policy changed
+    // more than its deadband in the given packet; otherwise return
+    // false.  Fields that can't be read count as changed.
+    boolean fieldsChanged(ESAT_CCSDSPacket& packet, byte index);
+
+    // Return the index of the policy of the given telemetry packet or
+    // numberOfPolicies if the packet has no policy.
+    // This leaves the read/write pointer at the start of the packet
+    // data.
+    byte findPacketPolicy(ESAT_CCSDSPacket& packet) const;
+
+    // Return the index of the policy with the given application
+    // process identifier and packet identifier or numberOfPolicies if
+    // there is no such policy.
+    byte findPolicy(word applicationProcessIdentifier,
+                    byte packetIdentifier) const;
+
+    // Read the policy table from its file.  Leave the policy table
+    // empty if the file is missing or damaged.
+    void readPolicies();
+
+    // Read the value of the given field from the given packet.
+    // Return true on success; otherwise return false.
+    boolean readField(ESAT_CCSDSPacket& packet,
+                      const Field& field,
+                      float& value) const;
+
+    // Reset the state and statistics of the policy at the given index.
+    void resetState(byte index);
+
+    // Write the policy table to its file.
+    void writePolicies();
+};
+
+// Global instance of the telemetry policy table library.
+extern ESAT_TelemetryPolicyTableClass ESAT_TelemetryPolicyTable;
+
+#endif /* ESAT_TelemetryPolicyTable_h */
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_TelemetryRoutingTable.h"
+
+// The filename of the routing table cannot exceed 8 characters
+// due to filesystem limitations.
+const char ESAT_TelemetryRoutingTableClass::ROUTES_FILENAME[] = "TMROUTES";
+
+void ESAT_TelemetryRoutingTableClass::begin()
+{
+  (void) memset(sinkStatistics, 0, sizeof(sinkStatistics));
+  readRoutes();
+}
+
+boolean ESAT_TelemetryRoutingTableClass::contains(const word sinks,
+                                                  const word sink) const
+{
+  if (sink >= NUMBER_OF_SINKS)
+  {
+    return true;
+  }
+  return (sinks & (word(1) << sink)) != 0;
+}
+
+void ESAT_TelemetryRoutingTableClass::count(const word sink,
+                                            ESAT_CCSDSPacket& packet)
+{
+  if (sink >= NUMBER_OF_SINKS)
+  {
+    return;
+  }
+  SinkStatistics& statistics = sinkStatistics[sink];
+  if (statistics.packets < 0xFFFFFFFF)
+  {
+    statistics.packets = statistics.packets + 1;
+  }
+  const unsigned long bytes =
+    ESAT_CCSDSPrimaryHeader::LENGTH + packet.length();
+  if (statistics.bytes <= (0xFFFFFFFF - bytes))
+  {
+    statistics.bytes = statistics.bytes + bytes;
+  }
+}
+
+byte ESAT_TelemetryRoutingTableClass::findPacketRoute(ESAT_CCSDSPacket& packet) const
+{
+  // A route for the packet identifier comes first; then, a route
+  // for any packet identifier of the application process.
+  if (numberOfRoutes == 0)
+  {
+    return numberOfRoutes;
+  }
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
+  byte packetIdentifier = ANY_PACKET_IDENTIFIER;
+  packet.rewind();
+  if (packet.length() >= ESAT_CCSDSSecondaryHeader::LENGTH)
+  {
+    const ESAT_CCSDSSecondaryHeader secondaryHeader =
+      packet.readSecondaryHeader();
+    packetIdentifier = secondaryHeader.packetIdentifier;
+    packet.rewind();
+  }
+  const byte index = findRoute(primaryHeader.applicationProcessIdentifier,
+                               packetIdentifier);
+  if (index < numberOfRoutes)
+  {
+    return index;
+  }
+  return findRoute(primaryHeader.applicationProcessIdentifier,
+                   ANY_PACKET_IDENTIFIER);
+}
+
+byte ESAT_TelemetryRoutingTableClass::findRoute(const word applicationProcessIdentifier,
+                                                const byte packetIdentifier) const
+{
+  for (byte index = 0; index < numberOfRoutes; index++)
+  {
+    const Route& route = routingTable[index];
+    if ((route.applicationProcessIdentifier == applicationProcessIdentifier)
+        && (route.packetIdentifier == packetIdentifier))
+    {
+      return index;
+    }
+  }
+  return numberOfRoutes;
+}
+
+ESAT_TelemetryRoutingTableClass::SinkStatistics ESAT_TelemetryRoutingTableClass::readSinkStatistics(const byte sink) const
+{
+  if (sink < NUMBER_OF_SINKS)
+  {
+    return sinkStatistics[sink];
+  }
+  SinkStatistics emptyStatistics;
+  (void) memset(&emptyStatistics, 0, sizeof(emptyStatistics));
+  return emptyStatistics;
+}
+
+void ESAT_TelemetryRoutingTableClass::readRoutes()
+{
+  // The file has the number of routes followed by the routes:
+  // application process identifier (2 bytes, big endian), packet
+  // identifier (1 byte), set of sinks (2 bytes, big endian) and
+  // priority class (1 byte).
+  // A short file means a damaged file.
+  numberOfRoutes = 0;
+  File file = SD.open(ROUTES_FILENAME, FILE_READ);
+  if (!file)
+  {
+    return;
+  }
+  file.seek(0);
+  const int storedRoutes = file.read();
+  if ((storedRoutes < 0) || (storedRoutes > MAXIMUM_NUMBER_OF_ROUTES))
+  {
+    file.close();
+    return;
+  }
+  for (int index = 0; index < storedRoutes; index++)
+  {
+    byte data[6];
+    const int bytesRead = file.read(data, sizeof(data));
+    if (bytesRead != int(sizeof(data)))
+    {
+      numberOfRoutes = 0;
+      break;
+    }
+    Route& route = routingTable[index];
+    route.applicationProcessIdentifier = word(data[0], data[1]);
+    route.packetIdentifier = data[2];
+    route.sinks = word(data[3], data[4]);
+    route.priorityClass = data[5];
+    numberOfRoutes = numberOfRoutes + 1;
+  }
+  file.close();
+}
+
+byte ESAT_TelemetryRoutingTableClass::priorityClass(ESAT_CCSDSPacket& packet) const
+{
+  const byte index = findPacketRoute(packet);
+  if (index == numberOfRoutes)
+  {
+    return 0;
+  }
+  return routingTable[index].priorityClass;
+}
+
+byte ESAT_TelemetryRoutingTableClass::routes() const
+{
+  return numberOfRoutes;
+}
+
+boolean ESAT_TelemetryRoutingTableClass::setRoute(const word applicationProcessIdentifier,
+                                                  const byte packetIdentifier,
+                                                  const word sinks,
+                                                  const byte priorityClass)
+{
+  const byte index = findRoute(applicationProcessIdentifier, packetIdentifier);
+  if ((sinks == ALL_SINKS) && (priorityClass == 0))
+  {
+    // Packets without route go to all the sinks with priority class 0,
+    // so there is no need to keep this route.  Fill its place with the
+    // last route.
+    if (index < numberOfRoutes)
+    {
+      numberOfRoutes = numberOfRoutes - 1;
+      routingTable[index] = routingTable[numberOfRoutes];
+    }
+  }
+  else
+  {
+    if (index == numberOfRoutes)
+    {
+      if (numberOfRoutes >= MAXIMUM_NUMBER_OF_ROUTES)
+      {
+        return false;
+      }
+      numberOfRoutes = numberOfRoutes + 1;
+    }
+    Route& route = routingTable[index];
+    route.applicationProcessIdentifier = applicationProcessIdentifier;
+    route.packetIdentifier = packetIdentifier;
+    route.sinks = sinks;
+    route.priorityClass = priorityClass;
+  }
+  writeRoutes();
+  return true;
+}
+
+word ESAT_TelemetryRoutingTableClass::sinks(ESAT_CCSDSPacket& packet) const
+{
+  const byte index = findPacketRoute(packet);
+  if (index == numberOfRoutes)
+  {
+    return ALL_SINKS;
+  }
+  return routingTable[index].sinks;
+}
+
+void ESAT_TelemetryRoutingTableClass::writeRoutes()
+{
+  File file = SD.open(ROUTES_FILENAME, FILE_WRITE);
+  if (!file)
+  {
+    return;
+  }
+  file.seek(0);
+  (void) file.write(numberOfRoutes);
+  for (byte index = 0; index < numberOfRoutes; index++)
+  {
+    const Route& route = routingTable[index];
+    const byte data[6] = {
+      highByte(route.applicationProcessIdentifier),
+      lowByte(route.applicationProcessIdentifier),
+      route.packetIdentifier,
+      highByte(route.sinks),
+      lowByte(route.sinks),
+      route.priorityClass,
+    };
+    (void) file.write(data, sizeof(data));
+  }
+  file.close();
+}
+
+ESAT_TelemetryRoutingTableClass ESAT_TelemetryRoutingTable;
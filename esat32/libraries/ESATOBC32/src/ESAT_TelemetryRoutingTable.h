@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_TelemetryRoutingTable_h
+#define ESAT_TelemetryRoutingTable_h
+
+#include <Arduino.h>
+#include <STM32SD.h>
+#include <ESAT_CCSDSPacket.h>
+
+// Telemetry routing table: the sinks of each telemetry packet.
+// Use the global instance ESAT_TelemetryRoutingTable.
+//
+// A sink is a subsystem that takes telemetry packets with
+// writeTelemetry() or the USB interface.  Subsystem sinks are numbered
+// after their application process identifier (0 to 14); sink number
+// USB_SINK (15) is the USB interface.  A set of sinks is a word with
+// one bit per sink.
+//
+// Each route goes from a telemetry packet (application process
+// identifier and packet identifier, which may be ANY_PACKET_IDENTIFIER)
+// to a set of sinks and a priority class for the sink queues (see
+// ESAT_TelemetrySinkQueue).  Packets without route go to all the sinks
+// with the housekeeping priority class, so an empty table broadcasts
+// every packet.  The table is kept in the SD
+// card.  The SPI interface must be configured before using this
+// library: you must have called SD.begin() before begin().
+class ESAT_TelemetryRoutingTableClass
+{
+  public:
+    // Traffic statistics of a sink.
+    // Counters stop at their maximum value instead of overflowing.
+    struct SinkStatistics
+    {
+      // Number of packets written to the sink.
+      unsigned long packets;
+
+      // Number of bytes written to the sink (whole packets).
+      unsigned long bytes;
+    };
+
+    // Set of all the sinks: the route of packets without route.
+    static const word ALL_SINKS = 0xFFFF;
+
+    // Routes with this packet identifier apply to all the packets of
+    // their application process identifier without a more specific
+    // route.
+    static const byte ANY_PACKET_IDENTIFIER = 0xFF;
+
+    // Maximum number of routes.
+    static const byte MAXIMUM_NUMBER_OF_ROUTES = 16;
+
+    // Number of sinks.  Subsystems with application process identifiers
+    // from USB_SINK on are not numbered and take every packet.
+    static const byte NUMBER_OF_SINKS = 16;
+
+    // Sink number of the USB interface.
+    static const byte USB_SINK = 15;
+
+    // Read the routing table from the SD card and reset the statistics.
+    void begin();
+
+    // Return true if the given set of sinks contains the given sink;
+    // otherwise return false.  Unnumbered sinks are in every set.
+    boolean contains(word sinks, word sink) const;
+
+    // Count a packet written to the given sink.
+    void count(word sink, ESAT_CCSDSPacket& packet);
+
+    // Return the statistics of the given sink.
+    SinkStatistics readSinkStatistics(byte sink) const;
+
+    // Return the priority class of the given telemetry packet.
+    // This leaves the read/write pointer at the start of the packet
+    // data.
+    byte priorityClass(ESAT_CCSDSPacket& packet) const;
+
+    // Return the number of routes.
+    byte routes() const;
+
+    // Set the sinks and the priority class of the telemetry packets
+    // with the given application process identifier and packet
+    // identifier and write the routing table to the SD card.  Setting
+    // ALL_SINKS with priority class 0 (housekeeping) removes the route.
+    // Return true on success; return false if there are already
+    // MAXIMUM_NUMBER_OF_ROUTES routes.
+    boolean setRoute(word applicationProcessIdentifier,
+                     byte packetIdentifier,
+                     word sinks,
+                     byte priorityClass = 0);
+
+    // Return the set of sinks of the given telemetry packet.
+    // This leaves the read/write pointer at the start of the packet
+    // data.
+    word sinks(ESAT_CCSDSPacket& packet) const;
+
+  private:
+    // Route of the telemetry packets with an application process
+    // identifier and a packet identifier.
+    struct Route
+    {
+      word applicationProcessIdentifier;
+      byte packetIdentifier;
+      word sinks;
+      byte priorityClass;
+    };
+
+    // Keep the routing table in this file.
+    static const char ROUTES_FILENAME[];
+
+    // Number of routes.
+    byte numberOfRoutes = 0;
+
+    // Routes.
+    Route routingTable[MAXIMUM_NUMBER_OF_ROUTES];
+
+    // Statistics of each sink.
+    SinkStatistics sinkStatistics[NUMBER_OF_SINKS];
+
+    // Return the index of the route with the given application process
+    // identifier and packet identifier or numberOfRoutes if there is
+    // no such route.
+    byte findRoute(word applicationProcessIdentifier,
+                   byte packetIdentifier) const;
+
+    // Return the index of the route of the given telemetry packet
+    // or numberOfRoutes if the packet has no route.
+    // This leaves the read/write pointer at the start of the packet
+    // data.
+    byte findPacketRoute(ESAT_CCSDSPacket& packet) const;
+
+    // Read the routing table from its file.  Leave the routing table
+    // empty if the file is missing or damaged.
+    void readRoutes();
+
+    // Write the routing table to its file.
+    void writeRoutes();
+};
+
+// Global instance of the telemetry routing table library.
+extern ESAT_TelemetryRoutingTableClass ESAT_TelemetryRoutingTable;
+
+#endif /* ESAT_TelemetryRoutingTable_h */
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_TelemetrySinkQueue.h"
+
+ESAT_TelemetrySinkQueue::~ESAT_TelemetrySinkQueue()
+{
+  if (slots != nullptr)
+  {
+    ::delete[] slots;
+  }
+  if (nextSlots != nullptr)
+  {
+    delete[] nextSlots;
+  }
+}
+
+void ESAT_TelemetrySinkQueue::begin(const byte sink,
+                                    const byte capacity,
+                                    const byte dropPolicy,
+                                    const unsigned long microsecondsPerCycle)
+{
+  // All the classes take their packets from one pool of capacity
+  // slots: each class is a list of slots chained through nextSlots,
+  // from its oldest packet to its newest packet, and the slots not
+  // in use make up the list of free slots.
+  sinkNumber = sink;
+  queueCapacity = capacity;
+  policy = dropPolicy;
+  drainBudget = microsecondsPerCycle;
+  if (slots != nullptr)
+  {
+    ::delete[] slots;
+    slots = nullptr;
+  }
+  if (nextSlots != nullptr)
+  {
+    delete[] nextSlots;
+    nextSlots = nullptr;
+  }
+  freeSlots = NO_SLOT;
+  if (queueCapacity > 0)
+  {
+    slots = ::new ESAT_CCSDSPacket[queueCapacity];
+    nextSlots = new byte[queueCapacity];
+    for (byte slot = 0; slot < queueCapacity; slot++)
+    {
+      slots[slot] = ESAT_CCSDSPacket(PACKET_DATA_CAPACITY);
+      freeSlot(slot);
+    }
+  }
+  for (byte priorityClass = 0;
+       priorityClass < NUMBER_OF_PRIORITY_CLASSES;
+       priorityClass++)
+  {
+    classDepths[priorityClass] = 0;
+    firstSlots[priorityClass] = NO_SLOT;
+    lastSlots[priorityClass] = NO_SLOT;
+    dropCounters[priorityClass] = 0;
+  }
+}
+
+unsigned long ESAT_TelemetrySinkQueue::budget() const
+{
+  return drainBudget;
+}
+
+void ESAT_TelemetrySinkQueue::countDrop(const byte priorityClass)
+{
+  if (dropCounters[priorityClass] < 0xFFFFFFFF)
+  {
+    dropCounters[priorityClass] = dropCounters[priorityClass] + 1;
+  }
+}
+
+byte ESAT_TelemetrySinkQueue::depth(const byte priorityClass) const
+{
+  if (priorityClass >= NUMBER_OF_PRIORITY_CLASSES)
+  {
+    return 0;
+  }
+  return classDepths[priorityClass];
+}
+
+boolean ESAT_TelemetrySinkQueue::dropLowest(const byte priorityClass)
+{
+  for (int candidate = NUMBER_OF_PRIORITY_CLASSES - 1;
+       candidate >= priorityClass;
+       candidate--)
+  {
+    if (dropOldest(candidate))
+    {
+      countDrop(candidate);
+      return true;
+    }
+  }
+  return false;
+}
+
+boolean ESAT_TelemetrySinkQueue::dropOldest(const byte priorityClass)
+{
+  const byte slot = takeOldestSlot(priorityClass);
+  if (slot == NO_SLOT)
+  {
+    return false;
+  }
+  freeSlot(slot);
+  return true;
+}
+
+unsigned long ESAT_TelemetrySinkQueue::drops(const byte priorityClass) const
+{
+  if (priorityClass >= NUMBER_OF_PRIORITY_CLASSES)
+  {
+    return 0;
+  }
+  return dropCounters[priorityClass];
+}
+
+void ESAT_TelemetrySinkQueue::freeSlot(const byte slot)
+{
+  nextSlots[slot] = freeSlots;
+  freeSlots = slot;
+}
+
+boolean ESAT_TelemetrySinkQueue::full() const
+{
+  return totalDepth() >= queueCapacity;
+}
+
+boolean ESAT_TelemetrySinkQueue::read(ESAT_CCSDSPacket& packet)
+{
+  for (byte priorityClass = 0;
+       priorityClass < NUMBER_OF_PRIORITY_CLASSES;
+       priorityClass++)
+  {
+    const byte slot = firstSlots[priorityClass];
+    if (slot == NO_SLOT)
+    {
+      continue;
+    }
+    packet.flush();
+    if (slots[slot].copyTo(packet))
+    {
+      (void) takeOldestSlot(priorityClass);
+      freeSlot(slot);
+      packet.rewind();
+      return true;
+    }
+  }
+  return false;
+}
+
+byte ESAT_TelemetrySinkQueue::sink() const
+{
+  return sinkNumber;
+}
+
+byte ESAT_TelemetrySinkQueue::takeOldestSlot(const byte priorityClass)
+{
+  const byte slot = firstSlots[priorityClass];
+  if (slot == NO_SLOT)
+  {
+    return NO_SLOT;
+  }
+  firstSlots[priorityClass] = nextSlots[slot];
+  if (firstSlots[priorityClass] == NO_SLOT)
+  {
+    lastSlots[priorityClass] = NO_SLOT;
+  }
+  classDepths[priorityClass] = classDepths[priorityClass] - 1;
+  return slot;
+}
+
+byte ESAT_TelemetrySinkQueue::totalDepth() const
+{
+  byte packets = 0;
+  for (byte priorityClass = 0;
+       priorityClass < NUMBER_OF_PRIORITY_CLASSES;
+       priorityClass++)
+  {
+    packets = packets + classDepths[priorityClass];
+  }
+  return packets;
+}
+
+boolean ESAT_TelemetrySinkQueue::write(ESAT_CCSDSPacket& packet,
+                                       byte priorityClass)
+{
+  if (priorityClass >= NUMBER_OF_PRIORITY_CLASSES)
+  {
+    priorityClass = BULK_CLASS;
+  }
+  if (full())
+  {
+    boolean madeRoom = false;
+    if (policy == DROP_OLDEST)
+    {
+      madeRoom = dropOldest(priorityClass);
+      if (madeRoom)
+      {
+        countDrop(priorityClass);
+      }
+    }
+    if (!madeRoom)
+    {
+      madeRoom = dropLowest(priorityClass);
+    }
+    if (!madeRoom)
+    {
+      countDrop(priorityClass);
+      return false;
+    }
+  }
+  const byte slot = freeSlots;
+  if (slot == NO_SLOT)
+  {
+    countDrop(priorityClass);
+    return false;
+  }
+  slots[slot].flush();
+  if (!packet.copyTo(slots[slot]))
+  {
+    countDrop(priorityClass);
+    return false;
+  }
+  freeSlots = nextSlots[slot];
+  nextSlots[slot] = NO_SLOT;
+  if (lastSlots[priorityClass] == NO_SLOT)
+  {
+    firstSlots[priorityClass] = slot;
+  }
+  else
+  {
+    nextSlots[lastSlots[priorityClass]] = slot;
+  }
+  lastSlots[priorityClass] = slot;
+  classDepths[priorityClass] = classDepths[priorityClass] + 1;
+  return true;
+}
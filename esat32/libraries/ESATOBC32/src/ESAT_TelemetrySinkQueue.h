@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_TelemetrySinkQueue_h
+#define ESAT_TelemetrySinkQueue_h
+
+#include <Arduino.h>
+#include <ESAT_CCSDSPacket.h>
+
+// Bounded output queue of telemetry packets for one telemetry sink
+// (see ESAT_TelemetryRoutingTable for the sink numbers).
+// Register it with ESAT_OnBoardDataHandling.addTelemetryQueue():
+// then, ESAT_OnBoardDataHandling.writeTelemetry() puts the packets
+// for the sink in the queue and
+// ESAT_OnBoardDataHandling.drainTelemetryQueues() writes them to the
+// sink within a time budget, so a slow or disconnected sink doesn't
+// stall the rest of the on-board data handling.
+//
+// Packets belong to one of several priority classes.  The queue
+// always gives out the packets of the most important class first.
+// The classes share the capacity of the queue: when the queue is
+// full, a new packet takes the place of an older packet according to
+// the drop policy, or it is dropped.
+//
+// The classes also share the packet buffers: a queue of capacity N
+// allocates N packets of PACKET_DATA_CAPACITY bytes, plus one byte
+// per packet to chain the packets of each class, no matter how the
+// packets are spread among the classes.
+class ESAT_TelemetrySinkQueue
+{
+  public:
+    // Priority classes, from the most important to the least important.
+    enum PriorityClass
+    {
+      // Real-time housekeeping telemetry.
+      HOUSEKEEPING_CLASS = 0,
+      // Event telemetry.
+      EVENT_CLASS = 1,
+      // Bulk telemetry, like stored telemetry downloads.
+      BULK_CLASS = 2,
+    };
+
+    // Number of priority classes.
+    static const byte NUMBER_OF_PRIORITY_CLASSES = 3;
+
+    // Drop policies for new packets arriving at a full queue.
+    enum DropPolicy
+    {
+      // Drop the oldest packet of the class of the new packet; if
+      // there are none, act as DROP_LOWEST.
+      DROP_OLDEST = 0,
+      // Drop the oldest packet of the least important class, as long
+      // as it is not more important than the new packet; if there are
+      // none, drop the new packet.
+      DROP_LOWEST = 1,
+    };
+
+    // Packet data capacity of the queued packets.
+    static const word PACKET_DATA_CAPACITY = 256;
+
+    // Next queue in the list of ESAT_OnBoardDataHandling.
+    // Only ESAT_OnBoardDataHandling should care about this.
+    ESAT_TelemetrySinkQueue* next = nullptr;
+
+    // Instantiate an empty queue.  Allocate it with begin().
+    ESAT_TelemetrySinkQueue() = default;
+
+    // Queues own their packet slots, so they can't be copied.
+    ESAT_TelemetrySinkQueue(const ESAT_TelemetrySinkQueue&) = delete;
+    ESAT_TelemetrySinkQueue& operator=(const ESAT_TelemetrySinkQueue&) = delete;
+
+    // Free the packet slots.
+    ~ESAT_TelemetrySinkQueue();
+
+    // Allocate a queue for the given sink that holds up to the given
+    // number of packets, with the given drop policy, and that may
+    // spend up to the given number of microseconds per cycle writing
+    // packets to the sink.
+    void begin(byte sink,
+               byte capacity,
+               byte dropPolicy,
+               unsigned long microsecondsPerCycle);
+
+    // Return the number of microseconds per cycle the queue may spend
+    // writing packets to its sink.
+    unsigned long budget() const;
+
+    // Return the number of queued packets of the given class.
+    byte depth(byte priorityClass) const;
+
+    // Return the number of dropped packets of the given class.
+    unsigned long drops(byte priorityClass) const;
+
+    // Return true if the queue is full; otherwise return false.
+    boolean full() const;
+
+    // Pop the next packet (the oldest packet of the most important
+    // class) and copy it into the given packet.
+    // Return true on success; return false if the queue is empty.
+    boolean read(ESAT_CCSDSPacket& packet);
+
+    // Return the sink number of the queue.
+    byte sink() const;
+
+    // Push a packet of the given class, making room for it according
+    // to the drop policy if the queue is full.
+    // Return true on success; return false if the packet was dropped.
+    boolean write(ESAT_CCSDSPacket& packet, byte priorityClass);
+
+  private:
+    // Marks the end of a list of packet slots.
+    static const byte NO_SLOT = 0xFF;
+
+    // Number of queued packets of each class.
+    byte classDepths[NUMBER_OF_PRIORITY_CLASSES];
+
+    // Oldest packet slot of each class or NO_SLOT.
+    byte firstSlots[NUMBER_OF_PRIORITY_CLASSES];
+
+    // First slot of the list of free packet slots or NO_SLOT.
+    byte freeSlots = NO_SLOT;
+
+    // Newest packet slot of each class or NO_SLOT.
+    byte lastSlots[NUMBER_OF_PRIORITY_CLASSES];
+
+    // Next slot in the list of each packet slot or NO_SLOT.
+    byte* nextSlots = nullptr;
+
+    // Maximum number of queued packets (all classes).
+    byte queueCapacity = 0;
+
+    // Number of dropped packets of each class.
+    // Counters stop at their maximum value instead of overflowing.
+    unsigned long dropCounters[NUMBER_OF_PRIORITY_CLASSES];
+
+    // Time budget per cycle in microseconds.
+    unsigned long drainBudget = 0;
+
+    // One of the DropPolicy values.
+    byte policy = DROP_LOWEST;
+
+    // Sink number.
+    byte sinkNumber = 0;
+
+    // Packet slots shared by all the classes.
+    ESAT_CCSDSPacket* slots = nullptr;
+
+    // Count a dropped packet of the given class.
+    void countDrop(byte priorityClass);
+
+    // Drop the oldest packet of the least important non-empty class
+    // that is not more important than the given class.
+    // Return true if a packet was dropped; otherwise return false.
+    boolean dropLowest(byte priorityClass);
+
+    // Drop the oldest packet of the given class.
+    // Return true if a packet was dropped; otherwise return false.
+    boolean dropOldest(byte priorityClass);
+
+    // Put the given packet slot back in the list of free slots.
+    void freeSlot(byte slot);
+
+    // Take the oldest packet slot out of the given class.
+    // Return NO_SLOT if the class is empty.
+    byte takeOldestSlot(byte priorityClass);
+
+    // Return the number of queued packets of all the classes.
+    byte totalDepth() const;
+};
+
+#endif /* ESAT_TelemetrySinkQueue_h */
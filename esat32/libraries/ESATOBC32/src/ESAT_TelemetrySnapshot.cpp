@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_TelemetrySnapshot.h"
+
+// The filename of the snapshot definition cannot exceed 8 characters
+// due to filesystem limitations.
+const char ESAT_TelemetrySnapshotClass::DEFINITION_FILENAME[] = "SNAPSHOT";
+
+void ESAT_TelemetrySnapshotClass::begin()
+{
+  (void) memset(cachedBytes, 0, sizeof(cachedBytes));
+  freshFields = 0;
+  latestSnapshotTime = millis();
+  readDefinition();
+}
+
+void ESAT_TelemetrySnapshotClass::cache(ESAT_CCSDSPacket& packet)
+{
+  if (numberOfFields == 0)
+  {
+    return;
+  }
+  const unsigned long packetDataLength = packet.packetDataLength();
+  if (packetDataLength < ESAT_CCSDSSecondaryHeader::LENGTH)
+  {
+    return;
+  }
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
+  packet.rewind();
+  const ESAT_CCSDSSecondaryHeader secondaryHeader =
+    packet.readSecondaryHeader();
+  // The fields are stored one after another in the order of the
+  // definition, so the position of each field is the sum of the
+  // lengths of the fields before it.
+  word position = 0;
+  for (byte field = 0; field < numberOfFields; field++)
+  {
+    const Field& definitionField = definition[field];
+    const unsigned long fieldEnd =
+      ESAT_CCSDSSecondaryHeader::LENGTH
+      + definitionField.offset
+      + definitionField.length;
+    if ((definitionField.applicationProcessIdentifier
+         == primaryHeader.applicationProcessIdentifier)
+        && (definitionField.packetIdentifier
+            == secondaryHeader.packetIdentifier)
+        && (fieldEnd <= packetDataLength))
+    {
+      (void) packet.seek(ESAT_CCSDSSecondaryHeader::LENGTH
+                         + definitionField.offset);
+      for (byte index = 0; index < definitionField.length; index++)
+      {
+        cachedBytes[position + index] = packet.readByte();
+      }
+      freshFields = freshFields | fieldBit(field);
+    }
+    position = position + definitionField.length;
+  }
+  packet.rewind();
+}
+
+boolean ESAT_TelemetrySnapshotClass::due() const
+{
+  if ((numberOfFields == 0) || (snapshotPeriod == 0))
+  {
+    return false;
+  }
+  const unsigned long period = 1000UL * snapshotPeriod;
+  return (millis() - latestSnapshotTime) >= period;
+}
+
+unsigned long ESAT_TelemetrySnapshotClass::fieldBit(const byte field) const
+{
+  return 0x80000000UL >> field;
+}
+
+byte ESAT_TelemetrySnapshotClass::fields() const
+{
+  return numberOfFields;
+}
+
+void ESAT_TelemetrySnapshotClass::readDefinition()
+{
+  // The file has the snapshot period (2 bytes, big endian) and the
+  // number of fields followed by the fields: application process
+  // identifier (2 bytes, big endian), packet identifier (1 byte),
+  // offset (1 byte) and length (1 byte).
+  // A short file means a damaged file.
+  numberOfFields = 0;
+  snapshotPeriod = 0;
+  File file = SD.open(DEFINITION_FILENAME, FILE_READ);
+  if (!file)
+  {
+    return;
+  }
+  file.seek(0);
+  byte header[3];
+  const int headerBytesRead = file.read(header, sizeof(header));
+  if ((headerBytesRead != int(sizeof(header)))
+      || (header[2] > MAXIMUM_NUMBER_OF_FIELDS))
+  {
+    file.close();
+    return;
+  }
+  for (byte field = 0; field < header[2]; field++)
+  {
+    byte data[FIELD_FILE_LENGTH];
+    const int bytesRead = file.read(data, sizeof(data));
+    if (bytesRead != int(sizeof(data)))
+    {
+      file.close();
+      return;
+    }
+    definition[field].applicationProcessIdentifier = word(data[0], data[1]);
+    definition[field].packetIdentifier = data[2];
+    definition[field].offset = data[3];
+    definition[field].length = data[4];
+  }
+  file.close();
+  if (snapshotLength(header[2], definition) > MAXIMUM_SNAPSHOT_LENGTH)
+  {
+    return;
+  }
+  snapshotPeriod = word(header[0], header[1]);
+  numberOfFields = header[2];
+}
+
+boolean ESAT_TelemetrySnapshotClass::setDefinition(const word period,
+                                                   const byte fieldCount,
+                                                   const Field definitionFields[])
+{
+  if (fieldCount > MAXIMUM_NUMBER_OF_FIELDS)
+  {
+    return false;
+  }
+  if (snapshotLength(fieldCount, definitionFields) > MAXIMUM_SNAPSHOT_LENGTH)
+  {
+    return false;
+  }
+  for (byte field = 0; field < fieldCount; field++)
+  {
+    definition[field] = definitionFields[field];
+  }
+  numberOfFields = fieldCount;
+  snapshotPeriod = period;
+  // The cached bytes belong to the old definition.
+  (void) memset(cachedBytes, 0, sizeof(cachedBytes));
+  freshFields = 0;
+  latestSnapshotTime = millis();
+  writeDefinition();
+  return true;
+}
+
+word ESAT_TelemetrySnapshotClass::snapshotLength(const byte fieldCount,
+                                                 const Field definitionFields[]) const
+{
+  word length = 0;
+  for (byte field = 0; field < fieldCount; field++)
+  {
+    length = length + definitionFields[field].length;
+    if (length > MAXIMUM_SNAPSHOT_LENGTH)
+    {
+      return MAXIMUM_SNAPSHOT_LENGTH + 1;
+    }
+  }
+  return length;
+}
+
+void ESAT_TelemetrySnapshotClass::writeDefinition()
+{
+  File file = SD.open(DEFINITION_FILENAME, FILE_WRITE);
+  if (!file)
+  {
+    return;
+  }
+  file.seek(0);
+  const byte header[3] = {
+    highByte(snapshotPeriod),
+    lowByte(snapshotPeriod),
+    numberOfFields,
+  };
+  (void) file.write(header, sizeof(header));
+  for (byte field = 0; field < numberOfFields; field++)
+  {
+    const Field& definitionField = definition[field];
+    const byte data[FIELD_FILE_LENGTH] = {
+      highByte(definitionField.applicationProcessIdentifier),
+      lowByte(definitionField.applicationProcessIdentifier),
+      definitionField.packetIdentifier,
+      definitionField.offset,
+      definitionField.length,
+    };
+    (void) file.write(data, sizeof(data));
+  }
+  file.close();
+}
+
+void ESAT_TelemetrySnapshotClass::writeTo(ESAT_CCSDSPacket& packet)
+{
+  packet.writeUnsignedLong(freshFields);
+  const word length = snapshotLength(numberOfFields, definition);
+  for (word index = 0; index < length; index++)
+  {
+    packet.writeByte(cachedBytes[index]);
+  }
+  freshFields = 0;
+  latestSnapshotTime = millis();
+}
+
+ESAT_TelemetrySnapshotClass ESAT_TelemetrySnapshot;
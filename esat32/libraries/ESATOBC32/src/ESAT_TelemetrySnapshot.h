@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT OBC library.
+ *
+ * Theia Space's ESAT OBC library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT OBC library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT OBC library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_TelemetrySnapshot_h
+#define ESAT_TelemetrySnapshot_h
+
+#include <Arduino.h>
+#include <STM32SD.h>
+#include <ESAT_CCSDSPacket.h>
+
+// Composite snapshot of the latest telemetry of all the subsystems.
+// Use the global instance ESAT_TelemetrySnapshot.
+//
+// The snapshot definition is a list of fields, each one a series of
+// bytes at an offset of the user data field of a telemetry packet
+// (application process identifier and packet identifier), and a
+// snapshot period.  As the telemetry packets go through
+// ESAT_OnBoardDataHandling.writeTelemetry() or through the router of
+// ESAT_ConcurrentOnBoardDataHandling, cache() keeps the latest bytes
+// of the fields of their definition, so the whole telemetry packets
+// don't need to be kept.  Once every snapshot
+// period, ESAT_OBCSnapshotTelemetry puts all the fields together in
+// one packet.  The snapshot definition is kept in the SD card.  The
+// SPI interface must be configured before using this library: you
+// must have called SD.begin() before begin().
+class ESAT_TelemetrySnapshotClass
+{
+  public:
+    // Field of the snapshot.
+    struct Field
+    {
+      // Application process identifier of the source packet.
+      word applicationProcessIdentifier;
+
+      // Packet identifier of the source packet.
+      byte packetIdentifier;
+
+      // Position of the field in the user data field of the source
+      // packet.
+      byte offset;
+
+      // Number of bytes of the field.
+      byte length;
+    };
+
+    // Maximum number of fields.
+    static const byte MAXIMUM_NUMBER_OF_FIELDS = 32;
+
+    // Maximum total number of bytes of the fields.
+    static const word MAXIMUM_SNAPSHOT_LENGTH = 192;
+
+    // Read the snapshot definition from the SD card and clear the
+    // cached fields.
+    void begin();
+
+    // Keep the fields of the given telemetry packet that are part of
+    // the snapshot.
+    // This leaves the read/write pointer at the start of the packet
+    // data.
+    void cache(ESAT_CCSDSPacket& packet);
+
+    // Return true if there is a snapshot definition and the snapshot
+    // period elapsed since the latest snapshot; otherwise return
+    // false.
+    boolean due() const;
+
+    // Return the number of fields of the snapshot.
+    byte fields() const;
+
+    // Set the snapshot definition and write it to the SD card: the
+    // given fields every period seconds.  A definition without fields
+    // or with a period of 0 disables the snapshot.
+    // Return true on success; return false if there are too many
+    // fields or bytes.
+    boolean setDefinition(word period,
+                          byte numberOfFields,
+                          const Field definitionFields[]);
+
+    // Write the snapshot to the given packet: a 32-bit mask with one
+    // bit per field (most significant bit first) set for the fields
+    // that changed source packet since the latest snapshot, followed
+    // by the bytes of each field in order (zeros for fields not
+    // received yet).  Start a new snapshot period.
+    void writeTo(ESAT_CCSDSPacket& packet);
+
+  private:
+    // Keep the snapshot definition in this file.
+    static const char DEFINITION_FILENAME[];
+
+    // Number of bytes of a field in the definition file.
+    static const byte FIELD_FILE_LENGTH = 5;
+
+    // Latest bytes of the fields, one after another.
+    byte cachedBytes[MAXIMUM_SNAPSHOT_LENGTH];
+
+    // Fields of the snapshot.
+    Field definition[MAXIMUM_NUMBER_OF_FIELDS];
+
+    // One bit per field set when the field was updated since the
+    // latest snapshot.
+    unsigned long freshFields = 0;
+
+    // Time (as given by millis()) of the latest snapshot.
+    unsigned long latestSnapshotTime = 0;
+
+    // Number of fields of the snapshot.
+    byte numberOfFields = 0;
+
+    // Time between snapshots in seconds.
+    word snapshotPeriod = 0;
+
+    // Return the bit of the given field in freshFields.
+    unsigned long fieldBit(byte field) const;
+
+    // Read the snapshot definition from its file.  Leave the
+    // definition empty if the file is missing or damaged.
+    void readDefinition();
+
+    // Return the total number of bytes of the given fields or
+    // MAXIMUM_SNAPSHOT_LENGTH + 1 if that's too many.
+    word snapshotLength(byte numberOfFields,
+                        const Field definitionFields[]) const;
+
+    // Write the snapshot definition to its file.
+    void writeDefinition();
+};
+
+// Global instance of the telemetry snapshot library.
+extern ESAT_TelemetrySnapshotClass ESAT_TelemetrySnapshot;
+
+#endif /* ESAT_TelemetrySnapshot_h */
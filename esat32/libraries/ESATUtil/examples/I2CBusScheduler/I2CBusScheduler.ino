@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ESAT_I2CBusScheduler.h>
+#include <ESAT_I2CMaster.h>
+#include <ESAT_I2CTransaction.h>
+
+// ESAT_I2CBusScheduler example program.
+// Keep sampling a sensor register every 10 milliseconds while
+// writing long packets to an I2C slave.  The sensor sample runs
+// between the chunks of the packet.
+
+// Address of the slave node.
+const byte slaveAddress = 64;
+
+// Address of the sensor.
+const byte sensorAddress = 0x69;
+
+// Register of the sensor with the reading.
+const byte sensorRegister = 71;
+
+// Take a sensor sample every this number of microseconds.
+const unsigned long samplingPeriod = 10000;
+
+// Sensor sample transaction.
+class SensorSampleTransactionClass: public ESAT_I2CTransaction
+{
+  public:
+    // Number of samples read so far.
+    unsigned long samples = 0;
+
+    // Time (in microseconds) of the latest sample.
+    unsigned long sampleTime = 0;
+
+    byte address()
+    {
+      return sensorAddress;
+    }
+
+    void run(TwoWire& bus)
+    {
+      bus.beginTransmission(sensorAddress);
+      (void) bus.write(sensorRegister);
+      const byte writeStatus = bus.endTransmission();
+      if (writeStatus == 0)
+      {
+        (void) bus.requestFrom(sensorAddress, byte(2));
+        while (bus.available() > 0)
+        {
+          (void) bus.read();
+        }
+      }
+      samples = samples + 1;
+      sampleTime = micros();
+      // Queue the next sample.
+      (void) ESAT_I2CBusScheduler.queue(*this, samplingPeriod);
+    }
+};
+
+SensorSampleTransactionClass SensorSampleTransaction;
+
+void setup()
+{
+  // Configure the Serial interface.
+  Serial.begin(9600);
+  // Wait until Serial is ready.
+  while (!Serial)
+  {
+  }
+  (void) Serial.println(F("##################################"));
+  (void) Serial.println(F("I2C bus scheduler example program."));
+  (void) Serial.println(F("##################################"));
+  // Configure the I2C bus, the I2C bus scheduler and the I2C master.
+  Wire.begin();
+  ESAT_I2CBusScheduler.begin(Wire);
+  (void) ESAT_I2CBusScheduler.configure(sensorAddress,
+                                        ESAT_I2CBusScheduler.ATTITUDE_PRIORITY);
+  (void) ESAT_I2CBusScheduler.configure(slaveAddress,
+                                        ESAT_I2CBusScheduler.BULK_PRIORITY,
+                                        500000);
+  ESAT_I2CMaster.begin(Wire);
+  (void) ESAT_I2CBusScheduler.queue(SensorSampleTransaction, samplingPeriod);
+}
+
+void loop()
+{
+  ESAT_I2CBusScheduler.beginCycle();
+  byte buffer[256];
+  ESAT_CCSDSPacket packet(buffer, sizeof(buffer));
+  packet.writeTelemetryHeaders(1,
+                               0,
+                               ESAT_Timestamp(),
+                               1,
+                               0,
+                               0,
+                               0);
+  while (packet.length() < packet.capacity())
+  {
+    packet.writeByte(0);
+  }
+  const unsigned long startTime = micros();
+  const boolean packetWritten =
+    ESAT_I2CMaster.writePacket(packet, slaveAddress, 1000);
+  const unsigned long endTime = micros();
+  ESAT_I2CBusScheduler.run();
+  (void) Serial.print(F("Packet written: "));
+  (void) Serial.println(packetWritten);
+  (void) Serial.print(F("Time writing the packet (microseconds): "));
+  (void) Serial.println(endTime - startTime);
+  (void) Serial.print(F("Sensor samples so far: "));
+  (void) Serial.println(SensorSampleTransaction.samples);
+  (void) Serial.println();
+  ESAT_I2CBusScheduler.wait(1000000);
+}
@@ -271,11 +271,14 @@ void setup()
   ESAT_SubsystemPacketHandler.enableTelemetry(TextTelemetry.packetIdentifier());
   ESAT_SubsystemPacketHandler.addTelemetry(RandomTelemetry);
   ESAT_SubsystemPacketHandler.enableTelemetry(RandomTelemetry.packetIdentifier());
+  // Build two I2C telemetry packets ahead of time.
+  ESAT_SubsystemPacketHandler.enableI2CTelemetryStaging(2);
 }
 
 // On each main loop cycle, the subsystem prepares its telemetry
 // packets, responds to USB telecommands, responds to I2C telecommands,
-// writes its telemetry to USB and responds to I2C packet requests.
+// writes its telemetry to USB, responds to I2C packet requests and
+// stages the next I2C telemetry packets.
 void loop()
 {
   ESAT_SubsystemPacketHandler.prepareSubsystemsOwnTelemetry();
@@ -295,4 +298,5 @@ void loop()
   {
     ESAT_SubsystemPacketHandler.respondToI2CPacketRequest();
   }
+  ESAT_SubsystemPacketHandler.stageI2CTelemetry();
 }
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_CCSDSPacketFromTransferFrameReader.h"
+#include "ESAT_Buffer.h"
+#include "ESAT_CCSDSPacketToTransferFrameWriter.h"
+
+ESAT_CCSDSPacketFromTransferFrameReader::ESAT_CCSDSPacketFromTransferFrameReader()
+{
+  frameLength = 0;
+  frameLoaded = false;
+  nextFrameCount = 0;
+  frameCountKnown = false;
+  lostFrameCount = 0;
+  packetBuffer = nullptr;
+  packetBufferCapacity = 0;
+  packetBytes = 0;
+  packetLength = 0;
+  reader = ESAT_KISSStream();
+  synchronised = false;
+}
+
+ESAT_CCSDSPacketFromTransferFrameReader::ESAT_CCSDSPacketFromTransferFrameReader(Stream& backend,
+                                                                                 byte frameBuffer[],
+                                                                                 const word length,
+                                                                                 byte buffer[],
+                                                                                 const unsigned long capacity)
+{
+  frameLength = length;
+  frameLoaded = false;
+  nextFrameCount = 0;
+  frameCountKnown = false;
+  lostFrameCount = 0;
+  packetBuffer = buffer;
+  packetBufferCapacity = capacity;
+  packetBytes = 0;
+  packetLength = 0;
+  // The extra byte of the frame buffer lets us tell frames of the
+  // right length from longer ones.
+  reader = ESAT_KISSStream(backend, frameBuffer, length + 1);
+  synchronised = false;
+}
+
+void ESAT_CCSDSPacketFromTransferFrameReader::countLostFrame()
+{
+  if (lostFrameCount < 0xFFFFFFFF)
+  {
+    lostFrameCount = lostFrameCount + 1;
+  }
+}
+
+boolean ESAT_CCSDSPacketFromTransferFrameReader::loadFrame()
+{
+  while (reader.receiveFrame())
+  {
+    if (reader.available() != int(frameLength))
+    {
+      countLostFrame();
+      synchronised = false;
+      continue;
+    }
+    ESAT_CCSDSTransferFrameHeader header;
+    const boolean correctHeaderRead = header.readFrom(reader);
+    if (!correctHeaderRead)
+    {
+      countLostFrame();
+      synchronised = false;
+      continue;
+    }
+    if (frameCountKnown)
+    {
+      const byte missingFrames =
+        byte(header.virtualChannelFrameCount - nextFrameCount);
+      if (missingFrames > 0)
+      {
+        for (byte frame = 0; frame < missingFrames; frame++)
+        {
+          countLostFrame();
+        }
+        synchronised = false;
+      }
+    }
+    nextFrameCount = byte(header.virtualChannelFrameCount + 1);
+    frameCountKnown = true;
+    if (!synchronised)
+    {
+      // The packet that was being reassembled lost some bytes, so we
+      // drop it and wait for the first packet that starts in this
+      // frame.
+      packetBytes = 0;
+      packetLength = 0;
+      const word dataFieldLength =
+        frameLength - ESAT_CCSDSTransferFrameHeader::LENGTH;
+      if (header.firstHeaderPointer >= dataFieldLength)
+      {
+        continue;
+      }
+      for (word index = 0; index < header.firstHeaderPointer; index++)
+      {
+        (void) reader.read();
+      }
+      synchronised = true;
+    }
+    frameLoaded = true;
+    return true;
+  }
+  frameLoaded = false;
+  return false;
+}
+
+unsigned long ESAT_CCSDSPacketFromTransferFrameReader::lostFrames() const
+{
+  return lostFrameCount;
+}
+
+boolean ESAT_CCSDSPacketFromTransferFrameReader::read(ESAT_CCSDSPacket& packet)
+{
+  if (packetBufferCapacity < ESAT_CCSDSPrimaryHeader::LENGTH)
+  {
+    return false;
+  }
+  while (true)
+  {
+    if (!frameLoaded || (reader.available() == 0))
+    {
+      const boolean gotFrame = loadFrame();
+      if (!gotFrame)
+      {
+        return false;
+      }
+    }
+    while (reader.available() > 0)
+    {
+      packetBuffer[packetBytes] = reader.read();
+      packetBytes = packetBytes + 1;
+      if (packetBytes == ESAT_CCSDSPrimaryHeader::LENGTH)
+      {
+        ESAT_Buffer headerBuffer(packetBuffer,
+                                 ESAT_CCSDSPrimaryHeader::LENGTH,
+                                 ESAT_CCSDSPrimaryHeader::LENGTH);
+        ESAT_CCSDSPrimaryHeader primaryHeader;
+        (void) primaryHeader.readFrom(headerBuffer);
+        packetLength =
+          ESAT_CCSDSPrimaryHeader::LENGTH + primaryHeader.packetDataLength;
+        if (packetLength > packetBufferCapacity)
+        {
+          // We can't hold this packet: drop it and synchronise again
+          // with the next frame.
+          packetBytes = 0;
+          packetLength = 0;
+          synchronised = false;
+          frameLoaded = false;
+          break;
+        }
+      }
+      if ((packetLength > 0) && (packetBytes == packetLength))
+      {
+        const unsigned long completePacketLength = packetLength;
+        packetBytes = 0;
+        packetLength = 0;
+        const word applicationProcessIdentifier =
+          word(packetBuffer[0] & B00000111, packetBuffer[1]);
+        if (applicationProcessIdentifier
+            == ESAT_CCSDSPacketToTransferFrameWriter::IDLE_APPLICATION_PROCESS_IDENTIFIER)
+        {
+          continue;
+        }
+        ESAT_Buffer packetData(packetBuffer,
+                               packetBufferCapacity,
+                               completePacketLength);
+        return packet.readFrom(packetData);
+      }
+    }
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_CCSDSPacketFromTransferFrameReader_h
+#define ESAT_CCSDSPacketFromTransferFrameReader_h
+
+#include <Arduino.h>
+#include "ESAT_CCSDSPacket.h"
+#include "ESAT_CCSDSTransferFrameHeader.h"
+#include "ESAT_KISSStream.h"
+
+// CCSDS-from-transfer-frame reader (packet demultiplexer).
+// Read CCSDS Space Packets from the fixed-length CCSDS TM Transfer
+// Frames written in KISS frames by
+// ESAT_CCSDSPacketToTransferFrameWriter to a backend Stream.  Meant
+// for the ground side of the link.
+// The reader follows one virtual channel.  When a transfer frame
+// goes missing (a gap in the virtual channel frame count) or comes
+// with the wrong length, the packet that was being reassembled is
+// dropped and the reader synchronises again at the first header
+// pointer of the next transfer frame.  Idle packets are dropped.
+class ESAT_CCSDSPacketFromTransferFrameReader
+{
+  public:
+    // Instantiate an empty CCSDS-from-transfer-frame reader without a
+    // backend stream.
+    // Reads will do nothing.
+    ESAT_CCSDSPacketFromTransferFrameReader();
+
+    // Instantiate a CCSDS-from-transfer-frame reader that will read
+    // transfer frames of the given length (header included) from this
+    // backend stream.
+    // Use the frame buffer (which must hold frameLength + 1 bytes) to
+    // receive the transfer frames and the packet buffer of given
+    // capacity to reassemble the packets (primary header included).
+    // Longer packets are dropped.
+    ESAT_CCSDSPacketFromTransferFrameReader(Stream& backend,
+                                            byte frameBuffer[],
+                                            word frameLength,
+                                            byte packetBuffer[],
+                                            unsigned long packetBufferCapacity);
+
+    // Return the number of transfer frames lost (missing from the
+    // virtual channel frame count or with the wrong length) so far.
+    unsigned long lostFrames() const;
+
+    // Read and fill the contents of the next CCSDS packet from the
+    // transfer frames coming from the backend stream.
+    // Return true on success; return false if there is no complete
+    // packet available yet.
+    boolean read(ESAT_CCSDSPacket& packet);
+
+  private:
+    // Length of the transfer frames.
+    word frameLength;
+
+    // True while a transfer frame is being read.
+    boolean frameLoaded;
+
+    // Expected virtual channel frame count of the next transfer frame.
+    byte nextFrameCount;
+
+    // True after the first transfer frame, when nextFrameCount is known.
+    boolean frameCountKnown;
+
+    // Number of transfer frames lost.
+    unsigned long lostFrameCount;
+
+    // Reassemble packets in this buffer.
+    byte* packetBuffer;
+
+    // Capacity of the packet buffer.
+    unsigned long packetBufferCapacity;
+
+    // Number of bytes of the current packet reassembled so far.
+    unsigned long packetBytes;
+
+    // Length of the current packet (primary header included) or 0 if
+    // its primary header isn't complete yet.
+    unsigned long packetLength;
+
+    // Read transfer frames from this KISS stream.
+    ESAT_KISSStream reader;
+
+    // True while the reader is synchronised with the packet boundaries.
+    boolean synchronised;
+
+    // Add one to the count of lost transfer frames, saturating at the
+    // maximum value.
+    void countLostFrame();
+
+    // Receive the next transfer frame, check its header and, if
+    // needed, skip to the first packet that starts in it.
+    // Return true if there is a transfer frame ready to read;
+    // otherwise return false.
+    boolean loadFrame();
+};
+
+#endif /* ESAT_CCSDSPacketFromTransferFrameReader_h */
@@ -114,6 +114,30 @@ unsigned long ESAT_CCSDSPacketQueue::capacity() const
   return queueCapacity;
 }
 
+boolean ESAT_CCSDSPacketQueue::drop()
+{
+  if (packets == nullptr)
+  {
+    return false;
+  }
+  if (unread == nullptr)
+  {
+    return false;
+  }
+  if (!unread[readPosition])
+  {
+    return false;
+  }
+  unsigned long nextReadPosition = readPosition + 1;
+  if (nextReadPosition == capacity())
+  {
+    nextReadPosition = 0;
+  }
+  unread[readPosition] = false;
+  readPosition = nextReadPosition;
+  return true;
+}
+
 void ESAT_CCSDSPacketQueue::flush()
 {
   if (packets == nullptr)
@@ -123,6 +147,10 @@ void ESAT_CCSDSPacketQueue::flush()
   for (unsigned long index = 0; index < queueCapacity; index = index + 1)
   {
     packets[index].flush();
+    if (unread != nullptr)
+    {
+      unread[index] = false;
+    }
   }
   readPosition = 0;
   writePosition = 0;
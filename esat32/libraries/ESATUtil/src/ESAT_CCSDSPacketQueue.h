@@ -59,6 +59,10 @@ class ESAT_CCSDSPacketQueue
     // Return the number of packets that this queue can hold.
     unsigned long capacity() const;
 
+    // Discard the next packet of the queue without reading it.
+    // Return true on success; return false if the queue is empty.
+    boolean drop();
+
     // Clear the queue.
     void flush();
 
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_CCSDSPacketToTransferFrameWriter.h"
+#include "ESAT_Buffer.h"
+#include "ESAT_KISSStream.h"
+
+ESAT_CCSDSPacketToTransferFrameWriter::ESAT_CCSDSPacketToTransferFrameWriter()
+{
+  backendStream = nullptr;
+  frameBuffer = nullptr;
+  frameLength = 0;
+  position = 0;
+}
+
+ESAT_CCSDSPacketToTransferFrameWriter::ESAT_CCSDSPacketToTransferFrameWriter(Stream& backend,
+                                                                             byte buffer[],
+                                                                             const word length,
+                                                                             const word spacecraftIdentifier,
+                                                                             const byte virtualChannelIdentifier)
+{
+  // Frames without room for data would never fill up.
+  if (length > ESAT_CCSDSTransferFrameHeader::LENGTH)
+  {
+    backendStream = &backend;
+  }
+  else
+  {
+    backendStream = nullptr;
+  }
+  frameBuffer = buffer;
+  frameLength = length;
+  header.spacecraftIdentifier = spacecraftIdentifier;
+  header.virtualChannelIdentifier = virtualChannelIdentifier;
+  position = ESAT_CCSDSTransferFrameHeader::LENGTH;
+}
+
+boolean ESAT_CCSDSPacketToTransferFrameWriter::append(const byte datum,
+                                                      const boolean packetStart)
+{
+  if (packetStart
+      && (header.firstHeaderPointer
+          == ESAT_CCSDSTransferFrameHeader::NO_FIRST_HEADER))
+  {
+    header.firstHeaderPointer =
+      position - ESAT_CCSDSTransferFrameHeader::LENGTH;
+  }
+  frameBuffer[position] = datum;
+  position = position + 1;
+  if (position < frameLength)
+  {
+    return true;
+  }
+  return writeFrame();
+}
+
+boolean ESAT_CCSDSPacketToTransferFrameWriter::appendPacketBytes(const byte bytes[],
+                                                                 const unsigned long length)
+{
+  boolean correctAppend = true;
+  for (unsigned long index = 0; index < length; index++)
+  {
+    const boolean correctByteAppend = append(bytes[index], index == 0);
+    correctAppend = correctAppend && correctByteAppend;
+  }
+  return correctAppend;
+}
+
+boolean ESAT_CCSDSPacketToTransferFrameWriter::flush()
+{
+  if (!backendStream)
+  {
+    return false;
+  }
+  if (position == ESAT_CCSDSTransferFrameHeader::LENGTH)
+  {
+    return true;
+  }
+  // The idle packet fills the rest of the frame.  It needs at least a
+  // primary header and one byte of packet data; when there isn't room
+  // for that, it spills over into the next frame.
+  const unsigned long minimumIdlePacketLength =
+    ESAT_CCSDSPrimaryHeader::LENGTH + 1;
+  unsigned long idlePacketLength = frameLength - position;
+  if (idlePacketLength < minimumIdlePacketLength)
+  {
+    idlePacketLength = minimumIdlePacketLength;
+  }
+  ESAT_CCSDSPrimaryHeader primaryHeader;
+  primaryHeader.packetVersionNumber = 0;
+  primaryHeader.packetType = primaryHeader.TELEMETRY;
+  primaryHeader.secondaryHeaderFlag =
+    primaryHeader.SECONDARY_HEADER_IS_NOT_PRESENT;
+  primaryHeader.applicationProcessIdentifier =
+    IDLE_APPLICATION_PROCESS_IDENTIFIER;
+  primaryHeader.sequenceFlags = primaryHeader.UNSEGMENTED_USER_DATA;
+  primaryHeader.packetSequenceCount = 0;
+  primaryHeader.packetDataLength =
+    idlePacketLength - ESAT_CCSDSPrimaryHeader::LENGTH;
+  byte headerOctets[ESAT_CCSDSPrimaryHeader::LENGTH];
+  ESAT_Buffer headerBuffer(headerOctets, sizeof(headerOctets));
+  const boolean correctHeaderWrite = primaryHeader.writeTo(headerBuffer);
+  if (!correctHeaderWrite)
+  {
+    return false;
+  }
+  boolean correctFlush = appendPacketBytes(headerOctets,
+                                           sizeof(headerOctets));
+  for (unsigned long index = 0;
+       index < primaryHeader.packetDataLength;
+       index++)
+  {
+    const boolean correctByteAppend = append(0, false);
+    correctFlush = correctFlush && correctByteAppend;
+  }
+  return correctFlush;
+}
+
+boolean ESAT_CCSDSPacketToTransferFrameWriter::write(ESAT_CCSDSPacket packet)
+{
+  if (!backendStream)
+  {
+    return false;
+  }
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
+  byte headerOctets[ESAT_CCSDSPrimaryHeader::LENGTH];
+  ESAT_Buffer headerBuffer(headerOctets, sizeof(headerOctets));
+  const boolean correctHeaderWrite = primaryHeader.writeTo(headerBuffer);
+  if (!correctHeaderWrite)
+  {
+    return false;
+  }
+  boolean correctWrite = appendPacketBytes(headerOctets,
+                                           sizeof(headerOctets));
+  packet.rewind();
+  const unsigned long packetDataLength = packet.packetDataLength();
+  for (unsigned long index = 0; index < packetDataLength; index++)
+  {
+    const boolean correctByteAppend = append(packet.readByte(), false);
+    correctWrite = correctWrite && correctByteAppend;
+  }
+  return correctWrite;
+}
+
+boolean ESAT_CCSDSPacketToTransferFrameWriter::writeFrame()
+{
+  ESAT_Buffer headerBuffer(frameBuffer, ESAT_CCSDSTransferFrameHeader::LENGTH);
+  const boolean correctHeaderWrite = header.writeTo(headerBuffer);
+  // The frame counts go on even if the frame couldn't be written, so
+  // the reader notices the lost frame.
+  header.masterChannelFrameCount = header.masterChannelFrameCount + 1;
+  header.virtualChannelFrameCount = header.virtualChannelFrameCount + 1;
+  header.firstHeaderPointer = ESAT_CCSDSTransferFrameHeader::NO_FIRST_HEADER;
+  position = ESAT_CCSDSTransferFrameHeader::LENGTH;
+  if (!correctHeaderWrite)
+  {
+    return false;
+  }
+  ESAT_KISSStream writer(*backendStream);
+  const size_t beginBytesWritten = writer.beginFrame();
+  if (beginBytesWritten < writer.FRAME_BEGIN_LENGTH)
+  {
+    return false;
+  }
+  const size_t frameBytesWritten = writer.write(frameBuffer, frameLength);
+  if (frameBytesWritten < frameLength)
+  {
+    return false;
+  }
+  const size_t endBytesWritten = writer.endFrame();
+  if (endBytesWritten < writer.FRAME_END_LENGTH)
+  {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_CCSDSPacketToTransferFrameWriter_h
+#define ESAT_CCSDSPacketToTransferFrameWriter_h
+
+#include <Arduino.h>
+#include "ESAT_CCSDSPacket.h"
+#include "ESAT_CCSDSTransferFrameHeader.h"
+
+// CCSDS-to-transfer-frame writer (packet multiplexer).
+// Pack CCSDS Space Packets into fixed-length CCSDS TM Transfer Frames
+// and write each transfer frame in a KISS frame to a backend Stream.
+// Packets go one after another in the data field of the transfer
+// frames and may span several transfer frames.  The first header
+// pointer of each transfer frame tells where the first packet that
+// starts in the frame begins, so that
+// ESAT_CCSDSPacketFromTransferFrameReader finds the packets again
+// after a lost frame.
+// The frame length sets the framing overhead: longer frames spread
+// the transfer frame header, the KISS marks and, on radio links, the
+// preamble of each radio frame over more packets, but they take
+// longer to fill up.  flush() completes the current transfer frame
+// with an idle packet and writes it right away.
+class ESAT_CCSDSPacketToTransferFrameWriter
+{
+  public:
+    // Application process identifier of idle packets.
+    static const word IDLE_APPLICATION_PROCESS_IDENTIFIER = 0x7FF;
+
+    // Instantiate an empty CCSDS-to-transfer-frame writer without a
+    // backend stream.
+    // Writes will do nothing.
+    ESAT_CCSDSPacketToTransferFrameWriter();
+
+    // Instantiate a CCSDS-to-transfer-frame writer that will write
+    // transfer frames of the given length (header included) with the
+    // given spacecraft identifier and virtual channel identifier to
+    // this backend stream.
+    // Use the buffer (which must hold frameLength bytes) to build the
+    // transfer frames.  Frames must be longer than their header.
+    ESAT_CCSDSPacketToTransferFrameWriter(Stream& backend,
+                                          byte buffer[],
+                                          word frameLength,
+                                          word spacecraftIdentifier,
+                                          byte virtualChannelIdentifier);
+
+    // Complete the current transfer frame with an idle packet and
+    // write it to the backend stream.  Do nothing if the current
+    // transfer frame is empty.  Short idle packets spill over into the
+    // next transfer frame, which is written later with the next
+    // packets.
+    // Return true on success; otherwise return false.
+    boolean flush();
+
+    // Add the given packet to the transfer frames and write the
+    // transfer frames that fill up to the backend stream.
+    // Return true on success; otherwise return false.
+    boolean write(ESAT_CCSDSPacket packet);
+
+  private:
+    // Write frames to this stream.
+    Stream* backendStream;
+
+    // Build the current transfer frame in this buffer.
+    byte* frameBuffer;
+
+    // Length of the transfer frames.
+    word frameLength;
+
+    // Primary header of the current transfer frame.
+    ESAT_CCSDSTransferFrameHeader header;
+
+    // Position of the next byte in the current transfer frame.
+    word position;
+
+    // Add a byte to the current transfer frame, recording its position
+    // in the first header pointer if it is the first byte of the first
+    // packet that starts in the frame.  Write the transfer frame when
+    // it fills up.
+    // Return true on success; otherwise return false.
+    boolean append(byte datum, boolean packetStart);
+
+    // Add the given bytes to the transfer frames as a packet.
+    // Return true on success; otherwise return false.
+    boolean appendPacketBytes(const byte bytes[], unsigned long length);
+
+    // Write the current transfer frame to the backend stream and start
+    // a new transfer frame.
+    // Return true on success; otherwise return false.
+    boolean writeFrame();
+};
+
+#endif /* ESAT_CCSDSPacketToTransferFrameWriter_h */
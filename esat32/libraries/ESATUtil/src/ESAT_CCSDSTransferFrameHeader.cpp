@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_CCSDSTransferFrameHeader.h"
+#include "ESAT_Buffer.h"
+
+boolean ESAT_CCSDSTransferFrameHeader::readFrom(Stream& input)
+{
+  byte octets[LENGTH];
+  ESAT_Buffer data(octets, sizeof(octets));
+  const boolean correctRead = data.readFrom(input, sizeof(octets));
+  if (!correctRead)
+  {
+    return false;
+  }
+  const byte firstByte = data.read();
+  const byte secondByte = data.read();
+  const word identifiers = word(firstByte, secondByte);
+  masterChannelFrameCount = data.read();
+  virtualChannelFrameCount = data.read();
+  const byte fifthByte = data.read();
+  const byte sixthByte = data.read();
+  const word dataFieldStatus = word(fifthByte, sixthByte);
+  spacecraftIdentifier = (identifiers >> 4) & 0x3FF;
+  virtualChannelIdentifier = (identifiers >> 1) & 0x7;
+  firstHeaderPointer = dataFieldStatus & 0x7FF;
+  return true;
+}
+
+boolean ESAT_CCSDSTransferFrameHeader::writeTo(Stream& output) const
+{
+  // The segment length identifier must be 3 (binary 11) when the
+  // synchronisation flag is 0.
+  const word identifiers =
+    ((spacecraftIdentifier & 0x3FF) << 4)
+    | ((virtualChannelIdentifier & 0x7) << 1);
+  const word dataFieldStatus =
+    (B11 << 11)
+    | (firstHeaderPointer & 0x7FF);
+  byte octets[LENGTH];
+  ESAT_Buffer data(octets, sizeof(octets));
+  (void) data.write(highByte(identifiers));
+  (void) data.write(lowByte(identifiers));
+  (void) data.write(masterChannelFrameCount);
+  (void) data.write(virtualChannelFrameCount);
+  (void) data.write(highByte(dataFieldStatus));
+  (void) data.write(lowByte(dataFieldStatus));
+  if (data.length() != LENGTH)
+  {
+    return false;
+  }
+  return data.writeTo(output);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_CCSDSTransferFrameHeader_h
+#define ESAT_CCSDSTransferFrameHeader_h
+
+#include <Arduino.h>
+
+// Primary header of the CCSDS TM Transfer Frames used by
+// ESAT_CCSDSPacketToTransferFrameWriter and
+// ESAT_CCSDSPacketFromTransferFrameReader.  It contains the following
+// fields:
+// - The transfer frame version number (2 bits, always 0).
+// - The spacecraft identifier (10 bits).
+// - The virtual channel identifier (3 bits).
+// - The operational control field flag (1 bit, always 0).
+// - The master channel frame count (8 bits).
+// - The virtual channel frame count (8 bits).
+// - The transfer frame data field status (16 bits): secondary header
+//   flag, synchronisation flag and packet order flag (always 0),
+//   segment length identifier (always 3) and first header pointer
+//   (11 bits).
+class ESAT_CCSDSTransferFrameHeader
+{
+  public:
+    // Number of bytes the primary header takes when stored in
+    // transfer frames.
+    static const byte LENGTH = 6;
+
+    // First header pointer of the frames where no packet starts.
+    static const word NO_FIRST_HEADER = 0x7FF;
+
+    // Spacecraft identifier (from 0 to 1023).
+    word spacecraftIdentifier = 0;
+
+    // Virtual channel identifier (from 0 to 7).
+    byte virtualChannelIdentifier = 0;
+
+    // Master channel frame count: number of the frame among all the
+    // frames of the spacecraft, modulo 256.
+    byte masterChannelFrameCount = 0;
+
+    // Virtual channel frame count: number of the frame among the
+    // frames of its virtual channel, modulo 256.
+    byte virtualChannelFrameCount = 0;
+
+    // Position of the first packet primary header in the transfer
+    // frame data field or NO_FIRST_HEADER if no packet starts in the
+    // frame.
+    word firstHeaderPointer = NO_FIRST_HEADER;
+
+    // Read the primary header from an input stream.
+    // Return true on success; otherwise return false.
+    boolean readFrom(Stream& input);
+
+    // Write the primary header to an output stream.
+    // Return true on success; otherwise return false.
+    boolean writeTo(Stream& output) const;
+};
+
+#endif /* ESAT_CCSDSTransferFrameHeader_h */
@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_I2CBusScheduler.h"
+
+void ESAT_I2CBusSchedulerClass::begin(TwoWire& i2cInterface)
+{
+  bus = &i2cInterface;
+  busBorrowed = false;
+  busLent = false;
+  busTaken = false;
+  nestedTransactions = 0;
+  runningQueuedTransaction = false;
+  beginCycle();
+}
+
+boolean ESAT_I2CBusSchedulerClass::beginTransaction(const byte address)
+{
+  if (!bus)
+  {
+    return true;
+  }
+  // The lock stays taken until endTransaction() when the bus is
+  // granted.  While the bus is lent, its holder sleeps in wait()
+  // and will take the lock back, so this thread must wait for the
+  // holder to call endTransaction() unless it is more urgent and
+  // can borrow the bus.  A thread that finds the bus borrowed after
+  // taking the lock is the borrower itself, and a thread that finds
+  // the bus taken and not lent is the holder itself.
+  lock();
+  const byte devicePriority = priority(address);
+  while (busLent && !busBorrowed && (devicePriority >= currentPriority))
+  {
+    unlock();
+    sleepFunction(0);
+    lock();
+  }
+  if (busBorrowed || (busTaken && !busLent) || runningQueuedTransaction)
+  {
+    nestedTransactions = nestedTransactions + 1;
+    return true;
+  }
+  if (busLent)
+  {
+    if (!hasTimeSlotLeft(address))
+    {
+      unlock();
+      return false;
+    }
+    busBorrowed = true;
+    borrowerAddress = address;
+    borrowerStartTime = micros();
+    return true;
+  }
+  runTransactions(NO_ADDRESS, devicePriority);
+  if (!hasTimeSlotLeft(address))
+  {
+    unlock();
+    return false;
+  }
+  busTaken = true;
+  currentAddress = address;
+  currentPriority = devicePriority;
+  currentStartTime = micros();
+  lentTime = 0;
+  return true;
+}
+
+void ESAT_I2CBusSchedulerClass::beginCycle()
+{
+  lock();
+  for (byte index = 0; index < numberOfDevices; index++)
+  {
+    devices[index].usedTime = 0;
+  }
+  unlock();
+}
+
+void ESAT_I2CBusSchedulerClass::chargeTime(const byte address,
+                                           const unsigned long time)
+{
+  Device* const device = findDevice(address);
+  if (device)
+  {
+    device->usedTime = device->usedTime + time;
+  }
+}
+
+boolean ESAT_I2CBusSchedulerClass::configure(const byte address,
+                                             const byte devicePriority,
+                                             const unsigned long timeSlot)
+{
+  lock();
+  Device* device = findDevice(address);
+  if (!device)
+  {
+    if (numberOfDevices >= MAXIMUM_NUMBER_OF_DEVICES)
+    {
+      unlock();
+      return false;
+    }
+    device = &devices[numberOfDevices];
+    numberOfDevices = numberOfDevices + 1;
+    device->address = address;
+    device->usedTime = 0;
+  }
+  device->priority = devicePriority;
+  device->timeSlot = timeSlot;
+  unlock();
+  return true;
+}
+
+boolean ESAT_I2CBusSchedulerClass::deadlineArrived(const ESAT_I2CTransaction& transaction) const
+{
+  // Compare as a signed difference so that the comparison keeps
+  // working when micros() overflows.
+  const long timeToDeadline = long(transaction.deadline - micros());
+  return timeToDeadline <= 0;
+}
+
+void ESAT_I2CBusSchedulerClass::endTransaction()
+{
+  // The caller holds the lock since beginTransaction(), except for
+  // stray calls without a matching beginTransaction(), which find
+  // the bus free and must not give back the lock.
+  if (!bus)
+  {
+    return;
+  }
+  if (nestedTransactions > 0)
+  {
+    nestedTransactions = nestedTransactions - 1;
+    unlock();
+    return;
+  }
+  if (busBorrowed)
+  {
+    const unsigned long borrowedTime = micros() - borrowerStartTime;
+    chargeTime(borrowerAddress, borrowedTime);
+    lentTime = lentTime + borrowedTime;
+    busBorrowed = false;
+    borrowerAddress = NO_ADDRESS;
+    unlock();
+    return;
+  }
+  if (!busTaken)
+  {
+    return;
+  }
+  const unsigned long elapsedTime = micros() - currentStartTime;
+  if (elapsedTime > lentTime)
+  {
+    chargeTime(currentAddress, elapsedTime - lentTime);
+  }
+  busTaken = false;
+  currentAddress = NO_ADDRESS;
+  currentPriority = LOWEST_PRIORITY;
+  unlock();
+}
+
+ESAT_I2CBusSchedulerClass::Device* ESAT_I2CBusSchedulerClass::findDevice(const byte address)
+{
+  for (byte index = 0; index < numberOfDevices; index++)
+  {
+    if (devices[index].address == address)
+    {
+      return &devices[index];
+    }
+  }
+  return nullptr;
+}
+
+boolean ESAT_I2CBusSchedulerClass::hasTimeSlotLeft(const byte address)
+{
+  const Device* const device = findDevice(address);
+  if (!device)
+  {
+    return true;
+  }
+  if (device->timeSlot == UNLIMITED_TIME_SLOT)
+  {
+    return true;
+  }
+  return device->usedTime < device->timeSlot;
+}
+
+void ESAT_I2CBusSchedulerClass::insertTransaction(ESAT_I2CTransaction& transaction)
+{
+  const byte transactionPriority = priority(transaction.address());
+  ESAT_I2CTransaction** position = &transactions;
+  while (*position != nullptr)
+  {
+    const byte queuedPriority = priority((*position)->address());
+    if (transactionPriority < queuedPriority)
+    {
+      break;
+    }
+    if ((transactionPriority == queuedPriority)
+        && (long(transaction.deadline - (*position)->deadline) < 0))
+    {
+      break;
+    }
+    position = &((*position)->next);
+  }
+  transaction.next = *position;
+  *position = &transaction;
+}
+
+void ESAT_I2CBusSchedulerClass::lock()
+{
+  if (lockFunction)
+  {
+    lockFunction();
+  }
+}
+
+byte ESAT_I2CBusSchedulerClass::priority(const byte address)
+{
+  const Device* const device = findDevice(address);
+  if (device)
+  {
+    return device->priority;
+  }
+  else
+  {
+    return DEFAULT_PRIORITY;
+  }
+}
+
+boolean ESAT_I2CBusSchedulerClass::queue(ESAT_I2CTransaction& transaction,
+                                         const unsigned long microsecondsToDeadline)
+{
+  if (!bus)
+  {
+    return false;
+  }
+  lock();
+  if (transaction.queued)
+  {
+    unlock();
+    return false;
+  }
+  transaction.deadline = micros() + microsecondsToDeadline;
+  transaction.queued = true;
+  insertTransaction(transaction);
+  unlock();
+  return true;
+}
+
+void ESAT_I2CBusSchedulerClass::run()
+{
+  if (!bus)
+  {
+    return;
+  }
+  lock();
+  if (!(busTaken || runningQueuedTransaction))
+  {
+    runTransactions(NO_ADDRESS, LOWEST_PRIORITY);
+  }
+  unlock();
+}
+
+void ESAT_I2CBusSchedulerClass::runTransaction(ESAT_I2CTransaction& transaction)
+{
+  runningQueuedTransaction = true;
+  const unsigned long startTime = micros();
+  transaction.run(*bus);
+  const unsigned long elapsedTime = micros() - startTime;
+  chargeTime(transaction.address(), elapsedTime);
+  if (busTaken)
+  {
+    lentTime = lentTime + elapsedTime;
+  }
+  runningQueuedTransaction = false;
+}
+
+void ESAT_I2CBusSchedulerClass::runTransactions(const byte skippedAddress,
+                                                const byte priorityThreshold)
+{
+  if (runningQueuedTransaction)
+  {
+    return;
+  }
+  // Take the whole queue out and put back the transactions that
+  // cannot run now.  This way, transactions that queue themselves
+  // again when they run wait until the next call.
+  ESAT_I2CTransaction* pendingTransactions = transactions;
+  transactions = nullptr;
+  while (pendingTransactions != nullptr)
+  {
+    ESAT_I2CTransaction& transaction = *pendingTransactions;
+    pendingTransactions = transaction.next;
+    const byte address = transaction.address();
+    boolean mayRun = false;
+    if (address != skippedAddress)
+    {
+      if (deadlineArrived(transaction))
+      {
+        mayRun = true;
+      }
+      else if ((priority(address) < priorityThreshold)
+               && hasTimeSlotLeft(address))
+      {
+        mayRun = true;
+      }
+    }
+    if (mayRun)
+    {
+      transaction.queued = false;
+      runTransaction(transaction);
+    }
+    else
+    {
+      insertTransaction(transaction);
+    }
+  }
+}
+
+void ESAT_I2CBusSchedulerClass::setLock(void (*newLockFunction)(),
+                                        void (*newUnlockFunction)(),
+                                        void (*newSleepFunction)(unsigned long))
+{
+  lockFunction = newLockFunction;
+  unlockFunction = newUnlockFunction;
+  sleepFunction = newSleepFunction;
+}
+
+unsigned long ESAT_I2CBusSchedulerClass::timeToNextDeadline(const unsigned long maximumTime)
+{
+  unsigned long time = maximumTime;
+  for (ESAT_I2CTransaction* transaction = transactions;
+       transaction != nullptr;
+       transaction = transaction->next)
+  {
+    if (transaction->address() == currentAddress)
+    {
+      continue;
+    }
+    const long timeToDeadline = long(transaction->deadline - micros());
+    if (timeToDeadline <= 0)
+    {
+      return 0;
+    }
+    if ((unsigned long) timeToDeadline < time)
+    {
+      time = timeToDeadline;
+    }
+  }
+  return time;
+}
+
+void ESAT_I2CBusSchedulerClass::unlock()
+{
+  if (unlockFunction)
+  {
+    unlockFunction();
+  }
+}
+
+void ESAT_I2CBusSchedulerClass::wait(const unsigned long microseconds)
+{
+  if (!bus)
+  {
+    delay(microseconds / 1000);
+    delayMicroseconds(microseconds % 1000);
+    return;
+  }
+  // Only queued transactions that are more urgent than the current
+  // holder of the bus may use it.  Without holder, only those whose
+  // deadline has arrived may use it: the rest wait for run().
+  // The lock is taken on each round so that other threads can use
+  // the bus while a thread that doesn't hold it waits.
+  // With a sleep function, each round ends with a sleep until the
+  // end of the wait or the next deadline, whatever comes first.
+  // The holder of the bus lends it while it sleeps: it gives back
+  // both the lock of the round and the lock of beginTransaction(),
+  // unless it holds more (nested transactions), and takes the lock
+  // of beginTransaction() again on waking up, after the borrower
+  // gives it back if the bus was borrowed.  A thread that finds the
+  // bus lent is not the holder and leaves the bus alone.
+  const unsigned long startTime = micros();
+  while (true)
+  {
+    lock();
+    const boolean holder = busTaken && !busLent;
+    if (!busTaken)
+    {
+      runTransactions(NO_ADDRESS, ATTITUDE_PRIORITY);
+    }
+    if (holder)
+    {
+      runTransactions(currentAddress, currentPriority);
+    }
+    const unsigned long elapsedTime = micros() - startTime;
+    if (elapsedTime >= microseconds)
+    {
+      unlock();
+      return;
+    }
+    if (!sleepFunction)
+    {
+      unlock();
+      continue;
+    }
+    const unsigned long sleepTime =
+      timeToNextDeadline(microseconds - elapsedTime);
+    const boolean lendBus =
+      holder && (nestedTransactions == 0) && !runningQueuedTransaction;
+    if (lendBus)
+    {
+      busLent = true;
+      unlock();
+      unlock();
+      sleepFunction(sleepTime);
+      lock();
+      busLent = false;
+    }
+    else
+    {
+      unlock();
+      sleepFunction(sleepTime);
+    }
+  }
+}
+
+ESAT_I2CBusSchedulerClass ESAT_I2CBusScheduler;
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_I2CBusScheduler_h
+#define ESAT_I2CBusScheduler_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ESAT_I2CTransaction.h"
+
+// Scheduler for sharing one I2C bus between several users.
+// Use the global instance ESAT_I2CBusScheduler.
+//
+// Each device (identified by its I2C address) has a priority and a
+// time slot: the number of microseconds of bus time it may use in
+// each scheduling cycle.
+//
+// Blocking users (like ESAT_I2CMaster) ask for the bus with
+// beginTransaction() and give it back with endTransaction().
+// While they wait for a slave (between packet chunks, or between
+// state polls), they call wait() instead of delay(), so queued
+// asynchronous transactions of higher priority, or those about to
+// miss their deadline, can use the bus in the meantime.
+//
+// Asynchronous users queue ESAT_I2CTransaction objects with a
+// deadline.  Queued transactions run from run(), from
+// beginTransaction() when they are more urgent than the blocking
+// user asking for the bus, and from wait().
+//
+// Until begin() is called, the scheduler lets every user take the
+// bus and wait() behaves like a plain delay.
+//
+// When several threads share the bus (for example, FreeRTOS tasks),
+// give the scheduler a pair of recursive lock functions and a sleep
+// function with setLock(): the thread that holds the bus between
+// beginTransaction() and endTransaction() keeps the lock, and the
+// rest of the threads wait for it in beginTransaction().  While the
+// holder waits for a slave in wait(), it sleeps and gives back the
+// lock, so the rest of the threads can run and queue transactions.
+// The bus stays lent to the holder until endTransaction(), except for
+// blocking users of higher priority: one of them at a time may borrow
+// the bus between beginTransaction() and endTransaction(), and the
+// holder waits for it to finish before going on.  This way, an
+// attitude sensor read doesn't wait for a whole bulk packet forward.
+class ESAT_I2CBusSchedulerClass
+{
+  public:
+    // Transaction priorities, from the most urgent to the least urgent.
+    enum Priority
+    {
+      ATTITUDE_PRIORITY = 0,
+      TELECOMMAND_PRIORITY = 1,
+      HOUSEKEEPING_PRIORITY = 2,
+      BULK_PRIORITY = 3,
+    };
+
+    // Devices that were not configured get this priority.
+    static const byte DEFAULT_PRIORITY = HOUSEKEEPING_PRIORITY;
+
+    // Devices with this time slot may use the bus for as long as
+    // they need.  Devices that were not configured get this time slot.
+    static const unsigned long UNLIMITED_TIME_SLOT = 0xFFFFFFFF;
+
+    // Maximum number of devices with their own configuration.
+    static const byte MAXIMUM_NUMBER_OF_DEVICES = 16;
+
+    // Start scheduling the transactions on the given bus.
+    void begin(TwoWire& bus);
+
+    // Ask for the bus to talk to the device at the given address
+    // without interruption until the next call to endTransaction().
+    // Run first the queued transactions that are more urgent than
+    // the device at the given address.  With several threads, a
+    // device of higher priority than the current holder borrows the
+    // bus as soon as the holder waits in wait().
+    // Return true if the device at the given address may use the bus;
+    // return false if it has spent its time slot for this cycle.
+    boolean beginTransaction(byte address);
+
+    // Start a new scheduling cycle: give back its full time slot
+    // to each device.
+    void beginCycle();
+
+    // Set the priority (one of the Priority constants) and the time
+    // slot in microseconds per cycle of the device at the given address.
+    // Return true on success; return false if there are already
+    // MAXIMUM_NUMBER_OF_DEVICES configured devices.
+    boolean configure(byte address,
+                      byte priority,
+                      unsigned long timeSlot = UNLIMITED_TIME_SLOT);
+
+    // Give back the bus after a call to beginTransaction().
+    // Charge the time since beginTransaction() to the device.
+    void endTransaction();
+
+    // Queue an asynchronous transaction that must run within the given
+    // number of microseconds.
+    // Return true on success; return false if the scheduler is not
+    // running or the transaction is already queued.
+    boolean queue(ESAT_I2CTransaction& transaction,
+                  unsigned long microsecondsToDeadline);
+
+    // Run the queued transactions by order of priority and deadline
+    // while their devices have time slot left.  Transactions whose
+    // deadline has arrived run regardless of the time slot.
+    void run();
+
+    // Take the given lock function before using the bus or the
+    // transaction queue and the given unlock function after that.
+    // The lock must be recursive: the thread that holds it may take
+    // it again, and it is free again after as many unlocks as locks.
+    // Threads waiting for the bus call the given sleep function with
+    // a number of microseconds instead of polling; it must let the
+    // rest of the threads run, even when asked to sleep for 0
+    // microseconds.  Without sleep function, waits are busy loops
+    // that keep the lock.
+    // Pass nullptr for all the functions to go back to single-thread
+    // operation, which is the default.
+    void setLock(void (*lockFunction)(),
+                 void (*unlockFunction)(),
+                 void (*sleepFunction)(unsigned long) = nullptr);
+
+    // Wait for the given number of microseconds.  In the meantime, let
+    // queued transactions that are more urgent than the current bus
+    // user run on the bus.  Call this from blocking users instead of
+    // delay() or delayMicroseconds() while the bus is idle.
+    // With a sleep function (see setLock()), the waiting thread
+    // sleeps between rounds of queued transactions and the current
+    // bus user gives back the lock while it sleeps.
+    void wait(unsigned long microseconds);
+
+  private:
+    // Scheduling configuration and bookkeeping of a device.
+    struct Device
+    {
+      byte address;
+      byte priority;
+      unsigned long timeSlot;
+      unsigned long usedTime;
+    };
+
+    // I2C addresses are 7-bit numbers, so this is never a device address.
+    static const byte NO_ADDRESS = 0xFF;
+
+    // Queued transactions of any priority are more urgent than this.
+    static const byte LOWEST_PRIORITY = 0xFF;
+
+    // Address of the device that borrowed the bus.
+    byte borrowerAddress = NO_ADDRESS;
+
+    // Time (in microseconds) when the device that borrowed the bus
+    // called beginTransaction().
+    unsigned long borrowerStartTime = 0;
+
+    // Schedule transactions on this bus.
+    TwoWire* bus = nullptr;
+
+    // True while a blocking user of higher priority than the current
+    // holder uses the bus lent to the holder.
+    boolean busBorrowed = false;
+
+    // True while the current holder of the bus sleeps in wait()
+    // without the lock.  Other threads may take the lock, but only
+    // more urgent devices may borrow the bus.
+    boolean busLent = false;
+
+    // True while a blocking user holds the bus.
+    boolean busTaken = false;
+
+    // Address of the device that currently holds the bus
+    // through beginTransaction().
+    byte currentAddress = NO_ADDRESS;
+
+    // Priority of the device that currently holds the bus
+    // through beginTransaction().
+    byte currentPriority = LOWEST_PRIORITY;
+
+    // Time (in microseconds) when the current holder of the bus
+    // called beginTransaction().
+    unsigned long currentStartTime = 0;
+
+    // Configured devices.
+    Device devices[MAXIMUM_NUMBER_OF_DEVICES];
+
+    // Time (in microseconds) that queued transactions and borrowers
+    // used the bus while the current holder was waiting.  This time
+    // is not charged to the current holder.
+    unsigned long lentTime = 0;
+
+    // Number of calls to beginTransaction() made while the bus was
+    // already taken (for example, by a queued transaction that uses
+    // a blocking user).  They don't change the bus holder.
+    byte nestedTransactions = 0;
+
+    // Number of configured devices.
+    byte numberOfDevices = 0;
+
+    // Take the lock with this function.
+    void (*lockFunction)() = nullptr;
+
+    // Give back the lock with this function.
+    void (*unlockFunction)() = nullptr;
+
+    // Sleep with this function while waiting.
+    void (*sleepFunction)(unsigned long) = nullptr;
+
+    // True while the scheduler is running a queued transaction.
+    // Used to avoid recursion.
+    boolean runningQueuedTransaction = false;
+
+    // Queued transactions sorted by priority and then by deadline.
+    ESAT_I2CTransaction* transactions = nullptr;
+
+    // Charge the given number of microseconds to the device at the
+    // given address.
+    void chargeTime(byte address, unsigned long time);
+
+    // Return true if the deadline of the transaction has arrived;
+    // otherwise return false.
+    boolean deadlineArrived(const ESAT_I2CTransaction& transaction) const;
+
+    // Return the configuration of the device at the given address
+    // or nullptr if the device is not configured.
+    Device* findDevice(byte address);
+
+    // Return true if the device at the given address has time slot
+    // left in the current cycle; otherwise return false.
+    boolean hasTimeSlotLeft(byte address);
+
+    // Put the transaction in the queue, sorted by priority and then
+    // by deadline.
+    void insertTransaction(ESAT_I2CTransaction& transaction);
+
+    // Take the lock if there is a lock function.
+    void lock();
+
+    // Return the priority of the device at the given address.
+    byte priority(byte address);
+
+    // Run the transaction and charge its time to its device.
+    void runTransaction(ESAT_I2CTransaction& transaction);
+
+    // Run the queued transactions that can use the bus now:
+    // those whose deadline has arrived and those with time slot left
+    // and higher priority than the given priority.  Skip transactions
+    // for the device at the given address, as it may be in the middle
+    // of an exchange.  The rest of the transactions stay in the queue.
+    void runTransactions(byte skippedAddress, byte priorityThreshold);
+
+    // Return the number of microseconds until the earliest deadline
+    // of the queued transactions that wait() may run, or the given
+    // maximum time if it comes first.
+    unsigned long timeToNextDeadline(unsigned long maximumTime);
+
+    // Give back the lock if there is an unlock function.
+    void unlock();
+};
+
+// Global instance of the I2C bus scheduler library.
+extern ESAT_I2CBusSchedulerClass ESAT_I2CBusScheduler;
+
+#endif /* ESAT_I2CBusScheduler_h */
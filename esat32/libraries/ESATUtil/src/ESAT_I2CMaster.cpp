@@ -19,6 +19,8 @@
  */
 
 #include "ESAT_I2CMaster.h"
+#include "ESAT_I2CBusScheduler.h"
+#include "ESAT_I2CStatistics.h"
 
 void ESAT_I2CMasterClass::begin(TwoWire& i2cInterface,
                                 const word numberOfAttempts,
@@ -41,29 +43,19 @@ boolean ESAT_I2CMasterClass::canReadPacket(const byte address)
   float retryDelay = initialDelay;
   for (unsigned long i = 0; i < attempts; i++)
   {
-    bus->beginTransmission(address);
-    (void) bus->write(READ_STATE);
-    const byte writeStatus = bus->endTransmission();
-    // Delay for compatiblity with deprecated method readTelemetry().
-    delay(millisecondsAfterWrites);
-    if (writeStatus != 0)
+    if (i > 0)
     {
-      return false;
+      ESAT_I2CStatistics.countRetry(address);
     }
-    const byte bytesToRead = 1;
-    const byte bytesRead = bus->requestFrom(address, bytesToRead);
-    if (bytesRead != bytesToRead)
-    {
-      return false;
-    }
-    const byte readState = bus->read();
+    const int readState = readMasterReadState(address);
     switch (readState)
     {
       case PACKET_NOT_REQUESTED:
         return false;
         break;
       case PACKET_NOT_READY:
-        delay(retryDelay);
+        ESAT_I2CStatistics.countPacketNotReady(address);
+        ESAT_I2CBusScheduler.wait(1000 * (unsigned long) retryDelay);
         retryDelay = growthFactor * retryDelay;
         break;
       case PACKET_READY:
@@ -95,6 +87,10 @@ boolean ESAT_I2CMasterClass::canWritePacket(const byte address)
   float retryDelay = initialDelay;
   for (unsigned long i = 0; i < attempts; i++)
   {
+    if (i > 0)
+    {
+      ESAT_I2CStatistics.countRetry(address);
+    }
     bus->beginTransmission(address);
     (void) bus->write(WRITE_STATE);
     const byte writeStatus = bus->endTransmission();
@@ -119,7 +115,7 @@ boolean ESAT_I2CMasterClass::canWritePacket(const byte address)
       case PACKET_DATA_WRITE_IN_PROGRESS:
         return true;
       case WRITE_BUFFER_FULL:
-        delay(retryDelay);
+        ESAT_I2CBusScheduler.wait(1000 * (unsigned long) retryDelay);
         retryDelay = growthFactor * retryDelay;
         break;
       default:
@@ -197,6 +193,56 @@ boolean ESAT_I2CMasterClass::readNextTelemetry(ESAT_CCSDSPacket& packet,
                     address);
 }
 
+boolean ESAT_I2CMasterClass::probe(const byte address)
+{
+  if (!bus)
+  {
+    return false;
+  }
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
+  {
+    return false;
+  }
+  const boolean ready = bus->isDeviceReady(address);
+  ESAT_I2CBusScheduler.endTransaction();
+  return ready;
+}
+
+ESAT_I2CMasterClass::PollResult ESAT_I2CMasterClass::pollNextTelemetry(ESAT_CCSDSPacket& packet,
+                                                                       const byte address)
+{
+  if (!bus)
+  {
+    return NO_PACKET;
+  }
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
+  {
+    return NO_PACKET;
+  }
+  PollResult result = NO_PACKET;
+  const int readState = readMasterReadState(address);
+  if (readState == PACKET_NOT_READY)
+  {
+    ESAT_I2CStatistics.countPacketNotReady(address);
+    result = PACKET_PENDING;
+  }
+  if (readState == PACKET_READY)
+  {
+    const boolean correctPacket =
+      readReadyPacket(packet, NEXT_TELEMETRY_PACKET_REQUESTED, address);
+    if (correctPacket)
+    {
+      result = PACKET_RECEIVED;
+    }
+  }
+  ESAT_I2CBusScheduler.endTransaction();
+  return result;
+}
+
 boolean ESAT_I2CMasterClass::readPacket(ESAT_CCSDSPacket& packet,
                                         const int requestedPacket,
                                         const byte address)
@@ -205,6 +251,22 @@ boolean ESAT_I2CMasterClass::readPacket(ESAT_CCSDSPacket& packet,
   {
     return false;
   }
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
+  {
+    return false;
+  }
+  const boolean correctPacket =
+    readScheduledPacket(packet, requestedPacket, address);
+  ESAT_I2CBusScheduler.endTransaction();
+  return correctPacket;
+}
+
+boolean ESAT_I2CMasterClass::readScheduledPacket(ESAT_CCSDSPacket& packet,
+                                                 const int requestedPacket,
+                                                 const byte address)
+{
   const boolean packetRequestCorrect =
     requestPacket(requestedPacket, address);
   if (!packetRequestCorrect)
@@ -217,6 +279,13 @@ boolean ESAT_I2CMasterClass::readPacket(ESAT_CCSDSPacket& packet,
   {
     return false;
   }
+  return readReadyPacket(packet, requestedPacket, address);
+}
+
+boolean ESAT_I2CMasterClass::readReadyPacket(ESAT_CCSDSPacket& packet,
+                                             const int requestedPacket,
+                                             const byte address)
+{
   const boolean primaryHeaderCorrect =
     readPrimaryHeader(packet, address);
   if (!primaryHeaderCorrect)
@@ -269,6 +338,26 @@ boolean ESAT_I2CMasterClass::readPacketData(ESAT_CCSDSPacket& packet,
   return true;
 }
 
+int ESAT_I2CMasterClass::readMasterReadState(const byte address)
+{
+  bus->beginTransmission(address);
+  (void) bus->write(READ_STATE);
+  const byte writeStatus = bus->endTransmission();
+  // Delay for compatiblity with deprecated method readTelemetry().
+  delay(millisecondsAfterWrites);
+  if (writeStatus != 0)
+  {
+    return -1;
+  }
+  const byte bytesToRead = 1;
+  const byte bytesRead = bus->requestFrom(address, bytesToRead);
+  if (bytesRead != bytesToRead)
+  {
+    return -1;
+  }
+  return bus->read();
+}
+
 boolean ESAT_I2CMasterClass::readPrimaryHeader(ESAT_CCSDSPacket& packet,
                                                const byte address)
 {
@@ -312,20 +401,25 @@ ESAT_SemanticVersionNumber ESAT_I2CMasterClass::readProtocolVersionNumber(const
   {
     return version;
   }
-  bus->beginTransmission(address);
-  (void) bus->write(PROTOCOL_VERSION_NUMBER);
-  const byte writeStatus = bus->endTransmission();
-  if (writeStatus != 0)
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
   {
     return version;
   }
-  const byte bytesToRead = ESAT_SemanticVersionNumber::LENGTH;
-  const byte bytesRead = bus->requestFrom(address, bytesToRead);
-  if (bytesRead != bytesToRead)
+  bus->beginTransmission(address);
+  (void) bus->write(PROTOCOL_VERSION_NUMBER);
+  const byte writeStatus = bus->endTransmission();
+  if (writeStatus == 0)
   {
-    return version;
+    const byte bytesToRead = ESAT_SemanticVersionNumber::LENGTH;
+    const byte bytesRead = bus->requestFrom(address, bytesToRead);
+    if (bytesRead == bytesToRead)
+    {
+      (void) version.readFrom(*bus);
+    }
   }
-  (void) version.readFrom(*bus);
+  ESAT_I2CBusScheduler.endTransaction();
   return version;
 }
 
@@ -414,15 +508,40 @@ boolean ESAT_I2CMasterClass::requestPacket(const int requestedPacket,
   }
 }
 
+boolean ESAT_I2CMasterClass::requestNextTelemetry(const byte address)
+{
+  if (!bus)
+  {
+    return false;
+  }
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
+  {
+    return false;
+  }
+  const boolean packetRequestCorrect =
+    requestPacket(NEXT_TELEMETRY_PACKET_REQUESTED, address);
+  ESAT_I2CBusScheduler.endTransaction();
+  return packetRequestCorrect;
+}
+
 boolean ESAT_I2CMasterClass::resetTelemetryQueue(const byte address)
 {
   if (!bus)
   {
     return false;
   }
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
+  {
+    return false;
+  }
   bus->beginTransmission(address);
   (void) bus->write(RESET_TELEMETRY_QUEUE);
   const byte writeStatus = bus->endTransmission();
+  ESAT_I2CBusScheduler.endTransaction();
   if (writeStatus == 0)
   {
     return true;
@@ -441,6 +560,22 @@ boolean ESAT_I2CMasterClass::writePacket(ESAT_CCSDSPacket& packet,
   {
     return false;
   }
+  const boolean busGranted =
+    ESAT_I2CBusScheduler.beginTransaction(address);
+  if (!busGranted)
+  {
+    return false;
+  }
+  const boolean correctPacket =
+    writeScheduledPacket(packet, address, microsecondsBetweenChunks);
+  ESAT_I2CBusScheduler.endTransaction();
+  return correctPacket;
+}
+
+boolean ESAT_I2CMasterClass::writeScheduledPacket(ESAT_CCSDSPacket& packet,
+                                                  const byte address,
+                                                  const word microsecondsBetweenChunks)
+{
   const boolean canWrite =
     canWritePacket(address);
   if (!canWrite)
@@ -479,7 +614,7 @@ boolean ESAT_I2CMasterClass::writePacketData(ESAT_CCSDSPacket& packet,
       (void) bus->write(packet.readByte());
     }
     const byte writeStatus = bus->endTransmission();
-    delayMicroseconds(microsecondsBetweenChunks);
+    ESAT_I2CBusScheduler.wait(microsecondsBetweenChunks);
     // Delay for compatiblity with deprecated method writeTelecommand().
     delay(millisecondsAfterWrites);
     if (writeStatus != 0)
@@ -503,7 +638,7 @@ boolean ESAT_I2CMasterClass::writePrimaryHeader(ESAT_CCSDSPacket& packet,
   const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
   (void) primaryHeader.writeTo(*bus);
   const byte writeStatus = bus->endTransmission();
-  delayMicroseconds(microsecondsBetweenChunks);
+  ESAT_I2CBusScheduler.wait(microsecondsBetweenChunks);
   // Delay for compatiblity with deprecated method writeTelecommand().
   delay(millisecondsAfterWrites);
   if (writeStatus == 0)
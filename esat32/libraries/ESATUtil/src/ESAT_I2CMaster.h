@@ -28,6 +28,8 @@
 
 // ESAT I2C telecommand and telemetry protocol for I2C master nodes.
 // Use the global instance ESAT_I2CMaster.
+// Each exchange with a slave asks ESAT_I2CBusScheduler for the bus
+// first, so it follows the priority and the time slot of the slave.
 class ESAT_I2CMasterClass
 {
   public:
@@ -60,6 +62,30 @@ class ESAT_I2CMasterClass
     boolean readNextTelemetry(ESAT_CCSDSPacket& packet,
                               byte address);
 
+    // Possible results of pollNextTelemetry().
+    enum PollResult
+    {
+      PACKET_RECEIVED,
+      PACKET_PENDING,
+      NO_PACKET,
+    };
+
+    // Cheap presence check: return true if the slave at the given
+    // address acknowledges its address; otherwise return false.
+    boolean probe(byte address);
+
+    // Look just once (without retries) at the next-packet telemetry
+    // request made with requestNextTelemetry() to the slave at the
+    // given address and return:
+    // - PACKET_RECEIVED if the packet was ready; then, fill the
+    //   given packet with it.
+    // - PACKET_PENDING if the slave is still preparing the packet;
+    //   poll again later.
+    // - NO_PACKET if the slave rejected the request, the packet was
+    //   wrong or there was an error.
+    PollResult pollNextTelemetry(ESAT_CCSDSPacket& packet,
+                                 byte address);
+
     // Return the protocol version number of the slave at the given address.
     // The protocol version number is 0.0.0 on error.
     ESAT_SemanticVersionNumber readProtocolVersionNumber(byte address);
@@ -92,6 +118,13 @@ class ESAT_I2CMasterClass
                           byte attempts,
                           word millisecondsBetweenAttempts) __attribute__((deprecated("Use ESAT_I2CMaster.readNamedTelemetry(packet, identifier, address) instead.")));
 
+    // Ask the slave at the given address for a next-packet telemetry
+    // packet, but don't wait for it: the slave can prepare the packet
+    // while the bus serves other slaves.  Collect the packet later
+    // with pollNextTelemetry().
+    // Return true on success; otherwise return false.
+    boolean requestNextTelemetry(byte address);
+
     // Reset the telemetry packet queue for next-packet telemetry pf
     // the slave at the given address.
     // Call this method before a series of calls to
@@ -102,11 +135,13 @@ class ESAT_I2CMasterClass
 
     // Write a packet to the slave at the given address.
     // Wait an optional number of microseconds between successive
-    // 15-byte chunks written to the slave to give it some time
-    // to process the received data.  Arduino's Wire library calls
-    // the user data reception function after the stop condition,
-    // so the slave cannot clock-stretch and it is necessary to give
-    // it time manually.
+    // 15-byte chunks written to the slave to give it some time to
+    // process the received data.  Arduino's Wire library calls the
+    // user data reception function after the stop condition, so the
+    // slave cannot clock-stretch and it is necessary to give it time
+    // manually.  In the meantime, more urgent users of
+    // ESAT_I2CBusScheduler may use the bus: queued transactions and,
+    // with several threads, blocking users of other threads.
     // Return true on success; otherwise return false.
     boolean writePacket(ESAT_CCSDSPacket& packet,
                         byte address,
@@ -133,6 +168,9 @@ class ESAT_I2CMasterClass
                              word millisecondsBetweenAttempts) __attribute__((deprecated("Use ESAT_I2CMaster.writePacket(packet, address) instead.")));
 
   private:
+    // ESAT_I2CPacketWriteTransaction speaks the same protocol.
+    friend class ESAT_I2CPacketWriteTransaction;
+
     // Pass this constant as the requestedPacket argument
     // to writePacketRequest() to ask for next-packet telemetry.
     static const int NEXT_TELEMETRY_PACKET_REQUESTED = -2;
@@ -235,6 +273,27 @@ class ESAT_I2CMasterClass
     // Return true on success; otherwise return false.
     boolean readPacketData(ESAT_CCSDSPacket& packet, byte address);
 
+    // Read a packet from the device at the given address once it
+    // is ready (its master-read state is PACKET_READY).
+    // The requested packet is the same as in readPacket().
+    // Return true on success; otherwise return false.
+    boolean readReadyPacket(ESAT_CCSDSPacket& packet,
+                            int requestedPacket,
+                            byte address);
+
+    // Read a packet from the device at the given address once the
+    // I2C bus scheduler has given us the bus.
+    // The requested packet is the same as in readPacket().
+    // Return true on success; otherwise return false.
+    boolean readScheduledPacket(ESAT_CCSDSPacket& packet,
+                                int requestedPacket,
+                                byte address);
+
+    // Read the master-read state (a MasterReadState value) of the
+    // slave at the given address.
+    // Return -1 on error.
+    int readMasterReadState(byte address);
+
     // Read the packet primary header from the given address.
     // Return true on success; otherwise return false.
     boolean readPrimaryHeader(ESAT_CCSDSPacket& packet, byte address);
@@ -255,6 +314,15 @@ class ESAT_I2CMasterClass
                             byte address,
                             word microsecondsBetweenChunks);
 
+    // Write a packet to the slave at the given address once the
+    // I2C bus scheduler has given us the bus.
+    // Wait a number of microseconds between chunks
+    // to give the slave time to process the data.
+    // Return true on success; otherwise return false.
+    boolean writeScheduledPacket(ESAT_CCSDSPacket& packet,
+                                 byte address,
+                                 word microsecondsBetweenChunks);
+
     // Write the primary header of the packet to the given address.
     // Wait a number of microseconds between chunks
     // to give the slave time to process the data.
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_I2CPacketWriteTransaction.h"
+#include "ESAT_CCSDSPrimaryHeader.h"
+#include "ESAT_I2CBusScheduler.h"
+#include "ESAT_I2CMaster.h"
+#include "ESAT_I2CStatistics.h"
+
+byte ESAT_I2CPacketWriteTransaction::address()
+{
+  return slaveAddress;
+}
+
+void ESAT_I2CPacketWriteTransaction::queueAgain(const unsigned long microseconds)
+{
+  const boolean queuedAgain = ESAT_I2CBusScheduler.queue(*this, microseconds);
+  if (!queuedAgain)
+  {
+    writeState = WRITE_FAILED;
+  }
+}
+
+void ESAT_I2CPacketWriteTransaction::run(TwoWire& bus)
+{
+  // The scheduler may run the transaction before the time between
+  // chunks is over (for example, when it is more urgent than the
+  // holder of the bus); in that case, it just goes back to the queue.
+  if (writeState != WRITE_IN_PROGRESS)
+  {
+    return;
+  }
+  const long timeToNextChunk = long(nextChunkTime - micros());
+  if (timeToNextChunk > 0)
+  {
+    queueAgain(timeToNextChunk);
+    return;
+  }
+  if (primaryHeaderWritten)
+  {
+    writePacketData(bus);
+  }
+  else
+  {
+    writePrimaryHeader(bus);
+  }
+}
+
+ESAT_I2CPacketWriteTransaction::State ESAT_I2CPacketWriteTransaction::state() const
+{
+  return writeState;
+}
+
+boolean ESAT_I2CPacketWriteTransaction::write(ESAT_CCSDSPacket& newPacket,
+                                              const byte address,
+                                              const unsigned long microsecondsToDeadline,
+                                              const word newMicrosecondsBetweenChunks)
+{
+  if (writeState == WRITE_IN_PROGRESS)
+  {
+    return false;
+  }
+  packet = &newPacket;
+  slaveAddress = address;
+  microsecondsBetweenChunks = newMicrosecondsBetweenChunks;
+  failedAttempts = 0;
+  primaryHeaderWritten = false;
+  nextChunkTime = micros();
+  packet->rewind();
+  writeState = WRITE_IN_PROGRESS;
+  const boolean queued =
+    ESAT_I2CBusScheduler.queue(*this, microsecondsToDeadline);
+  if (!queued)
+  {
+    writeState = WRITE_FAILED;
+    return false;
+  }
+  return true;
+}
+
+void ESAT_I2CPacketWriteTransaction::writePacketData(TwoWire& bus)
+{
+  if (packet->available() > 0)
+  {
+    bus.beginTransmission(slaveAddress);
+    (void) bus.write(ESAT_I2CMasterClass::WRITE_PACKET_DATA);
+    const byte bytesToWrite = ESAT_I2CMasterClass::I2C_CHUNK_LENGTH - 1;
+    for (byte i = 0;
+         (i < bytesToWrite) && (packet->available() > 0);
+         i++)
+    {
+      (void) bus.write(packet->readByte());
+    }
+    const byte writeStatus = bus.endTransmission();
+    if (writeStatus != 0)
+    {
+      writeState = WRITE_FAILED;
+      return;
+    }
+  }
+  if (packet->available() > 0)
+  {
+    nextChunkTime = micros() + microsecondsBetweenChunks;
+    queueAgain(microsecondsBetweenChunks);
+  }
+  else
+  {
+    writeState = WRITE_SUCCEEDED;
+  }
+}
+
+void ESAT_I2CPacketWriteTransaction::writePrimaryHeader(TwoWire& bus)
+{
+  // Same as ESAT_I2CMaster.writePacket(): ask the slave for its
+  // master-write state and write the primary header right away if
+  // it can take the packet; otherwise, ask again later.
+  bus.beginTransmission(slaveAddress);
+  (void) bus.write(ESAT_I2CMasterClass::WRITE_STATE);
+  const byte stateRequestStatus = bus.endTransmission();
+  if (stateRequestStatus != 0)
+  {
+    writeState = WRITE_FAILED;
+    return;
+  }
+  const byte bytesToRead = 1;
+  const byte bytesRead = bus.requestFrom(slaveAddress, bytesToRead);
+  if (bytesRead != bytesToRead)
+  {
+    writeState = WRITE_FAILED;
+    return;
+  }
+  const byte slaveWriteState = bus.read();
+  if (slaveWriteState == ESAT_I2CMasterClass::WRITE_BUFFER_FULL)
+  {
+    failedAttempts = failedAttempts + 1;
+    if (failedAttempts >= ATTEMPTS)
+    {
+      writeState = WRITE_FAILED;
+      return;
+    }
+    ESAT_I2CStatistics.countRetry(slaveAddress);
+    nextChunkTime = micros() + MICROSECONDS_BETWEEN_ATTEMPTS;
+    queueAgain(MICROSECONDS_BETWEEN_ATTEMPTS);
+    return;
+  }
+  if ((slaveWriteState != ESAT_I2CMasterClass::WRITE_BUFFER_EMPTY)
+      && (slaveWriteState != ESAT_I2CMasterClass::PACKET_DATA_WRITE_IN_PROGRESS))
+  {
+    writeState = WRITE_FAILED;
+    return;
+  }
+  bus.beginTransmission(slaveAddress);
+  (void) bus.write(ESAT_I2CMasterClass::WRITE_PRIMARY_HEADER);
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet->readPrimaryHeader();
+  (void) primaryHeader.writeTo(bus);
+  const byte writeStatus = bus.endTransmission();
+  if (writeStatus != 0)
+  {
+    writeState = WRITE_FAILED;
+    return;
+  }
+  primaryHeaderWritten = true;
+  nextChunkTime = micros() + microsecondsBetweenChunks;
+  queueAgain(microsecondsBetweenChunks);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_I2CPacketWriteTransaction_h
+#define ESAT_I2CPacketWriteTransaction_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "ESAT_CCSDSPacket.h"
+#include "ESAT_I2CTransaction.h"
+
+// Asynchronous packet write to an I2C slave with the ESAT CCSDS Space
+// Packet-over-I2C protocol, as in ESAT_I2CMaster.writePacket(), but
+// queued in ESAT_I2CBusScheduler instead of holding the bus.
+// Each run writes just one chunk of the packet (the first one after
+// checking that the slave can take the packet), and the transaction
+// queues itself again for the next chunk, so the waits between chunks
+// leave the bus free for the rest of its users.
+// ESAT_I2CBusScheduler must be running (see
+// ESAT_I2CBusScheduler.begin()).
+class ESAT_I2CPacketWriteTransaction: public ESAT_I2CTransaction
+{
+  public:
+    // States of the packet write.
+    enum State
+    {
+      // No packet write started yet.
+      WRITE_IDLE,
+      // The packet write is under way.
+      WRITE_IN_PROGRESS,
+      // The whole packet went to the slave.
+      WRITE_SUCCEEDED,
+      // The packet write failed.
+      WRITE_FAILED,
+    };
+
+    // Return the I2C address of the slave.
+    byte address();
+
+    // Write the next chunk of the packet.
+    // Only ESAT_I2CBusScheduler should call this.
+    void run(TwoWire& bus);
+
+    // Return the state of the packet write.
+    State state() const;
+
+    // Start writing the packet to the slave at the given address:
+    // queue the transaction so that it writes the first chunk
+    // within the given number of microseconds and each of the
+    // following chunks at least the given number of microseconds
+    // between chunks after the previous one.
+    // The packet must stay untouched until the write finishes.
+    // Return true if the write started; return false if there is a
+    // write under way or if ESAT_I2CBusScheduler is not running.
+    boolean write(ESAT_CCSDSPacket& packet,
+                  byte address,
+                  unsigned long microsecondsToDeadline,
+                  word microsecondsBetweenChunks);
+
+  private:
+    // Ask if the slave can take the packet up to this number of
+    // times.
+    static const byte ATTEMPTS = 5;
+
+    // Wait this number of microseconds before asking again when the
+    // slave cannot take the packet yet.
+    static const unsigned long MICROSECONDS_BETWEEN_ATTEMPTS = 10000;
+
+    // Number of times the slave couldn't take the packet yet.
+    byte failedAttempts = 0;
+
+    // Wait this number of microseconds between chunks.
+    word microsecondsBetweenChunks = 0;
+
+    // Time (in microseconds, as returned by micros()) from which the
+    // next chunk may go out.
+    unsigned long nextChunkTime = 0;
+
+    // Write this packet.
+    ESAT_CCSDSPacket* packet = nullptr;
+
+    // True once the primary header went to the slave.
+    boolean primaryHeaderWritten = false;
+
+    // I2C address of the slave.
+    byte slaveAddress = 0;
+
+    // State of the packet write.
+    State writeState = WRITE_IDLE;
+
+    // Queue the transaction again to run within the given number of
+    // microseconds.  Fail the write if it cannot be queued.
+    void queueAgain(unsigned long microseconds);
+
+    // Write the next chunk of packet data.
+    void writePacketData(TwoWire& bus);
+
+    // Write the primary header of the packet if the slave can take
+    // the packet now.
+    void writePrimaryHeader(TwoWire& bus);
+};
+
+#endif /* ESAT_I2CPacketWriteTransaction_h */
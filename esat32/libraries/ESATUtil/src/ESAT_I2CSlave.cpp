@@ -81,6 +81,15 @@ void ESAT_I2CSlaveClass::begin(TwoWire& i2cInterface,
   bus->onRequest(requestEvent);
 }
 
+void ESAT_I2CSlaveClass::beginTelemetryStaging(const unsigned long numberOfPackets,
+                                               const unsigned long packetDataCapacity)
+{
+  noInterrupts();
+  stagedTelemetry = ESAT_CCSDSPacketQueue(numberOfPackets,
+                                          packetDataCapacity);
+  interrupts();
+}
+
 void ESAT_I2CSlaveClass::clearMasterWrittenPacketsQueue()
 {
   noInterrupts();
@@ -172,6 +181,16 @@ void ESAT_I2CSlaveClass::handleReadTelemetryReception()
   {
     masterReadRequestedPacket = NEXT_TELEMETRY_PACKET_REQUESTED;
     masterReadState = PACKET_NOT_READY;
+    // Staged packets were already checked by stageTelemetry(),
+    // so we can hand them out right away.
+    if (stagedTelemetry.availableForRead() > 0)
+    {
+      const boolean gotPacket = stagedTelemetry.read(masterReadPacket);
+      if (gotPacket)
+      {
+        masterReadState = PACKET_READY;
+      }
+    }
   }
 }
 
@@ -214,7 +233,8 @@ void ESAT_I2CSlaveClass::handleResetTelemetryQueueReception()
   i2cState = IDLE;
   if (bus->available() == 0)
   {
-    resetTelemetryQueue = true;
+    telemetryQueueResets = telemetryQueueResets + 1;
+    stagedTelemetry.flush();
   }
 }
 
@@ -381,16 +401,65 @@ void ESAT_I2CSlaveClass::rejectPacket()
   }
 }
 
+boolean ESAT_I2CSlaveClass::stageTelemetry(ESAT_CCSDSPacket& packet,
+                                           const unsigned long resetSequence)
+{
+  packet.rewind();
+  const ESAT_CCSDSPrimaryHeader primaryHeader = packet.readPrimaryHeader();
+  packet.rewind();
+  if (primaryHeader.packetType != primaryHeader.TELEMETRY)
+  {
+    return false;
+  }
+  noInterrupts();
+  if (stagedTelemetry.capacity() == 0)
+  {
+    interrupts();
+    return false;
+  }
+  // A reset that came after the packet was built starts a new
+  // telemetry queue, so the packet is stale.  With interrupts off,
+  // no reset can sneak in between this check and the staging.
+  if (resetSequence != telemetryQueueResets)
+  {
+    interrupts();
+    return false;
+  }
+  if ((masterReadState == PACKET_NOT_READY)
+      && (masterReadRequestedPacket == NEXT_TELEMETRY_PACKET_REQUESTED))
+  {
+    writePacket(packet);
+    interrupts();
+    return true;
+  }
+  const boolean staged = stagedTelemetry.write(packet);
+  interrupts();
+  return staged;
+}
+
+unsigned long ESAT_I2CSlaveClass::stagedTelemetryAvailableForWrite()
+{
+  noInterrupts();
+  const unsigned long availableForWrite = stagedTelemetry.availableForWrite();
+  interrupts();
+  return availableForWrite;
+}
+
 boolean ESAT_I2CSlaveClass::telemetryQueueResetReceived()
 {
-  return resetTelemetryQueue;
+  return telemetryQueueResets != acknowledgedTelemetryQueueResets;
+}
+
+unsigned long ESAT_I2CSlaveClass::telemetryQueueResetSequence()
+{
+  return telemetryQueueResets;
 }
 
 void ESAT_I2CSlaveClass::updateTelemetryQueueState()
 {
   if (masterReadRequestedPacket == NEXT_TELEMETRY_PACKET_REQUESTED)
   {
-    resetTelemetryQueue = false;
+    acknowledgedTelemetryQueueResets = telemetryQueueResets;
   }
 }
 
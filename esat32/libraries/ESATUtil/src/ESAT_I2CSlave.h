@@ -91,6 +91,20 @@ class ESAT_I2CSlaveClass
                unsigned long masterReadPacketDataBufferLength,
                unsigned long inputPacketBufferCapacity);
 
+    // Enable the staging of next-packet telemetry: keep a ring of up
+    // to the given number of telemetry packets (each one of them with
+    // the given packet data capacity) built ahead of time with
+    // stageTelemetry().  Next-packet telemetry read requests take
+    // the oldest staged packet right away from the I2C interrupt, so
+    // the next read of READ_STATE is already PACKET_READY.  When there
+    // are no staged packets, next-packet telemetry read requests wait
+    // for writePacket() or rejectPacket() as usual.
+    // Telemetry queue resets discard the staged packets, and
+    // stageTelemetry() refuses packets built before the latest reset.
+    // Call this after begin().
+    void beginTelemetryStaging(unsigned long numberOfPackets,
+                               unsigned long packetDataCapacity);
+
     // Return:
     // - NO_PACKET_REQUESTED if there isn't a pending packet read
     //   request.
@@ -138,11 +152,35 @@ class ESAT_I2CSlaveClass
     // Clear the received packets queue.
     void clearMasterWrittenPacketsQueue();
 
+    // Stage a telemetry packet for an upcoming next-packet telemetry
+    // read request.  If there is already a pending next-packet
+    // telemetry read request, satisfy it with the packet as
+    // writePacket() does.
+    // The packet must belong to the telemetry queue started by the
+    // reset with the given sequence number (as returned by
+    // telemetryQueueResetSequence() before building the packet);
+    // packets of an older telemetry queue are discarded.
+    // Telemetry staging must be enabled with beginTelemetryStaging().
+    // Return true on success; otherwise (on a full staging ring,
+    // disabled staging, a packet that isn't a telemetry packet or a
+    // packet of an older telemetry queue) return false.
+    boolean stageTelemetry(ESAT_CCSDSPacket& packet,
+                           unsigned long resetSequence);
+
+    // Return the number of telemetry packets that still can be staged.
+    unsigned long stagedTelemetryAvailableForWrite();
+
     // Return true if the master requested a reset of the telemetry queue
     // since the last call to writePacket() with next-packet telemetry;
     // otherwise return false.
     boolean telemetryQueueResetReceived();
 
+    // Return the sequence number of the latest reset of the telemetry
+    // queue requested by the master.  It goes up by one on each reset.
+    // Compare it with the previous value to detect resets without
+    // missing any of them, and pass it to stageTelemetry().
+    unsigned long telemetryQueueResetSequence();
+
     // Queue a packet for reading by the master
     // if the following conditions are met:
     // - the packet is well-formed;
@@ -254,10 +292,17 @@ class ESAT_I2CSlaveClass
     // state machine.
     volatile MasterReadState masterReadState;
 
-    // Set this flag to true when the master requests a reset
-    // of the telemetry queue.  Set this flag to false on calls
-    // to writePacket() with next-packet telemetry.
-    volatile boolean resetTelemetryQueue;
+    // Value of telemetryQueueResets at the latest call to
+    // writePacket() with next-packet telemetry.
+    unsigned long acknowledgedTelemetryQueueResets;
+
+    // Number of resets of the telemetry queue requested by the
+    // master.  Only the I2C interrupt changes it.
+    volatile unsigned long telemetryQueueResets;
+
+    // Telemetry packets built ahead of time for next-packet
+    // telemetry read requests.
+    ESAT_CCSDSPacketQueue stagedTelemetry;
 
     // Handle a write to WRITE_PACKET_DATA.
     void handleWritePacketDataReception();
@@ -326,7 +371,7 @@ class ESAT_I2CSlaveClass
     static void requestEvent();
 
     // Update the state of the telemetry queue.
-    // This will disable the telemetry queue reset flag
+    // This will acknowledge the telemetry queue resets
     // if we are processing a next-packet telemetry read.
     void updateTelemetryQueueState();
 };
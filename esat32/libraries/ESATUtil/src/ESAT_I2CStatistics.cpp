@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "ESAT_I2CStatistics.h"
+
+void ESAT_I2CStatisticsClass::begin(TwoWire& bus)
+{
+  clear();
+  bus.onTransfer(transferObserver);
+}
+
+byte ESAT_I2CStatisticsClass::addresses() const
+{
+  return numberOfAddresses;
+}
+
+void ESAT_I2CStatisticsClass::clear()
+{
+  numberOfAddresses = 0;
+}
+
+void ESAT_I2CStatisticsClass::countPacketNotReady(const byte address)
+{
+  AddressStatistics* const addressStatistics = findAddress(address);
+  if (addressStatistics)
+  {
+    increment(addressStatistics->packetNotReadyPolls);
+  }
+}
+
+void ESAT_I2CStatisticsClass::countRetry(const byte address)
+{
+  AddressStatistics* const addressStatistics = findAddress(address);
+  if (addressStatistics)
+  {
+    increment(addressStatistics->retries);
+  }
+}
+
+void ESAT_I2CStatisticsClass::countTransfer(const byte address,
+                                            const byte status,
+                                            const word bytes,
+                                            const unsigned long duration)
+{
+  AddressStatistics* const addressStatistics = findAddress(address);
+  if (!addressStatistics)
+  {
+    return;
+  }
+  if (addressStatistics->transactions < 0xFFFFFFFF)
+  {
+    addressStatistics->transactions = addressStatistics->transactions + 1;
+  }
+  if (addressStatistics->bytes <= (0xFFFFFFFF - bytes))
+  {
+    addressStatistics->bytes = addressStatistics->bytes + bytes;
+  }
+  switch (status)
+  {
+    case I2C_OK:
+      break;
+    case I2C_NACK_ADDR:
+    case I2C_NACK_DATA:
+      increment(addressStatistics->nacks);
+      break;
+    default:
+      increment(addressStatistics->timeouts);
+      break;
+  }
+#ifdef DWT_BASE
+  const unsigned long cyclesPerMicrosecond = SystemCoreClock / 1000000;
+  const unsigned long microseconds = duration / cyclesPerMicrosecond;
+#else
+  const unsigned long microseconds = duration;
+#endif /* DWT_BASE */
+  increment(addressStatistics->latencyHistogram[latencyBucket(microseconds)]);
+}
+
+ESAT_I2CStatisticsClass::AddressStatistics* ESAT_I2CStatisticsClass::findAddress(const byte address)
+{
+  for (byte index = 0; index < numberOfAddresses; index++)
+  {
+    if (statistics[index].address == address)
+    {
+      return &statistics[index];
+    }
+  }
+  if (numberOfAddresses >= MAXIMUM_NUMBER_OF_ADDRESSES)
+  {
+    return nullptr;
+  }
+  AddressStatistics* const addressStatistics = &statistics[numberOfAddresses];
+  numberOfAddresses = numberOfAddresses + 1;
+  (void) memset(addressStatistics, 0, sizeof(AddressStatistics));
+  addressStatistics->address = address;
+  return addressStatistics;
+}
+
+void ESAT_I2CStatisticsClass::increment(word& counter)
+{
+  if (counter < 0xFFFF)
+  {
+    counter = counter + 1;
+  }
+}
+
+byte ESAT_I2CStatisticsClass::latencyBucket(const unsigned long microseconds) const
+{
+  // Log-scale buckets: the bucket number is the number of significant
+  // bits of the duration measured in units of the first bucket limit.
+  const unsigned long units = microseconds / FIRST_LATENCY_BUCKET_LIMIT;
+  if (units == 0)
+  {
+    return 0;
+  }
+  const byte bucket = 32 - __builtin_clz(units);
+  if (bucket >= LATENCY_HISTOGRAM_BUCKETS)
+  {
+    return LATENCY_HISTOGRAM_BUCKETS - 1;
+  }
+  return bucket;
+}
+
+ESAT_I2CStatisticsClass::AddressStatistics ESAT_I2CStatisticsClass::read(const byte index) const
+{
+  if (index < numberOfAddresses)
+  {
+    return statistics[index];
+  }
+  AddressStatistics emptyStatistics;
+  (void) memset(&emptyStatistics, 0, sizeof(emptyStatistics));
+  return emptyStatistics;
+}
+
+void ESAT_I2CStatisticsClass::transferObserver(const uint8_t address,
+                                               const uint8_t status,
+                                               const uint16_t bytes,
+                                               const uint32_t duration)
+{
+  ESAT_I2CStatistics.countTransfer(address, status, bytes, duration);
+}
+
+ESAT_I2CStatisticsClass ESAT_I2CStatistics;
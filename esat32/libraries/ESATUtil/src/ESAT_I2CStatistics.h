@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_I2CStatistics_h
+#define ESAT_I2CStatistics_h
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Health and latency statistics of the traffic on an I2C bus,
+// kept for each slave address.
+// Use the global instance ESAT_I2CStatistics.
+//
+// The bus reports each master transfer (status, bytes and duration
+// measured with the DWT cycle counter).  ESAT_I2CMaster reports the
+// retries of the ESAT CCSDS Space Packet-over-I2C protocol.
+class ESAT_I2CStatisticsClass
+{
+  public:
+    // Keep statistics for up to this number of addresses.
+    // The first addresses seen on the bus get a place; later
+    // addresses are not counted.
+    static const byte MAXIMUM_NUMBER_OF_ADDRESSES = 6;
+
+    // Number of buckets of the latency histograms.
+    static const byte LATENCY_HISTOGRAM_BUCKETS = 8;
+
+    // The first latency histogram bucket counts the transfers that
+    // took less than this number of microseconds.  Each next bucket
+    // goes up to twice the limit of the previous bucket, and the last
+    // bucket counts all the slower transfers.
+    static const word FIRST_LATENCY_BUCKET_LIMIT = 64;
+
+    // Statistics of the traffic with one slave address.
+    // Counters stop at their maximum value instead of overflowing.
+    struct AddressStatistics
+    {
+      // Slave address.
+      byte address;
+
+      // Number of master transfers (writes and reads).
+      unsigned long transactions;
+
+      // Number of bytes successfully transferred.
+      unsigned long bytes;
+
+      // Number of transfers the slave did not acknowledge.
+      word nacks;
+
+      // Number of transfers that ended in a timeout or a bus error.
+      word timeouts;
+
+      // Number of state polls repeated because the slave was not ready.
+      word retries;
+
+      // Number of PACKET_NOT_READY answers from the slave.
+      word packetNotReadyPolls;
+
+      // Latency histogram of the transfers.
+      word latencyHistogram[LATENCY_HISTOGRAM_BUCKETS];
+    };
+
+    // Start counting the transfers made through the given bus.
+    void begin(TwoWire& bus);
+
+    // Return the number of addresses with statistics.
+    byte addresses() const;
+
+    // Reset all statistics.
+    void clear();
+
+    // Count a PACKET_NOT_READY answer of the slave at the given address.
+    void countPacketNotReady(byte address);
+
+    // Count a repeated state poll to the slave at the given address.
+    void countRetry(byte address);
+
+    // Count a master transfer with the slave at the given address:
+    // its status (an i2c_status_e value), number of bytes transferred
+    // and duration in DWT cycles (in microseconds when the DWT cycle
+    // counter is not available).
+    void countTransfer(byte address,
+                       byte status,
+                       word bytes,
+                       unsigned long duration);
+
+    // Return the statistics of the address at the given index
+    // (from 0 to addresses() - 1).
+    AddressStatistics read(byte index) const;
+
+  private:
+    // Statistics of each address.
+    AddressStatistics statistics[MAXIMUM_NUMBER_OF_ADDRESSES];
+
+    // Number of addresses with statistics.
+    byte numberOfAddresses = 0;
+
+    // Return the statistics of the given address, adding the address
+    // if it is new and there is room for it.
+    // Return nullptr if there is no room for a new address.
+    AddressStatistics* findAddress(byte address);
+
+    // Increment a counter without overflowing it.
+    void increment(word& counter);
+
+    // Return the latency histogram bucket of a duration given
+    // in microseconds.
+    byte latencyBucket(unsigned long microseconds) const;
+
+    // Bus transfer observer.  Forward transfers to countTransfer().
+    static void transferObserver(uint8_t address,
+                                 uint8_t status,
+                                 uint16_t bytes,
+                                 uint32_t duration);
+};
+
+// Global instance of the I2C statistics library.
+extern ESAT_I2CStatisticsClass ESAT_I2CStatistics;
+
+#endif /* ESAT_I2CStatistics_h */
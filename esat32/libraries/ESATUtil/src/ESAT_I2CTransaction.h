@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 Theia Space, Universidad Politécnica de Madrid
+ *
+ * This file is part of Theia Space's ESAT Util library.
+ *
+ * Theia Space's ESAT Util library is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Theia Space's ESAT Util library is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Theia Space's ESAT Util library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESAT_I2CTransaction_h
+#define ESAT_I2CTransaction_h
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Asynchronous I2C bus transaction interface.
+// Use together with ESAT_I2CBusScheduler to queue short bus
+// transactions (like a sensor register read) that will run as soon
+// as the bus is free and their priority and deadline allow it.
+class ESAT_I2CTransaction
+{
+  public:
+    // Next transaction in the transaction queue.
+    // ESAT_I2CBusScheduler uses this to keep a linked list of queued
+    // transactions sorted by priority and deadline.
+    // Only ESAT_I2CBusScheduler should care about this.
+    ESAT_I2CTransaction* next = nullptr;
+
+    // Time (in microseconds, as returned by micros()) by which this
+    // transaction should have run.
+    // Only ESAT_I2CBusScheduler should care about this.
+    unsigned long deadline = 0;
+
+    // True while the transaction is waiting in the queue.
+    // Only ESAT_I2CBusScheduler should care about this.
+    boolean queued = false;
+
+    // Trivial destructor.
+    // We need to define it because the C++ programming language
+    // works this way.
+    virtual ~ESAT_I2CTransaction() {};
+
+    // Return the I2C address of the device this transaction talks to.
+    // ESAT_I2CBusScheduler uses this to know the priority and the
+    // time slot of the transaction.
+    virtual byte address() = 0;
+
+    // Run the transaction on the given bus.
+    // Transactions should be short: just a few bytes written or read
+    // without any waits.
+    virtual void run(TwoWire& bus) = 0;
+};
+
+#endif /* ESAT_I2CTransaction_h */
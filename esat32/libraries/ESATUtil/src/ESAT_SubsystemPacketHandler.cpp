@@ -57,6 +57,7 @@ void ESAT_SubsystemPacketHandlerClass::begin(const word applicationProcessIdenti
                       packetDataCapacity,
                       packetDataCapacity,
                       i2cInputPacketBufferCapacity);
+  i2cTelemetryQueueResetSequence = ESAT_I2CSlave.telemetryQueueResetSequence();
   i2cTelecommandPacket = ESAT_CCSDSPacket(packetDataCapacity);
   i2cTelemetryPacket = ESAT_CCSDSPacket(packetDataCapacity);
 }
@@ -71,6 +72,12 @@ boolean ESAT_SubsystemPacketHandlerClass::dispatchTelecommand(ESAT_CCSDSPacket&
   return telecommandPacketDispatcher.dispatch(telecommandPacket);
 }
 
+void ESAT_SubsystemPacketHandlerClass::enableI2CTelemetryStaging(const unsigned long numberOfPackets)
+{
+  ESAT_I2CSlave.beginTelemetryStaging(numberOfPackets,
+                                      i2cTelemetryPacket.capacity());
+}
+
 void ESAT_SubsystemPacketHandlerClass::enableTelemetry(const byte packetIdentifier)
 {
   enabledTelemetry.set(packetIdentifier);
@@ -131,6 +138,7 @@ boolean ESAT_SubsystemPacketHandlerClass::readSubsystemsOwnTelemetry(ESAT_CCSDSP
 
 void ESAT_SubsystemPacketHandlerClass::respondToI2CPacketRequest()
 {
+  stageI2CTelemetry();
   const int requestedPacket = ESAT_I2CSlave.requestedPacket();
   switch (requestedPacket)
   {
@@ -186,17 +194,7 @@ void ESAT_SubsystemPacketHandlerClass::respondToNextPacketTelecommandRequest()
 
 void ESAT_SubsystemPacketHandlerClass::respondToNextPacketTelemetryRequest()
 {
-  // We only update the list of pending I2C telemetry packets
-  // with the contents of the buffered list when we receive
-  // a command to reset the telemetry queue.
-  if (ESAT_I2CSlave.telemetryQueueResetReceived())
-  {
-    pendingI2CTelemetry = pendingI2CTelemetryBuffer;
-    pendingI2CTelemetryBuffer.clearAll();
-  }
-  // Some pending I2C telemetry packet might have been disabled
-  // since the last I2C request.
-  pendingI2CTelemetry = pendingI2CTelemetry & enabledTelemetry;
+  updatePendingI2CTelemetry();
   // We try to satisfy requests until we run out of packets.
   // Then, we just reject the request.
   if (pendingI2CTelemetry.available() > 0)
@@ -219,6 +217,55 @@ void ESAT_SubsystemPacketHandlerClass::setTime(ESAT_Timestamp timestamp)
   }
 }
 
+void ESAT_SubsystemPacketHandlerClass::stageI2CTelemetry()
+{
+  if (ESAT_I2CSlave.stagedTelemetryAvailableForWrite() == 0)
+  {
+    return;
+  }
+  updatePendingI2CTelemetry();
+  while ((ESAT_I2CSlave.stagedTelemetryAvailableForWrite() > 0)
+         && (pendingI2CTelemetry.available() > 0))
+  {
+    const byte identifier = byte(pendingI2CTelemetry.readNext());
+    pendingI2CTelemetry.clear(identifier);
+    const boolean gotPacket =
+      telemetryPacketBuilder.build(i2cTelemetryPacket, identifier);
+    if (gotPacket)
+    {
+      // Staging fails if the master reset the telemetry queue after
+      // updatePendingI2CTelemetry(); the next call starts over.
+      const boolean staged =
+        ESAT_I2CSlave.stageTelemetry(i2cTelemetryPacket,
+                                     i2cTelemetryQueueResetSequence);
+      if (!staged)
+      {
+        return;
+      }
+    }
+  }
+}
+
+void ESAT_SubsystemPacketHandlerClass::updatePendingI2CTelemetry()
+{
+  // We only update the list of pending I2C telemetry packets
+  // with the contents of the buffered list when we receive
+  // a command to reset the telemetry queue.  The reset sequence
+  // number catches every reset, even those that come while we are
+  // staging packets.
+  const unsigned long resetSequence =
+    ESAT_I2CSlave.telemetryQueueResetSequence();
+  if (resetSequence != i2cTelemetryQueueResetSequence)
+  {
+    i2cTelemetryQueueResetSequence = resetSequence;
+    pendingI2CTelemetry = pendingI2CTelemetryBuffer;
+    pendingI2CTelemetryBuffer.clearAll();
+  }
+  // Some pending I2C telemetry packet might have been disabled
+  // since the last I2C request.
+  pendingI2CTelemetry = pendingI2CTelemetry & enabledTelemetry;
+}
+
 void ESAT_SubsystemPacketHandlerClass::writePacketToUSB(ESAT_CCSDSPacket packet)
 {
   (void) usbWriter.unbufferedWrite(packet);
@@ -76,6 +76,14 @@ class ESAT_SubsystemPacketHandlerClass
     // Return true on success; otherwise return false.
     boolean dispatchTelecommand(ESAT_CCSDSPacket& telecommandPacket);
 
+    // Build up to the given number of I2C telemetry packets ahead
+    // of the next-packet telemetry requests of the I2C master, so
+    // that the I2C slave can answer them right away (see
+    // ESAT_I2CSlave.beginTelemetryStaging()).  Staged packets are
+    // built with the telemetry available at the time of staging.
+    // Call this after begin().
+    void enableI2CTelemetryStaging(unsigned long numberOfPackets);
+
     // Enable the telemetry packet with the given identifier.
     void enableTelemetry(byte packetIdentifier);
 
@@ -106,11 +114,20 @@ class ESAT_SubsystemPacketHandlerClass
     boolean readSubsystemsOwnTelemetry(ESAT_CCSDSPacket& packet);
 
     // Respond to the pending (if any) I2C request.
+    // Stage the next I2C telemetry packets if I2C telemetry staging
+    // is enabled.
     void respondToI2CPacketRequest();
 
     // Set the clock.
     void setTime(ESAT_Timestamp timestamp);
 
+    // Build the next pending I2C telemetry packets while there is
+    // room for them in the I2C telemetry staging ring.
+    // Call this on each main loop cycle if I2C telemetry staging is
+    // enabled (see enableI2CTelemetryStaging()); it does nothing
+    // otherwise.
+    void stageI2CTelemetry();
+
     // Write a packet to the USB interface.
     void writePacketToUSB(ESAT_CCSDSPacket packet);
 
@@ -121,6 +138,10 @@ class ESAT_SubsystemPacketHandlerClass
     // Telemetry packet for I2C requests.
     ESAT_CCSDSPacket i2cTelemetryPacket;
 
+    // Sequence number of the latest telemetry queue reset seen by
+    // updatePendingI2CTelemetry().
+    unsigned long i2cTelemetryQueueResetSequence;
+
     // Telecommand packet for I2C requests.
     ESAT_CCSDSPacket i2cTelecommandPacket;
 
@@ -160,6 +181,11 @@ class ESAT_SubsystemPacketHandlerClass
 
     // Respond to a next-packt telemetry request from the I2C master.
     void respondToNextPacketTelemetryRequest();
+
+    // Update the list of pending I2C telemetry packets with the
+    // buffered list if the I2C master requested a reset of the
+    // telemetry queue.
+    void updatePendingI2CTelemetry();
 };
 
 // Global instance of the subsystem data handler library.
@@ -192,6 +218,13 @@ extern ESAT_SubsystemPacketHandlerClass ESAT_SubsystemPacketHandler;
 //      telemetry packets.  Calling
 //      ESAT_SubsystemPacketHandler.respondToI2CPacketRequest()
 //      fulfills these requests automatically.
+//   -- To answer next-packet telemetry requests without waiting
+//      for the next call to
+//      ESAT_SubsystemPacketHandler.respondToI2CPacketRequest(),
+//      call ESAT_SubsystemPacketHandler.enableI2CTelemetryStaging()
+//      and then ESAT_SubsystemPacketHandler.stageI2CTelemetry()
+//      on each main loop cycle: the following packets will be built
+//      ahead of time.
 // - Subsystems can respond to CCSDS Space Packets carrying telecommands.
 //   -- Call ESAT_SubsystemPacketHandler.dispatchTelecommand()
 //      to respond to a telecommand.
@@ -25,6 +25,7 @@ void ESAT_TimerClass::begin(word thePeriod)
   period = thePeriod;
   previousWakeUpTime = millis();
   previousWaitTime = period;
+  currentWaitTime = 0;
 }
 
 byte ESAT_TimerClass::load()
@@ -66,4 +67,40 @@ void ESAT_TimerClass::waitUntilNextCycle()
   }
 }
 
+boolean ESAT_TimerClass::waitUntilNextCycleOrEvent(boolean (*eventPending)())
+{
+  // The wait is split into one-millisecond naps, with a look at the
+  // events after each one.  The waits of a cycle add up for load().
+  // As in waitUntilNextCycle(), a cycle that started late without
+  // any wait resynchronizes the wake-up time.
+  while (elapsedMilliseconds() < period)
+  {
+    if (eventPending())
+    {
+      return false;
+    }
+    const unsigned long napStartTime = millis();
+    delay(1);
+    currentWaitTime = currentWaitTime + (millis() - napStartTime);
+  }
+  if (currentWaitTime > 0)
+  {
+    previousWakeUpTime = previousWakeUpTime + period;
+  }
+  else
+  {
+    previousWakeUpTime = millis();
+  }
+  if (currentWaitTime > period)
+  {
+    previousWaitTime = period;
+  }
+  else
+  {
+    previousWaitTime = currentWaitTime;
+  }
+  currentWaitTime = 0;
+  return true;
+}
+
 ESAT_TimerClass ESAT_Timer;
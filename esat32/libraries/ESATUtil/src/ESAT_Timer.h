@@ -28,6 +28,10 @@
 // Use the global instance ESAT_Timer.
 // Set up with ESAT_Timer.begin().
 // Wait until the start of the next cycle with ESAT_Timer.waitUntilNextCycle().
+// Event-driven programs can wait with
+// ESAT_Timer.waitUntilNextCycleOrEvent() instead, which also returns
+// as soon as there is an event to handle, without shifting the start
+// of the next cycle.
 class ESAT_TimerClass
 {
   public:
@@ -56,7 +60,18 @@ class ESAT_TimerClass
     // the last wake-up time.
     void waitUntilNextCycle();
 
+    // Wait until the next cycle is due or until the given function
+    // returns true, whichever happens first.  The function is called
+    // once per millisecond while waiting.
+    // Return true at the start of the next cycle; return false on
+    // events, which don't change the start time of the next cycle.
+    boolean waitUntilNextCycleOrEvent(boolean (*eventPending)());
+
   private:
+    // Time (in milliseconds) waited so far in the current cycle
+    // by waitUntilNextCycleOrEvent().
+    unsigned long currentWaitTime;
+
     // Wait time (in milliseconds) of the previous cycle.
     unsigned long previousWaitTime;
 
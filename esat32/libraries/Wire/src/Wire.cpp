@@ -31,6 +31,17 @@ extern "C" {
 // 0x01 is a reserved value, and thus cannot be used by slave devices
 static const uint8_t MASTER_ADDRESS = 0x01;
 
+// Timestamp used to measure master transfers for the transfer observer:
+// DWT cycles when available, microseconds otherwise.
+static inline uint32_t transferTimestamp(void)
+{
+#ifdef DWT_BASE
+  return dwt_getCycles();
+#else
+  return micros();
+#endif
+}
+
 // Constructors ////////////////////////////////////////////////////////////////
 
 TwoWire::TwoWire(uint32_t sda, uint32_t scl)
@@ -43,6 +54,7 @@ TwoWire::TwoWire(uint32_t sda, uint32_t scl)
   txBufferAllocated = 0;
   rxBuffer = nullptr;
   rxBufferAllocated = 0;
+  lastTransferStatus = I2C_OK;
 }
 
 /**
@@ -170,9 +182,14 @@ uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint32_t iaddres
     }
 #endif
 
-    if (I2C_OK == i2c_master_read(&_i2c, address << 1, rxBuffer, quantity)) {
+    const uint32_t startTime = transferTimestamp();
+    lastTransferStatus = i2c_master_read(&_i2c, address << 1, rxBuffer, quantity);
+    if (I2C_OK == lastTransferStatus) {
       read = quantity;
     }
+    if (user_onTransfer) {
+      user_onTransfer(address, lastTransferStatus, read, transferTimestamp() - startTime);
+    }
 
     // set rx buffer iterator vars
     rxBufferIndex = 0;
@@ -252,7 +269,13 @@ uint8_t TwoWire::endTransmission(uint8_t sendStop)
 
   if (_i2c.isMaster == 1) {
     // transmit buffer (blocking)
-    switch (i2c_master_write(&_i2c, txAddress, txBuffer, txDataSize)) {
+    const uint32_t startTime = transferTimestamp();
+    lastTransferStatus = i2c_master_write(&_i2c, txAddress, txBuffer, txDataSize);
+    if (user_onTransfer) {
+      const uint16_t written = (lastTransferStatus == I2C_OK) ? txDataSize : 0;
+      user_onTransfer(txAddress >> 1, lastTransferStatus, written, transferTimestamp() - startTime);
+    }
+    switch (lastTransferStatus) {
       case I2C_OK :
         ret = 0; // Success
         break;
@@ -293,6 +316,23 @@ uint8_t TwoWire::endTransmission(void)
   return endTransmission((uint8_t)true);
 }
 
+//  This checks whether the slave at the given address is present:
+//  it addresses the slave (up to the given number of trials) and
+//  sees if it acknowledges, without transferring any data.
+//
+bool TwoWire::isDeviceReady(uint8_t address, uint32_t trials)
+{
+  if (_i2c.isMaster != 1) {
+    return false;
+  }
+  const uint32_t startTime = transferTimestamp();
+  lastTransferStatus = i2c_IsDeviceReady(&_i2c, address << 1, trials);
+  if (user_onTransfer) {
+    user_onTransfer(address, lastTransferStatus, 0, transferTimestamp() - startTime);
+  }
+  return (lastTransferStatus == I2C_OK);
+}
+
 // must be called in:
 // slave tx event callback
 // or after beginTransmission(address)
@@ -458,6 +498,12 @@ void TwoWire::onRequest(cb_function_request_t function)
   user_onRequest = function;
 }
 
+// sets function called after each master transfer
+void TwoWire::onTransfer(cb_function_transfer_t function)
+{
+  user_onTransfer = function;
+}
+
 /**
   * @brief  Allocate the Rx/Tx buffer to the requested length if needed
   * @note   Minimum allocated size is BUFFER_LENGTH)
@@ -45,6 +45,10 @@ class TwoWire : public Stream {
   public:
     typedef std::function<void(int)> cb_function_receive_t;
     typedef std::function<void(void)> cb_function_request_t;
+    // Master transfer observer: slave address, transfer status
+    // (i2c_status_e), bytes transferred and duration in DWT cycles
+    // (in microseconds when the DWT cycle counter is not available).
+    typedef std::function<void(uint8_t, uint8_t, uint16_t, uint32_t)> cb_function_transfer_t;
 
   private:
     uint8_t *rxBuffer;
@@ -64,6 +68,9 @@ class TwoWire : public Stream {
 
     std::function<void(int)> user_onReceive;
     std::function<void(void)> user_onRequest;
+    std::function<void(uint8_t, uint8_t, uint16_t, uint32_t)> user_onTransfer;
+
+    i2c_status_e lastTransferStatus;
 
     static void onRequestService(i2c_t *);
     static void onReceiveService(i2c_t *);
@@ -111,6 +118,7 @@ class TwoWire : public Stream {
     uint8_t requestFrom(uint8_t, uint8_t, uint32_t, uint8_t, uint8_t);
     uint8_t requestFrom(int, int);
     uint8_t requestFrom(int, int, int);
+    bool isDeviceReady(uint8_t, uint32_t trials = 1);
     virtual size_t write(uint8_t);
     virtual size_t write(const uint8_t *, size_t);
     virtual int available(void);
@@ -120,6 +128,15 @@ class TwoWire : public Stream {
 
     void onReceive(cb_function_receive_t callback);
     void onRequest(cb_function_request_t callback);
+    void onTransfer(cb_function_transfer_t callback);
+
+    // Status of the latest master transfer (endTransmission() or
+    // requestFrom()).  Unlike the return value of requestFrom(), it
+    // tells a NACK from a timeout.
+    i2c_status_e getLastTransferStatus(void)
+    {
+      return lastTransferStatus;
+    }
 
     inline size_t write(unsigned long n)
     {